@@ -4,7 +4,7 @@ AUTOCONF_BUILD = i686-pc-linux-gnu
 
 ARCH_CFLAGS  = -m32 -march=core2
 ARCH_LDFLAGS = -m32
-ARCH_LIBFLAGS = -lrt
+ARCH_LIBFLAGS = -lrt -lpthread
 
 EXT_CFLAGS   = -m32 -march=core2
 EXT_CXXFLAGS = -m32 -march=core2
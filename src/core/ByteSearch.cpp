@@ -0,0 +1,1065 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "fianet-core.h"
+#include "ByteSearch.h"
+#include "CharSet.h"
+
+#if defined(FIANET_SIMD_DISPATCH) || defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSSE3__)
+	#include <tmmintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+namespace Fianet {
+
+static inline const ByteKernels& kernels();
+
+/*
+ * Substring search kernels.
+ *
+ * The vectorized kernels compare two bytes of the needle (the first and the
+ * last ones, in most cases) against 16 or 32 consecutive haystack positions
+ * at once, and only run a memcmp() on the positions where both bytes match.
+ * On our XML and CSV payloads, the first byte of a needle ('<', '"', ...) is
+ * everywhere, so filtering on two distant bytes removes almost all of the
+ * false candidates the old memchr() + memcmp() loop had to verify.
+ */
+
+/**
+ * Rough frequency rank of each byte in our payloads (XML, CSV, free text in
+ * French and English). The higher the rank, the more common the byte.
+ */
+static const uint8_t byteRank[256] = {
+	 80,  60,  60,  60,  60,  60,  60,  60,  60, 230, 230,  60,  60, 230,  60,  60,
+	 60,  60,  60,  60,  60,  60,  60,  60,  60,  60,  60,  60,  60,  60,  60,  60,
+	255, 150, 235, 150, 150, 150, 150, 150, 150, 150, 150, 150, 235, 235, 235, 235,
+	225, 222, 215, 215, 215, 215, 215, 215, 215, 215, 235, 235, 235, 235, 235, 150,
+	150, 185, 170, 170, 170, 185, 170, 170, 170, 185, 170, 170, 185, 170, 185, 185,
+	170, 170, 185, 185, 185, 170, 170, 170, 170, 170, 170, 150, 150, 150, 150, 235,
+	150, 244, 193, 217, 223, 250, 205, 202, 229, 238, 184, 187, 220, 211, 235, 241,
+	196, 178, 226, 232, 247, 214, 190, 208, 181, 199, 175, 150, 150, 150, 150, 150,
+	 40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+	 40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+	 40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+	 40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+	 40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+	 40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+	 40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+	 40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40
+};
+
+void memfindSelectBytes (const void* needle, size_t needle_len, size_t& off1, size_t& off2)
+{
+	const uint8_t* n = static_cast<const uint8_t*>(needle);
+
+	off1 = 0;
+	off2 = (needle_len > 1) ? needle_len - 1 : 0;
+
+	// The first and last bytes are the most distant ones, hence the least
+	// correlated in structured data: they make the best filter, unless they
+	// have the same value ('"..."', '<...<'). In that case, the first byte
+	// is replaced by the rarest byte having a different value.
+	if (needle_len > 2 && n[0] == n[off2]) {
+		int best = 256;
+		for (size_t i = 1; i < off2; ++i) {
+			const int r = byteRank[n[i]];
+			if (r < best && n[i] != n[off2]) {
+				best = r;
+				off1 = i;
+			}
+		}
+	}
+}
+
+uint8_t* memfind_scalar (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	// The rare byte can only appear in [off1 ... last candidate + off1].
+	const uint8_t* p = hay + off1;
+	const uint8_t* end = hay + (len_s1 - len_s2) + off1 + 1;
+	const uint8_t c = needle[off1];
+
+	while (p < end) {
+		p = static_cast<const uint8_t*>(memchr (p, c, end - p));
+		if (!p) {
+			break;
+		}
+		if (memcmp (p - off1, needle, len_s2) == 0) {
+			return const_cast<uint8_t*>(p - off1);
+		}
+		++p;
+	}
+
+	return 0;
+}
+
+static uint8_t* find_scalar (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t UNUSED_PARAM(off2))
+{
+	return memfind_scalar (s1, len_s1, s2, len_s2, off1);
+}
+
+static uint8_t* candidate_scalar (const void* haystack, size_t haystack_len, size_t span, uint8_t b1, size_t off1, uint8_t b2, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(haystack);
+
+	if (span > haystack_len) {
+		return 0;
+	}
+
+	const size_t last = haystack_len - span;
+
+	for (size_t i = 0; i <= last; ++i) {
+		const uint8_t* p = static_cast<const uint8_t*>(memchr (hay + i + off1, b1, last - i + 1));
+		if (!p) {
+			break;
+		}
+		i = (p - hay) - off1;
+		if (hay[i + off2] == b2) {
+			return const_cast<uint8_t*>(hay + i);
+		}
+	}
+
+	return 0;
+}
+
+#if defined(FIANET_SIMD_SSE2)
+FIANET_TARGET("sse2")
+static uint8_t* memfind_sse2 (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	const size_t last = len_s1 - len_s2;	// last candidate position
+	const __m128i b1 = _mm_set1_epi8 (static_cast<char>(needle[off1]));
+	const __m128i b2 = _mm_set1_epi8 (static_cast<char>(needle[off2]));
+	size_t i = 0;
+
+	// Blocks of 16 candidates, as long as the whole block is readable.
+	for (; i + 16 <= last + 1; i += 16) {
+		const __m128i h1 = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(hay + i + off1));
+		const __m128i h2 = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(hay + i + off2));
+		uint32_t mask = _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (h1, b1), _mm_cmpeq_epi8 (h2, b2)));
+
+		while (mask) {
+			const size_t pos = i + __builtin_ctz (mask);
+			if (memcmp (hay + pos, needle, len_s2) == 0) {
+				return const_cast<uint8_t*>(hay + pos);
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	// Less than 16 candidates left.
+	if (i <= last) {
+		uint8_t* res = memfind_scalar (hay + i, len_s1 - i, needle, len_s2, off1);
+		if (res) {
+			return res;
+		}
+	}
+
+	return 0;
+}
+
+FIANET_TARGET("sse2")
+static uint8_t* candidate_sse2 (const void* haystack, size_t haystack_len, size_t span, uint8_t b1, size_t off1, uint8_t b2, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(haystack);
+
+	if (span > haystack_len) {
+		return 0;
+	}
+
+	const size_t last = haystack_len - span;
+	const __m128i v1 = _mm_set1_epi8 (static_cast<char>(b1));
+	const __m128i v2 = _mm_set1_epi8 (static_cast<char>(b2));
+	size_t i = 0;
+
+	for (; i + 16 <= last + 1; i += 16) {
+		const __m128i h1 = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(hay + i + off1));
+		const __m128i h2 = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(hay + i + off2));
+		uint32_t mask = _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (h1, v1), _mm_cmpeq_epi8 (h2, v2)));
+		if (mask) {
+			return const_cast<uint8_t*>(hay + i + __builtin_ctz (mask));
+		}
+	}
+
+	return candidate_scalar (hay + i, haystack_len - i, span, b1, off1, b2, off2);
+}
+#endif
+
+#if defined(FIANET_SIMD_AVX2)
+FIANET_TARGET("avx2")
+static uint8_t* memfind_avx2 (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	const size_t last = len_s1 - len_s2;
+	const __m256i b1 = _mm256_set1_epi8 (static_cast<char>(needle[off1]));
+	const __m256i b2 = _mm256_set1_epi8 (static_cast<char>(needle[off2]));
+	size_t i = 0;
+
+	for (; i + 32 <= last + 1; i += 32) {
+		const __m256i h1 = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(hay + i + off1));
+		const __m256i h2 = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(hay + i + off2));
+		uint32_t mask = _mm256_movemask_epi8 (_mm256_and_si256 (_mm256_cmpeq_epi8 (h1, b1), _mm256_cmpeq_epi8 (h2, b2)));
+
+		while (mask) {
+			const size_t pos = i + __builtin_ctz (mask);
+			if (memcmp (hay + pos, needle, len_s2) == 0) {
+				return const_cast<uint8_t*>(hay + pos);
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	if (i <= last) {
+		return memfind_sse2 (hay + i, len_s1 - i, needle, len_s2, off1, off2);
+	}
+
+	return 0;
+}
+
+FIANET_TARGET("avx2")
+static uint8_t* candidate_avx2 (const void* haystack, size_t haystack_len, size_t span, uint8_t b1, size_t off1, uint8_t b2, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(haystack);
+
+	if (span > haystack_len) {
+		return 0;
+	}
+
+	const size_t last = haystack_len - span;
+	const __m256i w1 = _mm256_set1_epi8 (static_cast<char>(b1));
+	const __m256i w2 = _mm256_set1_epi8 (static_cast<char>(b2));
+	size_t i = 0;
+
+	for (; i + 32 <= last + 1; i += 32) {
+		const __m256i h1 = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(hay + i + off1));
+		const __m256i h2 = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(hay + i + off2));
+		uint32_t mask = _mm256_movemask_epi8 (_mm256_and_si256 (_mm256_cmpeq_epi8 (h1, w1), _mm256_cmpeq_epi8 (h2, w2)));
+		if (mask) {
+			return const_cast<uint8_t*>(hay + i + __builtin_ctz (mask));
+		}
+	}
+
+	return candidate_sse2 (hay + i, haystack_len - i, span, b1, off1, b2, off2);
+}
+#endif
+
+uint8_t* memfind_pair (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1, size_t off2)
+{
+	return kernels().find (haystack, haystack_len, needle, needle_len, off1, off2);
+}
+
+uint8_t* memfind_candidate (const void* haystack, size_t haystack_len, size_t span, uint8_t b1, size_t off1, uint8_t b2, size_t off2)
+{
+	return kernels().candidate (haystack, haystack_len, span, b1, off1, b2, off2);
+}
+
+// Look for s2 in s1
+uint8_t* memfind (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
+{
+	if (UNLIKELY(len_s2 == 0)) {
+		return const_cast<uint8_t*>(static_cast<const uint8_t*>(s1));
+	} else if (len_s2 > len_s1) {
+		return 0;
+	} else if (len_s2 == 1) {
+		return static_cast<uint8_t*>(const_cast<void*>(memchr (s1, *static_cast<const uint8_t*>(s2), len_s1)));
+	}
+
+	size_t off1, off2;
+	memfindSelectBytes (s2, len_s2, off1, off2);
+
+	return memfind_pair (s1, len_s1, s2, len_s2, off1, off2);
+}
+
+/*
+ * Reverse search kernels: the same filters as the forward ones, candidate
+ * blocks being scanned from the end of the haystack.
+ */
+
+uint8_t* memrfind_scalar (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	// The filter byte of the candidates is in [start ... start + nb - 1].
+	const uint8_t* start = hay + off1;
+	const uint8_t c = needle[off1];
+	size_t nb = len_s1 - len_s2 + 1;
+
+	while (nb > 0) {
+		const uint8_t* p = static_cast<const uint8_t*>(memrchr (start, c, nb));
+		if (!p) {
+			break;
+		}
+		if (memcmp (p - off1, needle, len_s2) == 0) {
+			return const_cast<uint8_t*>(p - off1);
+		}
+		nb = p - start;
+	}
+
+	return 0;
+}
+
+static uint8_t* rfind_scalar (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t UNUSED_PARAM(off2))
+{
+	return memrfind_scalar (s1, len_s1, s2, len_s2, off1);
+}
+
+#if defined(FIANET_SIMD_SSE2)
+FIANET_TARGET("sse2")
+static uint8_t* memrfind_sse2 (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	const __m128i b1 = _mm_set1_epi8 (static_cast<char>(needle[off1]));
+	const __m128i b2 = _mm_set1_epi8 (static_cast<char>(needle[off2]));
+	size_t end = len_s1 - len_s2 + 1;	// candidates left: [0 ... end - 1]
+
+	for (; end >= 16; end -= 16) {
+		const size_t i = end - 16;
+		const __m128i h1 = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(hay + i + off1));
+		const __m128i h2 = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(hay + i + off2));
+		uint32_t mask = _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (h1, b1), _mm_cmpeq_epi8 (h2, b2)));
+
+		while (mask) {
+			const int bit = 31 - __builtin_clz (mask);
+			if (memcmp (hay + i + bit, needle, len_s2) == 0) {
+				return const_cast<uint8_t*>(hay + i + bit);
+			}
+			mask ^= (1U << bit);
+		}
+	}
+
+	// Less than 16 candidates left.
+	if (end > 0) {
+		return memrfind_scalar (hay, end - 1 + len_s2, needle, len_s2, off1);
+	}
+
+	return 0;
+}
+#endif
+
+#if defined(FIANET_SIMD_AVX2)
+FIANET_TARGET("avx2")
+static uint8_t* memrfind_avx2 (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	const __m256i b1 = _mm256_set1_epi8 (static_cast<char>(needle[off1]));
+	const __m256i b2 = _mm256_set1_epi8 (static_cast<char>(needle[off2]));
+	size_t end = len_s1 - len_s2 + 1;
+
+	for (; end >= 32; end -= 32) {
+		const size_t i = end - 32;
+		const __m256i h1 = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(hay + i + off1));
+		const __m256i h2 = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(hay + i + off2));
+		uint32_t mask = _mm256_movemask_epi8 (_mm256_and_si256 (_mm256_cmpeq_epi8 (h1, b1), _mm256_cmpeq_epi8 (h2, b2)));
+
+		while (mask) {
+			const int bit = 31 - __builtin_clz (mask);
+			if (memcmp (hay + i + bit, needle, len_s2) == 0) {
+				return const_cast<uint8_t*>(hay + i + bit);
+			}
+			mask ^= (1U << bit);
+		}
+	}
+
+	if (end > 0) {
+		return memrfind_sse2 (hay, end - 1 + len_s2, needle, len_s2, off1, off2);
+	}
+
+	return 0;
+}
+#endif
+
+uint8_t* memrfind_pair (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1, size_t off2)
+{
+	return kernels().rfind (haystack, haystack_len, needle, needle_len, off1, off2);
+}
+
+uint8_t* memrfind (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
+{
+	if (UNLIKELY(len_s2 == 0)) {
+		return const_cast<uint8_t*>(static_cast<const uint8_t*>(s1)) + len_s1;
+	} else if (len_s2 > len_s1) {
+		return 0;
+	} else if (len_s2 == 1) {
+		return static_cast<uint8_t*>(const_cast<void*>(memrchr (s1, *static_cast<const uint8_t*>(s2), len_s1)));
+	}
+
+	size_t off1, off2;
+	memfindSelectBytes (s2, len_s2, off1, off2);
+
+	return memrfind_pair (s1, len_s1, s2, len_s2, off1, off2);
+}
+
+/*
+ * Case-insensitive kernels.
+ *
+ * Both operands are converted to upper case, as toupper() does in the "C"
+ * locale: only 'a' ... 'z' change, which keeps the order of memicompare()
+ * unchanged. Vectors are converted with a single signed range compare:
+ * adding 0x80 - 'a' maps 'a' ... 'z' to -128 ... -103, then the 0x20 bit of
+ * the bytes below -102 is flipped. The case conversion kernels use the same
+ * compare, with 'A' for lower case.
+ */
+
+// Read by every thread: stored as an int with atomic operations.
+static int caseFolding = ASCII_CASE_FOLDING;
+
+void setCaseFolding (CaseFolding folding)
+{
+	__atomic_store_n (&caseFolding, folding, __ATOMIC_RELAXED);
+}
+
+CaseFolding getCaseFolding()
+{
+	return static_cast<CaseFolding>(__atomic_load_n (&caseFolding, __ATOMIC_RELAXED));
+}
+
+static inline uint8_t flipCase (uint8_t c, uint8_t first)
+{
+	return c ^ ((static_cast<uint8_t>(c - first) < 26) << 5);
+}
+
+static inline uint8_t asciiUpper (uint8_t c)
+{
+	return flipCase (c, 'a');
+}
+
+static int icompare_scalar (const void* s1, const void* s2, size_t sz)
+{
+	const uint8_t* p1 = static_cast<const uint8_t*>(s1);
+	const uint8_t* p2 = static_cast<const uint8_t*>(s2);
+
+	for (size_t i = 0; i < sz; ++i) {
+		const int res = asciiUpper (p1[i]) - asciiUpper (p2[i]);
+		if (res) {
+			return res;
+		}
+	}
+
+	return 0;
+}
+
+static uint8_t* ifind_scalar (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	const uint8_t c1 = asciiUpper (needle[off1]);
+	const uint8_t c2 = asciiUpper (needle[off2]);
+	const size_t last = len_s1 - len_s2;
+
+	for (size_t i = 0; i <= last; ++i) {
+		if (asciiUpper (hay[i + off1]) == c1 && asciiUpper (hay[i + off2]) == c2
+				&& icompare_scalar (hay + i, needle, len_s2) == 0) {
+			return const_cast<uint8_t*>(hay + i);
+		}
+	}
+
+	return 0;
+}
+
+static void flipcase_scalar (void* s, size_t len, uint8_t first)
+{
+	uint8_t* p = static_cast<uint8_t*>(s);
+
+	for (size_t i = 0; i < len; ++i) {
+		p[i] = flipCase (p[i], first);
+	}
+}
+
+#if defined(FIANET_SIMD_SSE2)
+FIANET_TARGET("sse2")
+static inline __m128i flipCase (__m128i v, uint8_t first)
+{
+	const __m128i t = _mm_add_epi8 (v, _mm_set1_epi8 (static_cast<char>(0x80 - first)));
+	const __m128i range = _mm_cmplt_epi8 (t, _mm_set1_epi8 (-128 + 26));
+	return _mm_xor_si128 (v, _mm_and_si128 (range, _mm_set1_epi8 (0x20)));
+}
+
+FIANET_TARGET("sse2")
+static inline __m128i asciiUpper (__m128i v)
+{
+	return flipCase (v, 'a');
+}
+
+FIANET_TARGET("sse2")
+static int icompare_sse2 (const void* s1, const void* s2, size_t sz)
+{
+	const uint8_t* p1 = static_cast<const uint8_t*>(s1);
+	const uint8_t* p2 = static_cast<const uint8_t*>(s2);
+	size_t i = 0;
+
+	for (; i + 16 <= sz; i += 16) {
+		const __m128i a = asciiUpper (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(p1 + i)));
+		const __m128i b = asciiUpper (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(p2 + i)));
+		const uint32_t diff = _mm_movemask_epi8 (_mm_cmpeq_epi8 (a, b)) ^ 0xFFFF;
+		if (diff) {
+			i += __builtin_ctz (diff);
+			return asciiUpper (p1[i]) - asciiUpper (p2[i]);
+		}
+	}
+
+	return icompare_scalar (p1 + i, p2 + i, sz - i);
+}
+
+FIANET_TARGET("sse2")
+static uint8_t* ifind_sse2 (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	const size_t last = len_s1 - len_s2;
+	const __m128i v1 = _mm_set1_epi8 (static_cast<char>(asciiUpper (needle[off1])));
+	const __m128i v2 = _mm_set1_epi8 (static_cast<char>(asciiUpper (needle[off2])));
+	size_t i = 0;
+
+	for (; i + 16 <= last + 1; i += 16) {
+		const __m128i h1 = asciiUpper (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(hay + i + off1)));
+		const __m128i h2 = asciiUpper (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(hay + i + off2)));
+		uint32_t mask = _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (h1, v1), _mm_cmpeq_epi8 (h2, v2)));
+
+		while (mask) {
+			const size_t pos = i + __builtin_ctz (mask);
+			if (icompare_sse2 (hay + pos, needle, len_s2) == 0) {
+				return const_cast<uint8_t*>(hay + pos);
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	return ifind_scalar (hay + i, len_s1 - i, needle, len_s2, off1, off2);
+}
+
+FIANET_TARGET("sse2")
+static void flipcase_sse2 (void* s, size_t len, uint8_t first)
+{
+	uint8_t* p = static_cast<uint8_t*>(s);
+	size_t i = 0;
+
+	for (; i + 16 <= len; i += 16) {
+		__m128i* v = reinterpret_cast<__m128i*>(p + i);
+		_mm_storeu_si128 (v, flipCase (_mm_loadu_si128 (v), first));
+	}
+
+	flipcase_scalar (p + i, len - i, first);
+}
+#endif
+
+#if defined(FIANET_SIMD_AVX2)
+FIANET_TARGET("avx2")
+static inline __m256i flipCase (__m256i v, uint8_t first)
+{
+	const __m256i t = _mm256_add_epi8 (v, _mm256_set1_epi8 (static_cast<char>(0x80 - first)));
+	const __m256i range = _mm256_cmpgt_epi8 (_mm256_set1_epi8 (-128 + 26), t);
+	return _mm256_xor_si256 (v, _mm256_and_si256 (range, _mm256_set1_epi8 (0x20)));
+}
+
+FIANET_TARGET("avx2")
+static inline __m256i asciiUpper (__m256i v)
+{
+	return flipCase (v, 'a');
+}
+
+FIANET_TARGET("avx2")
+static int icompare_avx2 (const void* s1, const void* s2, size_t sz)
+{
+	const uint8_t* p1 = static_cast<const uint8_t*>(s1);
+	const uint8_t* p2 = static_cast<const uint8_t*>(s2);
+	size_t i = 0;
+
+	for (; i + 32 <= sz; i += 32) {
+		const __m256i a = asciiUpper (_mm256_loadu_si256 (reinterpret_cast<const __m256i*>(p1 + i)));
+		const __m256i b = asciiUpper (_mm256_loadu_si256 (reinterpret_cast<const __m256i*>(p2 + i)));
+		const uint32_t diff = ~static_cast<uint32_t>(_mm256_movemask_epi8 (_mm256_cmpeq_epi8 (a, b)));
+		if (diff) {
+			i += __builtin_ctz (diff);
+			return asciiUpper (p1[i]) - asciiUpper (p2[i]);
+		}
+	}
+
+	return icompare_sse2 (p1 + i, p2 + i, sz - i);
+}
+
+FIANET_TARGET("avx2")
+static uint8_t* ifind_avx2 (const void* s1, size_t len_s1, const void* s2, size_t len_s2, size_t off1, size_t off2)
+{
+	const uint8_t* hay = static_cast<const uint8_t*>(s1);
+	const uint8_t* needle = static_cast<const uint8_t*>(s2);
+
+	if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	const size_t last = len_s1 - len_s2;
+	const __m256i w1 = _mm256_set1_epi8 (static_cast<char>(asciiUpper (needle[off1])));
+	const __m256i w2 = _mm256_set1_epi8 (static_cast<char>(asciiUpper (needle[off2])));
+	size_t i = 0;
+
+	for (; i + 32 <= last + 1; i += 32) {
+		const __m256i h1 = asciiUpper (_mm256_loadu_si256 (reinterpret_cast<const __m256i*>(hay + i + off1)));
+		const __m256i h2 = asciiUpper (_mm256_loadu_si256 (reinterpret_cast<const __m256i*>(hay + i + off2)));
+		uint32_t mask = _mm256_movemask_epi8 (_mm256_and_si256 (_mm256_cmpeq_epi8 (h1, w1), _mm256_cmpeq_epi8 (h2, w2)));
+
+		while (mask) {
+			const size_t pos = i + __builtin_ctz (mask);
+			if (icompare_avx2 (hay + pos, needle, len_s2) == 0) {
+				return const_cast<uint8_t*>(hay + pos);
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	return ifind_sse2 (hay + i, len_s1 - i, needle, len_s2, off1, off2);
+}
+
+FIANET_TARGET("avx2")
+static void flipcase_avx2 (void* s, size_t len, uint8_t first)
+{
+	uint8_t* p = static_cast<uint8_t*>(s);
+	size_t i = 0;
+
+	for (; i + 32 <= len; i += 32) {
+		__m256i* v = reinterpret_cast<__m256i*>(p + i);
+		_mm256_storeu_si256 (v, flipCase (_mm256_loadu_si256 (v), first));
+	}
+
+	flipcase_sse2 (p + i, len - i, first);
+}
+#endif
+
+int memicompare_ascii (const void* s1, const void* s2, size_t sz)
+{
+	return kernels().icompare (s1, s2, sz);
+}
+
+uint8_t* memifind_ascii (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
+{
+	if (UNLIKELY(len_s2 == 0)) {
+		return const_cast<uint8_t*>(static_cast<const uint8_t*>(s1));
+	} else if (len_s2 > len_s1) {
+		return 0;
+	}
+
+	// Same two bytes filter as memfind(), on upper case bytes.
+	size_t off1, off2;
+	memfindSelectBytes (s2, len_s2, off1, off2);
+
+	return kernels().ifind (s1, len_s1, s2, len_s2, off1, off2);
+}
+
+uint8_t* memifind (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
+{
+	if (UNLIKELY(getCaseFolding() == LOCALE_CASE_FOLDING)) {
+		return memifind_locale (s1, len_s1, s2, len_s2);
+	}
+	return memifind_ascii (s1, len_s1, s2, len_s2);
+}
+
+int memicompare (const void* s1, const void* s2, size_t sz)
+{
+	if (UNLIKELY(getCaseFolding() == LOCALE_CASE_FOLDING)) {
+		return memicompare_locale (s1, s2, sz);
+	}
+	return memicompare_ascii (s1, s2, sz);
+}
+
+void memupper_ascii (void* s, size_t len)
+{
+	kernels().flipcase (s, len, 'a');
+}
+
+void memlower_ascii (void* s, size_t len)
+{
+	kernels().flipcase (s, len, 'A');
+}
+
+/*
+ * Character set kernels.
+ *
+ * For each byte, a pshufb looks up the entry of its low nibble in the
+ * CharSet table of the bytes below 0x80: pshufb gives 0 for the bytes from
+ * 0x80, whose sign bit is set. The same is done with the table of the bytes
+ * from 0x80 and the sign bit flipped, unless that table is empty (ASCII
+ * sets). A third pshufb gives the bit of the high nibble in the entry.
+ */
+
+const CharSet& whiteSpaces()
+{
+	static const CharSet spaces (" \t\n\v\f\r");
+	return spaces;
+}
+
+size_t memltrim (const void* s, size_t len)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+
+	// Most strings have no white space at all.
+	if (len == 0 || !isspace (p[0])) {
+		return 0;
+	}
+	// The spaces of the C locale are spaces in every locale: skip them
+	// with the vector kernels, then the spaces of the locale, if any.
+	const uint8_t* first = memcharset (p, len, whiteSpaces(), false);
+	size_t i = first ? first - p : len;
+	while (i < len && isspace (p[i])) {
+		++i;
+	}
+	return i;
+}
+
+size_t memrtrim (const void* s, size_t len)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+
+	if (len == 0 || !isspace (p[len - 1])) {
+		return 0;
+	}
+	const uint8_t* last = memrcharset (p, len, whiteSpaces(), false);
+	size_t i = last ? (last - p) + 1 : 0;
+	while (i > 0 && isspace (p[i - 1])) {
+		--i;
+	}
+	return len - i;
+}
+
+static uint8_t* charset_scalar (const void* s, size_t len, const CharSet& set, bool in)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+
+	for (size_t i = 0; i < len; ++i) {
+		if (set.contains (static_cast<char>(p[i])) == in) {
+			return const_cast<uint8_t*>(p + i);
+		}
+	}
+
+	return 0;
+}
+
+static uint8_t* rcharset_scalar (const void* s, size_t len, const CharSet& set, bool in)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+
+	while (len > 0) {
+		--len;
+		if (set.contains (static_cast<char>(p[len])) == in) {
+			return const_cast<uint8_t*>(p + len);
+		}
+	}
+
+	return 0;
+}
+
+/// @return true if the set contains bytes from 0x80.
+static inline bool hasUpperBytes (const CharSet& set)
+{
+	uint64_t t[2];
+	memcpy (t, set.table (1), sizeof(t));
+	return (t[0] | t[1]) != 0;
+}
+
+#if defined(FIANET_SIMD_SSSE3)
+template <bool UPPER>
+FIANET_TARGET("ssse3")
+static inline uint32_t charsetMask (__m128i v, __m128i low, __m128i high)
+{
+	const __m128i bits = _mm_setr_epi8 (1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	__m128i row = _mm_shuffle_epi8 (low, v);
+	if (UPPER) {
+		row = _mm_or_si128 (row, _mm_shuffle_epi8 (high, _mm_xor_si128 (v, _mm_set1_epi8 (-128))));
+	}
+	const __m128i bit = _mm_shuffle_epi8 (bits, _mm_and_si128 (_mm_srli_epi16 (v, 4), _mm_set1_epi8 (0x0F)));
+	return _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_and_si128 (row, bit), bit));
+}
+
+template <bool UPPER>
+FIANET_TARGET("ssse3")
+static uint8_t* charsetForward_ssse3 (const uint8_t* p, size_t len, const CharSet& set, bool in)
+{
+	const __m128i low = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(set.table (0)));
+	const __m128i high = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(set.table (1)));
+	const uint32_t none = in ? 0 : 0xFFFF;
+	size_t i = 0;
+
+	for (; i + 16 <= len; i += 16) {
+		const uint32_t mask = charsetMask<UPPER> (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(p + i)), low, high) ^ none;
+		if (mask) {
+			return const_cast<uint8_t*>(p + i + __builtin_ctz (mask));
+		}
+	}
+
+	return charset_scalar (p + i, len - i, set, in);
+}
+
+template <bool UPPER>
+FIANET_TARGET("ssse3")
+static uint8_t* charsetBackward_ssse3 (const uint8_t* p, size_t len, const CharSet& set, bool in)
+{
+	const __m128i low = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(set.table (0)));
+	const __m128i high = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(set.table (1)));
+	const uint32_t none = in ? 0 : 0xFFFF;
+	size_t end = len;
+
+	for (; end >= 16; end -= 16) {
+		const uint32_t mask = charsetMask<UPPER> (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(p + end - 16)), low, high) ^ none;
+		if (mask) {
+			return const_cast<uint8_t*>(p + end - 16 + (31 - __builtin_clz (mask)));
+		}
+	}
+
+	return rcharset_scalar (p, end, set, in);
+}
+
+static uint8_t* charset_ssse3 (const void* s, size_t len, const CharSet& set, bool in)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+	return hasUpperBytes (set) ? charsetForward_ssse3<true> (p, len, set, in) : charsetForward_ssse3<false> (p, len, set, in);
+}
+
+static uint8_t* rcharset_ssse3 (const void* s, size_t len, const CharSet& set, bool in)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+	return hasUpperBytes (set) ? charsetBackward_ssse3<true> (p, len, set, in) : charsetBackward_ssse3<false> (p, len, set, in);
+}
+#endif
+
+#if defined(FIANET_SIMD_AVX2)
+template <bool UPPER>
+FIANET_TARGET("avx2")
+static inline uint32_t charsetMask (__m256i v, __m256i low, __m256i high)
+{
+	const __m256i bits = _mm256_setr_epi8 (1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+	                                       1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	__m256i row = _mm256_shuffle_epi8 (low, v);
+	if (UPPER) {
+		row = _mm256_or_si256 (row, _mm256_shuffle_epi8 (high, _mm256_xor_si256 (v, _mm256_set1_epi8 (-128))));
+	}
+	const __m256i bit = _mm256_shuffle_epi8 (bits, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), _mm256_set1_epi8 (0x0F)));
+	return _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (_mm256_and_si256 (row, bit), bit));
+}
+
+template <bool UPPER>
+FIANET_TARGET("avx2")
+static uint8_t* charsetForward_avx2 (const uint8_t* p, size_t len, const CharSet& set, bool in)
+{
+	const __m256i low = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(set.table (0))));
+	const __m256i high = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(set.table (1))));
+	const uint32_t none = in ? 0 : 0xFFFFFFFF;
+	size_t i = 0;
+
+	for (; i + 32 <= len; i += 32) {
+		const uint32_t mask = charsetMask<UPPER> (_mm256_loadu_si256 (reinterpret_cast<const __m256i*>(p + i)), low, high) ^ none;
+		if (mask) {
+			return const_cast<uint8_t*>(p + i + __builtin_ctz (mask));
+		}
+	}
+
+	return charsetForward_ssse3<UPPER> (p + i, len - i, set, in);
+}
+
+template <bool UPPER>
+FIANET_TARGET("avx2")
+static uint8_t* charsetBackward_avx2 (const uint8_t* p, size_t len, const CharSet& set, bool in)
+{
+	const __m256i low = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(set.table (0))));
+	const __m256i high = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(set.table (1))));
+	const uint32_t none = in ? 0 : 0xFFFFFFFF;
+	size_t end = len;
+
+	for (; end >= 32; end -= 32) {
+		const uint32_t mask = charsetMask<UPPER> (_mm256_loadu_si256 (reinterpret_cast<const __m256i*>(p + end - 32)), low, high) ^ none;
+		if (mask) {
+			return const_cast<uint8_t*>(p + end - 32 + (31 - __builtin_clz (mask)));
+		}
+	}
+
+	return charsetBackward_ssse3<UPPER> (p, end, set, in);
+}
+
+static uint8_t* charset_avx2 (const void* s, size_t len, const CharSet& set, bool in)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+	return hasUpperBytes (set) ? charsetForward_avx2<true> (p, len, set, in) : charsetForward_avx2<false> (p, len, set, in);
+}
+
+static uint8_t* rcharset_avx2 (const void* s, size_t len, const CharSet& set, bool in)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+	return hasUpperBytes (set) ? charsetBackward_avx2<true> (p, len, set, in) : charsetBackward_avx2<false> (p, len, set, in);
+}
+#endif
+
+uint8_t* memcharset (const void* s, size_t len, const CharSet& set, bool in)
+{
+	return kernels().charset (s, len, set, in);
+}
+
+uint8_t* memrcharset (const void* s, size_t len, const CharSet& set, bool in)
+{
+	return kernels().rcharset (s, len, set, in);
+}
+
+/*
+ * Run time dispatch: one table of kernels per level. The level is chosen
+ * the first time a kernel runs, from the CPU features and the FIANET_SIMD
+ * environment variable.
+ */
+
+static const ByteKernels scalarKernels = {
+	SIMD_SCALAR, find_scalar, rfind_scalar, candidate_scalar, ifind_scalar, icompare_scalar,
+	charset_scalar, rcharset_scalar, flipcase_scalar
+};
+
+#if defined(FIANET_SIMD_SSE2)
+static const ByteKernels sse2Kernels = {
+	SIMD_SSE2, memfind_sse2, memrfind_sse2, candidate_sse2, ifind_sse2, icompare_sse2,
+	charset_scalar, rcharset_scalar, flipcase_sse2
+};
+#endif
+
+#if defined(FIANET_SIMD_SSSE3)
+static const ByteKernels ssse3Kernels = {
+	SIMD_SSSE3, memfind_sse2, memrfind_sse2, candidate_sse2, ifind_sse2, icompare_sse2,
+	charset_ssse3, rcharset_ssse3, flipcase_sse2
+};
+#endif
+
+#if defined(FIANET_SIMD_AVX2)
+static const ByteKernels avx2Kernels = {
+	SIMD_AVX2, memfind_avx2, memrfind_avx2, candidate_avx2, ifind_avx2, icompare_avx2,
+	charset_avx2, rcharset_avx2, flipcase_avx2
+};
+#endif
+
+static const ByteKernels* activeKernels = 0;
+
+const ByteKernels* byteKernels (SimdLevel level)
+{
+	switch (level) {
+		case SIMD_SCALAR:
+			return &scalarKernels;
+#if defined(FIANET_SIMD_SSE2)
+		case SIMD_SSE2:
+			return &sse2Kernels;
+#endif
+#if defined(FIANET_SIMD_SSSE3)
+		case SIMD_SSSE3:
+			return &ssse3Kernels;
+#endif
+#if defined(FIANET_SIMD_AVX2)
+		case SIMD_AVX2:
+			return &avx2Kernels;
+#endif
+		default:
+			break;
+	}
+	return 0;
+}
+
+static const ByteKernels* selectKernels()
+{
+	SimdLevel level = supportedSimdLevel();
+	SimdLevel forced;
+	const char* env = getenv ("FIANET_SIMD");
+
+	if (env && simdLevelFromName (env, forced) && forced < level) {
+		level = forced;
+	}
+	return byteKernels (level);
+}
+
+/*
+ * The first kernel calls may run on several threads at once: activeKernels
+ * is read and written with atomic operations. Threads racing to select the
+ * kernels select the same ones.
+ */
+static inline const ByteKernels& kernels()
+{
+	const ByteKernels* k = __atomic_load_n (&activeKernels, __ATOMIC_ACQUIRE);
+
+	if (UNLIKELY(k == 0)) {
+		k = selectKernels();
+		__atomic_store_n (&activeKernels, k, __ATOMIC_RELEASE);
+	}
+	return *k;
+}
+
+SimdLevel getSimdLevel()
+{
+	return kernels().level;
+}
+
+SimdLevel setSimdLevel (SimdLevel level)
+{
+	const SimdLevel supported = supportedSimdLevel();
+
+	if (level < SIMD_SCALAR || level > supported) {
+		level = supported;
+	}
+	__atomic_store_n (&activeKernels, byteKernels (level), __ATOMIC_RELEASE);
+
+	return level;
+}
+
+} // namespace Fianet
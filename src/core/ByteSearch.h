@@ -0,0 +1,170 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_BYTESEARCH_H
+#define FIANET_BYTESEARCH_H
+
+#include "fianet-core.h"
+#include "CpuFeatures.h"
+
+/*
+ * Internal byte search kernels used by String and friends. The public entry
+ * points (memfind() and others) are declared in String.h.
+ *
+ * With GCC >= 4.9 and clang on x86, the SIMD kernels of every level are
+ * compiled with function target attributes, whatever the -march flags, and
+ * the level is chosen at run time (see CpuFeatures.h). Other compilers only
+ * build the levels enabled by the command line.
+ */
+
+#if (defined(__i386__) || defined(__x86_64__)) && \
+		(defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+	#define FIANET_SIMD_DISPATCH 1
+	#define FIANET_TARGET(isa) __attribute__((target (isa)))
+#else
+	#define FIANET_TARGET(isa)
+#endif
+
+#if defined(FIANET_SIMD_DISPATCH) || defined(__SSE2__)
+	#define FIANET_SIMD_SSE2 1
+#endif
+#if defined(FIANET_SIMD_DISPATCH) || defined(__SSSE3__)
+	#define FIANET_SIMD_SSSE3 1
+#endif
+#if defined(FIANET_SIMD_DISPATCH) || defined(__AVX2__)
+	#define FIANET_SIMD_AVX2 1
+#endif
+
+namespace Fianet {
+
+class CharSet;
+
+/**
+ * Chooses the two needle bytes the vectorized memfind() kernels filter
+ * candidates on: the first and the last bytes. When they have the same
+ * value and the needle is longer than 2 bytes, the first byte is replaced by
+ * the rarest inner byte with a different value, if there is one. off1 and
+ * off2 are always distinct when needle_len > 1.
+ *
+ * @param needle the needle.
+ * @param needle_len the needle length, in bytes.
+ * @param off1 receives the offset of the first filter byte.
+ * @param off2 receives the offset of the second filter byte.
+ */
+void memfindSelectBytes (const void* needle, size_t needle_len, size_t& off1, size_t& off2);
+
+/**
+ * The kernels of a SimdLevel. The needle of find, rfind and ifind is at
+ * least 1 byte long, and off1/off2 come from memfindSelectBytes().
+ */
+struct ByteKernels {
+	SimdLevel level;
+
+	/// memfind() with precomputed filter bytes.
+	uint8_t* (*find) (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1, size_t off2);
+	/// memrfind() with precomputed filter bytes.
+	uint8_t* (*rfind) (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1, size_t off2);
+	/// See memfind_candidate().
+	uint8_t* (*candidate) (const void* haystack, size_t haystack_len, size_t span, uint8_t b1, size_t off1, uint8_t b2, size_t off2);
+	/// memifind_ascii() with precomputed filter bytes.
+	uint8_t* (*ifind) (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1, size_t off2);
+	/// memicompare_ascii().
+	int (*icompare) (const void* s1, const void* s2, size_t sz);
+	/// See memcharset().
+	uint8_t* (*charset) (const void* s, size_t len, const CharSet& set, bool in);
+	/// See memrcharset().
+	uint8_t* (*rcharset) (const void* s, size_t len, const CharSet& set, bool in);
+	/// Flips the case of the bytes in [first ... first + 25]: 'a' for upper case, 'A' for lower case.
+	void (*flipcase) (void* s, size_t len, uint8_t first);
+};
+
+/**
+ * @return the kernels of a level, NULL when the level is not built into the
+ * library. Meant for tests and benchmarks: the level must be supported by
+ * the CPU (see supportedSimdLevel()).
+ */
+const ByteKernels* byteKernels (SimdLevel level);
+
+/**
+ * memfind() with precomputed filter bytes (see memfindSelectBytes()).
+ * needle_len must be at least 1.
+ */
+uint8_t* memfind_pair (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1, size_t off2);
+
+/**
+ * Candidate filter of the memfind() kernels, without the verification step.
+ * @return the address of the first position p such that p[off1] == b1 and
+ * p[off2] == b2, p + span being within the haystack. NULL if there is none.
+ */
+uint8_t* memfind_candidate (const void* haystack, size_t haystack_len, size_t span, uint8_t b1, size_t off1, uint8_t b2, size_t off2);
+
+/**
+ * Portable memfind(): memchr() on the needle byte at off1, then memcmp().
+ */
+uint8_t* memfind_scalar (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1);
+
+/**
+ * memrfind() with precomputed filter bytes (see memfindSelectBytes()).
+ * needle_len must be at least 1.
+ */
+uint8_t* memrfind_pair (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1, size_t off2);
+
+/**
+ * Portable memrfind(): memrchr() on the needle byte at off1, then memcmp().
+ */
+uint8_t* memrfind_scalar (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len, size_t off1);
+
+/**
+ * Looks for the first byte of a buffer that belongs (in = true) or does not
+ * belong (in = false) to a CharSet. Uses a pshufb nibble lookup with SSSE3
+ * or AVX2.
+ * @return the address of the byte, NULL if there is none.
+ */
+uint8_t* memcharset (const void* s, size_t len, const CharSet& set, bool in);
+
+/// Same as memcharset(), for the last byte.
+uint8_t* memrcharset (const void* s, size_t len, const CharSet& set, bool in);
+
+/// Converts the ASCII letters of a buffer to upper case, in place.
+void memupper_ascii (void* s, size_t len);
+
+/// Converts the ASCII letters of a buffer to lower case, in place.
+void memlower_ascii (void* s, size_t len);
+
+/**
+ * @return the number of white spaces at the beginning of a buffer: the
+ * isspace() bytes of the current locale. The C locale ones are skipped a
+ * SIMD register at a time, the others (such as 0xA0 in ISO-8859-1) one
+ * byte at a time.
+ */
+size_t memltrim (const void* s, size_t len);
+
+/// Same as memltrim(), for the white spaces at the end of a buffer.
+size_t memrtrim (const void* s, size_t len);
+
+/**
+ * @return the white space set of the trim() methods: the isspace() bytes
+ * of the "C" locale.
+ */
+const CharSet& whiteSpaces();
+
+} // namespace Fianet
+
+#endif // FIANET_BYTESEARCH_H
@@ -0,0 +1,139 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_CHARSET_H
+#define FIANET_CHARSET_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * @class CharSet
+ * A set of bytes, used by String::findFirstOf() and friends to look for
+ * several characters in a single pass.
+ *
+ * @code
+ * static const CharSet delimiters (";,|\t");
+ * ssize_t pos = record.findFirstOf (delimiters);
+ * @endcode
+ *
+ * The set is a 256-bit map stored as two 16-byte nibble lookup tables:
+ * bit h of row r, entry lo, is set when byte ((8 * r + h) << 4 | lo) belongs
+ * to the set. The vectorized kernels test 16 or 32 bytes at a time with a
+ * pshufb per table, without any conversion of the set.
+ *
+ * A CharSet is a 32-byte value, cheap to copy, which does not allocate.
+ */
+class CharSet {
+	uint8_t rows[2][16];
+
+public:
+	/// Creates an empty set.
+	CharSet()
+		: rows()
+	{ }
+
+	/**
+	 * Creates a set from the bytes of a String.
+	 * @param chars the bytes of the set.
+	 */
+	explicit CharSet (const String& chars)
+		: rows()
+	{
+		add (chars);
+	}
+
+	/// Adds a byte to the set.
+	CharSet& add (char c) {
+		const uint8_t b = static_cast<uint8_t>(c);
+		rows[b >> 7][b & 0x0F] |= static_cast<uint8_t>(1 << ((b >> 4) & 7));
+		return *this;
+	}
+
+	/// Adds the bytes of a String to the set.
+	CharSet& add (const String& chars) {
+		for (size_t i = 0; i < chars.length(); ++i) {
+			add (static_cast<char>(chars.bytes()[i]));
+		}
+		return *this;
+	}
+
+	/**
+	 * Adds a range of bytes to the set, bytes being compared as unsigned values.
+	 * @param first the first byte of the range.
+	 * @param last the last byte of the range, included.
+	 */
+	CharSet& addRange (char first, char last) {
+		for (unsigned b = static_cast<uint8_t>(first); b <= static_cast<uint8_t>(last); ++b) {
+			add (static_cast<char>(b));
+		}
+		return *this;
+	}
+
+	/// Removes a byte from the set.
+	CharSet& remove (char c) {
+		const uint8_t b = static_cast<uint8_t>(c);
+		rows[b >> 7][b & 0x0F] &= static_cast<uint8_t>(~(1 << ((b >> 4) & 7)));
+		return *this;
+	}
+
+	/// @return the set of the bytes that do not belong to *this.
+	CharSet complement() const {
+		CharSet res;
+		for (size_t i = 0; i < 16; ++i) {
+			res.rows[0][i] = static_cast<uint8_t>(~rows[0][i]);
+			res.rows[1][i] = static_cast<uint8_t>(~rows[1][i]);
+		}
+		return res;
+	}
+
+	/// @return true if c belongs to the set.
+	bool contains (char c) const {
+		const uint8_t b = static_cast<uint8_t>(c);
+		return (rows[b >> 7][b & 0x0F] >> ((b >> 4) & 7)) & 1;
+	}
+
+	/// @return the number of bytes of the set.
+	size_t size() const {
+		size_t nb = 0;
+		for (size_t i = 0; i < 16; ++i) {
+			nb += __builtin_popcount (rows[0][i]) + __builtin_popcount (rows[1][i]);
+		}
+		return nb;
+	}
+
+	/// @return true if the set is empty.
+	bool empty() const {
+		return (size() == 0);
+	}
+
+	/**
+	 * @return the nibble lookup table of the bytes below 0x80 (r = 0), or
+	 * of the bytes from 0x80 (r = 1). Used by the vectorized kernels.
+	 */
+	const uint8_t* table (int r) const {
+		return rows[r];
+	}
+};
+
+} // namespace Fianet
+
+#endif // FIANET_CHARSET_H
@@ -0,0 +1,293 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "fianet-core.h"
+#include "ColumnParsing.h"
+#include "ByteSearch.h"
+#include <cfloat>
+#include <pthread.h>
+
+#if defined(FIANET_SIMD_DISPATCH) || defined(__SSSE3__)
+	#include <tmmintrin.h>
+#endif
+
+namespace Fianet {
+
+namespace {
+
+/// Columns are split in slices of this many fields or more.
+const size_t PARALLEL_THRESHOLD = 16384;
+
+/// Powers of ten that are exact doubles.
+const double POWERS_OF_TEN[16] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+// The SIMD path divides as the Clinger fast path of tryToFloat() does,
+// which is only correctly rounded when doubles are not evaluated with a
+// wider precision, as they are by the x87 FPU.
+#if defined(FIANET_SIMD_SSSE3) && defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+	#define SIMD_DOUBLES
+#endif
+
+#if defined(__GNUC__)
+	#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+	#define NO_SANITIZE_ADDRESS
+#endif
+
+#if defined(FIANET_SIMD_SSSE3)
+/**
+ * Loads the 16 bytes at p, of which only len are meaningful. The bytes
+ * beyond p + len are read when they are within the page of p, where they
+ * cannot fault: the address sanitizer is told so.
+ */
+FIANET_TARGET("ssse3") NO_SANITIZE_ADDRESS
+inline __m128i load_ssse3 (const uint8_t* p, size_t len)
+{
+	if ((reinterpret_cast<uintptr_t>(p) & 4095) <= 4096 - 16) {
+		return _mm_loadu_si128 (reinterpret_cast<const __m128i*>(p));
+	}
+	uint8_t tmp[16] = { 0 };
+	memcpy (tmp, p, len);
+	return _mm_loadu_si128 (reinterpret_cast<const __m128i*>(tmp));
+}
+
+/**
+ * Converts 1 to 16 bytes of decimal digits, with at most one '.' when
+ * allowDot is true.
+ *
+ * The digits are right-aligned into a register by a pshufb whose mask
+ * skips the '.', the leading lanes being zeroed, then summed pairwise:
+ * pmaddubsw gives 8 numbers of 2 digits, pmaddwd 4 numbers of 4 digits,
+ * and a second pmaddwd 2 numbers of 8 digits.
+ *
+ * @param value receives the digits as an integer.
+ * @param decimals receives the number of digits following the '.'.
+ * @return false if the field holds anything else, or no digit.
+ */
+FIANET_TARGET("ssse3")
+inline bool digits_ssse3 (const uint8_t* p, size_t len, bool allowDot, uint64_t& value, size_t& decimals)
+{
+	const __m128i raw = load_ssse3 (p, len);
+	const uint32_t lanes = (1U << len) - 1;
+	const __m128i d = _mm_sub_epi8 (raw, _mm_set1_epi8 ('0'));
+	const uint32_t digits = _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_min_epu8 (d, _mm_set1_epi8 (9)), d)) & lanes;
+	uint32_t dots = 0;
+
+	if (digits != lanes) {
+		if (!allowDot) {
+			return false;
+		}
+		dots = _mm_movemask_epi8 (_mm_cmpeq_epi8 (raw, _mm_set1_epi8 ('.'))) & lanes;
+		if ((digits | dots) != lanes || (dots & (dots - 1)) != 0 || digits == 0) {
+			return false;
+		}
+	}
+
+	// Lane i of the result takes digit k = i - (16 - n), the digits
+	// following the '.' being one byte further.
+	const int n = static_cast<int>(len) - (dots != 0);
+	const int dot = dots ? __builtin_ctz (dots) : 16;
+	const __m128i k = _mm_sub_epi8 (_mm_setr_epi8 (0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+		_mm_set1_epi8 (static_cast<char>(16 - n)));
+	const __m128i skip = _mm_cmpgt_epi8 (k, _mm_set1_epi8 (static_cast<char>(dot - 1)));
+	const __m128i mask = _mm_or_si128 (_mm_sub_epi8 (k, skip), _mm_cmpgt_epi8 (_mm_setzero_si128(), k));
+
+	__m128i v = _mm_shuffle_epi8 (d, mask);
+	v = _mm_maddubs_epi16 (v, _mm_setr_epi8 (10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+	v = _mm_madd_epi16 (v, _mm_setr_epi16 (100, 1, 100, 1, 100, 1, 100, 1));
+	v = _mm_packs_epi32 (v, v);
+	v = _mm_madd_epi16 (v, _mm_setr_epi16 (10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+	value = static_cast<uint64_t>(_mm_cvtsi128_si32 (v)) * 100000000
+		+ static_cast<uint32_t>(_mm_cvtsi128_si32 (_mm_srli_si128 (v, 4)));
+	decimals = dots ? len - 1 - dot : 0;
+	return true;
+}
+
+FIANET_TARGET("ssse3")
+ParseStatus parseInt64_ssse3 (const StringView& s, int64_t& value)
+{
+	const uint8_t* p = s.bytes();
+	size_t len = s.length();
+	const bool negative = (len > 1 && *p == '-');
+	uint64_t v;
+	size_t decimals;
+
+	p += negative;
+	len -= negative;
+	if (len - 1 < 16 && (*p != '0' || len == 1) && digits_ssse3 (p, len, false, v, decimals)) {
+		value = negative ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+		return PARSE_OK;
+	}
+	return s.tryToInt64 (value);
+}
+
+#if defined(SIMD_DOUBLES)
+FIANET_TARGET("ssse3")
+ParseStatus parseDouble_ssse3 (const StringView& s, double& value)
+{
+	const uint8_t* p = s.bytes();
+	size_t len = s.length();
+	const bool negative = (len > 1 && *p == '-');
+	uint64_t v;
+	size_t decimals;
+
+	p += negative;
+	len -= negative;
+	if (len - 1 < 16 && digits_ssse3 (p, len, true, v, decimals) && v <= (1ULL << 53)) {
+		const double d = static_cast<double>(v) / POWERS_OF_TEN[decimals];
+		value = negative ? -d : d;
+		return PARSE_OK;
+	}
+	return s.tryToFloat (value);
+}
+#endif
+#endif
+
+ParseStatus parseInt64_scalar (const StringView& s, int64_t& value)
+{
+	return s.tryToInt64 (value);
+}
+
+ParseStatus parseDouble_scalar (const StringView& s, double& value)
+{
+	return s.tryToFloat (value);
+}
+
+/// A slice of a column, converted by one thread.
+template <class T>
+struct Slice {
+	typedef ParseStatus (*Parser) (const StringView& s, T& value);
+
+	Parser parse;
+	const uint8_t* in;
+	size_t stride;
+	size_t n;
+	T* out;
+	uint8_t* status;
+	size_t converted;
+
+	void run() {
+		size_t ok = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const StringView& s = *reinterpret_cast<const StringView*>(in + i * stride);
+			const ParseStatus st = parse (s, out[i]);
+			if (LIKELY(st == PARSE_OK)) {
+				++ok;
+			} else {
+				out[i] = 0;
+			}
+			if (status) {
+				status[i] = static_cast<uint8_t>(st);
+			}
+		}
+		converted = ok;
+	}
+};
+
+template <class T>
+void* worker (void* arg)
+{
+	static_cast<Slice<T>*>(arg)->run();
+	return 0;
+}
+
+template <class T>
+size_t parseColumn (typename Slice<T>::Parser parse, const StringView* in, size_t stride, size_t n, T* out, uint8_t* status, unsigned threads)
+{
+	if (threads == 0) {
+		const long cpus = sysconf (_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? static_cast<unsigned>(cpus) : 1;
+	}
+	if (threads > n / PARALLEL_THRESHOLD) {
+		threads = static_cast<unsigned>(n / PARALLEL_THRESHOLD);
+	}
+	if (threads <= 1) {
+		Slice<T> all = { parse, reinterpret_cast<const uint8_t*>(in), stride, n, out, status, 0 };
+		all.run();
+		return all.converted;
+	}
+
+	Slice<T>* slices = static_cast<Slice<T>*>(std::malloc (threads * sizeof(Slice<T>)));
+	pthread_t* ids = static_cast<pthread_t*>(std::malloc (threads * sizeof(pthread_t)));
+	if (!slices || !ids) {
+		std::free (slices);
+		std::free (ids);
+		THROW ("parseColumn: malloc() returned NULL");
+	}
+
+	for (unsigned t = 0; t < threads; ++t) {
+		const size_t first = n / threads * t;
+		const size_t count = (t + 1 < threads) ? n / threads : n - first;
+		const Slice<T> slice = { parse, reinterpret_cast<const uint8_t*>(in) + first * stride, stride, count,
+			out + first, status ? status + first : 0, 0 };
+		slices[t] = slice;
+	}
+
+	// The calling thread converts the last slice, and those of the
+	// threads that cannot be started.
+	unsigned t;
+	for (t = 0; t + 1 < threads; ++t) {
+		if (pthread_create (&ids[t], 0, worker<T>, &slices[t]) != 0) {
+			break;
+		}
+	}
+	const unsigned running = t;
+	for (; t < threads; ++t) {
+		slices[t].run();
+	}
+
+	size_t converted = 0;
+	for (t = 0; t < threads; ++t) {
+		if (t < running) {
+			pthread_join (ids[t], 0);
+		}
+		converted += slices[t].converted;
+	}
+	std::free (ids);
+	std::free (slices);
+	return converted;
+}
+
+} // namespace
+
+size_t parseInt64Column (const StringView* in, size_t stride, size_t n, int64_t* out, uint8_t* status, unsigned threads)
+{
+#if defined(FIANET_SIMD_SSSE3)
+	if (getSimdLevel() >= SIMD_SSSE3) {
+		return parseColumn<int64_t> (parseInt64_ssse3, in, stride, n, out, status, threads);
+	}
+#endif
+	return parseColumn<int64_t> (parseInt64_scalar, in, stride, n, out, status, threads);
+}
+
+size_t parseDoubleColumn (const StringView* in, size_t stride, size_t n, double* out, uint8_t* status, unsigned threads)
+{
+#if defined(SIMD_DOUBLES)
+	if (getSimdLevel() >= SIMD_SSSE3) {
+		return parseColumn<double> (parseDouble_ssse3, in, stride, n, out, status, threads);
+	}
+#endif
+	return parseColumn<double> (parseDouble_scalar, in, stride, n, out, status, threads);
+}
+
+} // namespace Fianet
@@ -0,0 +1,115 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_COLUMNPARSING_H
+#define FIANET_COLUMNPARSING_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * Converts a column of fields with StringView::tryToInt64(): out[i]
+ * receives the value of in[i], status[i] its ParseStatus. The fields that
+ * fail to convert set out[i] to 0.
+ *
+ * Fields made of an optional '-' and 1 to 16 decimal digits (not starting
+ * with a '0' unless it is the only one, which would be octal) are converted
+ * with SIMD instructions when the SSSE3 kernels are in use (see
+ * getSimdLevel()): the digits are shuffled into a 16-byte register, then
+ * multiplied and summed pairwise, 2, 4 then 8 digits at a time. Any other
+ * field goes through tryToInt64(), with the same results.
+ *
+ * Large columns are split between threads when threads is greater than 1:
+ * the threads are started for the call, and each one converts a slice of
+ * the column. Columns too small to be worth it are converted by the
+ * calling thread only.
+ *
+ * @code
+ * std::vector<String> amounts = ...;
+ * std::vector<int64_t> values (amounts.size());
+ * std::vector<uint8_t> status (amounts.size());
+ * parseInt64Column (&amounts[0], amounts.size(), &values[0], &status[0]);
+ * @endcode
+ *
+ * @param in the first field. Any array of StringView or derived classes.
+ * @param n the number of fields.
+ * @param out receives the n values.
+ * @param status receives the n ParseStatus values, unless it is NULL.
+ * @param threads the number of threads to use, the calling thread
+ * included. 0 uses one thread per online CPU.
+ * @return the number of fields converted (PARSE_OK).
+ */
+template <class S>
+size_t parseInt64Column (const S* in, size_t n, int64_t* out, uint8_t* status = 0, unsigned threads = 1);
+
+/**
+ * Converts a column of fields with StringView::tryToFloat(), as
+ * parseInt64Column() does.
+ *
+ * Fields made of an optional '-', then decimal digits with at most one
+ * '.', are converted with SIMD instructions when they are at most 16 bytes
+ * long and have at most 15 significant digits: their digits are exactly
+ * converted to an integer, which is divided by a power of ten as the
+ * Clinger fast path of tryToFloat() does. This path is only taken when
+ * doubles are evaluated in their own precision (FLT_EVAL_METHOD == 0),
+ * the division being rounded twice otherwise. Any other field goes
+ * through tryToFloat(), with the same results.
+ *
+ * @param in the first field. Any array of StringView or derived classes.
+ * @param n the number of fields.
+ * @param out receives the n values.
+ * @param status receives the n ParseStatus values, unless it is NULL.
+ * @param threads the number of threads to use, the calling thread
+ * included. 0 uses one thread per online CPU.
+ * @return the number of fields converted (PARSE_OK).
+ */
+template <class S>
+size_t parseDoubleColumn (const S* in, size_t n, double* out, uint8_t* status = 0, unsigned threads = 1);
+
+/**
+ * parseInt64Column() on fields stride bytes apart.
+ * @param in the StringView of the first field.
+ * @param stride the distance between two fields, in bytes.
+ */
+size_t parseInt64Column (const StringView* in, size_t stride, size_t n, int64_t* out, uint8_t* status, unsigned threads);
+
+/**
+ * parseDoubleColumn() on fields stride bytes apart.
+ * @param in the StringView of the first field.
+ * @param stride the distance between two fields, in bytes.
+ */
+size_t parseDoubleColumn (const StringView* in, size_t stride, size_t n, double* out, uint8_t* status, unsigned threads);
+
+template <class S>
+inline size_t parseInt64Column (const S* in, size_t n, int64_t* out, uint8_t* status, unsigned threads)
+{
+	return parseInt64Column (static_cast<const StringView*>(in), sizeof(S), n, out, status, threads);
+}
+
+template <class S>
+inline size_t parseDoubleColumn (const S* in, size_t n, double* out, uint8_t* status, unsigned threads)
+{
+	return parseDoubleColumn (static_cast<const StringView*>(in), sizeof(S), n, out, status, threads);
+}
+
+} // namespace Fianet
+
+#endif // FIANET_COLUMNPARSING_H
@@ -0,0 +1,238 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_COMPACTSTRING_H
+#define FIANET_COMPACTSTRING_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * @class CompactString
+ * A 16 byte, trivially copyable string view, for large in-memory tables.
+ *
+ * A String is 24 bytes on x86-64 (its vtable pointer, data pointer and
+ * length), and reads its data for every comparison. A CompactString holds
+ * a 4 byte length and the first 4 bytes of the data, followed by either the
+ * next 8 bytes (strings of up to INLINE_LENGTH bytes, entirely held by the
+ * CompactString) or a pointer to the data:
+ *
+ * @code
+ *   short:  | length | bytes 0-3 | bytes 4-11, 0-padded |
+ *   long:   | length | bytes 0-3 | data pointer         |
+ * @endcode
+ *
+ * Most comparisons are thus decided without following the pointer: strings
+ * of different lengths or first bytes are unequal, and the first 4 bytes
+ * usually order them. Short strings are compared as two 8 byte words.
+ *
+ * Like a String, a long CompactString references data it does not own,
+ * which must outlive it. Short ones copy their bytes: str() then returns a
+ * view on the CompactString itself, which must outlive the view.
+ */
+class CompactString {
+public:
+	/// Length up to which strings are held inline.
+	static const size_t INLINE_LENGTH = 12;
+
+	/// Orders CompactStrings as String::Comparator orders Strings.
+	struct Comparator {
+		bool operator() (const CompactString& s1, const CompactString& s2) const {
+			return (s1.compareTo (s2) < 0);
+		}
+	};
+
+	/// Allows CompactStrings to be used as keys of hashed containers, with Equal.
+	struct Hasher {
+		size_t operator() (const CompactString& s) const {
+			return static_cast<size_t>(s.hash());
+		}
+	};
+
+	struct Equal {
+		bool operator() (const CompactString& s1, const CompactString& s2) const {
+			return s1.equals (s2);
+		}
+	};
+
+private:
+	uint32_t len;
+	char prefix[4];
+	union {
+		char rest[8];
+		const char* ptr;
+	} tail;
+
+	/// @return the length and prefix, as a single word.
+	uint64_t head() const {
+		uint64_t v;
+		std::memcpy (&v, this, sizeof(v));
+		return v;
+	}
+
+	/// @return the inline bytes following the prefix, as a single word.
+	uint64_t inlineTail() const {
+		uint64_t v;
+		std::memcpy (&v, tail.rest, sizeof(v));
+		return v;
+	}
+
+	/// @return the prefix, in an order where integer comparison matches byte comparison.
+	uint32_t orderedPrefix() const {
+		uint32_t v;
+		std::memcpy (&v, prefix, sizeof(v));
+#ifdef CPU_IS_LITTLE_ENDIAN
+		v = __builtin_bswap32 (v);
+#endif
+		return v;
+	}
+
+	void assign (const char* data, size_t length) {
+		if (length > UINT32_MAX) {
+			THROW ("CompactString: string too long");
+		}
+		len = static_cast<uint32_t>(length);
+		std::memset (prefix, 0, sizeof(prefix));
+		std::memset (tail.rest, 0, sizeof(tail.rest));
+		if (length <= INLINE_LENGTH) {
+			if (length) {
+				std::memcpy (prefix, data, length);
+			}
+		} else {
+			std::memcpy (prefix, data, sizeof(prefix));
+			tail.ptr = data;
+		}
+	}
+
+public:
+	/// Creates an empty string.
+	CompactString()
+		: len(0), prefix(), tail()
+	{ }
+
+	/**
+	 * Creates a view on the data of a StringView, copying it if it is short.
+	 * @throw Exception if the String is longer than 4 GB.
+	 */
+	CompactString (const StringView& s)
+		: len(0), prefix(), tail()
+	{
+		assign (s.cstr(), s.length());
+	}
+
+	/// Creates a view on a NUL-terminated C string, copying it if it is short.
+	CompactString (const char* c_str)
+		: len(0), prefix(), tail()
+	{
+		assign (c_str, std::strlen (c_str));
+	}
+
+	/// @see CompactString(const StringView&)
+	CompactString (const char* data, size_t length)
+		: len(0), prefix(), tail()
+	{
+		assign (data, length);
+	}
+
+	/// @return the length, in bytes.
+	size_t length() const {
+		return len;
+	}
+
+	/// @return true if the bytes are held by the CompactString itself.
+	bool isInline() const {
+		return (len <= INLINE_LENGTH);
+	}
+
+	/// @return the data. It is not NUL-terminated.
+	const char* data() const {
+		return isInline() ? prefix : tail.ptr;
+	}
+
+	/// @return a String view on the data.
+	String str() const {
+		return String (data(), len);
+	}
+
+	/// @return the same hash as String::hash().
+	uint64_t hash() const {
+		return memhash (data(), len);
+	}
+
+	/// @return true if both strings have the same bytes.
+	bool equals (const CompactString& s) const {
+		if (head() != s.head()) {
+			return false;
+		} else if (isInline()) {
+			return (inlineTail() == s.inlineTail());
+		}
+		return (tail.ptr == s.tail.ptr || std::memcmp (tail.ptr + 4, s.tail.ptr + 4, len - 4) == 0);
+	}
+
+	/**
+	 * Compares two strings, as String::compareTo() does: by bytes, then by
+	 * length.
+	 * @return 0 if both are equal, < 0 if *this comes first, > 0 otherwise.
+	 */
+	int compareTo (const CompactString& s) const {
+		const uint32_t p1 = orderedPrefix(), p2 = s.orderedPrefix();
+		if (p1 != p2) {
+			return (p1 < p2) ? -1 : 1;
+		}
+		// The first min (4, length) bytes are equal, and padded with 0s.
+		const uint32_t n = (len < s.len) ? len : s.len;
+		if (n > 4) {
+			const int res = std::memcmp (data() + 4, s.data() + 4, n - 4);
+			if (res) {
+				return res;
+			}
+		}
+		return (len < s.len) ? -1 : (len > s.len) ? 1 : 0;
+	}
+
+	/// @return true if *this starts with the bytes of s.
+	bool startsWith (const CompactString& s) const {
+		if (s.len > len) {
+			return false;
+		}
+		const uint32_t n = (s.len < 4) ? s.len : 4;
+		if (n && std::memcmp (prefix, s.prefix, n) != 0) {
+			return false;
+		}
+		return (s.len <= 4 || std::memcmp (data() + 4, s.data() + 4, s.len - 4) == 0);
+	}
+
+	bool operator == (const CompactString& s) const {
+		return equals (s);
+	}
+
+	bool operator != (const CompactString& s) const {
+		return !equals (s);
+	}
+
+	bool operator < (const CompactString& s) const {
+		return (compareTo (s) < 0);
+	}
+};
+
+} // namespace Fianet
+
+#endif // FIANET_COMPACTSTRING_H
@@ -0,0 +1,117 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "fianet-core.h"
+#include "CpuFeatures.h"
+#include "ByteSearch.h"
+
+#include <strings.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+	#include <cpuid.h>
+#endif
+
+namespace Fianet {
+
+static const char* levelNames[] = { "scalar", "sse2", "ssse3", "avx2" };
+
+#if defined(__i386__) || defined(__x86_64__)
+/// @return the best level the CPU and the OS support.
+static SimdLevel detectCpu()
+{
+	unsigned eax, ebx, ecx, edx;
+
+	if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx) || !(edx & bit_SSE2)) {
+		return SIMD_SCALAR;
+	} else if (!(ecx & bit_SSSE3)) {
+		return SIMD_SSE2;
+	}
+
+	// AVX2 also needs the OS to save the YMM registers (XCR0 bits 1 and 2).
+	const unsigned osxsave = (1 << 27), avx = (1 << 28);
+	if ((ecx & (osxsave | avx)) == (osxsave | avx) && __get_cpuid_max (0, 0) >= 7) {
+		unsigned xcr0, xcr0h;
+		__asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0h) : "c" (0));
+
+		__cpuid_count (7, 0, eax, ebx, ecx, edx);
+		if ((xcr0 & 6) == 6 && (ebx & (1 << 5))) {
+			return SIMD_AVX2;
+		}
+	}
+
+	return SIMD_SSSE3;
+}
+#else
+static SimdLevel detectCpu()
+{
+	return SIMD_SCALAR;
+}
+#endif
+
+/// @return the best level built into the library.
+static SimdLevel builtLevel()
+{
+#if defined(FIANET_SIMD_AVX2)
+	return SIMD_AVX2;
+#elif defined(FIANET_SIMD_SSSE3)
+	return SIMD_SSSE3;
+#elif defined(FIANET_SIMD_SSE2)
+	return SIMD_SSE2;
+#else
+	return SIMD_SCALAR;
+#endif
+}
+
+SimdLevel supportedSimdLevel()
+{
+	// Detected once, possibly by several threads at once, which all find
+	// the same level.
+	static int supported = -1;
+	int level = __atomic_load_n (&supported, __ATOMIC_RELAXED);
+
+	if (UNLIKELY(level < 0)) {
+		const SimdLevel cpu = detectCpu();
+		const SimdLevel built = builtLevel();
+		level = (cpu < built) ? cpu : built;
+		__atomic_store_n (&supported, level, __ATOMIC_RELAXED);
+	}
+	return static_cast<SimdLevel>(level);
+}
+
+const char* simdLevelName (SimdLevel level)
+{
+	if (level < SIMD_SCALAR || level > SIMD_AVX2) {
+		return "unknown";
+	}
+	return levelNames[level];
+}
+
+bool simdLevelFromName (const char* name, SimdLevel& level)
+{
+	for (int i = SIMD_SCALAR; i <= SIMD_AVX2; ++i) {
+		if (strcasecmp (name, levelNames[i]) == 0) {
+			level = static_cast<SimdLevel>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace Fianet
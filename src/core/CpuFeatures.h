@@ -0,0 +1,80 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_CPUFEATURES_H
+#define FIANET_CPUFEATURES_H
+
+namespace Fianet {
+
+/**
+ * Instruction sets the byte kernels (memfind(), memifind(), memicompare(),
+ * String::findFirstOf(), trimming, case conversion, ...) are compiled for.
+ *
+ * Every level is built into the library, whatever the -march flags, and the
+ * best one the CPU supports is selected the first time a kernel runs. The
+ * FIANET_SIMD environment variable ("scalar", "sse2", "ssse3" or "avx2")
+ * forces a lower level, as does setSimdLevel().
+ */
+enum SimdLevel {
+	/// Portable C code, on top of memchr() and friends.
+	SIMD_SCALAR,
+	/// 16-byte SSE2 kernels.
+	SIMD_SSE2,
+	/// SSE2, plus the pshufb based kernels (CharSet lookups, Teddy).
+	SIMD_SSSE3,
+	/// 32-byte AVX2 kernels.
+	SIMD_AVX2
+};
+
+/**
+ * @return the best level supported by both the CPU and the library build.
+ * Compilers without function target attributes only build the levels
+ * enabled by the command line flags.
+ */
+SimdLevel supportedSimdLevel();
+
+/// @return the level of the kernels in use.
+SimdLevel getSimdLevel();
+
+/**
+ * Selects the level of the kernels, typically to compare the levels in a
+ * benchmark. Not thread-safe: must be called when no other thread uses the
+ * library.
+ *
+ * @param level the requested level.
+ * @return the level actually selected: level, or supportedSimdLevel() when
+ * the CPU does not support level.
+ */
+SimdLevel setSimdLevel (SimdLevel level);
+
+/// @return the name of a level, as accepted by the FIANET_SIMD variable.
+const char* simdLevelName (SimdLevel level);
+
+/**
+ * Converts a level name ("scalar", "sse2", "ssse3" or "avx2") to a level.
+ * @param name the name, case-insensitive.
+ * @param level receives the level.
+ * @return false if the name is unknown, level being left unchanged.
+ */
+bool simdLevelFromName (const char* name, SimdLevel& level);
+
+} // namespace Fianet
+
+#endif // FIANET_CPUFEATURES_H
@@ -0,0 +1,100 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_DECIMAL_H
+#define FIANET_DECIMAL_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * @class Decimal
+ * A fixed-point decimal number: an integer mantissa, and the number of its
+ * digits that follow the decimal separator. 1234.56 is stored as 123456
+ * with a scale of 2, so that amounts are read, added and written without
+ * the rounding of binary floating point numbers.
+ *
+ * @code
+ * Decimal amount;
+ * if (field.tryToDecimal (2, amount, ',', ' ') == PARSE_OK) {   // "1 234,56"
+ *     total += amount.mantissa();                              // 123456 cents
+ * }
+ * out.appendDecimal (Decimal (total, 2));                      // "1234.56"
+ * @endcode
+ *
+ * @see StringView::tryToDecimal(), XString::appendDecimal()
+ */
+class Decimal {
+	int64_t units;
+	unsigned decimals;
+
+public:
+	/// The largest scale: 10^18 is the largest power of ten of an int64_t.
+	static const unsigned MAX_SCALE = 18;
+
+	/// Creates a zero with no decimals.
+	Decimal()
+		: units(0), decimals(0)
+	{ }
+
+	/**
+	 * Creates mantissa * 10^-scale.
+	 * @param scale the number of decimals, at most MAX_SCALE.
+	 */
+	Decimal (int64_t mantissa, unsigned scale)
+		: units(mantissa), decimals(scale)
+	{ }
+
+	/// @return the value in units of 10^-scale(): 123456 for 1234.56 with a scale of 2.
+	int64_t mantissa() const {
+		return units;
+	}
+
+	/// @return the number of decimals.
+	unsigned scale() const {
+		return decimals;
+	}
+
+	/**
+	 * @return the nearest double. The conversion is exact, then correctly
+	 * rounded, when the mantissa is at most 2^53 in magnitude.
+	 */
+	double toDouble() const {
+		static const double POWERS_OF_TEN[MAX_SCALE + 1] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+			1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+		};
+		return static_cast<double>(units) / POWERS_OF_TEN[decimals];
+	}
+
+	/// @return true if both have the same mantissa and scale: 1.5 and 1.50 differ.
+	bool operator == (const Decimal& d) const {
+		return units == d.units && decimals == d.decimals;
+	}
+
+	bool operator != (const Decimal& d) const {
+		return !(*this == d);
+	}
+};
+
+} // namespace Fianet
+
+#endif // FIANET_DECIMAL_H
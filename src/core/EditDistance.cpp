@@ -0,0 +1,270 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "EditDistance.h"
+
+namespace Fianet {
+
+/*
+ * Myers' algorithm, in the formulation of Hyyro: Pv and Mv hold the
+ * positive and negative vertical deltas of the current column, Ph and Mh
+ * the horizontal deltas computed from them. Row 0 of the matrix is
+ * D[0][j] = j, so its horizontal delta is always +1.
+ *
+ * The distance is D[m][n]. A column can lower the last row by 1 at most,
+ * so the bounded variant stops when the score minus the number of columns
+ * left exceeds k.
+ */
+
+static const uint64_t HIGH_BIT = 1ULL << 63;
+
+EditDistance::EditDistance (const String& pattern, Mode mode)
+	: patternLength(pattern.length()), blocks((pattern.length() + BLOCK_SIZE - 1) / BLOCK_SIZE), peq(0), single()
+{
+	if (blocks <= 1) {
+		peq = single;
+	} else {
+		peq = static_cast<uint64_t*>(calloc (256 * blocks, sizeof(uint64_t)));
+		if (!peq) {
+			THROW ("EditDistance: cannot allocate the match vectors");
+		}
+	}
+
+	const uint8_t* p = pattern.bytes();
+
+	if (mode == CASE_SENSITIVE || getCaseFolding() == ASCII_CASE_FOLDING) {
+		for (size_t i = 0; i < patternLength; ++i) {
+			const uint64_t bit = 1ULL << (i % BLOCK_SIZE);
+			const size_t b = i / BLOCK_SIZE;
+
+			peq[p[i] * blocks + b] |= bit;
+			if (mode == IGNORE_CASE && static_cast<uint8_t>((p[i] | 0x20) - 'a') < 26) {
+				peq[(p[i] ^ 0x20) * blocks + b] |= bit;
+			}
+		}
+		return;
+	}
+
+	// Locale folding: bytes match the pattern positions of their upper case.
+	uint8_t fold[256];
+	for (int c = 0; c < 256; ++c) {
+		fold[c] = toupper (c);
+	}
+	for (size_t i = 0; i < patternLength; ++i) {
+		peq[fold[p[i]] * blocks + i / BLOCK_SIZE] |= 1ULL << (i % BLOCK_SIZE);
+	}
+	for (int c = 0; c < 256; ++c) {
+		if (fold[c] != c) {
+			memcpy (peq + c * blocks, peq + fold[c] * blocks, blocks * sizeof(uint64_t));
+		}
+	}
+}
+
+EditDistance::~EditDistance()
+{
+	if (peq != single) {
+		free (peq);
+	}
+}
+
+size_t EditDistance::compute (const uint8_t* text, size_t len, size_t k) const
+{
+	const size_t m = patternLength;
+
+	if (m == 0 || len == 0) {
+		return m + len;
+	} else if ((m > len ? m - len : len - m) > k) {
+		return k + 1;
+	} else if (blocks > 1) {
+		return computeBlocks (text, len, k);
+	}
+
+	const uint64_t last = 1ULL << (m - 1);
+	uint64_t pv = ~0ULL;
+	uint64_t mv = 0;
+	size_t score = m;
+
+	for (size_t j = 0; j < len; ++j) {
+		const uint64_t eq = peq[text[j]];
+		const uint64_t xv = eq | mv;
+		const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+		uint64_t ph = mv | ~(xh | pv);
+		uint64_t mh = pv & xh;
+
+		if (ph & last) {
+			++score;
+		} else if (mh & last) {
+			--score;
+		}
+
+		ph = (ph << 1) | 1;
+		mh <<= 1;
+		pv = mh | ~(xv | ph);
+		mv = ph & xv;
+
+		if (score > k && score - k > len - j - 1) {
+			return k + 1;
+		}
+	}
+
+	return score;
+}
+
+/**
+ * Advances a block of 64 rows by one column.
+ * @param hin the horizontal delta entering the block from above.
+ * @param out the bit of the row the returned delta is read from.
+ * @return the horizontal delta of that row.
+ */
+static inline int advanceBlock (uint64_t& pv, uint64_t& mv, uint64_t eq, int hin, uint64_t out)
+{
+	const uint64_t xv = eq | mv;
+	if (hin < 0) {
+		eq |= 1;
+	}
+	const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+	uint64_t ph = mv | ~(xh | pv);
+	uint64_t mh = pv & xh;
+
+	const int hout = (ph & out) ? 1 : ((mh & out) ? -1 : 0);
+
+	ph <<= 1;
+	mh <<= 1;
+	if (hin < 0) {
+		mh |= 1;
+	} else if (hin > 0) {
+		ph |= 1;
+	}
+	pv = mh | ~(xv | ph);
+	mv = ph & xv;
+
+	return hout;
+}
+
+size_t EditDistance::computeBlocks (const uint8_t* text, size_t len, size_t k) const
+{
+	static const size_t LOCAL_BLOCKS = 8;
+	uint64_t local[2 * LOCAL_BLOCKS];
+	uint64_t* pv = local;
+
+	if (blocks > LOCAL_BLOCKS) {
+		pv = static_cast<uint64_t*>(malloc (2 * blocks * sizeof(uint64_t)));
+		if (!pv) {
+			THROW ("EditDistance: cannot allocate the block vectors");
+		}
+	}
+	uint64_t* mv = pv + blocks;
+
+	for (size_t b = 0; b < blocks; ++b) {
+		pv[b] = ~0ULL;
+		mv[b] = 0;
+	}
+
+	// The rows below the pattern in the last block do not influence the
+	// rows above: the score is read from the last pattern row.
+	const uint64_t last = 1ULL << ((patternLength - 1) % BLOCK_SIZE);
+	size_t score = patternLength;
+
+	for (size_t j = 0; j < len; ++j) {
+		const uint64_t* eq = peq + text[j] * blocks;
+		int carry = 1;
+
+		for (size_t b = 0; b + 1 < blocks; ++b) {
+			carry = advanceBlock (pv[b], mv[b], eq[b], carry, HIGH_BIT);
+		}
+		carry = advanceBlock (pv[blocks - 1], mv[blocks - 1], eq[blocks - 1], carry, last);
+		if (carry > 0) {
+			++score;
+		} else if (carry < 0) {
+			--score;
+		}
+
+		if (score > k && score - k > len - j - 1) {
+			score = k + 1;
+			break;
+		}
+	}
+
+	if (pv != local) {
+		free (pv);
+	}
+
+	return score;
+}
+
+size_t EditDistance::distance (const String& text) const
+{
+	return compute (text.bytes(), text.length(), static_cast<size_t>(-1));
+}
+
+size_t EditDistance::distance (const String& text, size_t k) const
+{
+	return compute (text.bytes(), text.length(), k);
+}
+
+void EditDistance::distances (const String* candidates, size_t count, size_t* results) const
+{
+	for (size_t i = 0; i < count; ++i) {
+		results[i] = distance (candidates[i]);
+	}
+}
+
+ssize_t EditDistance::closest (const String* candidates, size_t count, size_t k, size_t* dist) const
+{
+	ssize_t best = -1;
+
+	for (size_t i = 0; i < count; ++i) {
+		const size_t d = distance (candidates[i], k);
+		if (d <= k) {
+			best = i;
+			if (dist) {
+				*dist = d;
+			}
+			if (d == 0) {
+				break;
+			}
+			// Only strictly closer candidates are of interest now.
+			k = d - 1;
+		}
+	}
+
+	return best;
+}
+
+size_t editDistance (const String& a, const String& b, EditDistance::Mode mode)
+{
+	// The shorter string is the pattern: fewer blocks.
+	if (a.length() < b.length()) {
+		return EditDistance (a, mode).distance (b);
+	}
+	return EditDistance (b, mode).distance (a);
+}
+
+bool withinDistance (const String& a, const String& b, size_t k, EditDistance::Mode mode)
+{
+	if ((a.length() > b.length() ? a.length() - b.length() : b.length() - a.length()) > k) {
+		return false;
+	} else if (a.length() < b.length()) {
+		return EditDistance (a, mode).within (b, k);
+	}
+	return EditDistance (b, mode).within (a, k);
+}
+
+} // namespace Fianet
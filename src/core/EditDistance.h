@@ -0,0 +1,144 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_EDITDISTANCE_H
+#define FIANET_EDITDISTANCE_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * @class EditDistance
+ * Computes the Levenshtein distance (insertions, deletions and
+ * substitutions of bytes) between a pattern and other strings.
+ *
+ * Typical use is matching a customer-supplied name or address against
+ * reference records: the pattern is compiled once, then compared with each
+ * candidate.
+ *
+ * @code
+ * EditDistance input (lastName, EditDistance::IGNORE_CASE);
+ * if (input.within (record.lastName, 2)) { ... }
+ * @endcode
+ *
+ * Uses Myers' bit-parallel algorithm: a column of the dynamic programming
+ * matrix is encoded as bit vectors of vertical deltas, and advanced one
+ * text byte at a time with a few word operations. Patterns up to 64 bytes
+ * fit in a single machine word, longer ones are split in blocks of 64 rows.
+ *
+ * A compiled EditDistance is read-only, and can be shared between threads.
+ */
+class EditDistance {
+public:
+	/// Comparison modes.
+	enum Mode {
+		/// Bytes must be equal.
+		CASE_SENSITIVE,
+		/// Letters match regardless of their case, see setCaseFolding().
+		IGNORE_CASE
+	};
+
+	/// Number of pattern bytes per block.
+	static const size_t BLOCK_SIZE = 64;
+
+private:
+	size_t patternLength;
+	size_t blocks;
+	/// Match vectors: bit i of peq[c * blocks + b] is set when text byte c matches pattern byte 64 * b + i.
+	uint64_t* peq;
+	/// Storage of peq for single block patterns.
+	uint64_t single[256];
+
+	EditDistance (const EditDistance&);
+	EditDistance& operator = (const EditDistance&);
+
+	size_t compute (const uint8_t* text, size_t len, size_t k) const;
+	size_t computeBlocks (const uint8_t* text, size_t len, size_t k) const;
+
+public:
+	/**
+	 * Compiles a pattern.
+	 * @param pattern the pattern. Its content is not referenced afterwards.
+	 * @param mode the comparison mode.
+	 */
+	explicit EditDistance (const String& pattern, Mode mode = CASE_SENSITIVE);
+
+	~EditDistance();
+
+	/// @return the pattern length, in bytes.
+	size_t length() const {
+		return patternLength;
+	}
+
+	/// @return the edit distance between the pattern and text.
+	size_t distance (const String& text) const;
+
+	/**
+	 * Bounded distance: gives up as soon as the distance is known to be
+	 * greater than k, which is much faster on unrelated strings.
+	 * @return the edit distance between the pattern and text if it is at
+	 * most k, any value greater than k otherwise.
+	 */
+	size_t distance (const String& text, size_t k) const;
+
+	/// @return true if the edit distance between the pattern and text is at most k.
+	bool within (const String& text, size_t k) const {
+		return distance (text, k) <= k;
+	}
+
+	/**
+	 * Computes the distance to a list of candidates.
+	 * @param candidates the candidates.
+	 * @param count the number of candidates.
+	 * @param results receives the count distances.
+	 */
+	void distances (const String* candidates, size_t count, size_t* results) const;
+
+	/**
+	 * Looks for the closest candidate. The bound shrinks with the best
+	 * distance found so far, so that most candidates are rejected early.
+	 *
+	 * @param candidates the candidates.
+	 * @param count the number of candidates.
+	 * @param k the maximum distance.
+	 * @param dist receives the distance of the closest candidate, if not NULL.
+	 * @return the index of the first closest candidate, -1 if no candidate
+	 * is within distance k.
+	 */
+	ssize_t closest (const String* candidates, size_t count, size_t k, size_t* dist = 0) const;
+};
+
+/**
+ * @return the edit distance between two strings.
+ * @see EditDistance
+ */
+size_t editDistance (const String& a, const String& b, EditDistance::Mode mode = EditDistance::CASE_SENSITIVE);
+
+/**
+ * @return true if the edit distance between two strings is at most k,
+ * giving up as soon as it is known to be greater.
+ * @see EditDistance
+ */
+bool withinDistance (const String& a, const String& b, size_t k, EditDistance::Mode mode = EditDistance::CASE_SENSITIVE);
+
+} // namespace Fianet
+
+#endif // FIANET_EDITDISTANCE_H
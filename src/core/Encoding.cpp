@@ -0,0 +1,832 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "fianet-core.h"
+#include "ByteSearch.h"
+
+#if defined(FIANET_SIMD_DISPATCH) || defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSSE3__)
+	#include <tmmintrin.h>
+#endif
+
+namespace Fianet {
+
+/*
+ * Hexadecimal, base64 and base32 (RFC 4648) conversions, and UUIDs.
+ *
+ * Hexadecimal digits and base64 are converted 16 or 32 bytes at a time
+ * with pshufb lookups, after the base64 kernels of W. Mula and D. Lemire:
+ * a character is validated with two bit sets indexed by its nibbles, and
+ * the 6-bit values are packed with pmaddubsw / pmaddwd. The AVX2 kernels
+ * hand their last bytes over to the SSSE3 ones, which hand theirs over to
+ * the scalar code. Base32, rarer and shorter, is converted 5 bytes at a
+ * time in a 64-bit register.
+ *
+ * Decoding is strict: a byte out of the alphabet, a missing padding or
+ * unused bits that are not 0 fail the whole conversion, so that a value
+ * has a single accepted encoding.
+ */
+
+namespace {
+
+const char LOWER_DIGITS[] = "0123456789abcdef";
+const char UPPER_DIGITS[] = "0123456789ABCDEF";
+const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char BASE64URL_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+const char BASE32_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+/// Values of the hexadecimal digits, 0xFF for other bytes.
+const uint8_t HEX_VALUES[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/// Values of the base64 characters (RFC 4648, section 4), 0xFF for other bytes.
+const uint8_t BASE64_VALUES[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/// Values of the base64url characters (RFC 4648, section 5), 0xFF for other bytes.
+const uint8_t BASE64URL_VALUES[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+	0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/// Values of the base32 characters (RFC 4648, section 6), 0xFF for other bytes.
+const uint8_t BASE32_VALUES[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/// A base64 alphabet, with the lookup tables of its SIMD kernels.
+struct Base64Alphabet {
+	/// The 64 characters, by value.
+	const char* chars;
+	/// The values of the characters, 0xFF for other bytes.
+	const uint8_t* values;
+	/// Offsets from values to characters, by class (see base64Chars_ssse3()).
+	int8_t encodeShifts[16];
+	/// Bit sets of the classes a low nibble is invalid in.
+	int8_t lowNibbles[16];
+	/// The class of each high nibble, 0x10 for the invalid ones.
+	int8_t highNibbles[16];
+	/// Offsets from characters to values, by high nibble.
+	int8_t decodeShifts[16];
+	/// The character that has no offset of its own in decodeShifts...
+	char value63;
+	/// ... and what is added to its high nibble to find it.
+	int8_t value63Slot;
+};
+
+const Base64Alphabet BASE64 = {
+	BASE64_CHARS, BASE64_VALUES,
+	{ 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 65, 0, 0 },
+	{ 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A },
+	{ 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 },
+	{ 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 },
+	'/', -1
+};
+
+const Base64Alphabet BASE64URL = {
+	BASE64URL_CHARS, BASE64URL_VALUES,
+	{ 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 65, 0, 0 },
+	{ 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x3B, 0x3B, 0x3A, 0x3B, 0x1B },
+	{ 0x10, 0x10, 0x01, 0x02, 0x04, 0x20, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 },
+	{ 0, 0, 17, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, -32, 0, 0 },
+	'_', 8
+};
+
+/// Number of base32 characters of 0 to 4 bytes, and the other way round.
+const uint8_t BASE32_TAIL_CHARS[5] = { 0, 2, 4, 5, 7 };
+const int8_t BASE32_TAIL_BYTES[8] = { 0, -1, 1, -1, 2, 3, -1, 4 };
+
+/*
+ * Scalar kernels.
+ */
+
+void encodeHex_scalar (const uint8_t* s, size_t n, uint8_t* d, const char* digits)
+{
+	for (size_t i = 0; i < n; ++i) {
+		d[2 * i] = digits[s[i] >> 4];
+		d[2 * i + 1] = digits[s[i] & 0x0F];
+	}
+}
+
+/// Decodes 2 * n digits into n bytes.
+bool decodeHex_scalar (const uint8_t* s, size_t n, uint8_t* d)
+{
+	for (size_t i = 0; i < n; ++i) {
+		const uint8_t hi = HEX_VALUES[s[2 * i]];
+		const uint8_t lo = HEX_VALUES[s[2 * i + 1]];
+		if ((hi | lo) & 0x80) {
+			return false;
+		}
+		d[i] = static_cast<uint8_t>((hi << 4) | lo);
+	}
+	return true;
+}
+
+/// Encodes n bytes without padding. @return the number of characters written.
+size_t encodeBase64_scalar (const uint8_t* s, size_t n, uint8_t* d, const Base64Alphabet& a)
+{
+	uint8_t* const start = d;
+
+	for (; n >= 3; n -= 3, s += 3, d += 4) {
+		const uint32_t v = (s[0] << 16) | (s[1] << 8) | s[2];
+		d[0] = a.chars[v >> 18];
+		d[1] = a.chars[(v >> 12) & 63];
+		d[2] = a.chars[(v >> 6) & 63];
+		d[3] = a.chars[v & 63];
+	}
+	if (n > 0) {
+		const uint32_t v = (s[0] << 16) | ((n > 1) ? s[1] << 8 : 0);
+		*d++ = a.chars[v >> 18];
+		*d++ = a.chars[(v >> 12) & 63];
+		if (n > 1) {
+			*d++ = a.chars[(v >> 6) & 63];
+		}
+	}
+	return d - start;
+}
+
+/// Decodes n characters without padding, n % 4 being 0, 2 or 3.
+bool decodeBase64_scalar (const uint8_t* s, size_t n, uint8_t* d, const Base64Alphabet& a)
+{
+	for (; n >= 4; n -= 4, s += 4, d += 3) {
+		const uint8_t c0 = a.values[s[0]], c1 = a.values[s[1]], c2 = a.values[s[2]], c3 = a.values[s[3]];
+		if ((c0 | c1 | c2 | c3) & 0x80) {
+			return false;
+		}
+		const uint32_t v = (c0 << 18) | (c1 << 12) | (c2 << 6) | c3;
+		d[0] = static_cast<uint8_t>(v >> 16);
+		d[1] = static_cast<uint8_t>(v >> 8);
+		d[2] = static_cast<uint8_t>(v);
+	}
+	if (n > 0) {
+		const uint8_t c0 = a.values[s[0]], c1 = a.values[s[1]], c2 = (n > 2) ? a.values[s[2]] : 0;
+		const uint32_t v = (c0 << 18) | (c1 << 12) | (c2 << 6);
+		const size_t bytes = n - 1;
+		if (((c0 | c1 | c2) & 0x80) || (v & ((1U << (24 - 8 * bytes)) - 1)) != 0) {
+			return false;
+		}
+		d[0] = static_cast<uint8_t>(v >> 16);
+		if (bytes > 1) {
+			d[1] = static_cast<uint8_t>(v >> 8);
+		}
+	}
+	return true;
+}
+
+/// Encodes n bytes without padding. @return the number of characters written.
+size_t encodeBase32 (const uint8_t* s, size_t n, uint8_t* d)
+{
+	uint8_t* const start = d;
+
+	for (; n >= 5; n -= 5, s += 5, d += 8) {
+		const uint64_t v = (static_cast<uint64_t>(s[0]) << 32) | (static_cast<uint64_t>(s[1]) << 24)
+			| (static_cast<uint64_t>(s[2]) << 16) | (static_cast<uint64_t>(s[3]) << 8) | s[4];
+		for (int i = 0; i < 8; ++i) {
+			d[i] = BASE32_CHARS[(v >> (35 - 5 * i)) & 31];
+		}
+	}
+	if (n > 0) {
+		uint64_t v = 0;
+		for (size_t i = 0; i < n; ++i) {
+			v |= static_cast<uint64_t>(s[i]) << (32 - 8 * i);
+		}
+		for (unsigned i = 0; i < BASE32_TAIL_CHARS[n]; ++i) {
+			*d++ = BASE32_CHARS[(v >> (35 - 5 * i)) & 31];
+		}
+	}
+	return d - start;
+}
+
+/// Decodes n characters without padding, n % 8 being 0, 2, 4, 5 or 7.
+bool decodeBase32 (const uint8_t* s, size_t n, uint8_t* d)
+{
+	while (n > 0) {
+		const size_t chars = (n < 8) ? n : 8;
+		const size_t bytes = (n < 8) ? BASE32_TAIL_BYTES[n] : 5;
+		uint64_t v = 0;
+		uint8_t invalid = 0;
+		for (size_t i = 0; i < chars; ++i) {
+			const uint8_t c = BASE32_VALUES[s[i]];
+			invalid |= c;
+			v |= static_cast<uint64_t>(c) << (35 - 5 * i);
+		}
+		if ((invalid & 0x80) || (v & ((1ULL << (40 - 8 * bytes)) - 1)) != 0) {
+			return false;
+		}
+		for (size_t i = 0; i < bytes; ++i) {
+			d[i] = static_cast<uint8_t>(v >> (32 - 8 * i));
+		}
+		s += chars;
+		n -= chars;
+		d += bytes;
+	}
+	return true;
+}
+
+/*
+ * SSSE3 kernels.
+ */
+
+#if defined(FIANET_SIMD_SSSE3)
+FIANET_TARGET("ssse3")
+void encodeHex_ssse3 (const uint8_t* s, size_t n, uint8_t* d, const char* digits)
+{
+	const __m128i table = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(digits));
+	const __m128i nibble = _mm_set1_epi8 (0x0F);
+
+	for (; n >= 16; n -= 16, s += 16, d += 32) {
+		const __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(s));
+		const __m128i hi = _mm_shuffle_epi8 (table, _mm_and_si128 (_mm_srli_epi16 (v, 4), nibble));
+		const __m128i lo = _mm_shuffle_epi8 (table, _mm_and_si128 (v, nibble));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*>(d), _mm_unpacklo_epi8 (hi, lo));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*>(d + 16), _mm_unpackhi_epi8 (hi, lo));
+	}
+	encodeHex_scalar (s, n, d, digits);
+}
+
+/**
+ * Converts 16 hexadecimal digits to their values.
+ * @return false if one of the bytes is not a digit.
+ */
+FIANET_TARGET("ssse3")
+inline bool hexValues_ssse3 (__m128i& v)
+{
+	const __m128i digit = _mm_sub_epi8 (v, _mm_set1_epi8 ('0'));
+	const __m128i letter = _mm_sub_epi8 (_mm_or_si128 (v, _mm_set1_epi8 (0x20)), _mm_set1_epi8 ('a'));
+	const __m128i isDigit = _mm_cmpeq_epi8 (_mm_min_epu8 (digit, _mm_set1_epi8 (9)), digit);
+	const __m128i isLetter = _mm_cmpeq_epi8 (_mm_min_epu8 (letter, _mm_set1_epi8 (5)), letter);
+
+	v = _mm_or_si128 (_mm_and_si128 (isDigit, digit),
+		_mm_and_si128 (isLetter, _mm_add_epi8 (letter, _mm_set1_epi8 (10))));
+	return _mm_movemask_epi8 (_mm_or_si128 (isDigit, isLetter)) == 0xFFFF;
+}
+
+FIANET_TARGET("ssse3")
+bool decodeHex_ssse3 (const uint8_t* s, size_t n, uint8_t* d)
+{
+	// Pairs of nibbles to bytes: high * 16 + low.
+	const __m128i weights = _mm_set1_epi16 (0x0110);
+
+	for (; n >= 16; n -= 16, s += 32, d += 16) {
+		__m128i v0 = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(s));
+		__m128i v1 = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(s + 16));
+		if (!(hexValues_ssse3 (v0) & hexValues_ssse3 (v1))) {
+			return false;
+		}
+		_mm_storeu_si128 (reinterpret_cast<__m128i*>(d),
+			_mm_packus_epi16 (_mm_maddubs_epi16 (v0, weights), _mm_maddubs_epi16 (v1, weights)));
+	}
+	return decodeHex_scalar (s, n, d);
+}
+
+/**
+ * Converts the 16 6-bit values of 12 bytes, laid out by the shuffle of
+ * encodeBase64_ssse3(), to base64 characters.
+ */
+FIANET_TARGET("ssse3")
+inline __m128i base64Chars_ssse3 (__m128i in, __m128i shifts)
+{
+	// Bytes b0 b1 b2 of each 32-bit lane, shuffled as b1 b0 b2 b1, to
+	// the values b0 >> 2, (b0 & 3) << 4 | b1 >> 4, ... of the 4 characters.
+	const __m128i t0 = _mm_and_si128 (in, _mm_set1_epi32 (0x0FC0FC00));
+	const __m128i t1 = _mm_mulhi_epu16 (t0, _mm_set1_epi32 (0x04000040));
+	const __m128i t2 = _mm_and_si128 (in, _mm_set1_epi32 (0x003F03F0));
+	const __m128i t3 = _mm_mullo_epi16 (t2, _mm_set1_epi32 (0x01000010));
+	const __m128i values = _mm_or_si128 (t1, t3);
+
+	// Classes of values: 0 for 26-51, 1 to 10 for 52-61, 11 for 62, 12
+	// for 63, 13 for 0-25. The class gives the offset to the character.
+	__m128i classes = _mm_subs_epu8 (values, _mm_set1_epi8 (51));
+	const __m128i upper = _mm_cmpgt_epi8 (_mm_set1_epi8 (26), values);
+	classes = _mm_or_si128 (classes, _mm_and_si128 (upper, _mm_set1_epi8 (13)));
+	return _mm_add_epi8 (values, _mm_shuffle_epi8 (shifts, classes));
+}
+
+FIANET_TARGET("ssse3")
+size_t encodeBase64_ssse3 (const uint8_t* s, size_t n, uint8_t* d, const Base64Alphabet& a)
+{
+	const __m128i shuffle = _mm_setr_epi8 (1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const __m128i shifts = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(a.encodeShifts));
+	uint8_t* const start = d;
+
+	// 12 bytes at a time, from 16-byte loads.
+	for (; n >= 16; n -= 12, s += 12, d += 16) {
+		const __m128i in = _mm_shuffle_epi8 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(s)), shuffle);
+		_mm_storeu_si128 (reinterpret_cast<__m128i*>(d), base64Chars_ssse3 (in, shifts));
+	}
+	return (d - start) + encodeBase64_scalar (s, n, d, a);
+}
+
+/// The lookup tables of a Base64Alphabet, in registers.
+struct Base64Tables_ssse3 {
+	__m128i lowNibbles, highNibbles, decodeShifts, value63, value63Slot;
+
+	FIANET_TARGET("ssse3")
+	explicit Base64Tables_ssse3 (const Base64Alphabet& a)
+		: lowNibbles(_mm_loadu_si128 (reinterpret_cast<const __m128i*>(a.lowNibbles))),
+		highNibbles(_mm_loadu_si128 (reinterpret_cast<const __m128i*>(a.highNibbles))),
+		decodeShifts(_mm_loadu_si128 (reinterpret_cast<const __m128i*>(a.decodeShifts))),
+		value63(_mm_set1_epi8 (a.value63)), value63Slot(_mm_set1_epi8 (a.value63Slot))
+	{ }
+};
+
+/**
+ * Converts 16 base64 characters to their values.
+ * @return false if one of the bytes is out of the alphabet.
+ */
+FIANET_TARGET("ssse3")
+inline bool base64Values_ssse3 (__m128i& v, const Base64Tables_ssse3& t)
+{
+	const __m128i nibble = _mm_set1_epi8 (0x0F);
+	const __m128i high = _mm_and_si128 (_mm_srli_epi32 (v, 4), nibble);
+	const __m128i lowBits = _mm_shuffle_epi8 (t.lowNibbles, _mm_and_si128 (v, nibble));
+	const __m128i highBits = _mm_shuffle_epi8 (t.highNibbles, high);
+
+	if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_and_si128 (lowBits, highBits), _mm_setzero_si128())) != 0xFFFF) {
+		return false;
+	}
+	const __m128i slot = _mm_add_epi8 (high, _mm_and_si128 (_mm_cmpeq_epi8 (v, t.value63), t.value63Slot));
+	v = _mm_add_epi8 (v, _mm_shuffle_epi8 (t.decodeShifts, slot));
+	return true;
+}
+
+/// Packs 16 6-bit values into the first 12 bytes of a register.
+FIANET_TARGET("ssse3")
+inline __m128i base64Pack_ssse3 (__m128i v)
+{
+	const __m128i pairs = _mm_maddubs_epi16 (v, _mm_set1_epi32 (0x01400140));
+	const __m128i quads = _mm_madd_epi16 (pairs, _mm_set1_epi32 (0x00011000));
+	return _mm_shuffle_epi8 (quads, _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+FIANET_TARGET("ssse3")
+bool decodeBase64_ssse3 (const uint8_t* s, size_t n, uint8_t* d, const Base64Alphabet& a)
+{
+	const Base64Tables_ssse3 tables (a);
+
+	// 16 characters to 12 bytes at a time, from 16-byte stores: the 4 last
+	// bytes are overwritten by the next iteration, or by the scalar code.
+	for (; n >= 24; n -= 16, s += 16, d += 12) {
+		__m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(s));
+		if (!base64Values_ssse3 (v, tables)) {
+			return false;
+		}
+		_mm_storeu_si128 (reinterpret_cast<__m128i*>(d), base64Pack_ssse3 (v));
+	}
+	return decodeBase64_scalar (s, n, d, a);
+}
+#endif // FIANET_SIMD_SSSE3
+
+/*
+ * AVX2 kernels: the SSSE3 ones on the two 128-bit lanes, which cannot
+ * exchange bytes in a shuffle. They clear the upper halves of the
+ * registers before handing over to the SSSE3 kernels: mixing dirty AVX
+ * registers with SSE instructions costs hundreds of cycles on some CPUs.
+ */
+
+#if defined(FIANET_SIMD_AVX2)
+FIANET_TARGET("avx2")
+void encodeHex_avx2 (const uint8_t* s, size_t n, uint8_t* d, const char* digits)
+{
+	const __m256i table = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(digits)));
+	const __m256i nibble = _mm256_set1_epi8 (0x0F);
+
+	for (; n >= 32; n -= 32, s += 32, d += 64) {
+		const __m256i v = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(s));
+		const __m256i hi = _mm256_shuffle_epi8 (table, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), nibble));
+		const __m256i lo = _mm256_shuffle_epi8 (table, _mm256_and_si256 (v, nibble));
+		// Bytes 0-7 and 16-23, then 8-15 and 24-31.
+		const __m256i first = _mm256_unpacklo_epi8 (hi, lo);
+		const __m256i second = _mm256_unpackhi_epi8 (hi, lo);
+		_mm256_storeu_si256 (reinterpret_cast<__m256i*>(d), _mm256_permute2x128_si256 (first, second, 0x20));
+		_mm256_storeu_si256 (reinterpret_cast<__m256i*>(d + 32), _mm256_permute2x128_si256 (first, second, 0x31));
+	}
+	_mm256_zeroupper();
+	encodeHex_ssse3 (s, n, d, digits);
+}
+
+/// hexValues_ssse3() on 32 digits.
+FIANET_TARGET("avx2")
+inline bool hexValues_avx2 (__m256i& v)
+{
+	const __m256i digit = _mm256_sub_epi8 (v, _mm256_set1_epi8 ('0'));
+	const __m256i letter = _mm256_sub_epi8 (_mm256_or_si256 (v, _mm256_set1_epi8 (0x20)), _mm256_set1_epi8 ('a'));
+	const __m256i isDigit = _mm256_cmpeq_epi8 (_mm256_min_epu8 (digit, _mm256_set1_epi8 (9)), digit);
+	const __m256i isLetter = _mm256_cmpeq_epi8 (_mm256_min_epu8 (letter, _mm256_set1_epi8 (5)), letter);
+
+	v = _mm256_or_si256 (_mm256_and_si256 (isDigit, digit),
+		_mm256_and_si256 (isLetter, _mm256_add_epi8 (letter, _mm256_set1_epi8 (10))));
+	return _mm256_movemask_epi8 (_mm256_or_si256 (isDigit, isLetter)) == -1;
+}
+
+FIANET_TARGET("avx2")
+bool decodeHex_avx2 (const uint8_t* s, size_t n, uint8_t* d)
+{
+	const __m256i weights = _mm256_set1_epi16 (0x0110);
+
+	for (; n >= 32; n -= 32, s += 64, d += 32) {
+		__m256i v0 = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(s));
+		__m256i v1 = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(s + 32));
+		if (!(hexValues_avx2 (v0) & hexValues_avx2 (v1))) {
+			return false;
+		}
+		// The pack interleaves the lanes: bytes 0-7, 16-23, 8-15, 24-31.
+		const __m256i packed = _mm256_packus_epi16 (_mm256_maddubs_epi16 (v0, weights), _mm256_maddubs_epi16 (v1, weights));
+		_mm256_storeu_si256 (reinterpret_cast<__m256i*>(d), _mm256_permute4x64_epi64 (packed, 0xD8));
+	}
+	_mm256_zeroupper();
+	return decodeHex_ssse3 (s, n, d);
+}
+
+/// base64Chars_ssse3() on 24 bytes, 12 per lane.
+FIANET_TARGET("avx2")
+inline __m256i base64Chars_avx2 (__m256i in, __m256i shifts)
+{
+	const __m256i t0 = _mm256_and_si256 (in, _mm256_set1_epi32 (0x0FC0FC00));
+	const __m256i t1 = _mm256_mulhi_epu16 (t0, _mm256_set1_epi32 (0x04000040));
+	const __m256i t2 = _mm256_and_si256 (in, _mm256_set1_epi32 (0x003F03F0));
+	const __m256i t3 = _mm256_mullo_epi16 (t2, _mm256_set1_epi32 (0x01000010));
+	const __m256i values = _mm256_or_si256 (t1, t3);
+
+	__m256i classes = _mm256_subs_epu8 (values, _mm256_set1_epi8 (51));
+	const __m256i upper = _mm256_cmpgt_epi8 (_mm256_set1_epi8 (26), values);
+	classes = _mm256_or_si256 (classes, _mm256_and_si256 (upper, _mm256_set1_epi8 (13)));
+	return _mm256_add_epi8 (values, _mm256_shuffle_epi8 (shifts, classes));
+}
+
+FIANET_TARGET("avx2")
+size_t encodeBase64_avx2 (const uint8_t* s, size_t n, uint8_t* d, const Base64Alphabet& a)
+{
+	const __m256i shuffle = _mm256_setr_epi8 (1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const __m256i shifts = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(a.encodeShifts)));
+	uint8_t* const start = d;
+
+	// 24 bytes at a time, 12 in each lane.
+	for (; n >= 28; n -= 24, s += 24, d += 32) {
+		const __m128i lo = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(s));
+		const __m128i hi = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(s + 12));
+		const __m256i in = _mm256_shuffle_epi8 (_mm256_inserti128_si256 (_mm256_castsi128_si256 (lo), hi, 1), shuffle);
+		_mm256_storeu_si256 (reinterpret_cast<__m256i*>(d), base64Chars_avx2 (in, shifts));
+	}
+	_mm256_zeroupper();
+	return (d - start) + encodeBase64_ssse3 (s, n, d, a);
+}
+
+FIANET_TARGET("avx2")
+bool decodeBase64_avx2 (const uint8_t* s, size_t n, uint8_t* d, const Base64Alphabet& a)
+{
+	const __m256i lowNibbles = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(a.lowNibbles)));
+	const __m256i highNibbles = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(a.highNibbles)));
+	const __m256i decodeShifts = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(a.decodeShifts)));
+	const __m256i value63 = _mm256_set1_epi8 (a.value63);
+	const __m256i value63Slot = _mm256_set1_epi8 (a.value63Slot);
+	const __m256i nibble = _mm256_set1_epi8 (0x0F);
+	const __m256i shuffle = _mm256_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	const __m256i gather = _mm256_setr_epi32 (0, 1, 2, 4, 5, 6, 3, 7);
+
+	// 32 characters to 24 bytes at a time, from 32-byte stores.
+	for (; n >= 44; n -= 32, s += 32, d += 24) {
+		__m256i v = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(s));
+		const __m256i high = _mm256_and_si256 (_mm256_srli_epi32 (v, 4), nibble);
+		const __m256i lowBits = _mm256_shuffle_epi8 (lowNibbles, _mm256_and_si256 (v, nibble));
+		const __m256i highBits = _mm256_shuffle_epi8 (highNibbles, high);
+		if (!_mm256_testz_si256 (lowBits, highBits)) {
+			return false;
+		}
+		const __m256i slot = _mm256_add_epi8 (high, _mm256_and_si256 (_mm256_cmpeq_epi8 (v, value63), value63Slot));
+		v = _mm256_add_epi8 (v, _mm256_shuffle_epi8 (decodeShifts, slot));
+
+		const __m256i pairs = _mm256_maddubs_epi16 (v, _mm256_set1_epi32 (0x01400140));
+		const __m256i quads = _mm256_madd_epi16 (pairs, _mm256_set1_epi32 (0x00011000));
+		_mm256_storeu_si256 (reinterpret_cast<__m256i*>(d),
+			_mm256_permutevar8x32_epi32 (_mm256_shuffle_epi8 (quads, shuffle), gather));
+	}
+	_mm256_zeroupper();
+	return decodeBase64_ssse3 (s, n, d, a);
+}
+#endif // FIANET_SIMD_AVX2
+
+/*
+ * Run time dispatch, see CpuFeatures.h.
+ */
+
+void encodeHex (const uint8_t* s, size_t n, uint8_t* d, const char* digits)
+{
+#if defined(FIANET_SIMD_AVX2)
+	if (getSimdLevel() >= SIMD_AVX2) {
+		return encodeHex_avx2 (s, n, d, digits);
+	}
+#endif
+#if defined(FIANET_SIMD_SSSE3)
+	if (getSimdLevel() >= SIMD_SSSE3) {
+		return encodeHex_ssse3 (s, n, d, digits);
+	}
+#endif
+	encodeHex_scalar (s, n, d, digits);
+}
+
+bool decodeHex (const uint8_t* s, size_t n, uint8_t* d)
+{
+#if defined(FIANET_SIMD_AVX2)
+	if (getSimdLevel() >= SIMD_AVX2) {
+		return decodeHex_avx2 (s, n, d);
+	}
+#endif
+#if defined(FIANET_SIMD_SSSE3)
+	if (getSimdLevel() >= SIMD_SSSE3) {
+		return decodeHex_ssse3 (s, n, d);
+	}
+#endif
+	return decodeHex_scalar (s, n, d);
+}
+
+size_t encodeBase64 (const uint8_t* s, size_t n, uint8_t* d, const Base64Alphabet& a)
+{
+#if defined(FIANET_SIMD_AVX2)
+	if (getSimdLevel() >= SIMD_AVX2) {
+		return encodeBase64_avx2 (s, n, d, a);
+	}
+#endif
+#if defined(FIANET_SIMD_SSSE3)
+	if (getSimdLevel() >= SIMD_SSSE3) {
+		return encodeBase64_ssse3 (s, n, d, a);
+	}
+#endif
+	return encodeBase64_scalar (s, n, d, a);
+}
+
+bool decodeBase64 (const uint8_t* s, size_t n, uint8_t* d, const Base64Alphabet& a)
+{
+#if defined(FIANET_SIMD_AVX2)
+	if (getSimdLevel() >= SIMD_AVX2) {
+		return decodeBase64_avx2 (s, n, d, a);
+	}
+#endif
+#if defined(FIANET_SIMD_SSSE3)
+	if (getSimdLevel() >= SIMD_SSSE3) {
+		return decodeBase64_ssse3 (s, n, d, a);
+	}
+#endif
+	return decodeBase64_scalar (s, n, d, a);
+}
+
+/**
+ * Counts the base64 characters of some data, without their padding.
+ * @return false if the length or the padding is not valid.
+ */
+bool base64Characters (const uint8_t* p, size_t len, bool paddingRequired, size_t& chars)
+{
+	size_t padding = 0;
+
+	if (len % 4 == 0) {
+		padding = (len > 0 && p[len - 1] == '=');
+		padding += (padding && p[len - 2] == '=');
+	} else if (paddingRequired) {
+		return false;
+	}
+	chars = len - padding;
+	return (chars % 4 != 1);
+}
+
+} // namespace
+
+XString& XString::appendHex (const String& data, bool upperCase)
+{
+	String s (data);
+	const size_t n = s.length();
+	uint8_t* d = appendSpace (2 * n, s);
+
+	encodeHex (s.bytes(), n, d, upperCase ? UPPER_DIGITS : LOWER_DIGITS);
+	return *this;
+}
+
+XString& XString::appendBase64 (const String& data)
+{
+	String s (data);
+	const size_t n = s.length();
+	const size_t size = (n + 2) / 3 * 4;
+	uint8_t* d = appendSpace (size, s);
+
+	const size_t written = encodeBase64 (s.bytes(), n, d, BASE64);
+	memset (d + written, '=', size - written);
+	return *this;
+}
+
+XString& XString::appendBase64Url (const String& data)
+{
+	String s (data);
+	const size_t n = s.length();
+	const size_t size = n / 3 * 4 + ((n % 3) ? n % 3 + 1 : 0);
+	uint8_t* d = appendSpace (size, s);
+
+	encodeBase64 (s.bytes(), n, d, BASE64URL);
+	return *this;
+}
+
+XString& XString::appendBase32 (const String& data)
+{
+	String s (data);
+	const size_t n = s.length();
+	const size_t size = (n + 4) / 5 * 8;
+	uint8_t* d = appendSpace (size, s);
+
+	const size_t written = encodeBase32 (s.bytes(), n, d);
+	memset (d + written, '=', size - written);
+	return *this;
+}
+
+XString& XString::appendUuid (const uint8_t uuid[16], bool upperCase)
+{
+	uint8_t digits[32];
+	encodeHex (uuid, 16, digits, upperCase ? UPPER_DIGITS : LOWER_DIGITS);
+
+	uint8_t* d = appendSpace (36);
+	memcpy (d, digits, 8);
+	d[8] = '-';
+	memcpy (d + 9, digits + 8, 4);
+	d[13] = '-';
+	memcpy (d + 14, digits + 12, 4);
+	d[18] = '-';
+	memcpy (d + 19, digits + 16, 4);
+	d[23] = '-';
+	memcpy (d + 24, digits + 20, 12);
+	return *this;
+}
+
+bool String::decodeHexInto (XString& out) const
+{
+	String s (*this);
+	const size_t n = s.length() / 2;
+
+	if (s.length() % 2 != 0) {
+		return false;
+	}
+	const size_t start = out.length();
+	uint8_t* d = out.appendSpace (n, s);
+	if (!decodeHex (s.bytes(), n, d)) {
+		out.resize (start);
+		return false;
+	}
+	return true;
+}
+
+bool String::decodeBase64Into (XString& out) const
+{
+	String s (*this);
+	size_t chars;
+
+	if (!base64Characters (s.bytes(), s.length(), true, chars)) {
+		return false;
+	}
+	const size_t start = out.length();
+	uint8_t* d = out.appendSpace (chars / 4 * 3 + ((chars % 4) ? chars % 4 - 1 : 0), s);
+	if (!decodeBase64 (s.bytes(), chars, d, BASE64)) {
+		out.resize (start);
+		return false;
+	}
+	return true;
+}
+
+bool String::decodeBase64UrlInto (XString& out) const
+{
+	String s (*this);
+	size_t chars;
+
+	if (!base64Characters (s.bytes(), s.length(), false, chars)) {
+		return false;
+	}
+	const size_t start = out.length();
+	uint8_t* d = out.appendSpace (chars / 4 * 3 + ((chars % 4) ? chars % 4 - 1 : 0), s);
+	if (!decodeBase64 (s.bytes(), chars, d, BASE64URL)) {
+		out.resize (start);
+		return false;
+	}
+	return true;
+}
+
+bool String::decodeBase32Into (XString& out) const
+{
+	String s (*this);
+	const uint8_t* p = s.bytes();
+	size_t chars = s.length();
+
+	if (chars % 8 != 0) {
+		return false;
+	}
+	for (int i = 0; i < 6 && chars > 0 && p[chars - 1] == '='; ++i) {
+		--chars;
+	}
+	if (BASE32_TAIL_BYTES[chars % 8] < 0) {
+		return false;
+	}
+	const size_t start = out.length();
+	uint8_t* d = out.appendSpace (chars / 8 * 5 + BASE32_TAIL_BYTES[chars % 8], s);
+	if (!decodeBase32 (s.bytes(), chars, d)) {
+		out.resize (start);
+		return false;
+	}
+	return true;
+}
+
+bool String::decodeUuid (uint8_t uuid[16]) const
+{
+	uint8_t digits[32];
+	uint8_t bytes[16];
+
+	if (len != 36 || ptr[8] != '-' || ptr[13] != '-' || ptr[18] != '-' || ptr[23] != '-') {
+		return false;
+	}
+	memcpy (digits, ptr, 8);
+	memcpy (digits + 8, ptr + 9, 4);
+	memcpy (digits + 12, ptr + 14, 4);
+	memcpy (digits + 16, ptr + 19, 4);
+	memcpy (digits + 20, ptr + 24, 12);
+	if (!decodeHex (digits, 16, bytes)) {
+		return false;
+	}
+	memcpy (uuid, bytes, 16);
+	return true;
+}
+
+} // namespace Fianet
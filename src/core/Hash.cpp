@@ -0,0 +1,180 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "fianet-core.h"
+#include "Multiply.h"
+
+namespace Fianet {
+
+/*
+ * wyhash (final version 4, by Wang Yi): 64x64->128 bit multiplications
+ * folded with a xor. Inputs up to 16 bytes are read with 2 to 4 possibly
+ * overlapping loads, longer inputs 16 or 48 bytes at a time.
+ *
+ * The case-insensitive variants run the same algorithm on folded loads:
+ * folding commutes with the loads, so no folded copy of the input is made.
+ */
+
+namespace {
+
+const uint64_t SECRET[4] = {
+	0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+/// a * b: the low bits in a, the high ones in b.
+inline void multiply (uint64_t& a, uint64_t& b)
+{
+	uint64_t high, low;
+	multiply128 (a, b, high, low);
+	a = low;
+	b = high;
+}
+
+inline uint64_t mix (uint64_t a, uint64_t b)
+{
+	multiply (a, b);
+	return a ^ b;
+}
+
+/// Bytes as they are.
+struct NoFolding {
+	static uint64_t word (uint64_t w) {
+		return w;
+	}
+	static uint8_t byte (uint8_t c) {
+		return c;
+	}
+};
+
+/// ASCII lower case letters to upper case, 8 bytes at a time.
+struct AsciiFolding {
+	static uint64_t word (uint64_t w) {
+		const uint64_t ones = 0x0101010101010101ULL;
+		const uint64_t low = w & (0x7F * ones);
+		const uint64_t geA = low + (0x80 - 'a') * ones;
+		const uint64_t gtZ = low + (0x80 - 'z' - 1) * ones;
+		const uint64_t letters = (geA ^ gtZ) & ~w & (0x80 * ones);
+		return w ^ (letters >> 2);
+	}
+	static uint8_t byte (uint8_t c) {
+		return (static_cast<uint8_t>(c - 'a') < 26) ? static_cast<uint8_t>(c - 0x20) : c;
+	}
+};
+
+/// Bytes folded with toupper().
+struct LocaleFolding {
+	static uint64_t word (uint64_t w) {
+		uint64_t res = 0;
+		for (int shift = 0; shift < 64; shift += 8) {
+			res |= static_cast<uint64_t>(static_cast<uint8_t>(toupper (static_cast<uint8_t>(w >> shift)))) << shift;
+		}
+		return res;
+	}
+	static uint8_t byte (uint8_t c) {
+		return static_cast<uint8_t>(toupper (c));
+	}
+};
+
+template <class Folding>
+inline uint64_t read8 (const uint8_t* p)
+{
+	uint64_t v;
+	memcpy (&v, p, sizeof(v));
+	return Folding::word (v);
+}
+
+template <class Folding>
+inline uint64_t read4 (const uint8_t* p)
+{
+	uint32_t v;
+	memcpy (&v, p, sizeof(v));
+	return Folding::word (v);
+}
+
+template <class Folding>
+uint64_t wyhash (const void* s, size_t len, uint64_t seed)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(s);
+	uint64_t a, b;
+
+	seed ^= mix (seed ^ SECRET[0], SECRET[1]);
+
+	if (__builtin_expect (len <= 16, 1)) {
+		if (len >= 4) {
+			const size_t off = (len >> 3) << 2;
+			a = (read4<Folding>(p) << 32) | read4<Folding>(p + off);
+			b = (read4<Folding>(p + len - 4) << 32) | read4<Folding>(p + len - 4 - off);
+		} else if (len > 0) {
+			a = (static_cast<uint64_t>(Folding::byte (p[0])) << 16)
+				| (static_cast<uint64_t>(Folding::byte (p[len >> 1])) << 8)
+				| Folding::byte (p[len - 1]);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = len;
+		if (i > 48) {
+			uint64_t seed1 = seed, seed2 = seed;
+			do {
+				seed = mix (read8<Folding>(p) ^ SECRET[1], read8<Folding>(p + 8) ^ seed);
+				seed1 = mix (read8<Folding>(p + 16) ^ SECRET[2], read8<Folding>(p + 24) ^ seed1);
+				seed2 = mix (read8<Folding>(p + 32) ^ SECRET[3], read8<Folding>(p + 40) ^ seed2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= seed1 ^ seed2;
+		}
+		while (i > 16) {
+			seed = mix (read8<Folding>(p) ^ SECRET[1], read8<Folding>(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = read8<Folding>(p + i - 16);
+		b = read8<Folding>(p + i - 8);
+	}
+
+	a ^= SECRET[1];
+	b ^= seed;
+	multiply (a, b);
+	return mix (a ^ SECRET[0] ^ len, b ^ SECRET[1]);
+}
+
+} // namespace
+
+uint64_t memhash (const void* s, size_t len, uint64_t seed)
+{
+	return wyhash<NoFolding>(s, len, seed);
+}
+
+uint64_t memihash (const void* s, size_t len, uint64_t seed)
+{
+	if (getCaseFolding() == ASCII_CASE_FOLDING) {
+		return wyhash<AsciiFolding>(s, len, seed);
+	}
+	return wyhash<LocaleFolding>(s, len, seed);
+}
+
+uint64_t StringView::hash() const
+{
+	return wyhash<NoFolding>(ptr, len, 0);
+}
+
+} // namespace Fianet
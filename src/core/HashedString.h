@@ -0,0 +1,101 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_HASHEDSTRING_H
+#define FIANET_HASHEDSTRING_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * @class HashedString
+ * A String view stored with its hash (see String::hash()), computed once.
+ *
+ * Looking up the same key in several hashed containers, or rehashing a
+ * container, then costs no further hashing, and comparing two
+ * HashedStrings compares their hashes before their bytes.
+ *
+ * @code
+ * std::unordered_map<HashedString, Merchant, HashedString::Hasher> merchants;
+ * HashedString key (record.merchantId);
+ * merchants.find (key);
+ * @endcode
+ *
+ * Like any String, a HashedString references data it does not own, which
+ * must outlive it. The view cannot be modified, so that the hash stays valid.
+ */
+class HashedString {
+	String view;
+	uint64_t hashValue;
+
+public:
+	/**
+	 * Allows HashedStrings to be used as keys of hashed containers, with
+	 * their operator ==.
+	 */
+	struct Hasher {
+		size_t operator() (const HashedString& s) const {
+			return static_cast<size_t>(s.hash());
+		}
+	};
+
+	/// Creates an empty view.
+	HashedString()
+		: view(), hashValue(memhash (0, 0))
+	{ }
+
+	/// Creates a view on the data of s, and hashes it.
+	explicit HashedString (const StringView& s)
+		: view(s), hashValue(s.hash())
+	{ }
+
+	/// @return the String view.
+	const String& str() const {
+		return view;
+	}
+
+	/// @return the hash of the view, equal to str().hash().
+	uint64_t hash() const {
+		return hashValue;
+	}
+
+	/// @return the length of the view, in bytes.
+	size_t length() const {
+		return view.length();
+	}
+
+	/// @return true if both views have equal contents.
+	bool equals (const HashedString& s) const {
+		return (hashValue == s.hashValue && view.equals (s.view));
+	}
+
+	bool operator == (const HashedString& s) const {
+		return equals (s);
+	}
+
+	bool operator != (const HashedString& s) const {
+		return !equals (s);
+	}
+};
+
+} // namespace Fianet
+
+#endif // FIANET_HASHEDSTRING_H
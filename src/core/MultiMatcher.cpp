@@ -0,0 +1,579 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "MultiMatcher.h"
+
+#include "ByteSearch.h"
+
+#if defined(FIANET_SIMD_DISPATCH)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace Fianet {
+
+namespace {
+
+const uint32_t NONE = UINT32_MAX;
+
+inline uint8_t foldCase (uint8_t c)
+{
+	return (static_cast<uint8_t>(c - 'A') < 26) ? static_cast<uint8_t>(c + ('a' - 'A')) : c;
+}
+
+template <class T>
+T* allocateArray (size_t nb)
+{
+	T* addr = static_cast<T*>(std::malloc (nb * sizeof(T)));
+	if (!addr && nb) {
+		THROW ("MultiMatcher: malloc() returned NULL");
+	}
+	return addr;
+}
+
+template <class T>
+void resizeArray (T*& addr, size_t nb)
+{
+	T* res = static_cast<T*>(std::realloc (addr, nb * sizeof(T)));
+	if (!res) {
+		THROW ("MultiMatcher: realloc() returned NULL");
+	}
+	addr = res;
+}
+
+/*
+ * Match sinks. Scanning stops when a sink returns false, and may also stop
+ * as soon as no further match can start at or before sink.limit.
+ */
+
+struct AnySink {
+	size_t limit;
+	bool found;
+
+	AnySink()
+		: limit(SIZE_MAX), found(false)
+	{ }
+
+	bool operator() (uint32_t, size_t) {
+		found = true;
+		return false;
+	}
+};
+
+struct LeftmostSink {
+	size_t limit;
+	MultiMatcher::Match& best;
+
+	explicit LeftmostSink (MultiMatcher::Match& m)
+		: limit(SIZE_MAX), best(m)
+	{ }
+
+	bool found() const {
+		return limit != SIZE_MAX;
+	}
+
+	bool operator() (uint32_t pattern, size_t offset) {
+		if (!found() || offset < best.offset || (offset == best.offset && pattern < best.pattern)) {
+			best.pattern = pattern;
+			best.offset = offset;
+			limit = offset;
+		}
+		return true;
+	}
+};
+
+struct HandlerSink {
+	size_t limit;
+	MultiMatcher::Handler& handler;
+	size_t count;
+
+	explicit HandlerSink (MultiMatcher::Handler& h)
+		: limit(SIZE_MAX), handler(h), count(0)
+	{ }
+
+	bool operator() (uint32_t pattern, size_t offset) {
+		++count;
+		return handler.onMatch (pattern, offset);
+	}
+};
+
+} // namespace
+
+MultiMatcher::MultiMatcher (Mode m)
+	: mode(m), engine(AUTO), compiled(false), patterns(), patternOffsets(0), patternLengths(0),
+	  patternCount(0), patternCapacity(0), minLength(0), maxLength(0), byteClasses(), classCount(0),
+	  transitions(0), stateCount(0), firstMatchState(0), outputIndex(0), outputs(0), dictionaryLinks(0),
+	  teddyMasks(), teddyLength(0), bucketIndex(), bucketPatterns(0)
+{
+}
+
+MultiMatcher::~MultiMatcher()
+{
+	release();
+}
+
+void MultiMatcher::release()
+{
+	std::free (patternOffsets);
+	std::free (patternLengths);
+	std::free (transitions);
+	std::free (outputIndex);
+	std::free (outputs);
+	std::free (dictionaryLinks);
+	std::free (bucketPatterns);
+	patternOffsets = patternLengths = transitions = outputIndex = outputs = dictionaryLinks = bucketPatterns = 0;
+}
+
+uint32_t MultiMatcher::add (const String& pattern)
+{
+	if (compiled) {
+		THROW ("MultiMatcher::add(): the matcher is already compiled");
+	} else if (pattern.length() == 0) {
+		THROW ("MultiMatcher::add(): empty pattern");
+	}
+
+	if (patternCount == patternCapacity) {
+		patternCapacity = patternCapacity ? patternCapacity * 2 : 16;
+		resizeArray (patternOffsets, patternCapacity);
+		resizeArray (patternLengths, patternCapacity);
+	}
+
+	patternOffsets[patternCount] = patterns.length();
+	patternLengths[patternCount] = pattern.length();
+
+	if (mode == IGNORE_CASE) {
+		for (size_t i = 0; i < pattern.length(); ++i) {
+			patterns.appendChar (foldCase (pattern.bytes()[i]));
+		}
+	} else {
+		patterns.append (pattern);
+	}
+
+	if (patternCount == 0 || pattern.length() < minLength) {
+		minLength = pattern.length();
+	}
+	if (pattern.length() > maxLength) {
+		maxLength = pattern.length();
+	}
+
+	return patternCount++;
+}
+
+String MultiMatcher::pattern (uint32_t id) const
+{
+	if (id >= patternCount) {
+		return String::blank();
+	}
+	return String (patterns.cstr() + patternOffsets[id], patternLengths[id]);
+}
+
+void MultiMatcher::compile (Engine e)
+{
+	if (compiled) {
+		THROW ("MultiMatcher::compile(): the matcher is already compiled");
+	}
+
+	const bool teddy = (e != AHO_CORASICK && patternCount > 0 && patternCount <= TEDDY_MAX_PATTERNS && minLength >= 2
+			&& getSimdLevel() >= SIMD_SSSE3);
+
+	if (teddy) {
+		compileTeddy();
+		engine = TEDDY;
+	} else {
+		compileAhoCorasick();
+		engine = AHO_CORASICK;
+	}
+	compiled = true;
+}
+
+void MultiMatcher::compileAhoCorasick()
+{
+	const uint8_t* bytes = patterns.bytes();
+	const size_t total = patterns.length();
+
+	// Byte classes: one per distinct pattern byte, class 0 for the others.
+	bool used[256] = { false };
+	for (size_t i = 0; i < total; ++i) {
+		used[bytes[i]] = true;
+	}
+	classCount = 1;
+	for (size_t b = 0; b < 256; ++b) {
+		byteClasses[b] = used[b] ? classCount++ : 0;
+	}
+	if (classCount > 256) {
+		// Every byte is used, class 0 is useless.
+		for (size_t b = 0; b < 256; ++b) {
+			--byteClasses[b];
+		}
+		classCount = 256;
+	}
+	if (mode == IGNORE_CASE) {
+		for (uint8_t c = 'A'; c <= 'Z'; ++c) {
+			byteClasses[c] = byteClasses[foldCase (c)];
+		}
+	}
+
+	const size_t C = classCount;
+	const size_t maxStates = total + 1;
+
+	if (maxStates * C > UINT32_MAX) {
+		THROW ("MultiMatcher::compile(): too many patterns");
+	}
+
+	// Trie, with node numbers (not premultiplied) and 0 for 'no child'.
+	uint32_t* trie = static_cast<uint32_t*>(std::calloc (maxStates * C, sizeof(uint32_t)));
+	uint32_t* firstOutput = allocateArray<uint32_t> (maxStates);
+	uint32_t* nextOutput = allocateArray<uint32_t> (patternCount);
+	uint32_t* fail = allocateArray<uint32_t> (maxStates);
+	uint32_t* dict = allocateArray<uint32_t> (maxStates);
+	uint32_t* queue = allocateArray<uint32_t> (maxStates);
+	uint32_t* ids = allocateArray<uint32_t> (maxStates);
+
+	if (!trie) {
+		THROW ("MultiMatcher::compile(): calloc() returned NULL");
+	}
+
+	for (size_t s = 0; s < maxStates; ++s) {
+		firstOutput[s] = NONE;
+	}
+
+	size_t nodes = 1;
+
+	// Patterns are inserted last first so that output lists are sorted.
+	for (size_t id = patternCount; id-- > 0; ) {
+		const uint8_t* p = bytes + patternOffsets[id];
+		uint32_t s = 0;
+
+		for (size_t i = 0; i < patternLengths[id]; ++i) {
+			uint32_t& t = trie[s * C + byteClasses[p[i]]];
+			if (!t) {
+				t = nodes++;
+			}
+			s = t;
+		}
+		nextOutput[id] = firstOutput[s];
+		firstOutput[s] = id;
+	}
+
+	// Breadth-first traversal: failure links, dictionary links, and missing
+	// transitions, which are taken from the failure state.
+	size_t head = 0, tail = 0;
+
+	fail[0] = 0;
+	dict[0] = NONE;
+	for (size_t c = 0; c < C; ++c) {
+		const uint32_t t = trie[c];
+		if (t) {
+			fail[t] = 0;
+			dict[t] = NONE;
+			queue[tail++] = t;
+		}
+	}
+
+	while (head < tail) {
+		const uint32_t s = queue[head++];
+
+		for (size_t c = 0; c < C; ++c) {
+			uint32_t& t = trie[s * C + c];
+			const uint32_t f = trie[fail[s] * C + c];
+
+			if (t) {
+				fail[t] = f;
+				dict[t] = (firstOutput[f] != NONE) ? f : dict[f];
+				queue[tail++] = t;
+			} else {
+				t = f;
+			}
+		}
+	}
+
+	// Numbering: states without outputs first, in breadth-first order.
+	size_t nonMatching = 1, matching = 0;
+
+	ids[0] = 0;
+	for (size_t i = 0; i < tail; ++i) {
+		const uint32_t s = queue[i];
+		if (firstOutput[s] == NONE && dict[s] == NONE) {
+			ids[s] = nonMatching++;
+		}
+	}
+	for (size_t i = 0; i < tail; ++i) {
+		const uint32_t s = queue[i];
+		if (firstOutput[s] != NONE || dict[s] != NONE) {
+			ids[s] = nonMatching + matching++;
+		}
+	}
+
+	stateCount = nodes;
+	firstMatchState = nonMatching * C;
+
+	transitions = allocateArray<uint32_t> (nodes * C);
+	for (size_t s = 0; s < nodes; ++s) {
+		for (size_t c = 0; c < C; ++c) {
+			transitions[ids[s] * C + c] = ids[trie[s * C + c]] * C;
+		}
+	}
+
+	outputIndex = allocateArray<uint32_t> (matching + 1);
+	outputs = allocateArray<uint32_t> (patternCount);
+	dictionaryLinks = allocateArray<uint32_t> (matching);
+
+	// Queue entries are in breadth-first order, match states keep it.
+	size_t nbOutputs = 0, m = 0;
+	for (size_t i = 0; i < tail; ++i) {
+		const uint32_t s = queue[i];
+		if (firstOutput[s] == NONE && dict[s] == NONE) {
+			continue;
+		}
+		outputIndex[m] = nbOutputs;
+		for (uint32_t id = firstOutput[s]; id != NONE; id = nextOutput[id]) {
+			outputs[nbOutputs++] = id;
+		}
+		dictionaryLinks[m] = (dict[s] != NONE) ? ids[dict[s]] * C : 0;
+		++m;
+	}
+	outputIndex[m] = nbOutputs;
+
+	std::free (trie);
+	std::free (firstOutput);
+	std::free (nextOutput);
+	std::free (fail);
+	std::free (dict);
+	std::free (queue);
+	std::free (ids);
+}
+
+void MultiMatcher::compileTeddy()
+{
+	const uint8_t* bytes = patterns.bytes();
+
+	teddyLength = (minLength < 3) ? minLength : 3;
+
+	// Patterns sharing their first bytes go to the same bucket.
+	bucketPatterns = allocateArray<uint32_t> (patternCount);
+	for (size_t i = 0; i < patternCount; ++i) {
+		const uint32_t id = i;
+		size_t j = i;
+		while (j > 0 && memcmp (bytes + patternOffsets[bucketPatterns[j - 1]], bytes + patternOffsets[id], teddyLength) > 0) {
+			bucketPatterns[j] = bucketPatterns[j - 1];
+			--j;
+		}
+		bucketPatterns[j] = id;
+	}
+	for (size_t b = 0; b <= 8; ++b) {
+		bucketIndex[b] = (b * patternCount) / 8;
+	}
+
+	memset (teddyMasks, 0, sizeof(teddyMasks));
+	for (size_t b = 0; b < 8; ++b) {
+		for (size_t k = bucketIndex[b]; k < bucketIndex[b + 1]; ++k) {
+			const uint8_t* p = bytes + patternOffsets[bucketPatterns[k]];
+
+			for (size_t j = 0; j < teddyLength; ++j) {
+				teddyMasks[j][0][p[j] & 0x0F] |= (1 << b);
+				teddyMasks[j][1][p[j] >> 4] |= (1 << b);
+				if (mode == IGNORE_CASE && static_cast<uint8_t>(p[j] - 'a') < 26) {
+					const uint8_t u = p[j] - ('a' - 'A');
+					teddyMasks[j][0][u & 0x0F] |= (1 << b);
+					teddyMasks[j][1][u >> 4] |= (1 << b);
+				}
+			}
+		}
+	}
+}
+
+bool MultiMatcher::verify (uint32_t id, const uint8_t* text) const
+{
+	const uint8_t* p = patterns.bytes() + patternOffsets[id];
+	const size_t len = patternLengths[id];
+
+	if (mode == CASE_SENSITIVE) {
+		return (memcmp (text, p, len) == 0);
+	}
+
+	for (size_t i = 0; i < len; ++i) {
+		if (foldCase (text[i]) != p[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <class Sink>
+void MultiMatcher::scanAhoCorasick (const uint8_t* text, size_t len, Sink& sink) const
+{
+	const uint32_t* trans = transitions;
+	const uint32_t threshold = firstMatchState;
+	size_t end = len;
+	uint32_t s = 0;
+
+	for (size_t i = 0; i < end; ++i) {
+		s = trans[s + byteClasses[text[i]]];
+
+		if (UNLIKELY(s >= threshold)) {
+			uint32_t m = s;
+			do {
+				const uint32_t idx = (m - threshold) / classCount;
+				for (uint32_t k = outputIndex[idx]; k < outputIndex[idx + 1]; ++k) {
+					const uint32_t id = outputs[k];
+					if (!sink (id, i + 1 - patternLengths[id])) {
+						return;
+					}
+				}
+				m = dictionaryLinks[idx];
+			} while (m);
+
+			// Matches ending after limit + maxLength start after limit.
+			if (sink.limit < len && sink.limit + maxLength < end) {
+				end = sink.limit + maxLength;
+			}
+		}
+	}
+}
+
+#if defined(FIANET_SIMD_SSSE3)
+/**
+ * Teddy filter: looks for the first block of 16 positions, from i, where the
+ * m first bytes match the nibble masks of some bucket.
+ * @return the positions of the block with candidates, 0 when there are no
+ * more full blocks. buckets receives the candidate buckets of each position.
+ */
+FIANET_TARGET("ssse3")
+static unsigned teddyFilter (const uint8_t masks[3][2][16], size_t m, const uint8_t* text, size_t len, size_t& i, uint8_t* buckets)
+{
+	const __m128i nibble = _mm_set1_epi8 (0x0F);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i lo[3], hi[3];
+
+	for (size_t j = 0; j < m; ++j) {
+		lo[j] = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(masks[j][0]));
+		hi[j] = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(masks[j][1]));
+	}
+
+	for (; i + 16 + m - 1 <= len; i += 16) {
+		__m128i res = _mm_set1_epi8 (-1);
+
+		for (size_t j = 0; j < m; ++j) {
+			const __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(text + i + j));
+			const __m128i l = _mm_shuffle_epi8 (lo[j], _mm_and_si128 (v, nibble));
+			const __m128i h = _mm_shuffle_epi8 (hi[j], _mm_and_si128 (_mm_srli_epi16 (v, 4), nibble));
+			res = _mm_and_si128 (res, _mm_and_si128 (l, h));
+		}
+
+		const unsigned mask = _mm_movemask_epi8 (_mm_cmpeq_epi8 (res, zero)) ^ 0xFFFF;
+		if (mask) {
+			_mm_storeu_si128 (reinterpret_cast<__m128i*>(buckets), res);
+			return mask;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+template <class Sink>
+void MultiMatcher::scanTeddy (const uint8_t* text, size_t len, Sink& sink) const
+{
+	const size_t m = teddyLength;
+	size_t i = 0;
+
+	// Verifies the patterns of the candidate buckets at a position, and
+	// returns when the scan is over.
+#define TEDDY_VERIFY(buckets, pos) \
+	do { \
+		if ((pos) > sink.limit) { \
+			return; \
+		} \
+		for (unsigned bits = (buckets); bits; bits &= bits - 1) { \
+			const unsigned b = __builtin_ctz (bits); \
+			for (uint32_t k = bucketIndex[b]; k < bucketIndex[b + 1]; ++k) { \
+				const uint32_t id = bucketPatterns[k]; \
+				if ((pos) + patternLengths[id] <= len && verify (id, text + (pos)) && !sink (id, (pos))) { \
+					return; \
+				} \
+			} \
+		} \
+	} while (0)
+
+#if defined(FIANET_SIMD_SSSE3)
+	if (getSimdLevel() >= SIMD_SSSE3) {
+		uint8_t buckets[16];
+		unsigned mask;
+
+		while ((mask = teddyFilter (teddyMasks, m, text, len, i, buckets)) != 0) {
+			for (; mask; mask &= mask - 1) {
+				const size_t p = __builtin_ctz (mask);
+				TEDDY_VERIFY (buckets[p], i + p);
+			}
+			i += 16;
+		}
+	}
+#endif
+
+	for (; i + minLength <= len; ++i) {
+		unsigned buckets = 0xFF;
+		for (size_t j = 0; j < m; ++j) {
+			buckets &= teddyMasks[j][0][text[i + j] & 0x0F] & teddyMasks[j][1][text[i + j] >> 4];
+		}
+		if (buckets) {
+			TEDDY_VERIFY (buckets, i);
+		}
+	}
+
+#undef TEDDY_VERIFY
+}
+
+template <class Sink>
+void MultiMatcher::scan (const String& text, Sink& sink) const
+{
+	if (!compiled) {
+		THROW ("MultiMatcher: the matcher is not compiled");
+	}
+
+	if (engine == TEDDY) {
+		scanTeddy (text.bytes(), text.length(), sink);
+	} else {
+		scanAhoCorasick (text.bytes(), text.length(), sink);
+	}
+}
+
+bool MultiMatcher::contains (const String& text) const
+{
+	AnySink sink;
+	scan (text, sink);
+	return sink.found;
+}
+
+bool MultiMatcher::findFirst (const String& text, Match& match) const
+{
+	LeftmostSink sink (match);
+	scan (text, sink);
+	return sink.found();
+}
+
+size_t MultiMatcher::findAll (const String& text, Handler& handler) const
+{
+	HandlerSink sink (handler);
+	scan (text, sink);
+	return sink.count;
+}
+
+} // namespace Fianet
@@ -0,0 +1,242 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_MULTIMATCHER_H
+#define FIANET_MULTIMATCHER_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * @class MultiMatcher
+ * Looks for a set of patterns in a String, in a single pass over the text.
+ *
+ * Typical use is checking free text fields against a blacklist: instead of
+ * calling String::icontains() once per pattern, the patterns are added to a
+ * MultiMatcher, compiled once, and every text is scanned once whatever the
+ * number of patterns.
+ *
+ * @code
+ * MultiMatcher blacklist (MultiMatcher::IGNORE_CASE);
+ * blacklist.add ("mickey mouse");
+ * blacklist.add ("test@test.com");
+ * blacklist.compile();
+ *
+ * if (blacklist.contains (field)) { ... }
+ * @endcode
+ *
+ * Two engines are available:
+ * - Teddy: a SIMD prefilter (SSSE3) finding candidate positions from the
+ *   first bytes of the patterns, 16 positions at a time. Candidates are then
+ *   verified against the few patterns sharing their bucket. Used for small
+ *   sets (up to TEDDY_MAX_PATTERNS patterns of 2 bytes or more), when the
+ *   SIMD level is at least SIMD_SSSE3 (see getSimdLevel()).
+ * - Aho-Corasick: a deterministic automaton reading one byte per step.
+ *   Bytes are mapped to equivalence classes so that the transition table
+ *   only has one column per distinct pattern byte, and states with outputs
+ *   are numbered last so that detecting a match costs a single comparison.
+ *
+ * Case insensitivity only applies to ASCII letters.
+ *
+ * Patterns cannot be added once the matcher is compiled. A compiled
+ * matcher is read-only, and can be shared between threads.
+ */
+class MultiMatcher {
+public:
+	/// Matching modes.
+	enum Mode {
+		/// Bytes must be equal.
+		CASE_SENSITIVE,
+		/// ASCII letters match regardless of their case.
+		IGNORE_CASE
+	};
+
+	/// Search engines, see the class documentation.
+	enum Engine {
+		/// Teddy when the patterns allow it, Aho-Corasick otherwise.
+		AUTO,
+		TEDDY,
+		AHO_CORASICK
+	};
+
+	/// Maximum number of patterns Teddy is used for.
+	static const size_t TEDDY_MAX_PATTERNS = 32;
+
+	/// A pattern occurrence.
+	struct Match {
+		/// Pattern identifier, as returned by add().
+		uint32_t pattern;
+		/// Position of the first byte of the occurrence in the text.
+		size_t offset;
+	};
+
+	/**
+	 * @class Handler
+	 * Receives the matches found by findAll().
+	 */
+	class Handler {
+	public:
+		virtual ~Handler()
+		{ }
+
+		/**
+		 * Called for each match.
+		 * @param pattern the pattern identifier.
+		 * @param offset the position of the occurrence in the text.
+		 * @return true to go on, false to stop the search.
+		 */
+		virtual bool onMatch (uint32_t pattern, size_t offset) = 0;
+	};
+
+private:
+	Mode mode;
+	Engine engine;
+	bool compiled;
+
+	/// All patterns, concatenated. Lowercased in IGNORE_CASE mode.
+	XString patterns;
+	/// Offset and length of each pattern in 'patterns'.
+	uint32_t* patternOffsets;
+	uint32_t* patternLengths;
+	size_t patternCount;
+	size_t patternCapacity;
+	size_t minLength;
+	size_t maxLength;
+
+	/// Aho-Corasick: byte to equivalence class.
+	uint8_t byteClasses[256];
+	size_t classCount;
+	/// Transitions, indexed by state + class. States are premultiplied by classCount.
+	uint32_t* transitions;
+	size_t stateCount;
+	/// First state with outputs, premultiplied. Every state above has outputs.
+	uint32_t firstMatchState;
+	/// Outputs of the match state i: outputs[outputIndex[i] ... outputIndex[i+1]-1].
+	uint32_t* outputIndex;
+	uint32_t* outputs;
+	/// Next match state along the failure links, 0 if none.
+	uint32_t* dictionaryLinks;
+
+	/// Teddy: nibble masks of the first teddyLength bytes, low nibble then high nibble.
+	uint8_t teddyMasks[3][2][16];
+	size_t teddyLength;
+	/// Patterns of bucket b: bucketPatterns[bucketIndex[b] ... bucketIndex[b+1]-1].
+	uint32_t bucketIndex[9];
+	uint32_t* bucketPatterns;
+
+	MultiMatcher (const MultiMatcher&);
+	MultiMatcher& operator = (const MultiMatcher&);
+
+	void release();
+	void compileAhoCorasick();
+	void compileTeddy();
+	bool verify (uint32_t pattern, const uint8_t* text) const;
+
+	template <class Sink> void scanAhoCorasick (const uint8_t* text, size_t len, Sink& sink) const;
+	template <class Sink> void scanTeddy (const uint8_t* text, size_t len, Sink& sink) const;
+	template <class Sink> void scan (const String& text, Sink& sink) const;
+
+public:
+	/**
+	 * Creates an empty matcher.
+	 * @param mode the matching mode.
+	 */
+	explicit MultiMatcher (Mode mode = CASE_SENSITIVE);
+
+	~MultiMatcher();
+
+	/**
+	 * Adds a pattern to look for.
+	 * @param pattern the pattern, which cannot be empty. Its content is copied.
+	 * @return the pattern identifier: 0 for the first pattern, then 1, ...
+	 * @throw Exception if the matcher is already compiled, or the pattern
+	 * is empty.
+	 */
+	uint32_t add (const String& pattern);
+
+	/**
+	 * Builds the search structures. Must be called once all patterns
+	 * are added, and before any search.
+	 * @param engine the engine to use, AUTO by default.
+	 * @throw Exception if the matcher is already compiled.
+	 */
+	void compile (Engine engine = AUTO);
+
+	/// @return true if compile() was called.
+	bool isCompiled() const {
+		return compiled;
+	}
+
+	/// @return the engine chosen by compile(), TEDDY or AHO_CORASICK.
+	Engine usedEngine() const {
+		return engine;
+	}
+
+	/// @return the matching mode.
+	Mode matchMode() const {
+		return mode;
+	}
+
+	/// @return the number of patterns.
+	size_t size() const {
+		return patternCount;
+	}
+
+	/**
+	 * @return the pattern of identifier id, lowercased in IGNORE_CASE mode,
+	 * String::blank() for unknown identifiers. The String is valid until the
+	 * next call to add().
+	 */
+	String pattern (uint32_t id) const;
+
+	/**
+	 * @return true if the text contains at least one of the patterns.
+	 * @throw Exception if the matcher is not compiled.
+	 */
+	bool contains (const String& text) const;
+
+	/**
+	 * Finds the leftmost occurrence of any pattern. When several patterns
+	 * occur at the leftmost position, the one with the smallest identifier
+	 * is returned.
+	 *
+	 * @param text the text to scan.
+	 * @param match receives the occurrence, if any.
+	 * @return true if a pattern was found.
+	 * @throw Exception if the matcher is not compiled.
+	 */
+	bool findFirst (const String& text, Match& match) const;
+
+	/**
+	 * Reports every occurrence of every pattern, overlapping ones included.
+	 * The order of the reports depends on the engine.
+	 *
+	 * @param text the text to scan.
+	 * @param handler receives the matches.
+	 * @return the number of matches reported.
+	 * @throw Exception if the matcher is not compiled.
+	 */
+	size_t findAll (const String& text, Handler& handler) const;
+};
+
+} // namespace Fianet
+
+#endif // FIANET_MULTIMATCHER_H
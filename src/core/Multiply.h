@@ -0,0 +1,59 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_MULTIPLY_H
+#define FIANET_MULTIPLY_H
+
+#include "fianet-core.h"
+
+/*
+ * Internal 64x64->128 bit multiplication, shared by the hash functions and
+ * the number conversions.
+ */
+
+namespace Fianet {
+
+/**
+ * Multiplies two 64-bit numbers into 128 bits, with a single multiply
+ * instruction where the compiler supports unsigned __int128.
+ *
+ * @param high receives the 64 high bits of a * b.
+ * @param low receives the 64 low bits of a * b.
+ */
+inline void multiply128 (uint64_t a, uint64_t b, uint64_t& high, uint64_t& low)
+{
+#ifdef __SIZEOF_INT128__
+	const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+	low = static_cast<uint64_t>(r);
+	high = static_cast<uint64_t>(r >> 64);
+#else
+	const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+	const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	const uint64_t t = rl + (rm0 << 32);
+	uint64_t carry = (t < rl);
+	low = t + (rm1 << 32);
+	carry += (low < t);
+	high = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+} // namespace Fianet
+
+#endif // FIANET_MULTIPLY_H
@@ -0,0 +1,94 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_NUMBERFORMATTING_H
+#define FIANET_NUMBERFORMATTING_H
+
+#include "fianet-core.h"
+
+/*
+ * Internal floating point formatters used by the XString::append*()
+ * methods. They write the same bytes as the printf() formats they mimic in
+ * the "C" locale, whatever the current locale, and do not throw.
+ */
+
+namespace Fianet {
+
+/// Upper bound of the bytes written by the format*() functions.
+const size_t MAX_DOUBLE_LENGTH = 32;
+
+/**
+ * Computes the shortest decimal number that reads back as v, the nearest
+ * to v when there are several, with Ryu (Adams, "Ryu: Fast Float-to-String
+ * Conversion", 2018): v is read as m * 2^e, the bounds of its rounding
+ * interval are multiplied by a 125-bit approximation of 5^-e or 2^e / 5^q,
+ * then digits are removed for as long as the bounds keep distinct.
+ *
+ * @param v a finite, strictly positive number.
+ * @param digits receives the digits, with no trailing zeros.
+ * @param exponent receives the power of ten: v reads as digits * 10^exponent.
+ */
+void shortestDecimal (double v, uint64_t& digits, int& exponent);
+
+/**
+ * Writes the shortest decimal number that reads back as v, laid out as
+ * "%.17g" does: exponent notation below 1e-4 or from 1e17 on.
+ * "inf", "-inf", "nan" and "-nan" are written for the special values.
+ *
+ * @param out receives up to MAX_DOUBLE_LENGTH bytes.
+ * @return the number of bytes written.
+ */
+size_t formatShortest (double v, uint8_t* out);
+
+/**
+ * Writes v as "%.*g" does. The precision digits are the shortest digits
+ * of v rounded, which is exact for normal numbers up to 15 digits, unless
+ * the dropped digits are exactly a half.
+ *
+ * @param precision the number of significant digits, 0 meaning 1.
+ * @param out receives up to MAX_DOUBLE_LENGTH bytes.
+ * @return the number of bytes written, 0 when precision is over 15, v is
+ * subnormal, or the digits cannot be rounded with certainty (see
+ * printDouble()).
+ */
+size_t formatGeneral (double v, unsigned precision, uint8_t* out);
+
+/**
+ * Writes v as "%.*f" does, rounding v * 10^decimals exactly to an integer.
+ *
+ * @param decimals the number of digits after the '.'.
+ * @param out receives up to MAX_DOUBLE_LENGTH bytes.
+ * @return the number of bytes written, 0 when decimals is over 19 or the
+ * rounded value needs more than 64 bits (see printDouble()).
+ */
+size_t formatFixed (double v, unsigned decimals, uint8_t* out);
+
+/**
+ * snprintf() of a floating point format with a precision, such as "%.*g",
+ * in the "C" locale.
+ *
+ * @param out receives up to size bytes, the terminal '\0' included.
+ * @return the length of the whole result, as snprintf().
+ */
+size_t printDouble (char* out, size_t size, const char* format, unsigned precision, double v);
+
+} // namespace Fianet
+
+#endif // FIANET_NUMBERFORMATTING_H
@@ -0,0 +1,91 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_NUMBERPARSING_H
+#define FIANET_NUMBERPARSING_H
+
+#include "fianet-core.h"
+#include <locale.h>
+
+/*
+ * Internal number parsers used by the StringView::tryTo*() conversions.
+ * They work on a byte buffer that must be entirely consumed, and return
+ * PARSE_EMPTY when it is empty. They do not throw, and do not allocate but
+ * for the hexadecimal and NaN forms longer than 255 bytes (parseDouble()).
+ */
+
+namespace Fianet {
+
+/**
+ * Parses an integer the way strtoull() does in the "C" locale with a 0
+ * base: leading white spaces, an optional sign, then a decimal, octal
+ * (0 prefix) or hexadecimal (0x prefix) number.
+ *
+ * Decimal digits are converted 8 at a time while the value cannot
+ * overflow.
+ *
+ * @param value receives the absolute value.
+ * @param negative receives true if the number has a '-' sign.
+ * @return PARSE_RANGE_ERROR as soon as the value exceeds 64 bits.
+ */
+ParseStatus parseInteger (const uint8_t* p, size_t len, uint64_t& value, bool& negative);
+
+/**
+ * Parses a floating point number with the same results as strtod() in the
+ * "C" locale, whatever the current locale.
+ *
+ * Decimal numbers are converted with the Clinger fast path when the
+ * mantissa and the power of ten are exact doubles, then with the
+ * Eisel-Lemire algorithm. The rare inputs that these cannot round with
+ * certainty, the results out of the normal range, and the hexadecimal,
+ * infinite and NaN forms are handed to strtod_l().
+ *
+ * @param value receives the number.
+ * @return PARSE_RANGE_ERROR when strtod() would set ERANGE.
+ */
+ParseStatus parseDouble (const uint8_t* p, size_t len, double& value);
+
+/**
+ * Parses a fixed-point decimal number: leading white spaces, an optional
+ * sign, then digits with at most one decimal separator, and at least one
+ * digit. Group separators, when not 0, may split the integer part in
+ * groups of 3 digits (the first one of 1 to 3 digits).
+ *
+ * Runs of 8 digits are converted at once while the value cannot overflow.
+ *
+ * @param scale the number of decimals of the result, at most
+ * Decimal::MAX_SCALE.
+ * @param mantissa receives the number times 10^scale.
+ * @return PARSE_RANGE_ERROR when the result does not fit an int64_t, or
+ * when non-zero digits follow the scale first decimals: the number cannot
+ * be represented exactly.
+ */
+ParseStatus parseDecimal (const uint8_t* p, size_t len, unsigned scale, uint8_t decimalSeparator,
+	uint8_t groupSeparator, int64_t& mantissa);
+
+/**
+ * @return the "C" locale, for the *_l() and uselocale() functions.
+ * @throw Exception if it cannot be created.
+ */
+locale_t cLocale();
+
+} // namespace Fianet
+
+#endif // FIANET_NUMBERPARSING_H
@@ -0,0 +1,883 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_RADIXTREE_H
+#define FIANET_RADIXTREE_H
+
+#include "fianet-core.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+namespace Fianet {
+
+/**
+ * @class RadixTree
+ * An ordered map from Strings to values of type T, for prefix lookups.
+ *
+ * Typical uses are card BIN ranges, phone number prefixes and IP prefixes:
+ * longestPrefix() finds the longest key that starts a text, and
+ * withPrefix() walks through the keys that start with a given prefix, so
+ * that neither needs to scan the keys with startsWith().
+ *
+ * @code
+ * RadixTree<Issuer> bins;
+ * bins.insert ("4970", cb);
+ * bins.insert ("497010", bank);
+ *
+ * const Issuer* issuer = bins.longestPrefix (cardNumber);
+ *
+ * for (RadixTree<Issuer>::Iterator it = bins.withPrefix ("497"); it.valid(); ++it) {
+ *     ... it.key() ... it.value() ...
+ * }
+ * @endcode
+ *
+ * The tree is an adaptive radix tree (Leis et al., 2013): each inner node
+ * branches on one byte of the keys, and has room for 4, 16, 48 or 256
+ * children depending on how many it has. Runs of bytes shared by all the
+ * keys below a node are stored once in the node (path compression), and a
+ * subtree holding a single key is replaced by the key itself (lazy
+ * expansion). Nodes of 16 children are searched with SSE2 when available.
+ * A lookup thus visits at most one node per byte of the key, whatever the
+ * number of keys, and usually much fewer.
+ *
+ * Keys are ordered as String::compareTo() orders them: by bytes, then by
+ * length. They are copied in the tree, next to their value. Keys cannot be
+ * removed but by clear(), as reference data is loaded once and then only
+ * looked up.
+ */
+template <class T>
+class RadixTree {
+	struct Leaf;
+	struct Node;
+
+	template <class Value> class BasicIterator;
+
+public:
+	/// Iterator on a tree.
+	typedef BasicIterator<T> Iterator;
+	/// Iterator on a const tree.
+	typedef BasicIterator<const T> ConstIterator;
+
+private:
+	enum NodeType {
+		NODE4,
+		NODE16,
+		NODE48,
+		NODE256
+	};
+
+	/// A key and its value, followed by the bytes of the key.
+	struct Leaf {
+		size_t length;
+		T value;
+
+		const uint8_t* key() const {
+			return reinterpret_cast<const uint8_t*>(this + 1);
+		}
+	};
+
+	/**
+	 * Header of the inner nodes. Children are nodes or tagged leaf
+	 * pointers. The compressed path points into the key of a leaf of the
+	 * subtree, as leaves are never removed before their nodes.
+	 */
+	struct Node {
+		uint8_t type;
+		uint16_t count;
+		uint32_t prefixLength;
+		const uint8_t* prefix;
+		/// Key ending at this node, if any.
+		Leaf* leaf;
+	};
+
+	struct Node4 : Node {
+		uint8_t keys[4];
+		void* children[4];
+	};
+
+	struct Node16 : Node {
+		uint8_t keys[16];
+		void* children[16];
+	};
+
+	struct Node48 : Node {
+		/// Position of the child of each byte, plus 1, or 0.
+		uint8_t index[256];
+		void* children[48];
+	};
+
+	struct Node256 : Node {
+		void* children[256];
+	};
+
+	void* root;
+	size_t count;
+	size_t memory;
+
+	RadixTree (const RadixTree&);
+	RadixTree& operator = (const RadixTree&);
+
+	static bool isLeaf (const void* p) {
+		return (reinterpret_cast<uintptr_t>(p) & 1) != 0;
+	}
+
+	static Leaf* asLeaf (const void* p) {
+		return reinterpret_cast<Leaf*>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(1));
+	}
+
+	static void* tag (Leaf* l) {
+		return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(l) | 1);
+	}
+
+	static Node* asNode (const void* p) {
+		return static_cast<Node*>(const_cast<void*>(p));
+	}
+
+	static size_t nodeSize (uint8_t type) {
+		switch (type) {
+		case NODE4:
+			return sizeof(Node4);
+		case NODE16:
+			return sizeof(Node16);
+		case NODE48:
+			return sizeof(Node48);
+		default:
+			return sizeof(Node256);
+		}
+	}
+
+	void* allocate (size_t size) {
+		void* addr = std::malloc (size);
+		if (!addr) {
+			THROW ("RadixTree: malloc() returned NULL");
+		}
+		memory += size;
+		return addr;
+	}
+
+	Node* newNode (uint8_t type, const uint8_t* prefix, size_t prefixLength) {
+		if (prefixLength > UINT32_MAX) {
+			THROW ("RadixTree: key too long");
+		}
+		const size_t size = nodeSize (type);
+		Node* n = static_cast<Node*>(allocate (size));
+		std::memset (n, 0, size);
+		n->type = type;
+		n->prefix = prefix;
+		n->prefixLength = static_cast<uint32_t>(prefixLength);
+		return n;
+	}
+
+	void freeNode (Node* n) {
+		memory -= nodeSize (n->type);
+		std::free (n);
+	}
+
+	Leaf* newLeaf (const String& key, const T* value) {
+		Leaf* l = static_cast<Leaf*>(allocate (sizeof(Leaf) + key.length()));
+		try {
+			if (value) {
+				new (&l->value) T (*value);
+			} else {
+				new (&l->value) T();
+			}
+		} catch (...) {
+			memory -= sizeof(Leaf) + key.length();
+			std::free (l);
+			throw;
+		}
+		l->length = key.length();
+		if (key.length()) {
+			std::memcpy (l + 1, key.cstr(), key.length());
+		}
+		return l;
+	}
+
+	void freeLeaf (Leaf* l) {
+		memory -= sizeof(Leaf) + l->length;
+		l->value.~T();
+		std::free (l);
+	}
+
+	/// Frees a subtree.
+	void destroy (void* p) {
+		if (!p) {
+			return;
+		} else if (isLeaf (p)) {
+			freeLeaf (asLeaf (p));
+			return;
+		}
+		Node* n = asNode (p);
+		if (n->leaf) {
+			freeLeaf (n->leaf);
+		}
+		for (int b = nextChild (n, 0); b >= 0; b = nextChild (n, b + 1)) {
+			destroy (*findChild (n, static_cast<uint8_t>(b)));
+		}
+		freeNode (n);
+	}
+
+	/// @return the child of a node for a byte, NULL if none.
+	static void** findChild (Node* n, uint8_t b) {
+		switch (n->type) {
+		case NODE4: {
+			Node4* n4 = static_cast<Node4*>(n);
+			for (unsigned i = 0; i < n->count; ++i) {
+				if (n4->keys[i] == b) {
+					return &n4->children[i];
+				}
+			}
+			return 0;
+		}
+		case NODE16: {
+			Node16* n16 = static_cast<Node16*>(n);
+#if defined(__SSE2__)
+			const __m128i keys = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(n16->keys));
+			const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8 (_mm_cmpeq_epi8 (keys, _mm_set1_epi8 (static_cast<char>(b)))))
+				& ((1u << n->count) - 1);
+			return mask ? &n16->children[__builtin_ctz (mask)] : 0;
+#else
+			for (unsigned i = 0; i < n->count; ++i) {
+				if (n16->keys[i] == b) {
+					return &n16->children[i];
+				}
+			}
+			return 0;
+#endif
+		}
+		case NODE48: {
+			Node48* n48 = static_cast<Node48*>(n);
+			return n48->index[b] ? &n48->children[n48->index[b] - 1] : 0;
+		}
+		default: {
+			Node256* n256 = static_cast<Node256*>(n);
+			return n256->children[b] ? &n256->children[b] : 0;
+		}
+		}
+	}
+
+	/// @return the smallest byte greater than or equal to 'from' that has a child, -1 if none.
+	static int nextChild (const Node* n, int from) {
+		switch (n->type) {
+		case NODE4:
+		case NODE16: {
+			const uint8_t* keys = (n->type == NODE4) ? static_cast<const Node4*>(n)->keys : static_cast<const Node16*>(n)->keys;
+			for (unsigned i = 0; i < n->count; ++i) {
+				if (keys[i] >= from) {
+					return keys[i];
+				}
+			}
+			return -1;
+		}
+		case NODE48: {
+			const Node48* n48 = static_cast<const Node48*>(n);
+			for (int b = from; b < 256; ++b) {
+				if (n48->index[b]) {
+					return b;
+				}
+			}
+			return -1;
+		}
+		default: {
+			const Node256* n256 = static_cast<const Node256*>(n);
+			for (int b = from; b < 256; ++b) {
+				if (n256->children[b]) {
+					return b;
+				}
+			}
+			return -1;
+		}
+		}
+	}
+
+	/// Inserts a child in a sorted key array of a node with room for it.
+	static void insertSorted (uint8_t* keys, void** children, unsigned count, uint8_t b, void* child) {
+		unsigned i = count;
+		while (i > 0 && keys[i - 1] > b) {
+			keys[i] = keys[i - 1];
+			children[i] = children[i - 1];
+			--i;
+		}
+		keys[i] = b;
+		children[i] = child;
+	}
+
+	/**
+	 * Adds a child to a node, replacing it with a larger node if it is full.
+	 * @param ref the reference to the node, updated if it is replaced.
+	 */
+	void addChild (void** ref, Node* n, uint8_t b, void* child) {
+		switch (n->type) {
+		case NODE4: {
+			Node4* n4 = static_cast<Node4*>(n);
+			if (n->count < 4) {
+				insertSorted (n4->keys, n4->children, n->count++, b, child);
+				return;
+			}
+			Node16* n16 = static_cast<Node16*>(newNode (NODE16, n->prefix, n->prefixLength));
+			n16->leaf = n->leaf;
+			n16->count = 4;
+			std::memcpy (n16->keys, n4->keys, sizeof(n4->keys));
+			std::memcpy (n16->children, n4->children, sizeof(n4->children));
+			freeNode (n);
+			*ref = n16;
+			addChild (ref, n16, b, child);
+			return;
+		}
+		case NODE16: {
+			Node16* n16 = static_cast<Node16*>(n);
+			if (n->count < 16) {
+				insertSorted (n16->keys, n16->children, n->count++, b, child);
+				return;
+			}
+			Node48* n48 = static_cast<Node48*>(newNode (NODE48, n->prefix, n->prefixLength));
+			n48->leaf = n->leaf;
+			n48->count = 16;
+			for (unsigned i = 0; i < 16; ++i) {
+				n48->index[n16->keys[i]] = static_cast<uint8_t>(i + 1);
+				n48->children[i] = n16->children[i];
+			}
+			freeNode (n);
+			*ref = n48;
+			addChild (ref, n48, b, child);
+			return;
+		}
+		case NODE48: {
+			Node48* n48 = static_cast<Node48*>(n);
+			if (n->count < 48) {
+				// Keys are never removed: children are packed.
+				n48->children[n->count] = child;
+				n48->index[b] = static_cast<uint8_t>(++n->count);
+				return;
+			}
+			Node256* n256 = static_cast<Node256*>(newNode (NODE256, n->prefix, n->prefixLength));
+			n256->leaf = n->leaf;
+			n256->count = 48;
+			for (unsigned c = 0; c < 256; ++c) {
+				if (n48->index[c]) {
+					n256->children[c] = n48->children[n48->index[c] - 1];
+				}
+			}
+			freeNode (n);
+			*ref = n256;
+			addChild (ref, n256, b, child);
+			return;
+		}
+		default:
+			static_cast<Node256*>(n)->children[b] = child;
+			++n->count;
+		}
+	}
+
+	/// Attaches a leaf to a new node at a depth, as its own key or as a child.
+	static void place (Node* n, Leaf* l, size_t depth) {
+		if (l->length == depth) {
+			n->leaf = l;
+		} else {
+			Node4* n4 = static_cast<Node4*>(n);
+			insertSorted (n4->keys, n4->children, n->count++, l->key()[depth], tag (l));
+		}
+	}
+
+	/// @return the leaf of a key, NULL if the key is not in the tree.
+	Leaf* lookup (const String& key) const {
+		const uint8_t* k = reinterpret_cast<const uint8_t*>(key.cstr());
+		const size_t len = key.length();
+		const void* p = root;
+		size_t depth = 0;
+
+		while (p) {
+			if (isLeaf (p)) {
+				Leaf* l = asLeaf (p);
+				if (l->length == len && (len == depth || std::memcmp (l->key() + depth, k + depth, len - depth) == 0)) {
+					return l;
+				}
+				return 0;
+			}
+			Node* n = asNode (p);
+			if (n->prefixLength) {
+				if (len - depth < n->prefixLength || std::memcmp (n->prefix, k + depth, n->prefixLength) != 0) {
+					return 0;
+				}
+				depth += n->prefixLength;
+			}
+			if (depth == len) {
+				return n->leaf;
+			}
+			void** child = findChild (n, k[depth++]);
+			p = child ? *child : 0;
+		}
+		return 0;
+	}
+
+	/// Links a leaf whose key is not in the tree yet.
+	void link (Leaf* l) {
+		const uint8_t* k = l->key();
+		const size_t len = l->length;
+		void** ref = &root;
+		size_t depth = 0;
+
+		for (;;) {
+			void* p = *ref;
+			if (!p) {
+				*ref = tag (l);
+				return;
+			}
+
+			if (isLeaf (p)) {
+				// Expand the leaf into a node for both keys.
+				Leaf* other = asLeaf (p);
+				const size_t max = (other->length < len) ? other->length : len;
+				size_t i = depth;
+				while (i < max && other->key()[i] == k[i]) {
+					++i;
+				}
+				Node* n = newNode (NODE4, other->key() + depth, i - depth);
+				place (n, other, i);
+				place (n, l, i);
+				*ref = n;
+				return;
+			}
+
+			Node* n = asNode (p);
+			size_t i = 0;
+			while (i < n->prefixLength && depth + i < len && n->prefix[i] == k[depth + i]) {
+				++i;
+			}
+			if (i < n->prefixLength) {
+				// Split the compressed path where the key leaves it.
+				Node* parent = newNode (NODE4, n->prefix, i);
+				const uint8_t b = n->prefix[i];
+				n->prefix += i + 1;
+				n->prefixLength -= static_cast<uint32_t>(i + 1);
+				insertSorted (static_cast<Node4*>(parent)->keys, static_cast<Node4*>(parent)->children, parent->count++, b, n);
+				place (parent, l, depth + i);
+				*ref = parent;
+				return;
+			}
+
+			depth += n->prefixLength;
+			if (depth == len) {
+				n->leaf = l;
+				return;
+			}
+			void** child = findChild (n, k[depth]);
+			if (!child) {
+				addChild (ref, n, k[depth], tag (l));
+				return;
+			}
+			ref = child;
+			++depth;
+		}
+	}
+
+	Leaf* findOrInsert (const String& key, const T* value, bool& inserted) {
+		Leaf* l = lookup (key);
+		if (l) {
+			inserted = false;
+			return l;
+		}
+		l = newLeaf (key, value);
+		try {
+			link (l);
+		} catch (...) {
+			freeLeaf (l);
+			throw;
+		}
+		++count;
+		inserted = true;
+		return l;
+	}
+
+	/**
+	 * Iterates over keys in order, from a lower bound, while they start
+	 * with a prefix and are lower than an upper bound.
+	 */
+	template <class Value>
+	class BasicIterator {
+		friend class RadixTree;
+
+		struct Frame {
+			const Node* node;
+			/// Next position to visit: -1 for the key of the node, else a child byte.
+			int next;
+		};
+
+		Frame* stack;
+		size_t depth;
+		size_t capacity;
+		const Leaf* current;
+		String prefix;
+		String upper;
+		bool bounded;
+
+		void push (const Node* n, int next) {
+			if (depth == capacity) {
+				const size_t newCapacity = capacity ? 2 * capacity : 16;
+				Frame* s = static_cast<Frame*>(std::realloc (stack, newCapacity * sizeof(Frame)));
+				if (!s) {
+					THROW ("RadixTree: realloc() returned NULL");
+				}
+				stack = s;
+				capacity = newCapacity;
+			}
+			stack[depth].node = n;
+			stack[depth].next = next;
+			++depth;
+		}
+
+		/// Moves to the next leaf in key order, from the stack.
+		void advance() {
+			current = 0;
+			while (depth) {
+				Frame& f = stack[depth - 1];
+				if (f.next < 0) {
+					f.next = 0;
+					if (f.node->leaf) {
+						current = f.node->leaf;
+						break;
+					}
+				}
+				const int b = (f.next < 256) ? nextChild (f.node, f.next) : -1;
+				if (b < 0) {
+					--depth;
+					continue;
+				}
+				f.next = b + 1;
+				const void* child = *findChild (const_cast<Node*>(f.node), static_cast<uint8_t>(b));
+				if (isLeaf (child)) {
+					current = asLeaf (child);
+					break;
+				}
+				push (asNode (child), -1);
+			}
+			checkBounds();
+		}
+
+		/// @return <0, 0 or >0 as a leaf key is lower than, equal to or greater than s.
+		static int compare (const Leaf* l, const String& s) {
+			const size_t len = (l->length < s.length()) ? l->length : s.length();
+			const int res = len ? std::memcmp (l->key(), s.cstr(), len) : 0;
+			if (res != 0 || l->length == s.length()) {
+				return res;
+			}
+			return (l->length < s.length()) ? -1 : 1;
+		}
+
+		void checkBounds() {
+			if (!current) {
+				return;
+			}
+			const bool inPrefix = (current->length >= prefix.length()
+				&& (prefix.length() == 0 || std::memcmp (current->key(), prefix.cstr(), prefix.length()) == 0));
+			if (!inPrefix || (bounded && compare (current, upper) >= 0)) {
+				current = 0;
+				depth = 0;
+			}
+		}
+
+		/// Positions on the first key greater than or equal to a bound.
+		void seek (const void* root, const String& lower) {
+			const uint8_t* k = reinterpret_cast<const uint8_t*>(lower.cstr());
+			const size_t len = lower.length();
+			const void* p = root;
+			size_t d = 0;
+
+			depth = 0;
+			current = 0;
+			for (;;) {
+				if (!p) {
+					advance();
+					return;
+				}
+				if (isLeaf (p)) {
+					const Leaf* l = asLeaf (p);
+					if (compare (l, lower) >= 0) {
+						current = l;
+						checkBounds();
+					} else {
+						advance();
+					}
+					return;
+				}
+
+				const Node* n = asNode (p);
+				size_t i = 0;
+				while (i < n->prefixLength && d + i < len && n->prefix[i] == k[d + i]) {
+					++i;
+				}
+				if (i < n->prefixLength) {
+					// The subtree is either entirely greater than the bound, or lower.
+					if (d + i == len || n->prefix[i] > k[d + i]) {
+						push (n, -1);
+					}
+					advance();
+					return;
+				}
+				d += n->prefixLength;
+				if (d == len) {
+					push (n, -1);
+					advance();
+					return;
+				}
+				const uint8_t b = k[d++];
+				push (n, b + 1);
+				void** child = findChild (const_cast<Node*>(n), b);
+				p = child ? *child : 0;
+			}
+		}
+
+		BasicIterator (const void* root, const String& lower, const String& pre, const String* up)
+			: stack(0), depth(0), capacity(0), current(0), prefix(pre), upper(up ? *up : String()), bounded(up != 0)
+		{
+			seek (root, lower);
+		}
+
+	public:
+		BasicIterator (const BasicIterator& it)
+			: stack(0), depth(0), capacity(0), current(it.current), prefix(it.prefix), upper(it.upper), bounded(it.bounded)
+		{
+			for (size_t i = 0; i < it.depth; ++i) {
+				push (it.stack[i].node, it.stack[i].next);
+			}
+		}
+
+		BasicIterator& operator = (const BasicIterator& it) {
+			if (this != &it) {
+				depth = 0;
+				for (size_t i = 0; i < it.depth; ++i) {
+					push (it.stack[i].node, it.stack[i].next);
+				}
+				current = it.current;
+				prefix = it.prefix;
+				upper = it.upper;
+				bounded = it.bounded;
+			}
+			return *this;
+		}
+
+		~BasicIterator() {
+			std::free (stack);
+		}
+
+		/// @return true if the iterator is on a key.
+		bool valid() const {
+			return (current != 0);
+		}
+
+		/// @return the current key, a view on the copy held by the tree.
+		String key() const {
+			return String (reinterpret_cast<const char*>(current->key()), current->length);
+		}
+
+		/// @return the value of the current key.
+		Value& value() const {
+			return const_cast<Leaf*>(current)->value;
+		}
+
+		/// Moves to the next key.
+		BasicIterator& operator ++() {
+			if (current) {
+				advance();
+			}
+			return *this;
+		}
+	};
+
+public:
+	/// Creates an empty tree.
+	RadixTree()
+		: root(0), count(0), memory(0)
+	{ }
+
+	~RadixTree() {
+		destroy (root);
+	}
+
+	/// @return the number of keys.
+	size_t size() const {
+		return count;
+	}
+
+	/// @return true if the tree holds no key.
+	bool empty() const {
+		return (count == 0);
+	}
+
+	/// @return the number of bytes allocated for the nodes, keys and values.
+	size_t memoryUsage() const {
+		return memory;
+	}
+
+	/// Removes all keys.
+	void clear() {
+		destroy (root);
+		root = 0;
+		count = 0;
+	}
+
+	/**
+	 * Inserts a key, if it is not in the tree yet.
+	 * @param key the key. Its content is copied.
+	 * @param value its value.
+	 * @return true if the key was inserted, false if it was already in the
+	 * tree: its value is then left unchanged.
+	 */
+	bool insert (const String& key, const T& value) {
+		bool inserted;
+		findOrInsert (key, &value, inserted);
+		return inserted;
+	}
+
+	/**
+	 * Accesses the value of a key, inserting the key with a
+	 * default-constructed value if it is not in the tree.
+	 */
+	T& operator [] (const String& key) {
+		bool inserted;
+		return findOrInsert (key, 0, inserted)->value;
+	}
+
+	/// @return the value of a key, NULL if it is not in the tree.
+	T* find (const String& key) {
+		Leaf* l = lookup (key);
+		return l ? &l->value : 0;
+	}
+
+	/// @see find()
+	const T* find (const String& key) const {
+		const Leaf* l = lookup (key);
+		return l ? &l->value : 0;
+	}
+
+	/// @return true if a key is in the tree.
+	bool contains (const String& key) const {
+		return (lookup (key) != 0);
+	}
+
+	/**
+	 * Finds the longest key that is a prefix of a text.
+	 * @param text the text, e.g. a card number.
+	 * @param length receives the length of the key found.
+	 * @return the value of the key, NULL if no key is a prefix of the text.
+	 */
+	const T* longestPrefix (const String& text, size_t& length) const {
+		const uint8_t* k = reinterpret_cast<const uint8_t*>(text.cstr());
+		const size_t len = text.length();
+		const Leaf* best = 0;
+		const void* p = root;
+		size_t depth = 0;
+
+		while (p) {
+			if (isLeaf (p)) {
+				const Leaf* l = asLeaf (p);
+				if (l->length <= len && (l->length == depth || std::memcmp (l->key() + depth, k + depth, l->length - depth) == 0)) {
+					best = l;
+				}
+				break;
+			}
+			const Node* n = asNode (p);
+			if (n->prefixLength) {
+				if (len - depth < n->prefixLength || std::memcmp (n->prefix, k + depth, n->prefixLength) != 0) {
+					break;
+				}
+				depth += n->prefixLength;
+			}
+			if (n->leaf) {
+				best = n->leaf;
+			}
+			if (depth == len) {
+				break;
+			}
+			void** child = findChild (const_cast<Node*>(n), k[depth++]);
+			p = child ? *child : 0;
+		}
+
+		if (!best) {
+			return 0;
+		}
+		length = best->length;
+		return &best->value;
+	}
+
+	/// @see longestPrefix()
+	const T* longestPrefix (const String& text) const {
+		size_t length;
+		return longestPrefix (text, length);
+	}
+
+	/// @see longestPrefix()
+	T* longestPrefix (const String& text, size_t& length) {
+		return const_cast<T*>(static_cast<const RadixTree*>(this)->longestPrefix (text, length));
+	}
+
+	/// @see longestPrefix()
+	T* longestPrefix (const String& text) {
+		size_t length;
+		return longestPrefix (text, length);
+	}
+
+	/// @return an iterator on all keys, in order.
+	Iterator all() {
+		return Iterator (root, String(), String(), 0);
+	}
+
+	/// @see all()
+	ConstIterator all() const {
+		return ConstIterator (root, String(), String(), 0);
+	}
+
+	/**
+	 * @return an iterator on the keys starting with a prefix, in order.
+	 * @note prefix must exist while the iterator is in use.
+	 */
+	Iterator withPrefix (const String& prefix) {
+		return Iterator (root, prefix, prefix, 0);
+	}
+
+	/// @see withPrefix()
+	ConstIterator withPrefix (const String& prefix) const {
+		return ConstIterator (root, prefix, prefix, 0);
+	}
+
+	/**
+	 * @return an iterator on the keys greater than or equal to 'from', and
+	 * lower than 'to', in order.
+	 * @note from and to must exist while the iterator is in use.
+	 */
+	Iterator range (const String& from, const String& to) {
+		return Iterator (root, from, String(), &to);
+	}
+
+	/// @see range()
+	ConstIterator range (const String& from, const String& to) const {
+		return ConstIterator (root, from, String(), &to);
+	}
+};
+
+} // namespace Fianet
+
+#endif // FIANET_RADIXTREE_H
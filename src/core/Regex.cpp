@@ -0,0 +1,1492 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Regex.h"
+#include "ByteSearch.h"
+
+namespace Fianet {
+
+namespace {
+
+/// Maximum nesting of groups.
+const int MAX_DEPTH = 100;
+/// Maximum count of a bounded repetition.
+const int32_t MAX_REPEAT = 1000;
+/// Maximum number of instructions of a compiled pattern.
+const size_t MAX_PROGRAM = 100000;
+
+template <class T>
+T* allocateArray (size_t nb)
+{
+	T* addr = static_cast<T*>(std::malloc (nb * sizeof(T)));
+	if (!addr && nb) {
+		THROW ("Regex: malloc() returned NULL");
+	}
+	return addr;
+}
+
+template <class T>
+void resizeArray (T*& addr, size_t nb)
+{
+	T* res = static_cast<T*>(std::realloc (addr, nb * sizeof(T)));
+	if (!res) {
+		THROW ("Regex: realloc() returned NULL");
+	}
+	addr = res;
+}
+
+/**
+ * A growable array of plain values.
+ */
+template <class T>
+class Buffer {
+	Buffer (const Buffer&);
+	Buffer& operator = (const Buffer&);
+
+public:
+	T* data;
+	size_t size;
+	size_t capacity;
+
+	Buffer()
+		: data(0), size(0), capacity(0)
+	{ }
+
+	~Buffer() {
+		std::free (data);
+	}
+
+	size_t push (const T& value) {
+		if (size == capacity) {
+			capacity = capacity ? 2 * capacity : 16;
+			resizeArray (data, capacity);
+		}
+		data[size] = value;
+		return size++;
+	}
+};
+
+/*
+ * Syntax tree.
+ */
+
+enum NodeType {
+	NODE_EMPTY,
+	NODE_SET,
+	NODE_CONCAT,
+	NODE_ALTERNATION,
+	NODE_REPEAT,
+	NODE_GROUP,
+	NODE_BOL,
+	NODE_EOL
+};
+
+struct Node {
+	NodeType type;
+	/// SET: set index. CONCAT, ALTERNATION: first operand. REPEAT, GROUP: operand.
+	int32_t a;
+	/// CONCAT, ALTERNATION: second operand. GROUP: group number.
+	int32_t b;
+	/// REPEAT bounds, max < 0 when unbounded.
+	int32_t min;
+	int32_t max;
+	bool greedy;
+};
+
+/**
+ * Recursive descent parser, building the syntax tree of a pattern.
+ */
+class Parser {
+	const String& pattern;
+	const uint8_t* p;
+	size_t len;
+	size_t pos;
+	bool ignoreCase;
+
+	Parser (const Parser&);
+	Parser& operator = (const Parser&);
+
+	void fail (const char* msg) const __attribute__((noreturn));
+	int32_t addNode (NodeType type, int32_t a = -1, int32_t b = -1);
+	int32_t addSet (CharSet set);
+	int32_t alternation (int depth);
+	int32_t concatenation (int depth);
+	int32_t repetition (int depth);
+	int32_t atom (int depth);
+	int escape (CharSet& set);
+	void characterClass (CharSet& set);
+	bool number (int32_t& n);
+
+public:
+	Buffer<Node> nodes;
+	Buffer<CharSet> sets;
+	/// Number of groups, group 0 included.
+	size_t groups;
+
+	Parser (const String& pat, bool ic)
+		: pattern(pat), p(pat.bytes()), len(pat.length()), pos(0), ignoreCase(ic), nodes(), sets(), groups(1)
+	{ }
+
+	/// @return the root of the syntax tree.
+	int32_t parse();
+};
+
+void Parser::fail (const char* msg) const
+{
+	THROWF ("Regex: %s at offset %u of \"%s\"", msg, static_cast<unsigned>(pos), XString (pattern).cstr());
+}
+
+int32_t Parser::addNode (NodeType type, int32_t a, int32_t b)
+{
+	Node n;
+	n.type = type;
+	n.a = a;
+	n.b = b;
+	n.min = n.max = 0;
+	n.greedy = true;
+	return static_cast<int32_t>(nodes.push (n));
+}
+
+int32_t Parser::addSet (CharSet set)
+{
+	if (ignoreCase) {
+		for (char c = 'a'; c <= 'z'; ++c) {
+			if (set.contains (c) || set.contains (c - 'a' + 'A')) {
+				set.add (c).add (c - 'a' + 'A');
+			}
+		}
+	}
+	return addNode (NODE_SET, static_cast<int32_t>(sets.push (set)));
+}
+
+int32_t Parser::parse()
+{
+	const int32_t root = alternation (0);
+	if (pos < len) {
+		fail ("unbalanced parenthesis");
+	}
+	return root;
+}
+
+int32_t Parser::alternation (int depth)
+{
+	if (depth > MAX_DEPTH) {
+		fail ("too many nested groups");
+	}
+	int32_t res = concatenation (depth);
+	while (pos < len && p[pos] == '|') {
+		++pos;
+		const int32_t right = concatenation (depth);
+		res = addNode (NODE_ALTERNATION, res, right);
+	}
+	return res;
+}
+
+int32_t Parser::concatenation (int depth)
+{
+	int32_t res = -1;
+	while (pos < len && p[pos] != '|' && p[pos] != ')') {
+		const int32_t right = repetition (depth);
+		res = (res < 0) ? right : addNode (NODE_CONCAT, res, right);
+	}
+	return (res < 0) ? addNode (NODE_EMPTY) : res;
+}
+
+bool Parser::number (int32_t& n)
+{
+	if (pos >= len || !isdigit (p[pos])) {
+		return false;
+	}
+	n = 0;
+	while (pos < len && isdigit (p[pos])) {
+		n = 10 * n + (p[pos++] - '0');
+		if (n > MAX_REPEAT) {
+			fail ("repetition count too large");
+		}
+	}
+	return true;
+}
+
+int32_t Parser::repetition (int depth)
+{
+	const int32_t operand = atom (depth);
+	int32_t min, max;
+
+	if (pos >= len) {
+		return operand;
+	}
+	switch (p[pos]) {
+	case '*':
+		min = 0;
+		max = -1;
+		++pos;
+		break;
+	case '+':
+		min = 1;
+		max = -1;
+		++pos;
+		break;
+	case '?':
+		min = 0;
+		max = 1;
+		++pos;
+		break;
+	case '{':
+		++pos;
+		if (!number (min)) {
+			fail ("invalid repetition");
+		}
+		max = min;
+		if (pos < len && p[pos] == ',') {
+			++pos;
+			if (!number (max)) {
+				max = -1;
+			} else if (max < min) {
+				fail ("invalid repetition bounds");
+			}
+		}
+		if (pos >= len || p[pos] != '}') {
+			fail ("invalid repetition");
+		}
+		++pos;
+		break;
+	default:
+		return operand;
+	}
+
+	bool greedy = true;
+	if (pos < len && p[pos] == '?') {
+		greedy = false;
+		++pos;
+	}
+	if (pos < len && (p[pos] == '*' || p[pos] == '+' || p[pos] == '?' || p[pos] == '{')) {
+		fail ("nested repetition");
+	}
+
+	const int32_t res = addNode (NODE_REPEAT, operand);
+	nodes.data[res].min = min;
+	nodes.data[res].max = max;
+	nodes.data[res].greedy = greedy;
+	return res;
+}
+
+int32_t Parser::atom (int depth)
+{
+	CharSet set;
+	const uint8_t c = p[pos++];
+
+	switch (c) {
+	case '(': {
+		int32_t group = -1;
+		if (pos < len && p[pos] == '?') {
+			if (pos + 1 >= len || p[pos + 1] != ':') {
+				fail ("unsupported group syntax");
+			}
+			pos += 2;
+		} else {
+			if (groups >= Regex::MAX_GROUPS) {
+				fail ("too many groups");
+			}
+			group = static_cast<int32_t>(groups++);
+		}
+		const int32_t operand = alternation (depth + 1);
+		if (pos >= len || p[pos] != ')') {
+			fail ("missing closing parenthesis");
+		}
+		++pos;
+		return (group < 0) ? operand : addNode (NODE_GROUP, operand, group);
+	}
+	case '[':
+		characterClass (set);
+		return addSet (set);
+	case '.':
+		return addSet (set.add ('\n').complement());
+	case '^':
+		return addNode (NODE_BOL);
+	case '$':
+		return addNode (NODE_EOL);
+	case '\\':
+		escape (set);
+		return addSet (set);
+	case '*':
+	case '+':
+	case '?':
+	case '{':
+		--pos;
+		fail ("nothing to repeat");
+	default:
+		return addSet (set.add (c));
+	}
+}
+
+/**
+ * Parses the escape sequence following a backslash, and adds its bytes to a set.
+ * @return the byte of a single byte escape, -1 for a class.
+ */
+int Parser::escape (CharSet& set)
+{
+	if (pos >= len) {
+		fail ("trailing backslash");
+	}
+
+	CharSet cls;
+	bool negate = false;
+	const uint8_t c = p[pos++];
+
+	switch (c) {
+	case 'D':
+		negate = true;
+		// fall through
+	case 'd':
+		cls.addRange ('0', '9');
+		break;
+	case 'W':
+		negate = true;
+		// fall through
+	case 'w':
+		cls.addRange ('a', 'z').addRange ('A', 'Z').addRange ('0', '9').add ('_');
+		break;
+	case 'S':
+		negate = true;
+		// fall through
+	case 's':
+		cls.add (" \t\n\r\f\v");
+		break;
+	case 't':
+		set.add ('\t');
+		return '\t';
+	case 'n':
+		set.add ('\n');
+		return '\n';
+	case 'r':
+		set.add ('\r');
+		return '\r';
+	case 'f':
+		set.add ('\f');
+		return '\f';
+	case 'v':
+		set.add ('\v');
+		return '\v';
+	case 'x': {
+		int value = 0;
+		for (int i = 0; i < 2; ++i, ++pos) {
+			if (pos >= len || !isxdigit (p[pos])) {
+				fail ("invalid hexadecimal escape");
+			}
+			value = 16 * value + (isdigit (p[pos]) ? p[pos] - '0' : (p[pos] | 0x20) - 'a' + 10);
+		}
+		set.add (static_cast<char>(value));
+		return value;
+	}
+	default:
+		if (isalnum (c)) {
+			--pos;
+			fail ("unsupported escape sequence");
+		}
+		set.add (c);
+		return c;
+	}
+
+	if (negate) {
+		cls = cls.complement();
+	}
+	for (int b = 0; b < 256; ++b) {
+		if (cls.contains (static_cast<char>(b))) {
+			set.add (static_cast<char>(b));
+		}
+	}
+	return -1;
+}
+
+void Parser::characterClass (CharSet& set)
+{
+	bool negate = false;
+	if (pos < len && p[pos] == '^') {
+		negate = true;
+		++pos;
+	}
+
+	for (bool first = true; ; first = false) {
+		if (pos >= len) {
+			fail ("missing closing bracket");
+		}
+
+		const uint8_t c = p[pos++];
+		if (c == ']' && !first) {
+			break;
+		}
+
+		int low = c;
+		if (c == '\\') {
+			low = escape (set);
+		} else {
+			set.add (c);
+		}
+
+		if (low >= 0 && pos + 1 < len && p[pos] == '-' && p[pos + 1] != ']') {
+			++pos;
+			int high = p[pos++];
+			if (high == '\\') {
+				CharSet tmp;
+				high = escape (tmp);
+			}
+			if (high < low) {
+				fail ("invalid class range");
+			}
+			set.addRange (static_cast<char>(low), static_cast<char>(high));
+		}
+	}
+
+	if (negate) {
+		// Both cases must be excluded.
+		if (ignoreCase) {
+			for (char c = 'a'; c <= 'z'; ++c) {
+				if (set.contains (c) || set.contains (c - 'a' + 'A')) {
+					set.add (c).add (c - 'a' + 'A');
+				}
+			}
+		}
+		set = set.complement();
+	}
+}
+
+/**
+ * Collects the operands of a chain of concatenations, from left to right.
+ */
+void flatten (const Node* nodes, int32_t n, Buffer<int32_t>& items)
+{
+	const size_t first = items.size;
+	while (nodes[n].type == NODE_CONCAT) {
+		items.push (nodes[n].b);
+		n = nodes[n].a;
+	}
+	items.push (n);
+
+	for (size_t i = first, j = items.size - 1; i < j; ++i, --j) {
+		const int32_t tmp = items.data[i];
+		items.data[i] = items.data[j];
+		items.data[j] = tmp;
+	}
+}
+
+/**
+ * Tells whether n matches the empty text, assertions aside.
+ */
+bool canMatchEmpty (const Node* nodes, int32_t n)
+{
+	const Node& node = nodes[n];
+
+	switch (node.type) {
+	case NODE_SET:
+		return false;
+	case NODE_CONCAT:
+		return canMatchEmpty (nodes, node.a) && canMatchEmpty (nodes, node.b);
+	case NODE_ALTERNATION:
+		return canMatchEmpty (nodes, node.a) || canMatchEmpty (nodes, node.b);
+	case NODE_GROUP:
+		return canMatchEmpty (nodes, node.a);
+	case NODE_REPEAT:
+		return node.min == 0 || canMatchEmpty (nodes, node.a);
+	default:
+		return true;
+	}
+}
+
+/*
+ * Required literal extraction. A node matching a single byte (both cases of
+ * a letter in IGNORE_CASE mode) is a literal byte.
+ */
+
+class LiteralExtractor {
+	const Node* nodes;
+	const CharSet* sets;
+	bool ignoreCase;
+
+	LiteralExtractor (const LiteralExtractor&);
+	LiteralExtractor& operator = (const LiteralExtractor&);
+
+	int literalByte (int32_t n) const {
+		if (nodes[n].type != NODE_SET) {
+			return -1;
+		}
+		const CharSet& set = sets[nodes[n].a];
+		const size_t size = set.size();
+		for (int c = 0; c < 256; ++c) {
+			if (set.contains (static_cast<char>(c))) {
+				if (size == 1 || (ignoreCase && size == 2 && static_cast<uint8_t>((c | 0x20) - 'a') < 26)) {
+					return c;
+				}
+				return -1;
+			}
+		}
+		return -1;
+	}
+
+	/// Appends the text matched by n, if it only matches one text.
+	bool exact (int32_t n, XString& out) const {
+		const Node& node = nodes[n];
+		int c = literalByte (n);
+
+		if (c >= 0) {
+			out.appendChar (static_cast<char>(c));
+			return true;
+		}
+		switch (node.type) {
+		case NODE_EMPTY:
+		case NODE_BOL:
+		case NODE_EOL:
+			return true;
+		case NODE_GROUP:
+			return exact (node.a, out);
+		case NODE_REPEAT:
+			for (int32_t i = 0; i < node.min && node.min == node.max; ++i) {
+				if (!exact (node.a, out)) {
+					return false;
+				}
+			}
+			return (node.min == node.max);
+		case NODE_CONCAT: {
+			Buffer<int32_t> items;
+			flatten (nodes, n, items);
+			for (size_t i = 0; i < items.size; ++i) {
+				if (!exact (items.data[i], out)) {
+					return false;
+				}
+			}
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+
+public:
+	LiteralExtractor (const Node* n, const CharSet* s, bool ic)
+		: nodes(n), sets(s), ignoreCase(ic)
+	{ }
+
+	/// Gets the longest literal every text matched by n contains.
+	void required (int32_t n, XString& best) const {
+		const Node& node = nodes[n];
+		XString run, tmp;
+
+		best.clear();
+		switch (node.type) {
+		case NODE_GROUP:
+			required (node.a, best);
+			break;
+		case NODE_REPEAT:
+			if (node.min > 0) {
+				required (node.a, best);
+			}
+			break;
+		case NODE_SET:
+			if (!exact (n, best)) {
+				best.clear();
+			}
+			break;
+		case NODE_CONCAT: {
+			Buffer<int32_t> items;
+			flatten (nodes, n, items);
+			for (size_t i = 0; i <= items.size; ++i) {
+				tmp.clear();
+				if (i < items.size && exact (items.data[i], tmp)) {
+					run.append (tmp);
+					continue;
+				}
+				if (run.length() > best.length()) {
+					best.copyFrom (run);
+				}
+				run.clear();
+				if (i < items.size) {
+					required (items.data[i], tmp);
+					if (tmp.length() > best.length()) {
+						best.copyFrom (tmp);
+					}
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+};
+
+/*
+ * NFA program.
+ */
+
+enum Opcode {
+	/// Consumes a byte of the set x.
+	OP_CHAR,
+	/// Goes on at x, then at y with a lower priority.
+	OP_SPLIT,
+	/// Goes on at x.
+	OP_JMP,
+	/// Stores the position in the capture slot x.
+	OP_SAVE,
+	/// Start of text assertion.
+	OP_BOL,
+	/// End of text assertion.
+	OP_EOL,
+	OP_MATCH
+};
+
+struct Instruction {
+	Opcode op;
+	uint32_t x;
+	uint32_t y;
+};
+
+/// DFA state flags.
+const uint8_t STATE_ACCEPT = 1;
+const uint8_t STATE_ACCEPT_AT_END = 2;
+const uint8_t STATE_DEAD = 4;
+
+/// Transition not computed yet.
+const uint32_t UNKNOWN = UINT32_MAX;
+/// Tag of the transitions to states the matching loop must stop on.
+const uint32_t STOP = 0x80000000;
+
+/**
+ * A cache of DFA states. Each state is a sorted set of NFA instructions
+ * (CHAR, EOL and MATCH), and its transitions are computed on first use.
+ */
+struct DfaCache {
+	/// Floating caches restart the NFA at every position, for searches.
+	bool floating;
+	size_t stateCount;
+	/**
+	 * Transitions, indexed by state + class. States are premultiplied by
+	 * classCount, and tagged with STOP when their flags intersect stopFlags.
+	 */
+	uint32_t* transitions;
+	uint8_t stopFlags;
+	uint8_t* flags;
+	/// Instructions of state s: pool[setStarts[s] ... setStarts[s + 1] - 1].
+	uint32_t* setStarts;
+	uint32_t* pool;
+	size_t poolCapacity;
+	/// Open addressing hash table of the states, -1 for empty slots.
+	int32_t* table;
+	int32_t start;
+	/// Incremented by each flush.
+	uint32_t flushes;
+};
+
+/**
+ * Threads of the Pike VM, in priority order. A sparse set of instructions,
+ * with the capture slots of each thread.
+ */
+struct ThreadList {
+	uint32_t* dense;
+	uint32_t* sparse;
+	size_t size;
+	ssize_t* captures;
+};
+
+/// Pike VM stack entry: an instruction to follow, or a capture slot to restore when slot >= 0.
+struct Frame {
+	uint32_t pc;
+	int32_t slot;
+	ssize_t value;
+};
+
+} // namespace
+
+/**
+ * The compiled form of a pattern, with the matching buffers.
+ */
+class Regex::Program {
+	Program (const Program&);
+	Program& operator = (const Program&);
+
+	Instruction* code;
+	size_t codeSize;
+	size_t codeCapacity;
+	CharSet* sets;
+	size_t setCount;
+
+	uint8_t byteClasses[256];
+	size_t classCount;
+
+	DfaCache anchored;
+	DfaCache floating;
+	/// The program matches the reversed texts: concatenations and anchors are swapped.
+	bool reversed;
+
+	/// Closure scratch buffers.
+	uint32_t* marks;
+	uint32_t generation;
+	uint32_t* stack;
+	uint32_t* list;
+	uint32_t* endList;
+
+	/// Pike VM buffers.
+	ThreadList threads[2];
+	Frame* frames;
+	ssize_t* work;
+
+	void release();
+	void nextGeneration();
+	uint32_t emit (Opcode op, uint32_t x = 0, uint32_t y = 0);
+	void generate (const Node* nodes, int32_t n);
+	void computeByteClasses();
+
+	size_t closure (uint32_t pc, bool atStart, bool atEnd, uint32_t* out, size_t n);
+	void initCache (DfaCache& cache);
+	void flush (DfaCache& cache);
+	int32_t addState (DfaCache& cache, const uint32_t* states, size_t n);
+	int32_t startState (DfaCache& cache);
+	int32_t step (DfaCache& cache, int32_t s, uint8_t byte);
+
+	void initThreads();
+	void addThread (ThreadList& list, uint32_t pc, const ssize_t* captures, size_t pos, size_t len);
+
+public:
+	/// Number of capture slots, 2 per group.
+	size_t slots;
+
+	/**
+	 * Generates the program of a pattern.
+	 * @param reverse true to generate the program matching the reversed texts.
+	 */
+	Program (const Parser& parser, int32_t root, bool reverse);
+	~Program();
+
+	/**
+	 * Runs a DFA.
+	 * @param searching true to look for a match anywhere, false to match the whole text.
+	 */
+	bool run (bool searching, const uint8_t* text, size_t len);
+
+	/**
+	 * Runs the floating DFA of a reversed pattern backwards.
+	 * @return the smallest position at or after from where a match starts,
+	 * -1 if none.
+	 */
+	ssize_t leftmostStart (const uint8_t* text, size_t len, size_t from);
+
+	/**
+	 * Runs the Pike VM.
+	 * @param start the position the match must start at.
+	 * @param full true if the match must end at len.
+	 * @param captures receives the capture slots of the match.
+	 */
+	bool pike (const uint8_t* text, size_t len, size_t start, bool full, ssize_t* captures);
+};
+
+Regex::Program::Program (const Parser& parser, int32_t root, bool reverse)
+	: code(0), codeSize(0), codeCapacity(0), sets(0), setCount(parser.sets.size),
+	  classCount(0), anchored(), floating(), reversed(reverse),
+	  marks(0), generation(0), stack(0), list(0), endList(0), threads(), frames(0), work(0),
+	  slots(2 * parser.groups)
+{
+	floating.floating = true;
+
+	try {
+		sets = allocateArray<CharSet>(setCount);
+		for (size_t i = 0; i < setCount; ++i) {
+			sets[i] = parser.sets.data[i];
+		}
+
+		emit (OP_SAVE, 0);
+		generate (parser.nodes.data, root);
+		emit (OP_SAVE, 1);
+		emit (OP_MATCH);
+
+		marks = allocateArray<uint32_t>(codeSize);
+		memset (marks, 0, codeSize * sizeof(uint32_t));
+		stack = allocateArray<uint32_t>(codeSize);
+		list = allocateArray<uint32_t>(codeSize);
+		endList = allocateArray<uint32_t>(codeSize);
+
+		computeByteClasses();
+	} catch (...) {
+		release();
+		throw;
+	}
+}
+
+Regex::Program::~Program()
+{
+	release();
+}
+
+void Regex::Program::release()
+{
+	DfaCache* caches[2] = { &anchored, &floating };
+	for (int i = 0; i < 2; ++i) {
+		std::free (caches[i]->transitions);
+		std::free (caches[i]->flags);
+		std::free (caches[i]->setStarts);
+		std::free (caches[i]->pool);
+		std::free (caches[i]->table);
+		caches[i]->transitions = 0;
+		caches[i]->flags = 0;
+		caches[i]->setStarts = 0;
+		caches[i]->pool = 0;
+		caches[i]->table = 0;
+	}
+	for (int i = 0; i < 2; ++i) {
+		std::free (threads[i].dense);
+		std::free (threads[i].sparse);
+		std::free (threads[i].captures);
+		threads[i].dense = threads[i].sparse = 0;
+		threads[i].captures = 0;
+	}
+	std::free (frames);
+	std::free (work);
+	std::free (marks);
+	std::free (stack);
+	std::free (list);
+	std::free (endList);
+	std::free (sets);
+	std::free (code);
+	frames = 0;
+	work = 0;
+	marks = stack = list = endList = 0;
+	sets = 0;
+	code = 0;
+}
+
+void Regex::Program::nextGeneration()
+{
+	if (++generation == 0) {
+		memset (marks, 0, codeSize * sizeof(uint32_t));
+		generation = 1;
+	}
+}
+
+uint32_t Regex::Program::emit (Opcode op, uint32_t x, uint32_t y)
+{
+	if (codeSize >= MAX_PROGRAM) {
+		THROW ("Regex: the pattern is too large");
+	}
+	if (codeSize == codeCapacity) {
+		codeCapacity = codeCapacity ? 2 * codeCapacity : 64;
+		resizeArray (code, codeCapacity);
+	}
+	code[codeSize].op = op;
+	code[codeSize].x = x;
+	code[codeSize].y = y;
+	return static_cast<uint32_t>(codeSize++);
+}
+
+/*
+ * Thompson construction. SPLIT tries x first: for repetitions x is the
+ * operand when greedy, the exit when lazy.
+ *
+ * Unbounded repetitions loop after their operand, as in x+, so that an
+ * iteration matching the empty text ends the loop instead of letting a
+ * lower priority path consume more, as Perl does. x* is x+ made optional
+ * when x can match the empty text.
+ */
+void Regex::Program::generate (const Node* nodes, int32_t n)
+{
+	const Node& node = nodes[n];
+
+	switch (node.type) {
+	case NODE_EMPTY:
+		break;
+	case NODE_SET:
+		emit (OP_CHAR, node.a);
+		break;
+	case NODE_BOL:
+		emit (reversed ? OP_EOL : OP_BOL);
+		break;
+	case NODE_EOL:
+		emit (reversed ? OP_BOL : OP_EOL);
+		break;
+	case NODE_CONCAT: {
+		Buffer<int32_t> items;
+		flatten (nodes, n, items);
+		for (size_t i = 0; i < items.size; ++i) {
+			generate (nodes, items.data[reversed ? items.size - 1 - i : i]);
+		}
+		break;
+	}
+	case NODE_ALTERNATION: {
+		const uint32_t split = emit (OP_SPLIT);
+		code[split].x = codeSize;
+		generate (nodes, node.a);
+		const uint32_t jump = emit (OP_JMP);
+		code[split].y = codeSize;
+		generate (nodes, node.b);
+		code[jump].x = codeSize;
+		break;
+	}
+	case NODE_GROUP:
+		emit (OP_SAVE, 2 * node.b);
+		generate (nodes, node.a);
+		emit (OP_SAVE, 2 * node.b + 1);
+		break;
+	case NODE_REPEAT: {
+		const bool loop = (node.max < 0 && (node.min > 0 || canMatchEmpty (nodes, node.a)));
+		for (int32_t i = loop; i < node.min; ++i) {
+			generate (nodes, node.a);
+		}
+		if (loop) {
+			const uint32_t skip = (node.min == 0) ? emit (OP_SPLIT) : 0;
+			const uint32_t body = codeSize;
+			generate (nodes, node.a);
+			const uint32_t split = emit (OP_SPLIT);
+			code[split].x = node.greedy ? body : codeSize;
+			code[split].y = node.greedy ? codeSize : body;
+			if (node.min == 0) {
+				code[skip].x = node.greedy ? body : codeSize;
+				code[skip].y = node.greedy ? codeSize : body;
+			}
+		} else if (node.max < 0) {
+			const uint32_t split = emit (OP_SPLIT);
+			generate (nodes, node.a);
+			emit (OP_JMP, split);
+			code[split].x = node.greedy ? split + 1 : codeSize;
+			code[split].y = node.greedy ? codeSize : split + 1;
+		} else if (node.max > node.min) {
+			// Nested optional copies, all exiting to the end.
+			Buffer<uint32_t> splits;
+			for (int32_t i = node.min; i < node.max; ++i) {
+				splits.push (emit (OP_SPLIT));
+				generate (nodes, node.a);
+			}
+			for (size_t i = 0; i < splits.size; ++i) {
+				const uint32_t split = splits.data[i];
+				code[split].x = node.greedy ? split + 1 : codeSize;
+				code[split].y = node.greedy ? codeSize : split + 1;
+			}
+		}
+		break;
+	}
+	}
+}
+
+/*
+ * Bytes no set distinguishes share a class, and a DFA transition.
+ */
+void Regex::Program::computeByteClasses()
+{
+	int16_t remap[2][256];
+	uint8_t next[256];
+
+	memset (byteClasses, 0, sizeof(byteClasses));
+	classCount = 1;
+
+	for (size_t s = 0; s < setCount; ++s) {
+		memset (remap, 0xFF, sizeof(remap));
+		size_t count = 0;
+		for (int b = 0; b < 256; ++b) {
+			int16_t& cls = remap[sets[s].contains (static_cast<char>(b)) ? 1 : 0][byteClasses[b]];
+			if (cls < 0) {
+				cls = static_cast<int16_t>(count++);
+			}
+			next[b] = static_cast<uint8_t>(cls);
+		}
+		memcpy (byteClasses, next, sizeof(byteClasses));
+		classCount = count;
+	}
+}
+
+/**
+ * Adds the instructions reachable from pc without consuming a byte to out,
+ * skipping those already marked in the current generation.
+ * @return the new size of out.
+ */
+size_t Regex::Program::closure (uint32_t pc, bool atStart, bool atEnd, uint32_t* out, size_t n)
+{
+	size_t top = 0;
+
+	if (marks[pc] != generation) {
+		marks[pc] = generation;
+		stack[top++] = pc;
+	}
+	while (top > 0) {
+		const uint32_t cur = stack[--top];
+		const Instruction& in = code[cur];
+		uint32_t targets[2];
+		int nb = 0;
+
+		switch (in.op) {
+		case OP_JMP:
+			targets[nb++] = in.x;
+			break;
+		case OP_SPLIT:
+			targets[nb++] = in.y;
+			targets[nb++] = in.x;
+			break;
+		case OP_SAVE:
+			targets[nb++] = cur + 1;
+			break;
+		case OP_BOL:
+			if (atStart) {
+				targets[nb++] = cur + 1;
+			}
+			break;
+		case OP_EOL:
+			if (atEnd) {
+				targets[nb++] = cur + 1;
+			} else {
+				out[n++] = cur;
+			}
+			break;
+		default:
+			out[n++] = cur;
+			break;
+		}
+		for (int i = 0; i < nb; ++i) {
+			if (marks[targets[i]] != generation) {
+				marks[targets[i]] = generation;
+				stack[top++] = targets[i];
+			}
+		}
+	}
+	return n;
+}
+
+/*
+ * DFA.
+ */
+
+static int compareStates (const void* a, const void* b)
+{
+	const uint32_t x = *static_cast<const uint32_t*>(a);
+	const uint32_t y = *static_cast<const uint32_t*>(b);
+	return (x < y) ? -1 : (x > y);
+}
+
+static inline size_t hashStates (const uint32_t* states, size_t n)
+{
+	uint64_t h = 14695981039346656037ULL;
+	for (size_t i = 0; i < n; ++i) {
+		h = (h ^ states[i]) * 1099511628211ULL;
+	}
+	return static_cast<size_t>(h ^ (h >> 29));
+}
+
+void Regex::Program::initCache (DfaCache& cache)
+{
+	cache.transitions = allocateArray<uint32_t>(MAX_DFA_STATES * classCount);
+	cache.flags = allocateArray<uint8_t>(MAX_DFA_STATES);
+	cache.setStarts = allocateArray<uint32_t>(MAX_DFA_STATES + 1);
+	cache.poolCapacity = codeSize + 16 * MAX_DFA_STATES;
+	cache.pool = allocateArray<uint32_t>(cache.poolCapacity);
+	cache.table = allocateArray<int32_t>(2 * MAX_DFA_STATES);
+	cache.stopFlags = cache.floating ? (STATE_DEAD | STATE_ACCEPT) : STATE_DEAD;
+	cache.stateCount = MAX_DFA_STATES;
+	flush (cache);
+}
+
+void Regex::Program::flush (DfaCache& cache)
+{
+	memset (cache.transitions, 0xFF, cache.stateCount * classCount * sizeof(uint32_t));
+	memset (cache.table, 0xFF, 2 * MAX_DFA_STATES * sizeof(int32_t));
+	cache.stateCount = 0;
+	cache.setStarts[0] = 0;
+	cache.start = -1;
+	++cache.flushes;
+}
+
+/**
+ * Gets the state of a sorted set of instructions, creating it if needed.
+ * When the cache is full, it is flushed first: the ids of the other states
+ * are no longer valid.
+ */
+int32_t Regex::Program::addState (DfaCache& cache, const uint32_t* states, size_t n)
+{
+	const size_t mask = 2 * MAX_DFA_STATES - 1;
+	size_t slot = hashStates (states, n) & mask;
+
+	for (int32_t s; (s = cache.table[slot]) >= 0; slot = (slot + 1) & mask) {
+		const uint32_t first = cache.setStarts[s];
+		if (cache.setStarts[s + 1] - first == n && memcmp (cache.pool + first, states, n * sizeof(uint32_t)) == 0) {
+			return s;
+		}
+	}
+
+	if (cache.stateCount == MAX_DFA_STATES || cache.setStarts[cache.stateCount] + n > cache.poolCapacity) {
+		flush (cache);
+		slot = hashStates (states, n) & mask;
+	}
+
+	const int32_t s = static_cast<int32_t>(cache.stateCount++);
+	const uint32_t first = cache.setStarts[s];
+	memcpy (cache.pool + first, states, n * sizeof(uint32_t));
+	cache.setStarts[s + 1] = static_cast<uint32_t>(first + n);
+	cache.table[slot] = s;
+
+	// Flags: a pending end of text assertion accepts if its continuation
+	// reaches MATCH.
+	uint8_t flags = (n == 0) ? STATE_DEAD : 0;
+	for (size_t i = 0; i < n; ++i) {
+		if (code[states[i]].op == OP_MATCH) {
+			flags |= STATE_ACCEPT | STATE_ACCEPT_AT_END;
+		} else if (code[states[i]].op == OP_EOL && !(flags & STATE_ACCEPT_AT_END)) {
+			nextGeneration();
+			const size_t nb = closure (states[i], false, true, endList, 0);
+			for (size_t j = 0; j < nb; ++j) {
+				if (code[endList[j]].op == OP_MATCH) {
+					flags |= STATE_ACCEPT_AT_END;
+				}
+			}
+		}
+	}
+	cache.flags[s] = flags;
+
+	return s;
+}
+
+int32_t Regex::Program::startState (DfaCache& cache)
+{
+	if (!cache.transitions) {
+		initCache (cache);
+	}
+	if (cache.start < 0) {
+		nextGeneration();
+		const size_t n = closure (0, true, false, list, 0);
+		qsort (list, n, sizeof(uint32_t), compareStates);
+		cache.start = addState (cache, list, n);
+	}
+	return cache.start;
+}
+
+/**
+ * Computes and stores a transition.
+ * @return the next state, not premultiplied.
+ */
+int32_t Regex::Program::step (DfaCache& cache, int32_t s, uint8_t byte)
+{
+	size_t n = 0;
+
+	nextGeneration();
+	for (uint32_t i = cache.setStarts[s]; i < cache.setStarts[s + 1]; ++i) {
+		const Instruction& in = code[cache.pool[i]];
+		if (in.op == OP_CHAR && sets[in.x].contains (static_cast<char>(byte))) {
+			n = closure (cache.pool[i] + 1, false, false, list, n);
+		}
+	}
+	if (cache.floating) {
+		n = closure (0, false, false, list, n);
+	}
+	qsort (list, n, sizeof(uint32_t), compareStates);
+
+	const uint32_t flushes = cache.flushes;
+	const int32_t next = addState (cache, list, n);
+	if (cache.flushes == flushes) {
+		cache.transitions[s * classCount + byteClasses[byte]] =
+			(next * classCount) | ((cache.flags[next] & cache.stopFlags) ? STOP : 0);
+	}
+	return next;
+}
+
+/*
+ * The matching loops only leave the fast path on unknown transitions, and
+ * on the states tagged with STOP.
+ */
+
+bool Regex::Program::run (bool searching, const uint8_t* text, size_t len)
+{
+	DfaCache& cache = searching ? floating : anchored;
+	int32_t s = startState (cache);
+
+	if (cache.flags[s] & cache.stopFlags) {
+		return (cache.flags[s] & STATE_ACCEPT);
+	}
+
+	uint32_t cur = s * classCount;
+	for (size_t i = 0; i < len; ++i) {
+		uint32_t t = cache.transitions[cur + byteClasses[text[i]]];
+		if (t >= STOP) {
+			s = (t == UNKNOWN) ? step (cache, cur / classCount, text[i]) : (t & ~STOP) / classCount;
+			if (cache.flags[s] & cache.stopFlags) {
+				return (cache.flags[s] & STATE_ACCEPT);
+			}
+			t = s * classCount;
+		}
+		cur = t;
+	}
+	return (cache.flags[cur / classCount] & STATE_ACCEPT_AT_END);
+}
+
+ssize_t Regex::Program::leftmostStart (const uint8_t* text, size_t len, size_t from)
+{
+	DfaCache& cache = floating;
+	int32_t s = startState (cache);
+	ssize_t res = (cache.flags[s] & STATE_ACCEPT) ? len : -1;
+
+	if (cache.flags[s] & STATE_DEAD) {
+		return res;
+	}
+
+	uint32_t cur = s * classCount;
+	for (size_t i = len; i > from; ) {
+		--i;
+		uint32_t t = cache.transitions[cur + byteClasses[text[i]]];
+		if (t >= STOP) {
+			s = (t == UNKNOWN) ? step (cache, cur / classCount, text[i]) : (t & ~STOP) / classCount;
+			if (cache.flags[s] & STATE_DEAD) {
+				return res;
+			} else if (cache.flags[s] & STATE_ACCEPT) {
+				res = i;
+			}
+			t = s * classCount;
+		}
+		cur = t;
+	}
+
+	// The start of text assertions of the pattern are pending at position 0.
+	if (from == 0 && res != 0 && (cache.flags[cur / classCount] & STATE_ACCEPT_AT_END)) {
+		res = 0;
+	}
+	return res;
+}
+
+/*
+ * Pike VM.
+ */
+
+void Regex::Program::initThreads()
+{
+	for (int i = 0; i < 2; ++i) {
+		threads[i].dense = allocateArray<uint32_t>(codeSize);
+		threads[i].sparse = allocateArray<uint32_t>(codeSize);
+		threads[i].captures = allocateArray<ssize_t>(codeSize * slots);
+		// Sparse entries are checked against dense, but should not be read uninitialized.
+		memset (threads[i].sparse, 0, codeSize * sizeof(uint32_t));
+		threads[i].size = 0;
+	}
+	frames = allocateArray<Frame>(codeSize + 1);
+	work = allocateArray<ssize_t>(2 * slots);
+}
+
+/**
+ * Adds the threads reachable from pc without consuming a byte, in priority
+ * order, following the captures along the way.
+ */
+void Regex::Program::addThread (ThreadList& threadList, uint32_t pc, const ssize_t* captures, size_t pos, size_t len)
+{
+	size_t top = 0;
+
+	memcpy (work, captures, slots * sizeof(ssize_t));
+	frames[top].pc = pc;
+	frames[top].slot = -1;
+	++top;
+
+	while (top > 0) {
+		const Frame frame = frames[--top];
+		if (frame.slot >= 0) {
+			work[frame.slot] = frame.value;
+			continue;
+		}
+
+		for (uint32_t cur = frame.pc; ; ) {
+			const uint32_t idx = threadList.sparse[cur];
+			if (idx < threadList.size && threadList.dense[idx] == cur) {
+				break;
+			}
+			threadList.sparse[cur] = static_cast<uint32_t>(threadList.size);
+			threadList.dense[threadList.size++] = cur;
+
+			const Instruction& in = code[cur];
+			if (in.op == OP_JMP) {
+				cur = in.x;
+			} else if (in.op == OP_SPLIT) {
+				frames[top].pc = in.y;
+				frames[top].slot = -1;
+				++top;
+				cur = in.x;
+			} else if (in.op == OP_SAVE) {
+				frames[top].slot = static_cast<int32_t>(in.x);
+				frames[top].value = work[in.x];
+				++top;
+				work[in.x] = pos;
+				++cur;
+			} else if (in.op == OP_BOL) {
+				if (pos != 0) {
+					break;
+				}
+				++cur;
+			} else if (in.op == OP_EOL) {
+				if (pos != len) {
+					break;
+				}
+				++cur;
+			} else {
+				memcpy (threadList.captures + (threadList.size - 1) * slots, work, slots * sizeof(ssize_t));
+				break;
+			}
+		}
+	}
+}
+
+bool Regex::Program::pike (const uint8_t* text, size_t len, size_t start, bool full, ssize_t* captures)
+{
+	if (!frames) {
+		initThreads();
+	}
+
+	ThreadList* current = &threads[0];
+	ThreadList* next = &threads[1];
+	ssize_t* none = work + slots;
+	bool matched = false;
+
+	for (size_t i = 0; i < slots; ++i) {
+		none[i] = -1;
+	}
+	current->size = 0;
+	addThread (*current, 0, none, start, len);
+
+	for (size_t pos = start; pos <= len && current->size > 0; ++pos) {
+		next->size = 0;
+		for (size_t i = 0; i < current->size; ++i) {
+			const uint32_t pc = current->dense[i];
+			const Instruction& in = code[pc];
+			const ssize_t* caps = current->captures + i * slots;
+
+			if (in.op == OP_CHAR) {
+				if (pos < len && sets[in.x].contains (static_cast<char>(text[pos]))) {
+					addThread (*next, pc + 1, caps, pos + 1, len);
+				}
+			} else if (in.op == OP_MATCH && (!full || pos == len)) {
+				// Lower priority threads are cut.
+				memcpy (captures, caps, slots * sizeof(ssize_t));
+				matched = true;
+				break;
+			}
+		}
+
+		ThreadList* tmp = current;
+		current = next;
+		next = tmp;
+	}
+
+	return matched;
+}
+
+/*
+ * Regex.
+ */
+
+Regex::Match::Match()
+	: base(0), count(0)
+{
+	for (size_t i = 0; i < 2 * MAX_GROUPS; ++i) {
+		offsets[i] = -1;
+	}
+}
+
+void Regex::Match::reset (const String& text, size_t groups)
+{
+	base = text.cstr();
+	count = groups;
+	for (size_t i = 0; i < 2 * MAX_GROUPS; ++i) {
+		offsets[i] = -1;
+	}
+}
+
+String Regex::Match::group (size_t group) const
+{
+	if (!matched (group)) {
+		return String();
+	}
+	return String (base + offsets[2 * group], offsets[2 * group + 1] - offsets[2 * group]);
+}
+
+Regex::Regex (const String& pattern, Mode m)
+	: source(pattern), mode(m), program(0), reverseProgram(0), literal(), literalSearcher(String())
+{
+	compile();
+}
+
+Regex::Regex (const Regex& r)
+	: source(r.source), mode(r.mode), program(0), reverseProgram(0), literal(), literalSearcher(String())
+{
+	compile();
+}
+
+Regex::~Regex()
+{
+	delete program;
+	delete reverseProgram;
+}
+
+void Regex::compile()
+{
+	Parser parser (source, mode == IGNORE_CASE);
+	const int32_t root = parser.parse();
+
+	LiteralExtractor (parser.nodes.data, parser.sets.data, mode == IGNORE_CASE).required (root, literal);
+	if (mode == CASE_SENSITIVE) {
+		literalSearcher = String::Searcher (literal);
+	}
+
+	program = new Program (parser, root, false);
+	try {
+		reverseProgram = new Program (parser, root, true);
+	} catch (...) {
+		delete program;
+		program = 0;
+		throw;
+	}
+}
+
+size_t Regex::groups() const
+{
+	return program->slots / 2;
+}
+
+bool Regex::mayMatch (const String& text, size_t from) const
+{
+	if (literal.length() == 0) {
+		return true;
+	} else if (mode == CASE_SENSITIVE) {
+		return (literalSearcher.find (text, from) >= 0);
+	}
+	return (memifind_ascii (text.bytes() + from, text.length() - from, literal.bytes(), literal.length()) != 0);
+}
+
+bool Regex::matches (const String& text)
+{
+	return mayMatch (text, 0) && program->run (false, text.bytes(), text.length());
+}
+
+bool Regex::contains (const String& text)
+{
+	return mayMatch (text, 0) && program->run (true, text.bytes(), text.length());
+}
+
+bool Regex::match (const String& text, Match& m)
+{
+	m.reset (text, groups());
+	return matches (text) && program->pike (text.bytes(), text.length(), 0, true, m.offsets);
+}
+
+bool Regex::find (const String& text, Match& m, size_t from)
+{
+	m.reset (text, groups());
+	if (from > text.length() || !mayMatch (text, from)) {
+		return false;
+	}
+	// The captures are only computed from the start of the leftmost match.
+	const ssize_t start = reverseProgram->leftmostStart (text.bytes(), text.length(), from);
+	return (start >= 0 && program->pike (text.bytes(), text.length(), start, false, m.offsets));
+}
+
+} // namespace Fianet
@@ -0,0 +1,220 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_REGEX_H
+#define FIANET_REGEX_H
+
+#include "fianet-core.h"
+#include "StringSearcher.h"
+
+namespace Fianet {
+
+/**
+ * @class Regex
+ * A compiled regular expression, matched against Strings without
+ * backtracking.
+ *
+ * Typical use is validating fields (postcodes, phone numbers, references)
+ * and extracting their parts: the pattern is compiled once, then matched
+ * against every record.
+ *
+ * @code
+ * Regex postcode ("^(\\d{2})\\d{3}$");
+ * Regex::Match m;
+ *
+ * if (postcode.match (field, m)) {
+ *     String department = m.group (1);
+ * }
+ * @endcode
+ *
+ * Supported syntax:
+ * - literal bytes, '.' (any byte but '\\n'), classes such as [a-z_] or
+ *   [^0-9], and the escapes \\d \\w \\s \\D \\W \\S \\t \\n \\r \\f \\v \\xHH.
+ *   Other punctuation characters are escaped with a backslash.
+ * - alternation '|', groups '(...)' and non-capturing groups '(?:...)'.
+ * - repetitions '*', '+', '?', '{n}', '{n,}' and '{n,m}', greedy or lazy
+ *   (followed by '?').
+ * - anchors '^' and '$', matching at the start and end of the text only.
+ * Back-references and look-around assertions are not supported.
+ *
+ * Three engines cooperate:
+ * - a literal prefilter: the longest literal every match must contain is
+ *   extracted from the pattern and looked up with the vectorized memfind()
+ *   kernels first, so that most non-matching texts are rejected without
+ *   entering the automaton.
+ * - a lazy DFA: states are sets of NFA states, built on first use and
+ *   cached, so that each text byte costs a single table lookup. The cache
+ *   is flushed when full, and the DFA does not report captures.
+ * - a Pike VM, simulating the NFA with one thread per state, for the
+ *   captures. Matches follow Perl rules: the leftmost match, and among
+ *   those the one preferred by the order of alternatives and the greediness
+ *   of repetitions, a repetition ending at an iteration matching the empty
+ *   text. As in Go, repetitions nested in such a loop may still differ
+ *   from Perl, whose backtracking tries the same states again. find()
+ *   first locates the start of the leftmost match with the DFA of the
+ *   reversed pattern, scanning the text backwards, so that the Pike VM
+ *   only runs over the match.
+ * None of them backtracks: matching runs in linear time whatever the
+ * pattern. Buffers are allocated when the pattern is compiled, or the first
+ * time an engine is used: the matching loops themselves never allocate.
+ *
+ * Case insensitivity only applies to ASCII letters.
+ *
+ * As the DFA is built while matching, a Regex cannot be shared between
+ * threads: each thread must use its own copy.
+ */
+class Regex {
+public:
+	/// Matching modes.
+	enum Mode {
+		/// Bytes must be equal.
+		CASE_SENSITIVE,
+		/// ASCII letters match regardless of their case.
+		IGNORE_CASE
+	};
+
+	/// Maximum number of capturing groups, group 0 (the whole match) included.
+	static const size_t MAX_GROUPS = 16;
+
+	/// Maximum number of cached DFA states.
+	static const size_t MAX_DFA_STATES = 256;
+
+	/**
+	 * @class Regex::Match
+	 * The captures of a match. Groups are views on the matched text, which
+	 * must outlive the Match.
+	 */
+	class Match {
+		friend class Regex;
+
+		const char* base;
+		size_t count;
+		ssize_t offsets[2 * MAX_GROUPS];
+
+		void reset (const String& text, size_t groups);
+
+	public:
+		Match();
+
+		/// @return the number of groups of the pattern, group 0 included.
+		size_t groups() const {
+			return count;
+		}
+
+		/// @return true if a group took part in the match.
+		bool matched (size_t group = 0) const {
+			return (group < count && offsets[2 * group] >= 0 && offsets[2 * group + 1] >= 0);
+		}
+
+		/// @return the position of a group in the text, -1 if it did not take part in the match.
+		ssize_t start (size_t group = 0) const {
+			return matched (group) ? offsets[2 * group] : -1;
+		}
+
+		/// @return the position following a group in the text, -1 if it did not take part in the match.
+		ssize_t end (size_t group = 0) const {
+			return matched (group) ? offsets[2 * group + 1] : -1;
+		}
+
+		/// @return the text of a group, an empty String if it did not take part in the match.
+		String group (size_t group = 0) const;
+	};
+
+private:
+	class Program;
+
+	XString source;
+	Mode mode;
+	Program* program;
+	/// Program of the reversed pattern, finding where matches start.
+	Program* reverseProgram;
+
+	/// Literal every match contains, empty if none.
+	XString literal;
+	String::Searcher literalSearcher;
+
+	Regex& operator = (const Regex&);
+
+	void compile();
+	bool mayMatch (const String& text, size_t from) const;
+
+public:
+	/**
+	 * Compiles a pattern.
+	 * @param pattern the pattern. Its content is copied.
+	 * @param mode the matching mode.
+	 * @throw Exception if the pattern is invalid.
+	 */
+	explicit Regex (const String& pattern, Mode mode = CASE_SENSITIVE);
+
+	/// Compiles the pattern of another Regex, e.g. for another thread.
+	Regex (const Regex& r);
+
+	~Regex();
+
+	/// @return the pattern.
+	const String& pattern() const {
+		return source;
+	}
+
+	/// @return the matching mode.
+	Mode matchMode() const {
+		return mode;
+	}
+
+	/// @return the number of groups of the pattern, group 0 included.
+	size_t groups() const;
+
+	/// @return the literal the prefilter looks for, empty if none.
+	const String& requiredLiteral() const {
+		return literal;
+	}
+
+	/// @return true if the whole text matches the pattern.
+	bool matches (const String& text);
+
+	/// @return true if the pattern matches somewhere in the text.
+	bool contains (const String& text);
+
+	/**
+	 * Matches the whole text and gets the captures.
+	 * @param text the text.
+	 * @param m receives the captures.
+	 * @return true if the whole text matches the pattern.
+	 */
+	bool match (const String& text, Match& m);
+
+	/**
+	 * Looks for the leftmost match at or after a position. To iterate over
+	 * all matches, search again from m.end(), or from m.end() + 1 after an
+	 * empty match.
+	 *
+	 * @param text the text.
+	 * @param m receives the captures.
+	 * @param from the position the search starts from. '^' still only
+	 * matches at position 0.
+	 * @return true if a match was found.
+	 */
+	bool find (const String& text, Match& m, size_t from = 0);
+};
+
+} // namespace Fianet
+
+#endif // FIANET_REGEX_H
@@ -20,73 +20,19 @@
  */
 #include "fianet-core.h"
 #include "String.h"
+#include "ByteSearch.h"
+#include "CharSet.h"
+#include "NumberParsing.h"
 #include <cctype>
 #include <cstdlib>
-#include <errno.h>
 #include <stdint.h>
-#include <limits.h>
-
-// Adjust some function names depending on the bit size of the platform.
-#if (__WORDSIZE == 64)
-	#define strtoint	strtol
-	#define isIntOutOfRange(v) (v > INT_MAX || v < INT_MIN)
-
-	#define strtoint32	strtol
-	#define isInt32OutOfRange(v) (v > INT32_MAX || v < INT32_MIN)
-
-	#define strtouint32	strtoul
-	#define isUint32OutOfRange(v) (v > UINT32_MAX)
-
-	#define strtoint64	strtol
-	#define isInt64OutOfRange(v) (errno == ERANGE && (v == INT64_MAX || v == INT64_MIN))
-
-	#define strtouint64	strtoul
-	#define isUint64OutOfRange(v) (errno == ERANGE && (v == UINT64_MAX))
-#else
-	#define strtoint	strtol
-	#define isIntOutOfRange(v) (errno == ERANGE && (v == INT_MAX || v == INT_MIN))
-
-	#define strtoint32	strtol
-	#define isInt32OutOfRange(v) (errno == ERANGE && (v == INT32_MAX || v == INT32_MIN))
-
-	#define strtouint32	strtoul
-	#define isUint32OutOfRange(v) (errno == ERANGE && (v == UINT32_MAX))
-
-	#define strtoint64	strtoll
-	#define isInt64OutOfRange(v) (errno == ERANGE && (v == INT64_MAX || v == INT64_MIN))
-
-	#define strtouint64	strtoull
-	#define isUint64OutOfRange(v) (errno == ERANGE && (v == UINT64_MAX))
-#endif
 
 namespace Fianet {
 
 static const char* blank_str = "";
 
-// Look for s2 in s1
-uint8_t* memfind (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
-{
-	const uint8_t* ptr1 = static_cast<const uint8_t*>(s1);
-	const uint8_t* ptr2 = static_cast<const uint8_t*>(s2);
-	const uint8_t* end = ptr1 + len_s1;
-	ssize_t ln = len_s1;
-
-	while (ln > 0) {
-		ptr1 = (uint8_t*) memchr(ptr1, (int)*ptr2, ln);
-		if (!ptr1 || (end - ptr1) < static_cast<ssize_t>(len_s2))
-			break;  // Not found
-
-		if (memcmp(ptr1, ptr2, len_s2) == 0)
-			return const_cast<uint8_t*>(ptr1);
-
-		++ptr1;
-		ln = end - ptr1;
-	}
-
-	return 0;
-}
-// same but case-insensitive
-uint8_t* memifind (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
+// Case-insensitive search, with the current locale.
+uint8_t* memifind_locale (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
 {
 	const uint8_t* ptr1 = static_cast<const uint8_t*>(s1);
 	const uint8_t* ptr2 = static_cast<const uint8_t*>(s2);
@@ -114,8 +60,8 @@ uint8_t* memifind (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
 	return 0;
 }
 
-//
-int memicompare (const void* s1, const void* s2, size_t sz)
+// Case-insensitive compare, with the current locale.
+int memicompare_locale (const void* s1, const void* s2, size_t sz)
 {
 	const uint8_t* ptr1 = static_cast<const uint8_t*>(s1);
 	const uint8_t* ptr2 = static_cast<const uint8_t*>(s2);
@@ -139,17 +85,7 @@ String::~String()
 }
 
 String::String()
-	: ptr((uint8_t*)blank_str), len(0)
-{
-}
-
-String::String (const char* addr, size_t ln)
-	: ptr((uint8_t*)addr), len(ln)
-{
-}
-
-String::String (const String& s)
-	: ptr(s.ptr), len(s.len)
+	: StringView(blank_str, 0)
 {
 }
 
@@ -182,344 +118,245 @@ String& String::adopt (const String& src)
 	return *this;
 }
 
-bool String::equals (const String& s) const
+ssize_t StringView::findFirstOf (const CharSet& set, size_t from) const
 {
-	return ((&s == this) || (s.ptr == this->ptr) || (s.length() == length() && (length() == 0 || (std::memcmp (ptr, s.ptr, length()) == 0))));
+	if (from >= len) {
+		return -1;
+	}
+	const uint8_t* p = memcharset (ptr + from, len - from, set, true);
+	return p ? (p - ptr) : -1;
 }
 
-bool String::iequals (const String& s) const
+ssize_t StringView::findFirstNotOf (const CharSet& set, size_t from) const
 {
-	return ((&s == this) || (s.ptr == this->ptr) || (s.length() == length() && (length() == 0 || (memicompare (cstr(), s.cstr(), length()) == 0))));
+	if (from >= len) {
+		return -1;
+	}
+	const uint8_t* p = memcharset (ptr + from, len - from, set, false);
+	return p ? (p - ptr) : -1;
 }
 
-bool String::contains (const String& s) const
+ssize_t StringView::findLastOf (const CharSet& set) const
 {
-	return ((&s == this) || (s.ptr == this->ptr) || (length() > 0 && length() >= s.length() && (s.length() == 0 || memfind (bytes(), length(), s.ptr, s.length()) != 0)));
+	const uint8_t* p = memrcharset (ptr, len, set, true);
+	return p ? (p - ptr) : -1;
 }
 
-bool String::icontains (const String& s) const
+ssize_t StringView::findLastNotOf (const CharSet& set) const
 {
-	return ((&s == this) || (s.ptr == this->ptr) || (length() > 0 && length() >= s.length() && (s.length() == 0 || memifind (bytes(), length(), s.bytes(), s.length()) != 0)));
+	const uint8_t* p = memrcharset (ptr, len, set, false);
+	return p ? (p - ptr) : -1;
 }
 
-bool String::startsWith (const String& s) const
+StringView::MatchIterator::MatchIterator (const StringView& h, const StringView& n, Overlap m)
+	: hay(h.bytes()), hayLength(h.length()), needle(n.bytes()), needleLength(n.length()), mode(m), off1(0), off2(0), pos(-1)
 {
-	return ( (&s == this) || (s.ptr == this->ptr) || (length() >= s.length() && (s.length() == 0 || std::memcmp (ptr, s.ptr, s.length()) == 0)) );
+	if (needleLength > 0) {
+		memfindSelectBytes (needle, needleLength, off1, off2);
+		next (0);
+	}
 }
 
-bool String::istartsWith (const String& s) const
+void StringView::MatchIterator::next (size_t from)
 {
-	return ( (&s == this) || (s.ptr == this->ptr) || (length() >= s.length() && (s.length() == 0 || memicompare (bytes(), s.bytes(), s.length()) == 0)) );
-}
+	const uint8_t* p = 0;
 
-bool String::endsWith (const String& s) const
-{
-	return ((&s == this) || (s.ptr == this->ptr) || (length() >= s.length() && (s.length() == 0 || std::memcmp (bytes()+length()-s.length(), s.bytes(), s.length()) == 0)) );
-}
+	if (from + needleLength <= hayLength) {
+		if (needleLength == 1) {
+			p = static_cast<const uint8_t*>(memchr (hay + from, *needle, hayLength - from));
+		} else {
+			p = memfind_pair (hay + from, hayLength - from, needle, needleLength, off1, off2);
+		}
+	}
 
-bool String::iendsWith (const String& s) const
-{
-	return ( (&s == this) || (s.ptr == this->ptr) || (s.length() <= length() && (s.length() == 0 || memicompare (bytes()+length()-s.length(), s.bytes(), s.length()) == 0)) );
+	pos = p ? (p - hay) : -1;
 }
 
-int String::compareTo (const String& s) const
+size_t StringView::countOf (const StringView& needle, Overlap mode) const
 {
-	if (&s == this || s.ptr == this->ptr) {
-		return 0;
+	size_t nb = 0;
+	for (MatchIterator it (*this, needle, mode); it.valid(); ++it) {
+		++nb;
 	}
+	return nb;
+}
 
-	int res;
+namespace {
 
-	if (length() < s.length()) {
-		res = ::memcmp (cstr(), s.cstr(), length());
-		if (res == 0) {
-			return -1;
-		}
-	} else if (length() > s.length()) {
-		res = ::memcmp (cstr(), s.cstr(), s.length());
-		if (res == 0) {
-			return 1;
-		}
-	} else {
-		res = ::memcmp (cstr(), s.cstr(), length());
+/**
+ * Parses a signed integer whose absolute value cannot exceed max, or
+ * max + 1 when it is negative.
+ */
+ParseStatus parseSigned (const uint8_t* p, size_t len, uint64_t max, int64_t& value)
+{
+	uint64_t v;
+	bool negative;
+	const ParseStatus status = parseInteger (p, len, v, negative);
+
+	if (UNLIKELY(status != PARSE_OK)) {
+		return status;
+	}
+	if (UNLIKELY(v > max + negative)) {
+		return PARSE_RANGE_ERROR;
 	}
-	return res;
+	// Negated as an unsigned value, so that -2^63 does not overflow.
+	value = negative ? static_cast<int64_t>(0 - v) : static_cast<int64_t>(v);
+	return PARSE_OK;
 }
 
-int String::compareTo (const String& s, uint32_t nbChars) const
+/// Parses an unsigned integer that cannot exceed max. Only 0 may be negative.
+ParseStatus parseUnsigned (const uint8_t* p, size_t len, uint64_t max, uint64_t& value)
 {
-	if (&s == this || s.ptr == this->ptr) {
-		return 0;
-	}
-
-	uint32_t lenMax = (length() < s.length()) ? length() : s.length();
+	uint64_t v;
+	bool negative;
+	const ParseStatus status = parseInteger (p, len, v, negative);
 
-	if (nbChars > lenMax) {
-		nbChars = lenMax;
+	if (UNLIKELY(status != PARSE_OK)) {
+		return status;
 	}
-
-	return ::memcmp (cstr(), (const char*)s.cstr(), nbChars);
+	if (UNLIKELY(v > max || (negative && v != 0))) {
+		return PARSE_RANGE_ERROR;
+	}
+	value = v;
+	return PARSE_OK;
 }
 
+/// The exception of the to*() conversions for a failed status.
+void throwParseError (ParseStatus status, const char* rangeMessage = "NumberRangeError") NO_RETURN;
 
-int String::icompareTo (const String& s) const
+void throwParseError (ParseStatus status, const char* rangeMessage)
 {
-	if (&s == this || s.ptr == this->ptr) {
-		return 0;
+	if (status == PARSE_RANGE_ERROR) {
+		throw NumberRangeError (rangeMessage);
 	}
+	throw NumberFormatError();
+}
 
-	int res;
+} // namespace
 
-	if (length() < s.length()) {
-		res = memicompare (cstr(), s.cstr(), length());
-		if (res == 0) {
-			return -1;
-		}
-	} else if (length() > s.length()) {
-		res = memicompare (cstr(), s.cstr(), s.length());
-		if (res == 0) {
-			return 1;
-		}
-	} else {
-		res = memicompare (cstr(), s.cstr(), length());
+ParseStatus StringView::tryToInt (int& value) const
+{
+	int32_t v;
+	const ParseStatus status = tryToInt32 (v);
+	if (status == PARSE_OK) {
+		value = v;
 	}
-	return res;
+	return status;
 }
 
-
-
-int String::icompareTo (const String& s, uint32_t nbChars) const
+ParseStatus StringView::tryToInt32 (int32_t& value) const
 {
-	if (&s == this || s.ptr == this->ptr) {
-		return 0;
+	int64_t v;
+	const ParseStatus status = parseSigned (ptr, len, INT32_MAX, v);
+	if (LIKELY(status == PARSE_OK)) {
+		value = static_cast<int32_t>(v);
 	}
+	return status;
+}
 
-	uint32_t lenMax = (length() < s.length()) ? length() : s.length();
-
-	if (nbChars > lenMax) {
-		nbChars = lenMax;
+ParseStatus StringView::tryToUint32 (uint32_t& value) const
+{
+	uint64_t v;
+	const ParseStatus status = parseUnsigned (ptr, len, UINT32_MAX, v);
+	if (LIKELY(status == PARSE_OK)) {
+		value = static_cast<uint32_t>(v);
 	}
-
-	return (memicompare (cstr(), s.cstr(), nbChars));
+	return status;
 }
 
-ssize_t String::indexOfChar (char c) const
+ParseStatus StringView::tryToInt64 (int64_t& value) const
 {
-	const uint8_t* p = (uint8_t*) memchr (ptr, (int)c, len);
-	return (ssize_t) ((p) ? (p - ptr) : -1);
+	return parseSigned (ptr, len, INT64_MAX, value);
 }
 
-ssize_t String::indexOf (const String& s) const
+ParseStatus StringView::tryToUint64 (uint64_t& value) const
 {
-	if (s.length() == 0) {
-		return -1;
-	}
-
-	const uint8_t* p = (uint8_t*) memfind (ptr, len, s.ptr, s.len);
-	return (ssize_t) ((p) ? (p - ptr) : -1);
+	return parseUnsigned (ptr, len, UINT64_MAX, value);
 }
 
-ssize_t String::lastIndexOfChar (char c) const
+ParseStatus StringView::tryToFloat (double& value) const
 {
-	register const uint8_t* p = ptr + len - 1;
-
-	while (p >= ptr && *p != (uint8_t)c) {
-		--p;
+	double v;
+	const ParseStatus status = parseDouble (ptr, len, v);
+	if (LIKELY(status == PARSE_OK)) {
+		value = v;
 	}
-
-	return (p >= ptr && *p == (uint8_t)c) ? (p - ptr) : -1;
+	return status;
 }
 
-ssize_t String::lastIndexOf (const String& s) const
+ParseStatus StringView::tryToDecimal (unsigned scale, Decimal& value, char decimalSeparator, char groupSeparator) const
 {
-	if (s.length() > 0 && length() >= s.length()) {
-		char first = s.charAt(0);
-		register const uint8_t* p = ptr + len - s.length();
-		register const uint8_t* end = ptr + length();
-
-		while (p >= ptr) {
-
-			if (*p == first) {
-				if ( (end-p) >= static_cast<int32_t>(s.length()) && !memcmp(p, s.cstr(), s.length()) ) {
-					return (p-ptr);
-				}
-			}
-			--p;
-		}
+	int64_t mantissa;
+	const ParseStatus status = parseDecimal (ptr, len, scale, static_cast<uint8_t>(decimalSeparator),
+		static_cast<uint8_t>(groupSeparator), mantissa);
+	if (LIKELY(status == PARSE_OK)) {
+		value = Decimal (mantissa, scale);
 	}
-
-	return -1;
+	return status;
 }
 
-int32_t String::toInt() const
+int32_t StringView::toInt() const
 {
-	if (length() == 0) {
-		throw NumberFormatError();
-	}
-	char* endptr;
-	char tmp[256];
-	size_t lenmax = (sizeof(tmp) / sizeof(tmp[0])) - 1;
-
-	if (length() < lenmax) {
-		lenmax = length();
-	}
-	memcpy (tmp, ptr, lenmax);
-	*(tmp+lenmax) = 0;
-
-	errno = 0;
-	long value = strtol (tmp, &endptr, 0);
-
-	if (isInt32OutOfRange(value)) {
-		throw NumberRangeError();
-	} else if (errno == EINVAL || endptr == tmp || (size_t)(endptr-tmp) != length()) {
-		throw NumberFormatError();
-	}
-
-	return static_cast<int>(value);
+	return toInt32();
 }
 
-int32_t String::toInt32() const
+int32_t StringView::toInt32() const
 {
-	if (length() == 0) {
-		throw NumberFormatError();
-	}
-	char* endptr;
-	char tmp[256];
-	size_t lenmax = (sizeof(tmp) / sizeof(tmp[0])) - 1;
-
-	if (length() < lenmax) {
-		lenmax = length();
-	}
-	memcpy (tmp, ptr, lenmax);
-	*(tmp+lenmax) = 0;
-
-	errno = 0;
-	int32_t value = strtoint32 (tmp, &endptr, 0);
-
-	if (isInt32OutOfRange(value)) {
-		throw NumberRangeError();
-	} else if (errno == EINVAL || endptr == tmp || (size_t)(endptr-tmp) != length()) {
-		throw NumberFormatError();
+	int32_t value;
+	const ParseStatus status = tryToInt32 (value);
+	if (UNLIKELY(status != PARSE_OK)) {
+		throwParseError (status);
 	}
-
-	return static_cast<int32_t>(value);
+	return value;
 }
 
-uint32_t String::toUint32() const
+uint32_t StringView::toUint32() const
 {
-	if (length() == 0) {
-		throw NumberFormatError();
-	}
-	char* endptr;
-	char tmp[256];
-	size_t lenmax = (sizeof(tmp) / sizeof(tmp[0])) - 1;
-
-	if (length() < lenmax) {
-		lenmax = length();
-	}
-	memcpy (tmp, ptr, lenmax);
-	*(tmp+lenmax) = 0;
-
-	errno = 0;
-	uint32_t value = strtouint32 (tmp, &endptr, 0);
-
-	if (isUint32OutOfRange(value)) {
-		throw NumberRangeError();
-	} else if (errno == EINVAL || endptr == tmp || (size_t)(endptr-tmp) != length()) {
-		throw NumberFormatError();
-	} else {
-		// Contrairement � la libc, la conversion d'un nombre n�gatif d�clenche une erreur.
-		if (indexOfChar('-') >= 0 && value != 0) {
-			throw NumberRangeError();
-		}
+	uint32_t value;
+	const ParseStatus status = tryToUint32 (value);
+	if (UNLIKELY(status != PARSE_OK)) {
+		throwParseError (status);
 	}
-
-	return static_cast<uint32_t>(value);
+	return value;
 }
 
-int64_t String::toInt64() const
+int64_t StringView::toInt64() const
 {
-	if (length() == 0) {
-		throw NumberFormatError();
-	}
-	char* endptr;
-	char tmp[256];
-	size_t lenmax = (sizeof(tmp) / sizeof(tmp[0])) - 1;
-
-	if (length() < lenmax) {
-		lenmax = length();
+	int64_t value;
+	const ParseStatus status = tryToInt64 (value);
+	if (UNLIKELY(status != PARSE_OK)) {
+		throwParseError (status);
 	}
-	memcpy (tmp, ptr, lenmax);
-	*(tmp+lenmax) = 0;
-
-	errno = 0;
-	int64_t value = strtoint64 (tmp, &endptr, 0);
-
-	if (isInt64OutOfRange(value)) {
-		throw NumberRangeError();
-	} else if (errno == EINVAL || endptr == tmp || (size_t)(endptr-tmp) != length()) {
-		throw NumberFormatError();
-	}
-
-	return static_cast<int64_t>(value);
+	return value;
 }
 
-uint64_t String::toUint64() const
+uint64_t StringView::toUint64() const
 {
-	if (length() == 0) {
-		throw NumberFormatError();
-	}
-	char* endptr;
-	char tmp[256];
-	size_t lenmax = (sizeof(tmp) / sizeof(tmp[0])) - 1;
-
-	if (length() < lenmax) {
-		lenmax = length();
-	}
-	memcpy (tmp, ptr, lenmax);
-	*(tmp+lenmax) = 0;
-
-	errno = 0;
-	uint64_t value = strtouint64 (tmp, &endptr, 0);
-
-	if (isUint64OutOfRange(value)) {
-		throw NumberRangeError();
-	} else if (errno == EINVAL || endptr == tmp || (size_t)(endptr-tmp) != length()) {
-		throw NumberFormatError();
-	} else {
-		// Contrairement � la libc, la conversion d'un nombre n�gatif d�clenche une erreur.
-		if (indexOfChar('-') >= 0) {
-			throw NumberRangeError();
-		}
+	uint64_t value;
+	const ParseStatus status = tryToUint64 (value);
+	if (UNLIKELY(status != PARSE_OK)) {
+		throwParseError (status);
 	}
-
-	return static_cast<uint64_t>(value);
+	return value;
 }
 
-double String::toFloat() const
+double StringView::toFloat() const
 {
-	if (length() == 0) {
-		throw NumberFormatError();
-	}
-	char* endptr;
-	char tmp[256];
-	size_t lenmax = (sizeof(tmp) / sizeof(tmp[0])) - 1;
-
-	if (length() < lenmax) {
-		lenmax = length();
+	double value;
+	const ParseStatus status = tryToFloat (value);
+	if (UNLIKELY(status != PARSE_OK)) {
+		throwParseError (status, "toFloat() conversion failed.");
 	}
-	memcpy (tmp, ptr, lenmax);
-	*(tmp+lenmax) = 0;
-
-	errno = 0;
-	double value = strtod (tmp, &endptr);
+	return value;
+}
 
-	if (endptr != tmp+length() || errno == EINVAL) {
-		throw NumberFormatError();
-	} else if (errno == ERANGE) {
-		throw NumberRangeError("toFloat() conversion failed.");
+Decimal StringView::toDecimal (unsigned scale, char decimalSeparator, char groupSeparator) const
+{
+	Decimal value;
+	const ParseStatus status = tryToDecimal (scale, value, decimalSeparator, groupSeparator);
+	if (UNLIKELY(status != PARSE_OK)) {
+		throwParseError (status, "toDecimal() conversion failed.");
 	}
-
 	return value;
 }
 
@@ -527,19 +364,12 @@ double String::toFloat() const
 String& String::ltrim()
 {
 	if (len) {
-		const char* lptr = cstr();
-		const char* endptr = cstr()+len-1;
-		size_t newlen = len;
-
-		while (lptr <= endptr && isspace ((int)*lptr)) {
-			++lptr;
-			--newlen;
-		}
+		const size_t nb = memltrim (ptr, len);
 
-		if (newlen == 0) {
+		if (nb == len) {
 			len = 0;
-		} else {
-			adopt (lptr, newlen);
+		} else if (nb) {
+			adopt (cstr() + nb, len - nb);
 		}
 	}
 	return *this;
@@ -548,15 +378,7 @@ String& String::ltrim()
 String& String::rtrim()
 {
 	if (len) {
-		uint8_t* rptr = ptr+len-1;
-		size_t newlen = len;
-
-		while (rptr >= ptr && isspace ((int)*rptr)) {
-			--rptr;
-			--newlen;
-		}
-
-		len = newlen;
+		len -= memrtrim (ptr, len);
 	}
 	return *this;
 }
@@ -567,7 +389,7 @@ String& String::trim()
 	return ltrim();
 }
 
-const String String::substr (int start, int nbchars) const
+StringView StringView::substr (int start, int nbchars) const
 {
 	// start n�gatif -> on compte � partir de la fin.
 	if (start < 0) {
@@ -576,7 +398,7 @@ const String String::substr (int start, int nbchars) const
 
 	// D�but de cha�ne en dehors de notre zone -> cha�ne vide.
 	if (start < 0 || (start > static_cast<int>(length())) ) {
-		return String::blank();
+		return StringView();
 	}
 
 	int available = length() - start;
@@ -584,7 +406,7 @@ const String String::substr (int start, int nbchars) const
 	if (nbchars < 0) {
 		nbchars = available + nbchars;
 		if (nbchars < 0) {
-			return String::blank();
+			return StringView();
 		}
 	} else {
 		if (nbchars > available) {
@@ -592,10 +414,10 @@ const String String::substr (int start, int nbchars) const
 		}
 	}
 
-	return String (this->cstr()+start, nbchars);
+	return StringView (cstr()+start, nbchars);
 }
 
-const String String::substr (int start) const
+StringView StringView::substr (int start) const
 {
 	// start n�gatif -> on compte � partir de la fin.
 	if (start < 0) {
@@ -604,10 +426,10 @@ const String String::substr (int start) const
 
 	// D�but de cha�ne en dehors de notre zone -> cha�ne vide.
 	if (start < 0 || (start > static_cast<int>(length()))) {
-		return String::blank();
+		return StringView();
 	}
 
-	return String (this->cstr()+start, length()-start);
+	return StringView (cstr()+start, length()-start);
 }
 
 
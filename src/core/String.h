@@ -22,11 +22,14 @@
 #define FIANET_STRING_H
 
 #include "fianet-core.h"
+#include "StringView.h"
 
 #define CSTR(s)	String(s, (sizeof(s)/sizeof(char)-1))
 
 namespace Fianet {
 
+class XString;
+
 /**
  * @class String
  * Basic read-only string class. They basically are a char pointer and a length.
@@ -44,14 +47,16 @@ namespace Fianet {
  *
  * String objects can handle static C strings (e.g. const char* str = "hello")
  * and therefore handle the trailing NUL character.
+ *
+ * The read-only algorithms (comparisons, searches, conversions) are
+ * inherited from StringView, the non-virtual core of String. Functions that
+ * only read their argument should take a const StringView&.
  */
-class String {
-protected:
-	/// Address of our data.
-	uint8_t* ptr;
-	/// Number of bytes used by our data.
-	size_t len;
-
+// StringView has no virtual destructor: Strings must not be deleted through
+// a StringView pointer.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+class String : public StringView {
 public:
 	/**
 	 * Empty string.
@@ -86,6 +91,14 @@ public:
 	 */
 	String (const String& s);
 
+	/**
+	 * Constructs a String on the data of a StringView. No copy is made of
+	 * the data.
+	 *
+	 * @param s the source view.
+	 */
+	String (const StringView& s);
+
 	/**
 	 * Assignment. As with the copy constructor, the pointer and length
 	 * are copied, but no copy is made of the pointer content.
@@ -99,25 +112,6 @@ public:
 	 */
 	virtual ~String();
 
-	/**
-	 * Convenient read-only pointer access. 
-	 * @note Unlike std::string::c_str(), there is no guarantee to have a
-	 * NUL-terminated string! Use with caution!
-	 * @return the data pointer casted to a char*.
-	 */
-	const char* cstr() const;
-
-	/**
-	 * Convenient read-only pointer access.
-	 * @return the data pointer casted to a uint8_t.
-	 */
-	const uint8_t* bytes() const;
-
-	/**
-	 * @return the buffer length in bytes.
-	 */
-	size_t length() const;
-
 	/**
 	 * Removes whitespaces at the beginning of the pointed data.
 	 * 
@@ -167,156 +161,9 @@ public:
 	 */
 	virtual String& adopt (const String& src);
 
-	/**
-	 * Access a character at a given position with bounds checking.
-	 * @param pos the position to get the character from. Must be included in
-	 * the range [ 0 ... length() - 1]
-	 * @return the character.
-	 * @throw Exception when the position is out of bounds.
-	 */
-	char operator[] (size_t pos) const;
-
-	/**
-	 * Access a character at a given position with bounds checking.
-	 * @param pos the position to get the character from. Must be included in
-	 * the range [ 0 ... length() - 1]
-	 * @return the character.
-	 * @throw Exception when the position is out of bounds.
-	 */
-	char charAt (size_t pos) const;
-
-	/**
-	 * @return true if the data pointed by both strings is the same, using
-	 * byte comparison if necessary.
-	 */
-	bool equals (const String& s) const;
-
-	/**
-	 * See if a char is present in the String data.
-	 * @return true if c is found, false if not.
-	 */
-	bool containsChar (char c) const;
-
-	/**
-	 * See if current String data contains the data of an other String, using
-	 * byte comparison if necessary.
-	 * @param s the String that may be contained by *this instance.
-	 * @return true if *this contains s, false if not.
-	 */
-	bool contains (const String& s) const;
-
-	/**
-	 * See if current String data starts with the same bytes than an 
-	 * other String, using byte comparison if necessary.
-	 *
-	 * @param s the String to look for in *this instance.
-	 * @return true if *this starts with s, false if not.
-	 */
-	bool startsWith (const String& s) const;
-
-	/**
-	 * See if current String data ends with the same bytes than an
-	 * other String, using byte comparison if necessary.
-	 *
-	 * @param s the String to look for in *this instance.
-	 * @return true if *this starts with s, false if not.
-	 */
-	bool endsWith (const String& s) const;
-
-
-	/**
-	 * Compares two Strings.
-	 *
-	 * This function performs a binary comparison of the byte data contained
-	 * in the current instance buffer and in the given argument.
-	 *
-	 * @param s the String instance to compare to.
-	 *
-	 * @return 0 when the contents of both String objects are equal.
-	 * @return a number > 0 when the first character that does not match
-	 * has a greater value in the current instance than in s.
-	 * @return a number &lt; 0 when the first character that does not match
-	 * has a greater value in the current instance than in s.
-	 *
-	 * @see memcmp
-	 */
-	int compareTo (const String& s) const;
-
-	/**
-	 * Compares two Strings up to a given number of characters.
-	 *
-	 * This function performs a binary comparison of the byte data contained
-	 * in the current instance buffer and in the given argument.
-	 *
-	 * @param s the String instance to compare to.
-	 * @param nb the maximum number of bytes to compare.
-	 *
-	 * @return 0 when the contents of both String objects are equal.
-	 * @return a number > 0 when the first character that does not match
-	 * has a greater value in the current instance than in s.
-	 * @return a number &lt; 0 when the first character that does not match
-	 * has a greater value in the current instance than in s.
-	 *
-	 * @see memcmp
-	 */
-	int compareTo (const String& s, uint32_t nb) const;
-
-
-	/**
-	 * @return true if the data pointed by both strings is the same, using
-	 * case-insensitive comparison if necessary.
-	 */
-	bool iequals (const String& s) const;
-
-	/**
-	 * See if current String data contains the data of an other String, using
-	 * case-insensitive comparison.
-	 * 
-	 * @param s the String that may be contained by *this instance.
-	 * @return true if *this contains s, false if not.
-	 * @note results depends on the current locale.
-	 */
-	bool icontains (const String& s) const;
-
-	/**
-	 * See if current String data starts with the same bytes than an
-	 * other String, using case-insensitive comparison.
-	 *
-	 * @param s the String to look for in *this instance.
-	 * @return true if *this starts with s, false if not.
-	 * @note results depends on the current locale.
-	 */
-	bool istartsWith (const String& s) const;
-
-	/**
-	 * See if current String data ends with the same bytes than an
-	 * other String, using case-insensitive comparison.
-	 *
-	 * @param s the String to look for in *this instance.
-	 * @return true if *this starts with s, false if not.
-	 * @note results depends on the current locale.
-	 * @note results depends on the current locale.
-	 */
-	bool iendsWith (const String& s) const;
-
-	int icompareTo (const String& s, uint32_t nbChars) const;
-	int icompareTo (const String& s) const;
-
 	/**
 	 * Get a substring with zero-copy.
-	 *
-	 * @param offset is the beginning offset of the substring. The substring will
-	 *   - if offset is non negative, the extracted string begins at the [0+offset] position.
-	 *   - if offset is negative, the substring begins at the [length()+offset] position (e.g. counting is made from the end of the String buffer).
-	 *   - if offset is out of bounds (e.g. offset > length() or offset &lt; -length()), the returned String is empty (e.g. String::blank()).
-	 *
-	 * @param nb is the number of bytes of the desired substring, given that:
-	 *   - If nb is zero, the returned substring is String::blank().
-	 *   - If nb is non negative, the substring will contain at most nb bytes from the starting position.
-	 *   - If nb is negative, the substring will contain at most (length() - nb) bytes.
-	 *   - The calculated length cannot be larger than the String instance length, and cannot be negative.
-	 *     It is adjusted as necessary.
-	 *
+	 * @see StringView::substr(int, int)
 	 * @return a String instance with the extracted substring, or String::blank().
 	 */
 	const String substr (int offset, int nb) const;
@@ -324,158 +171,60 @@ public:
 	/**
 	 * Get a substring with zero-copy. The substring begins at a given position and
 	 * includes all the bytes up to the end of the pointed data.
-	 *
-	 * @param offset is the beginning offset of the substring. The substring will
-	 *   - If offset is non negative, the extracted string begins at the [0 + offset] position.
-	 *   - If offset is negative, the substring begins at the [length() + offset] position (e.g. counting is made from the end of the String buffer).
-	 *   - If offset is out of bounds (e.g. offset > length() or offset &lt; -length()), the returned String is empty (e.g. String::blank()).
+	 * @see StringView::substr(int)
 	 * @return a String instance with the extracted substring, or String::blank().
 	 */
 	const String substr (int offset) const;
 
 	/**
-	 * Substring search.
+	 * Decodes hexadecimal digits (either case) and appends the bytes to out.
 	 *
-	 * Gets the position of the first occurrence of a String within
-	 * the current instance.
+	 * Decoding is strict: an odd number of digits, or any other byte
+	 * (white spaces included), fails the whole conversion.
 	 *
-	 * @param s the String to look for in the current instance.
-	 * @return the position of the matching byte sequence that is looked for,
-	 * -1 if not found.
+	 * @param out receives the decoded bytes. It is left unchanged on failure.
+	 * @return true if the data was valid.
+	 * @see XString::appendHex (const String&, bool)
 	 */
-	ssize_t indexOf (const String& s) const;
+	bool decodeHexInto (XString& out) const;
 
 	/**
-	 * Character search.
+	 * Decodes base64 (RFC 4648, section 4) and appends the bytes to out.
 	 *
-	 * @param c the character to look for.
-	 * @return the position of the first occurrence of c in the String
-	 * data, -1 if not found.
-	 */
-	ssize_t indexOfChar (char c) const;
-
-	/**
-	 * Substring search from the end.
+	 * The data must be padded with '=' to a multiple of 4 characters, and
+	 * the unused bits of the last character must be 0, so that only the
+	 * canonical encoding of a value is accepted.
 	 *
-	 * Gets the position of the last occurrence of a String within
-	 * the current instance.
-	 *
-	 * @param s the String to look for in the current instance.
-	 * @return the last position of the 1st byte of s within the current instance
-	 * data, -1 if not found.
+	 * @param out receives the decoded bytes. It is left unchanged on failure.
+	 * @return true if the data was valid.
+	 * @see XString::appendBase64()
 	 */
-	ssize_t lastIndexOf (const String& s) const;
+	bool decodeBase64Into (XString& out) const;
 
 	/**
-	 * Character search.
-	 *
-	 * @param c the character to look for.
-	 * @return the position of the last occurrence of c in the String
-	 * data, -1 if not found.
+	 * Same as decodeBase64Into(), for the base64url alphabet (RFC 4648,
+	 * section 5: '-' and '_' instead of '+' and '/'). The padding is
+	 * optional, as JWT and most URL tokens leave it out.
 	 */
-	ssize_t lastIndexOfChar (char c) const;
+	bool decodeBase64UrlInto (XString& out) const;
 
 	/**
-	 * Converts the String data to an int value.
-	 *
-	 * The String content is interpreted as an integral number and returns the
-	 * corresponding value. The base in which the number is written
-	 * is determined automatically.
-	 *
-	 * @see strtol() and similar C functions.
-	 *
-	 * @return the integral value read from the String data.
-	 * @throw NumberRangeError when the value cannot fit in the range of the
-	 * desired type.
-	 * @throw NumberFormatError if an invalid character was encountered during
-	 * the conversion process.
+	 * Decodes base32 (RFC 4648, section 6: upper case letters and digits 2
+	 * to 7, padded with '=' to a multiple of 8 characters) and appends the
+	 * bytes to out. Same rules as decodeBase64Into().
 	 */
-	int toInt() const;
+	bool decodeBase32Into (XString& out) const;
 
 	/**
-	 * Converts the String data to an int32_t value.
-	 *
-	 * The String content is interpreted as an integral number and returns the
-	 * corresponding value. The base in which the number is written
-	 * is determined automatically.
-	 * 
-	 * @see strtol() and similar C functions.
+	 * Parses a UUID in its canonical form: 36 characters, 32 hexadecimal
+	 * digits (either case) in groups of 8, 4, 4, 4 and 12 separated by '-'.
 	 *
-	 * @return the integral value read from the String data.
-	 * @throw NumberRangeError when the value cannot fit in the range of the
-	 * desired type.
-	 * @throw NumberFormatError if an invalid character was encountered during
-	 * the conversion process.
+	 * @param uuid receives the 16 bytes of the UUID. It is left unchanged
+	 * on failure.
+	 * @return true if the data was a UUID.
+	 * @see XString::appendUuid()
 	 */
-	int32_t toInt32() const;
-
-	/**
-	 * Converts the String data to an uint32_t value.
-	 *
-	 * The String content is interpreted as an integral number and returns the
-	 * corresponding value. The base in which the number is written
-	 * is determined automatically.
-	 *
-	 * @see strtol() and similar C functions.
-	 *
-	 * @return the integral value read from the String data.
-	 * @throw NumberRangeError when the value cannot fit in the range of the
-	 * desired type.
-	 * @throw NumberFormatError if an invalid character was encountered during
-	 * the conversion process.
-	 */
-	uint32_t toUint32() const;
-
-	/**
-	 * Converts the String data to an int64_t value.
-	 *
-	 * The String content is interpreted as an integral number and returns the
-	 * corresponding value. The base in which the number is written
-	 * is determined automatically.
-	 *
-	 * @see strtol() and similar C functions.
-	 *
-	 * @return the integral value read from the String data.
-	 * @throw NumberRangeError when the value cannot fit in the range of the
-	 * desired type.
-	 * @throw NumberFormatError if an invalid character was encountered during
-	 * the conversion process.
-	 */
-	int64_t toInt64() const;
-
-	/**
-	 * Converts the String data to an uint64_t value.
-	 *
-	 * The String content is interpreted as an integral number and returns the
-	 * corresponding value. The base in which the number is written
-	 * is determined automatically.
-	 *
-	 * @see strtol() and similar C functions.
-	 *
-	 * @return the integral value read from the String data.
-	 * @throw NumberRangeError when the value cannot fit in the range of the
-	 * desired type.
-	 * @throw NumberFormatError if an invalid character was encountered during
-	 * the conversion process.
-	 */
-	uint64_t toUint64() const;
-
-	/**
-	 * Converts the String data to a double value.
-	 *
-	 * The String content is interpreted as a floating point number and returns
-	 * the corresponding value.
-	 *
-	 * @see strtod() and similar C functions.
-	 *
-	 * @return the floating point value read from the String data.
-	 * @throw NumberRangeError when the value cannot fit in the range of the
-	 * desired type.
-	 * @throw NumberFormatError if an invalid character was encountered during
-	 * the conversion process.
-	 */
-	double toFloat() const;
-
+	bool decodeUuid (uint8_t uuid[16]) const;
 
 	/**
 	 * @return a blank String with 0 length. Convenience function, the String()
@@ -491,62 +240,31 @@ public:
 	static const String& CRLF();
 
 	/**
-	 * Allows Strings to be used in STL containers, used for value comparison.
-	 */
-	struct Comparator {
-
-	 	bool operator() (const String& p1, const String& p2) const {
-			return (p1.compareTo(p2) < 0);
-		}
-		bool starts (const String& p1, const String& s2) const {
-			return p1.startsWith(s2);
-		}
-
-	};
-
-	/**
-	 * Allows Strings to be used in STL containers, used for case-insensitive
-	 * value comparison.
+	 * Precompiled substring searcher, for needles looked up many times.
+	 * @see StringSearcher.h
 	 */
-	struct IComparator {
-	 	bool operator() (const String& p1, const String& p2) const {
-			return (p1.icompareTo(p2) < 0);
-		}
-		bool starts (const String& p1, const String& s2) const {
-			return p1.istartsWith(s2);
-		}
-	};
+	class Searcher;
 };
+#pragma GCC diagnostic pop
 
 inline String::String (const char* c_str)
-	: ptr((uint8_t*)c_str), len(::strlen(c_str))
+	: StringView(c_str)
 { }
 
-inline String& 	String::operator = (const String& s) {
-	return this->adopt(s);
-}
-
-inline const char* String::cstr() const {
-	return (const char*) ptr;
-}
-
-inline const uint8_t* String::bytes() const {
-	return ptr;
-}
+inline String::String (const char* addr, size_t ln)
+	: StringView(addr, ln)
+{ }
 
-inline size_t String::length() const {
-	return len;
-}
+inline String::String (const String& s)
+	: StringView(s)
+{ }
 
-inline char String::charAt (uint32_t pos) const {
-	if (pos >= (uint32_t) length()) {
-		THROWF ("String::charAt(): index '%d' out of bounds.", (unsigned long) pos);
-	}
-	return (char) (*(ptr+pos));
-}
+inline String::String (const StringView& s)
+	: StringView(s)
+{ }
 
-inline char String::operator [] (uint32_t pos) const {
-	return charAt(pos);
+inline String& 	String::operator = (const String& s) {
+	return this->adopt(s);
 }
 
 inline String& String::clear() {
@@ -554,55 +272,14 @@ inline String& String::clear() {
 	return *this;
 }
 
-inline bool String::containsChar (char c) const {
-	return (indexOfChar (c) >= 0);
-}
-
-inline bool operator == (const String& s1, const String& s2) {
-	return (s1.equals(s2));
+inline const String String::substr (int offset, int nb) const {
+	return StringView::substr (offset, nb);
 }
 
-inline bool operator != (const String& s1, const String& s2) {
-	return (!s1.equals(s2));
+inline const String String::substr (int offset) const {
+	return StringView::substr (offset);
 }
 
-inline bool operator > (const String& s1, const String& s2) {
-	return (s1.compareTo(s2) > 0);
-}
-
-inline bool operator >= (const String& s1, const String& s2) {
-	return (s1.compareTo(s2) >= 0);
-}
-
-inline bool operator < (const String& s1, const String& s2) {
-	return (s1.compareTo(s2) < 0);
-}
-
-inline bool operator <= (const String& s1, const String& s2) {
-	return (s1.compareTo(s2) <= 0);
-}
-
-/**
- * Looks for the 1st occurrence of needle in haystack.
- * @return the address of the 1st haystack byte sequence that matches needle.
- * @return NULL if needle is not found in haystack.
- */
-uint8_t* memfind (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len);
-
-/**
- * Looks for the 1st occurrence of needle in haystack. case-insensitive variant.
- * @return the address of the 1st haystack byte sequence that matches needle.
- * @return NULL if needle is not found in haystack.
- */
-uint8_t* memifind (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len);
-
-
-/**
- * Compares two byte buffers in a "case-insensitive" way.
- * @see memcmp()
- */
-int memicompare (const void* s1, const void* s2, size_t sz);
-
 
 } // namespace Fianet
 
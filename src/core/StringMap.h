@@ -0,0 +1,619 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_STRINGMAP_H
+#define FIANET_STRINGMAP_H
+
+#include "fianet-core.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+namespace Fianet {
+
+/**
+ * @class StringMap
+ * A hash map from Strings to values of type T, stored in flat arrays.
+ *
+ * It replaces std::map<String, T, String::Comparator> for reference data
+ * (BIN tables, merchant categories, blacklists): a lookup hashes the key
+ * once, then usually compares a single key, instead of following a
+ * pointer and calling memcmp() at each level of a tree.
+ *
+ * @code
+ * StringMap<Category> categories;
+ * categories["5411"] = GROCERY;
+ *
+ * const Category* c = categories.find (record.mcc);
+ * if (c) { ... }
+ *
+ * for (StringMap<Category>::Iterator it (categories); it.valid(); ++it) {
+ *     ... it.key() ... it.value() ...
+ * }
+ * @endcode
+ *
+ * The table follows the "swiss table" design: slots are split in groups
+ * of 16, and a separate array holds one control byte per slot, either
+ * empty, deleted, or 7 bits of the hash of its key. A lookup compares the
+ * 16 control bytes of a group at once (with SSE2 when available), and only
+ * compares the keys of the slots whose 7 bits match. Slots store the full
+ * hash of their key, which is compared first, and never recomputed when the
+ * table grows. Groups are probed quadratically; the table grows when 7/8 of
+ * its slots are used.
+ *
+ * Keys are hashed with String::hash(), or String::ihash() for IGNORE_CASE
+ * maps, which then follow the folding rules selected by setCaseFolding():
+ * they must not change while the map holds keys.
+ *
+ * By default the bytes of the keys are copied in an arena owned by the
+ * map, released by clear() and the destructor. With BORROWED_KEYS the map
+ * only keeps views, and the keys must outlive it.
+ *
+ * Pointers to values are invalidated when the table grows. T must be
+ * copy-constructible, and default-constructible for operator [].
+ */
+template <class T>
+class StringMap {
+public:
+	/// Key matching modes.
+	enum Mode {
+		/// Keys are equal if their bytes are equal.
+		CASE_SENSITIVE,
+		/// Keys are equal if memicompare() finds them equal.
+		IGNORE_CASE
+	};
+
+	/// Storage of the keys.
+	enum Keys {
+		/// Keys are copied in the map.
+		OWNED_KEYS,
+		/// The map keeps views on the keys, which must outlive it.
+		BORROWED_KEYS
+	};
+
+	class Iterator;
+	class ConstIterator;
+
+private:
+	/// Slots per group, compared at once.
+	static const size_t GROUP_SIZE = 16;
+
+	/// Size of the arena blocks. Longer keys get a block of their own.
+	static const size_t ARENA_BLOCK_SIZE = 16 * 1024;
+
+	/// Control bytes. Used slots hold the low 7 bits of their hash.
+	enum {
+		EMPTY = 0x80,
+		DELETED = 0xFE
+	};
+
+	struct Slot {
+		const char* key;
+		size_t length;
+		uint64_t hash;
+		T value;
+	};
+
+	struct Block {
+		Block* next;
+	};
+
+	uint8_t* ctrl;
+	Slot* slots;
+	/// Number of slots: 0, or a power of 2 greater than or equal to GROUP_SIZE.
+	size_t capacity;
+	size_t count;
+	/// Number of empty slots that can still be used before growing.
+	size_t growthLeft;
+	Mode mode;
+	Keys keys;
+
+	Block* blocks;
+	char* arenaPtr;
+	size_t arenaLeft;
+
+	StringMap (const StringMap&);
+	StringMap& operator = (const StringMap&);
+
+	/// @return a bit per slot of a group whose control byte is c.
+	static unsigned matchByte (const uint8_t* group, uint8_t c) {
+#if defined(__SSE2__)
+		const __m128i bytes = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(group));
+		return static_cast<unsigned>(_mm_movemask_epi8 (_mm_cmpeq_epi8 (bytes, _mm_set1_epi8 (static_cast<char>(c)))));
+#else
+		unsigned mask = 0;
+		for (unsigned i = 0; i < GROUP_SIZE; ++i) {
+			mask |= static_cast<unsigned>(group[i] == c) << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// @return a bit per empty or deleted slot of a group.
+	static unsigned matchFree (const uint8_t* group) {
+#if defined(__SSE2__)
+		return static_cast<unsigned>(_mm_movemask_epi8 (_mm_loadu_si128 (reinterpret_cast<const __m128i*>(group))));
+#else
+		unsigned mask = 0;
+		for (unsigned i = 0; i < GROUP_SIZE; ++i) {
+			mask |= static_cast<unsigned>(group[i] >> 7) << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// @return the slots the table can use before growing.
+	static size_t maxLoad (size_t slots) {
+		return slots - slots / 8;
+	}
+
+	static void* allocate (size_t size) {
+		void* addr = std::malloc (size);
+		if (!addr && size) {
+			THROW ("StringMap: malloc() returned NULL");
+		}
+		return addr;
+	}
+
+	uint64_t hashOf (const String& key) const {
+		return (mode == IGNORE_CASE) ? key.ihash() : key.hash();
+	}
+
+	bool keyEquals (const Slot& s, const String& key, uint64_t h) const {
+		if (s.hash != h || s.length != key.length()) {
+			return false;
+		} else if (s.length == 0) {
+			return true;
+		} else if (mode == IGNORE_CASE) {
+			return (memicompare (s.key, key.cstr(), s.length) == 0);
+		}
+		return (std::memcmp (s.key, key.cstr(), s.length) == 0);
+	}
+
+	/// @return the slot of a key, NULL if it is not in the map.
+	Slot* lookup (const String& key, uint64_t h) const {
+		if (count == 0) {
+			return 0;
+		}
+		const size_t groupMask = capacity / GROUP_SIZE - 1;
+		const uint8_t tag = static_cast<uint8_t>(h & 0x7F);
+
+		size_t g = static_cast<size_t>(h >> 7) & groupMask;
+		for (size_t step = 1; ; g = (g + step++) & groupMask) {
+			const uint8_t* group = ctrl + g * GROUP_SIZE;
+			for (unsigned m = matchByte (group, tag); m; m &= m - 1) {
+				Slot* s = slots + g * GROUP_SIZE + __builtin_ctz (m);
+				if (keyEquals (*s, key, h)) {
+					return s;
+				}
+			}
+			if (matchByte (group, EMPTY)) {
+				return 0;
+			}
+		}
+	}
+
+	/// @return the first empty or deleted slot on the probe sequence of a hash.
+	size_t freeSlot (uint64_t h) const {
+		const size_t groupMask = capacity / GROUP_SIZE - 1;
+
+		size_t g = static_cast<size_t>(h >> 7) & groupMask;
+		for (size_t step = 1; ; g = (g + step++) & groupMask) {
+			const unsigned m = matchFree (ctrl + g * GROUP_SIZE);
+			if (m) {
+				return g * GROUP_SIZE + __builtin_ctz (m);
+			}
+		}
+	}
+
+	/// Moves all entries to a table of another capacity.
+	void rehash (size_t newCapacity) {
+		uint8_t* newCtrl = static_cast<uint8_t*>(allocate (newCapacity));
+		Slot* newSlots;
+		try {
+			newSlots = static_cast<Slot*>(allocate (newCapacity * sizeof(Slot)));
+		} catch (...) {
+			std::free (newCtrl);
+			throw;
+		}
+		std::memset (newCtrl, EMPTY, newCapacity);
+
+		uint8_t* oldCtrl = ctrl;
+		Slot* oldSlots = slots;
+		const size_t oldCapacity = capacity;
+		ctrl = newCtrl;
+		slots = newSlots;
+		capacity = newCapacity;
+
+		size_t i = 0;
+		try {
+			for (; i < oldCapacity; ++i) {
+				if (oldCtrl[i] < EMPTY) {
+					const Slot& from = oldSlots[i];
+					const size_t to = freeSlot (from.hash);
+					new (&newSlots[to].value) T (from.value);
+					newSlots[to].key = from.key;
+					newSlots[to].length = from.length;
+					newSlots[to].hash = from.hash;
+					newCtrl[to] = oldCtrl[i];
+				}
+			}
+		} catch (...) {
+			// Keep the old table.
+			for (size_t k = 0; k < newCapacity; ++k) {
+				if (newCtrl[k] < EMPTY) {
+					newSlots[k].value.~T();
+				}
+			}
+			std::free (newCtrl);
+			std::free (newSlots);
+			ctrl = oldCtrl;
+			slots = oldSlots;
+			capacity = oldCapacity;
+			throw;
+		}
+
+		for (i = 0; i < oldCapacity; ++i) {
+			if (oldCtrl[i] < EMPTY) {
+				oldSlots[i].value.~T();
+			}
+		}
+		std::free (oldCtrl);
+		std::free (oldSlots);
+		growthLeft = maxLoad (capacity) - count;
+	}
+
+	/// @return a copy of a key in the arena.
+	const char* copyKey (const String& key) {
+		const size_t len = key.length();
+		if (len == 0) {
+			return "";
+		}
+		char* res;
+		if (len > ARENA_BLOCK_SIZE / 4) {
+			Block* b = static_cast<Block*>(allocate (sizeof(Block) + len));
+			b->next = blocks ? blocks->next : 0;
+			if (blocks) {
+				blocks->next = b;
+			} else {
+				blocks = b;
+			}
+			res = reinterpret_cast<char*>(b + 1);
+		} else {
+			if (len > arenaLeft) {
+				Block* b = static_cast<Block*>(allocate (sizeof(Block) + ARENA_BLOCK_SIZE));
+				b->next = blocks;
+				blocks = b;
+				arenaPtr = reinterpret_cast<char*>(b + 1);
+				arenaLeft = ARENA_BLOCK_SIZE;
+			}
+			res = arenaPtr;
+			arenaPtr += len;
+			arenaLeft -= len;
+		}
+		std::memcpy (res, key.cstr(), len);
+		return res;
+	}
+
+	void releaseArena() {
+		while (blocks) {
+			Block* next = blocks->next;
+			std::free (blocks);
+			blocks = next;
+		}
+		arenaPtr = 0;
+		arenaLeft = 0;
+	}
+
+	void destroyValues() {
+		for (size_t i = 0; i < capacity; ++i) {
+			if (ctrl[i] < EMPTY) {
+				slots[i].value.~T();
+			}
+		}
+	}
+
+	/**
+	 * Finds the slot of a key, or prepares one.
+	 * @param inserted set to true if the key was not in the map: the value
+	 * of the returned slot is then not constructed yet.
+	 */
+	Slot* prepare (const String& key, uint64_t h, bool& inserted) {
+		Slot* s = lookup (key, h);
+		if (s) {
+			inserted = false;
+			return s;
+		}
+
+		if (growthLeft == 0) {
+			// Reclaim deleted slots if they are many, otherwise grow.
+			const size_t target = (capacity == 0) ? GROUP_SIZE
+				: (count < capacity / 2) ? capacity : 2 * capacity;
+			rehash (target);
+		}
+
+		const size_t i = freeSlot (h);
+		s = slots + i;
+		s->key = (keys == OWNED_KEYS) ? copyKey (key) : key.cstr();
+		s->length = key.length();
+		s->hash = h;
+		inserted = true;
+		return s;
+	}
+
+	/// Marks a slot prepared for a new key as used, once its value is constructed.
+	void commit (Slot* s) {
+		const size_t i = s - slots;
+		if (ctrl[i] == EMPTY) {
+			--growthLeft;
+		}
+		ctrl[i] = static_cast<uint8_t>(s->hash & 0x7F);
+		++count;
+	}
+
+public:
+	/**
+	 * Creates an empty map. No memory is allocated before the first insertion.
+	 * @param m the key matching mode.
+	 * @param k the storage of the keys.
+	 */
+	explicit StringMap (Mode m = CASE_SENSITIVE, Keys k = OWNED_KEYS)
+		: ctrl(0), slots(0), capacity(0), count(0), growthLeft(0), mode(m), keys(k),
+		  blocks(0), arenaPtr(0), arenaLeft(0)
+	{ }
+
+	~StringMap() {
+		destroyValues();
+		std::free (ctrl);
+		std::free (slots);
+		releaseArena();
+	}
+
+	/// @return the number of keys.
+	size_t size() const {
+		return count;
+	}
+
+	/// @return true if the map holds no key.
+	bool empty() const {
+		return (count == 0);
+	}
+
+	/// @return the key matching mode.
+	Mode matchMode() const {
+		return mode;
+	}
+
+	/**
+	 * Makes room for a number of keys, so that inserting them does not
+	 * rehash the table.
+	 * @param n the number of keys.
+	 */
+	void reserve (size_t n) {
+		size_t target = GROUP_SIZE;
+		while (maxLoad (target) < n) {
+			target *= 2;
+		}
+		if (target > capacity) {
+			rehash (target);
+		}
+	}
+
+	/**
+	 * Looks up a key.
+	 * @param key the key. const char*, String and XString keys are all
+	 * looked up without copy.
+	 * @return the value of the key, NULL if it is not in the map.
+	 */
+	T* find (const String& key) {
+		Slot* s = lookup (key, hashOf (key));
+		return s ? &s->value : 0;
+	}
+
+	/// @see find()
+	const T* find (const String& key) const {
+		const Slot* s = lookup (key, hashOf (key));
+		return s ? &s->value : 0;
+	}
+
+	/**
+	 * Looks up a key whose hash is already known.
+	 * @param key the key. Its cached hash is used in CASE_SENSITIVE mode.
+	 * @return the value of the key, NULL if it is not in the map.
+	 */
+	T* find (const HashedString& key) {
+		Slot* s = lookup (key.str(), (mode == IGNORE_CASE) ? key.str().ihash() : key.hash());
+		return s ? &s->value : 0;
+	}
+
+	/// @see find()
+	const T* find (const HashedString& key) const {
+		const Slot* s = lookup (key.str(), (mode == IGNORE_CASE) ? key.str().ihash() : key.hash());
+		return s ? &s->value : 0;
+	}
+
+	/// @return true if a key is in the map.
+	bool contains (const String& key) const {
+		return (lookup (key, hashOf (key)) != 0);
+	}
+
+	/**
+	 * Inserts a key, if it is not in the map yet.
+	 * @param key the key.
+	 * @param value its value.
+	 * @return true if the key was inserted, false if it was already in the
+	 * map: its value is then left unchanged.
+	 */
+	bool insert (const String& key, const T& value) {
+		bool inserted;
+		Slot* s = prepare (key, hashOf (key), inserted);
+		if (inserted) {
+			new (&s->value) T (value);
+			commit (s);
+		}
+		return inserted;
+	}
+
+	/**
+	 * Accesses the value of a key, inserting the key with a
+	 * default-constructed value if it is not in the map.
+	 */
+	T& operator [] (const String& key) {
+		bool inserted;
+		Slot* s = prepare (key, hashOf (key), inserted);
+		if (inserted) {
+			new (&s->value) T();
+			commit (s);
+		}
+		return s->value;
+	}
+
+	/**
+	 * Removes a key. The bytes of owned keys are only released by clear().
+	 * @return true if the key was in the map.
+	 */
+	bool erase (const String& key) {
+		Slot* s = lookup (key, hashOf (key));
+		if (!s) {
+			return false;
+		}
+		const size_t i = s - slots;
+		s->value.~T();
+		// Lookups stop at groups with an empty slot: if this one has one, no
+		// key was placed beyond it because of this slot.
+		if (matchByte (ctrl + (i & ~(GROUP_SIZE - 1)), EMPTY)) {
+			ctrl[i] = EMPTY;
+			++growthLeft;
+		} else {
+			ctrl[i] = DELETED;
+		}
+		--count;
+		return true;
+	}
+
+	/// Removes all keys. The table keeps its capacity.
+	void clear() {
+		destroyValues();
+		if (capacity) {
+			std::memset (ctrl, EMPTY, capacity);
+		}
+		count = 0;
+		growthLeft = capacity ? maxLoad (capacity) : 0;
+		releaseArena();
+	}
+
+	/**
+	 * @class StringMap::Iterator
+	 * Walks through the entries of a map, in no particular order. The map
+	 * must not be modified, but through value(), while in use.
+	 */
+	class Iterator {
+		StringMap* map;
+		size_t pos;
+
+		void skip() {
+			while (pos < map->capacity && map->ctrl[pos] >= EMPTY) {
+				++pos;
+			}
+		}
+
+	public:
+		explicit Iterator (StringMap& m)
+			: map(&m), pos(0)
+		{
+			skip();
+		}
+
+		/// @return true if the iterator is on an entry.
+		bool valid() const {
+			return (pos < map->capacity);
+		}
+
+		/// @return the key of the current entry.
+		String key() const {
+			return String (map->slots[pos].key, map->slots[pos].length);
+		}
+
+		/// @return the value of the current entry.
+		T& value() const {
+			return map->slots[pos].value;
+		}
+
+		/// Moves to the next entry.
+		Iterator& operator ++() {
+			++pos;
+			skip();
+			return *this;
+		}
+	};
+
+	/**
+	 * @class StringMap::ConstIterator
+	 * Iterator on a const map.
+	 */
+	class ConstIterator {
+		const StringMap* map;
+		size_t pos;
+
+		void skip() {
+			while (pos < map->capacity && map->ctrl[pos] >= EMPTY) {
+				++pos;
+			}
+		}
+
+	public:
+		explicit ConstIterator (const StringMap& m)
+			: map(&m), pos(0)
+		{
+			skip();
+		}
+
+		/// @return true if the iterator is on an entry.
+		bool valid() const {
+			return (pos < map->capacity);
+		}
+
+		/// @return the key of the current entry.
+		String key() const {
+			return String (map->slots[pos].key, map->slots[pos].length);
+		}
+
+		/// @return the value of the current entry.
+		const T& value() const {
+			return map->slots[pos].value;
+		}
+
+		/// Moves to the next entry.
+		ConstIterator& operator ++() {
+			++pos;
+			skip();
+			return *this;
+		}
+	};
+};
+
+} // namespace Fianet
+
+#endif // FIANET_STRINGMAP_H
@@ -0,0 +1,382 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "fianet-core.h"
+#include "StringPool.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace Fianet {
+
+namespace {
+
+/// log2 (StringPool::SHARDS). The shard is given by the top bits of the hash.
+const unsigned SHARD_BITS = 4;
+typedef char ShardBitsCheck[((1u << SHARD_BITS) == StringPool::SHARDS) ? 1 : -1];
+
+/// Maximum number of strings per shard, so that ids fit in 32 bits.
+const uint32_t MAX_SHARD_STRINGS = (1u << (32 - SHARD_BITS)) - 1;
+
+/// Initial capacity of the hash tables and id indexes.
+const size_t INITIAL_CAPACITY = 64;
+
+template <class T>
+inline T* loadAcquire (T* const& p)
+{
+	return __atomic_load_n (&p, __ATOMIC_ACQUIRE);
+}
+
+template <class T>
+inline void storeRelease (T*& p, T* v)
+{
+	__atomic_store_n (&p, v, __ATOMIC_RELEASE);
+}
+
+void* allocate (size_t size)
+{
+	void* addr = std::malloc (size);
+	if (!addr) {
+		THROW ("StringPool: malloc() returned NULL");
+	}
+	return addr;
+}
+
+/// Locks a mutex for the lifetime of the object.
+class MutexLock {
+	pthread_mutex_t& mutex;
+
+	MutexLock (const MutexLock&);
+	MutexLock& operator = (const MutexLock&);
+
+public:
+	explicit MutexLock (pthread_mutex_t& m)
+		: mutex(m)
+	{
+		pthread_mutex_lock (&mutex);
+	}
+
+	~MutexLock() {
+		pthread_mutex_unlock (&mutex);
+	}
+};
+
+} // namespace
+
+/// A pooled string, followed by its bytes and a NUL byte.
+struct StringPool::Entry {
+	uint64_t hash;
+	uint32_t id;
+	uint32_t length;
+
+	const char* data() const {
+		return reinterpret_cast<const char*>(this + 1);
+	}
+};
+
+/**
+ * An array of entries, used both as the open addressing hash table of a
+ * shard (capacity is a power of 2, at most half full) and as its index by
+ * id. Replaced arrays are kept in the 'previous' list.
+ */
+struct StringPool::Table {
+	Table* previous;
+	size_t capacity;
+	const Entry* items[1];
+
+	static Table* create (size_t capacity, Table* previous) {
+		Table* t = static_cast<Table*>(allocate (bytes (capacity)));
+		t->previous = previous;
+		t->capacity = capacity;
+		std::memset (t->items, 0, capacity * sizeof(const Entry*));
+		return t;
+	}
+
+	static size_t bytes (size_t capacity) {
+		return sizeof(Table) + (capacity - 1) * sizeof(const Entry*);
+	}
+
+	static void destroy (Table* t) {
+		while (t) {
+			Table* previous = t->previous;
+			std::free (t);
+			t = previous;
+		}
+	}
+};
+
+/// Storage for entries, followed by its bytes.
+struct StringPool::Slab {
+	Slab* next;
+	size_t size;
+	size_t used;
+
+	char* data() {
+		return reinterpret_cast<char*>(this + 1);
+	}
+};
+
+/// A shard, on its own cache lines.
+struct StringPool::Shard {
+	pthread_mutex_t mutex;
+	/// The hash table. Atomic.
+	Table* table;
+	/// The entries by id. Atomic.
+	Table* index;
+	/// Number of entries. Atomic.
+	uint32_t count;
+	/// Slabs, the one being filled first.
+	Slab* slabs;
+	/// Bytes allocated. Atomic.
+	size_t memory;
+
+	void init() {
+		table = index = 0;
+		count = 0;
+		slabs = 0;
+		memory = 0;
+		pthread_mutex_init (&mutex, 0);
+		table = Table::create (INITIAL_CAPACITY, 0);
+		index = Table::create (INITIAL_CAPACITY, 0);
+		memory = 2 * Table::bytes (INITIAL_CAPACITY);
+	}
+
+	void destroy() {
+		Table::destroy (table);
+		Table::destroy (index);
+		while (slabs) {
+			Slab* next = slabs->next;
+			std::free (slabs);
+			slabs = next;
+		}
+		pthread_mutex_destroy (&mutex);
+	}
+
+	/// @return room for an entry of a given size. Called with the lock held.
+	Entry* allocateEntry (size_t size) {
+		size = (size + 7) & ~static_cast<size_t>(7);
+
+		if (size > SLAB_SIZE / 4) {
+			// A slab of its own, behind the one being filled.
+			Slab* slab = static_cast<Slab*>(allocate (sizeof(Slab) + size));
+			slab->size = slab->used = size;
+			if (slabs) {
+				slab->next = slabs->next;
+				slabs->next = slab;
+			} else {
+				slab->next = 0;
+				slabs = slab;
+			}
+			__atomic_add_fetch (&memory, sizeof(Slab) + size, __ATOMIC_RELAXED);
+			return reinterpret_cast<Entry*>(slab->data());
+		}
+
+		if (!slabs || slabs->used + size > slabs->size) {
+			Slab* slab = static_cast<Slab*>(allocate (sizeof(Slab) + SLAB_SIZE));
+			slab->size = SLAB_SIZE;
+			slab->used = 0;
+			slab->next = slabs;
+			slabs = slab;
+			__atomic_add_fetch (&memory, sizeof(Slab) + SLAB_SIZE, __ATOMIC_RELAXED);
+		}
+		Entry* e = reinterpret_cast<Entry*>(slabs->data() + slabs->used);
+		slabs->used += size;
+		return e;
+	}
+} __attribute__ ((aligned (64)));
+
+StringPool::StringPool()
+	: shards(0)
+{
+	void* addr;
+	if (posix_memalign (&addr, 64, SHARDS * sizeof(Shard)) != 0) {
+		THROW ("StringPool: posix_memalign() failed");
+	}
+	shards = static_cast<Shard*>(addr);
+
+	size_t ready = 0;
+	try {
+		for (; ready < SHARDS; ++ready) {
+			shards[ready].init();
+		}
+	} catch (...) {
+		// The shard that threw can be destroyed too.
+		for (size_t i = 0; i <= ready && i < SHARDS; ++i) {
+			shards[i].destroy();
+		}
+		std::free (shards);
+		throw;
+	}
+}
+
+StringPool::~StringPool()
+{
+	for (size_t i = 0; i < SHARDS; ++i) {
+		shards[i].destroy();
+	}
+	std::free (shards);
+}
+
+const StringPool::Entry* StringPool::lookup (const Shard& shard, const String& s, uint64_t h) const
+{
+	const Table* t = loadAcquire (shard.table);
+	const size_t mask = t->capacity - 1;
+
+	for (size_t i = static_cast<size_t>(h) & mask; ; i = (i + 1) & mask) {
+		const Entry* e = loadAcquire (t->items[i]);
+		if (!e) {
+			return 0;
+		}
+		if (e->hash == h && e->length == s.length()
+				&& (e->length == 0 || std::memcmp (e->data(), s.cstr(), s.length()) == 0)) {
+			return e;
+		}
+	}
+}
+
+const StringPool::Entry* StringPool::insert (Shard& shard, const String& s, uint64_t h)
+{
+	MutexLock lock (shard.mutex);
+
+	// Another thread may have inserted it since the lock-free lookup.
+	const Entry* found = lookup (shard, s, h);
+	if (found) {
+		return found;
+	}
+
+	const uint32_t n = shard.count;
+	if (n == MAX_SHARD_STRINGS) {
+		THROW ("StringPool: too many strings");
+	}
+	if (s.length() > UINT32_MAX - sizeof(Entry) - 8) {
+		THROW ("StringPool: string too long");
+	}
+
+	// Grow first, so that nothing is published if an allocation fails.
+	Table* index = shard.index;
+	if (n == index->capacity) {
+		Table* bigger = Table::create (2 * index->capacity, index);
+		std::memcpy (bigger->items, index->items, n * sizeof(const Entry*));
+		__atomic_add_fetch (&shard.memory, Table::bytes (bigger->capacity), __ATOMIC_RELAXED);
+		storeRelease (shard.index, bigger);
+		index = bigger;
+	}
+
+	Table* table = shard.table;
+	if (2 * (n + 1) > table->capacity) {
+		Table* bigger = Table::create (2 * table->capacity, table);
+		const size_t mask = bigger->capacity - 1;
+		for (uint32_t k = 0; k < n; ++k) {
+			const Entry* e = index->items[k];
+			size_t i = static_cast<size_t>(e->hash) & mask;
+			while (bigger->items[i]) {
+				i = (i + 1) & mask;
+			}
+			bigger->items[i] = e;
+		}
+		__atomic_add_fetch (&shard.memory, Table::bytes (bigger->capacity), __ATOMIC_RELAXED);
+		storeRelease (shard.table, bigger);
+		table = bigger;
+	}
+
+	Entry* e = shard.allocateEntry (sizeof(Entry) + s.length() + 1);
+	e->hash = h;
+	e->id = ((n << SHARD_BITS) | static_cast<uint32_t>(&shard - shards)) + 1;
+	e->length = static_cast<uint32_t>(s.length());
+	char* data = reinterpret_cast<char*>(e + 1);
+	if (s.length()) {
+		std::memcpy (data, s.cstr(), s.length());
+	}
+	data[s.length()] = '\0';
+
+	// Publish the entry: the release stores make its content visible first.
+	index->items[n] = e;
+	__atomic_store_n (&shard.count, n + 1, __ATOMIC_RELEASE);
+
+	const size_t mask = table->capacity - 1;
+	size_t i = static_cast<size_t>(h) & mask;
+	while (table->items[i]) {
+		i = (i + 1) & mask;
+	}
+	storeRelease (table->items[i], static_cast<const Entry*>(e));
+
+	return e;
+}
+
+Symbol StringPool::intern (const String& s)
+{
+	const uint64_t h = s.hash();
+	Shard& shard = shards[h >> (64 - SHARD_BITS)];
+
+	const Entry* e = lookup (shard, s, h);
+	if (!e) {
+		e = insert (shard, s, h);
+	}
+	return Symbol (e->id, String (e->data(), e->length));
+}
+
+bool StringPool::find (const String& s, Symbol& sym) const
+{
+	const uint64_t h = s.hash();
+	const Entry* e = lookup (shards[h >> (64 - SHARD_BITS)], s, h);
+
+	if (!e) {
+		return false;
+	}
+	sym = Symbol (e->id, String (e->data(), e->length));
+	return true;
+}
+
+Symbol StringPool::symbol (uint32_t id) const
+{
+	if (id == 0) {
+		THROW ("StringPool: invalid symbol id 0");
+	}
+	const Shard& shard = shards[(id - 1) & (SHARDS - 1)];
+	const uint32_t n = (id - 1) >> SHARD_BITS;
+
+	// The index is published before the count: if the count covers n, the
+	// index loaded next holds entry n.
+	if (n >= __atomic_load_n (&shard.count, __ATOMIC_ACQUIRE)) {
+		THROWF ("StringPool: unknown symbol id %u", id);
+	}
+	const Entry* e = loadAcquire (shard.index)->items[n];
+	return Symbol (e->id, String (e->data(), e->length));
+}
+
+size_t StringPool::size() const
+{
+	size_t total = 0;
+	for (size_t i = 0; i < SHARDS; ++i) {
+		total += __atomic_load_n (&shards[i].count, __ATOMIC_RELAXED);
+	}
+	return total;
+}
+
+size_t StringPool::memoryUsage() const
+{
+	size_t total = sizeof(Shard) * SHARDS;
+	for (size_t i = 0; i < SHARDS; ++i) {
+		total += __atomic_load_n (&shards[i].memory, __ATOMIC_RELAXED);
+	}
+	return total;
+}
+
+} // namespace Fianet
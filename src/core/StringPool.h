@@ -0,0 +1,185 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_STRINGPOOL_H
+#define FIANET_STRINGPOOL_H
+
+#include "fianet-core.h"
+#include <pthread.h>
+
+namespace Fianet {
+
+/**
+ * @class Symbol
+ * A string interned in a StringPool: a 32-bit id and a view on the pooled
+ * copy of the string.
+ *
+ * Two Symbols of the same pool are equal if and only if their ids are, so
+ * that comparing them costs an integer comparison. Their views also point
+ * to the same bytes, so that String::equals() returns on its pointer
+ * comparison. Symbols of different pools must not be compared.
+ *
+ * The view stays valid as long as the pool exists.
+ */
+class Symbol {
+	friend class StringPool;
+
+	uint32_t ident;
+	String view;
+
+	Symbol (uint32_t i, const String& s)
+		: ident(i), view(s)
+	{ }
+
+public:
+	/// Allows Symbols to be used as keys of hashed containers.
+	struct Hasher {
+		size_t operator() (const Symbol& s) const {
+			return s.ident;
+		}
+	};
+
+	/// Creates a null symbol, with id 0 and an empty view.
+	Symbol()
+		: ident(0), view()
+	{ }
+
+	/// @return the id, 0 for the null symbol.
+	uint32_t id() const {
+		return ident;
+	}
+
+	/// @return the pooled string.
+	const String& str() const {
+		return view;
+	}
+
+	/// @return true if this is the null symbol.
+	bool isNull() const {
+		return (ident == 0);
+	}
+
+	bool operator == (const Symbol& s) const {
+		return (ident == s.ident);
+	}
+
+	bool operator != (const Symbol& s) const {
+		return (ident != s.ident);
+	}
+
+	/// Orders symbols by id, not by string.
+	bool operator < (const Symbol& s) const {
+		return (ident < s.ident);
+	}
+};
+
+/**
+ * @class StringPool
+ * Interns strings: each distinct string is copied once into the pool and
+ * gets a Symbol, returned again every time the same string is interned.
+ *
+ * Typical use is for values recurring across records (merchant ids,
+ * country codes, field names): records keep Symbols rather than their own
+ * XString copies, and compare them as integers.
+ *
+ * @code
+ * StringPool merchants;
+ * Symbol id = merchants.intern (record.merchantId);
+ * if (id == topMerchant) { ... }
+ * @endcode
+ *
+ * A StringPool can be shared between threads without any external locking:
+ * - the pool is split in SHARDS shards selected by the hash of the strings
+ *   (see String::hash()), each with its own lock, hash table and storage.
+ *   Concurrent intern() calls only contend when they hit the same shard.
+ * - find() and symbol() never lock: hash tables are published with atomic
+ *   stores, and are never modified once a reader may see them but through
+ *   atomic stores of new entries. When a table grows, the previous one is
+ *   kept until the pool is destroyed, for readers still probing it.
+ * - intern() first looks the string up without locking, and only takes the
+ *   lock of its shard to insert a new string.
+ *
+ * Strings are copied into slabs of SLAB_SIZE bytes, rather than allocated
+ * one by one, and followed by a NUL byte. Nothing is freed before the pool
+ * is destroyed.
+ *
+ * Ids are not consecutive: they encode the shard and the position of the
+ * string in the shard. A pool holds up to about 2^32 strings.
+ */
+class StringPool {
+public:
+	/// Number of shards, a power of 2.
+	static const size_t SHARDS = 16;
+
+	/// Size of the storage slabs, in bytes. Longer strings get their own slab.
+	static const size_t SLAB_SIZE = 64 * 1024;
+
+private:
+	struct Entry;
+	struct Table;
+	struct Slab;
+	struct Shard;
+
+	Shard* shards;
+
+	StringPool (const StringPool&);
+	StringPool& operator = (const StringPool&);
+
+	const Entry* lookup (const Shard& shard, const String& s, uint64_t h) const;
+	const Entry* insert (Shard& shard, const String& s, uint64_t h);
+
+public:
+	StringPool();
+	~StringPool();
+
+	/**
+	 * Interns a string.
+	 * @param s the string. Its content is copied if it is not pooled yet.
+	 * @return the symbol of the string.
+	 * @throw Exception if memory is exhausted, or the shard of the string is full.
+	 */
+	Symbol intern (const String& s);
+
+	/**
+	 * Looks up a string, without interning it.
+	 * @param s the string.
+	 * @param sym receives the symbol of the string, if it is pooled.
+	 * @return true if the string is pooled.
+	 */
+	bool find (const String& s, Symbol& sym) const;
+
+	/**
+	 * Gets a symbol from its id.
+	 * @param id an id returned by Symbol::id().
+	 * @return the symbol.
+	 * @throw Exception if no string of the pool has this id.
+	 */
+	Symbol symbol (uint32_t id) const;
+
+	/// @return the number of strings in the pool.
+	size_t size() const;
+
+	/// @return the number of bytes allocated by the pool.
+	size_t memoryUsage() const;
+};
+
+} // namespace Fianet
+
+#endif // FIANET_STRINGPOOL_H
@@ -0,0 +1,318 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "StringSearcher.h"
+#include "ByteSearch.h"
+
+namespace Fianet {
+
+String::Searcher::Searcher (const StringView& s)
+	: needle(s), strategy(EMPTY), off1(0), off2(0), critical(0), period(0), memory0(0), shift(), rshift()
+{
+	compile();
+}
+
+String::Searcher::Searcher (const Searcher& s)
+	: needle(s.needle), strategy(EMPTY), off1(0), off2(0), critical(0), period(0), memory0(0), shift(), rshift()
+{
+	compile();
+}
+
+String::Searcher& String::Searcher::operator = (const Searcher& s)
+{
+	if (&s != this) {
+		needle.copyFrom (s.needle);
+		compile();
+	}
+	return *this;
+}
+
+void String::Searcher::compile()
+{
+	const uint8_t* n = needle.bytes();
+	const size_t l = needle.length();
+
+	if (l == 0) {
+		strategy = EMPTY;
+		return;
+	} else if (l == 1) {
+		strategy = SINGLE_BYTE;
+		return;
+	}
+
+	memfindSelectBytes (n, l, off1, off2);
+
+	if (l <= LONG_NEEDLE) {
+		strategy = SHORT_NEEDLE;
+		return;
+	}
+
+	strategy = LONG_NEEDLE_HYBRID;
+
+	// Backward bad character shifts: distance from the window start to the
+	// first occurrence of a byte in needle[1 ... l-1].
+	for (size_t i = 0; i < 256; ++i) {
+		rshift[i] = l;
+	}
+	for (size_t i = l - 1; i > 0; --i) {
+		rshift[n[i]] = i;
+	}
+
+	// Forward bad character shifts: 1 + last position of a byte in the
+	// needle, 0 when absent.
+	for (size_t i = 0; i < 256; ++i) {
+		shift[i] = 0;
+	}
+	for (size_t i = 0; i < l; ++i) {
+		shift[n[i]] = i + 1;
+	}
+
+	// Critical factorization: maximal suffixes for both byte orderings.
+	// ip starts at (size_t)-1 on purpose, n[ip + k] wraps to n[k - 1].
+	size_t ip, jp, k, p, ms, p0;
+
+	ip = (size_t) -1; jp = 0; k = p = 1;
+	while (jp + k < l) {
+		if (n[ip + k] == n[jp + k]) {
+			if (k == p) {
+				jp += p;
+				k = 1;
+			} else {
+				++k;
+			}
+		} else if (n[ip + k] > n[jp + k]) {
+			jp += k;
+			k = 1;
+			p = jp - ip;
+		} else {
+			ip = jp++;
+			k = p = 1;
+		}
+	}
+	ms = ip;
+	p0 = p;
+
+	ip = (size_t) -1; jp = 0; k = p = 1;
+	while (jp + k < l) {
+		if (n[ip + k] == n[jp + k]) {
+			if (k == p) {
+				jp += p;
+				k = 1;
+			} else {
+				++k;
+			}
+		} else if (n[ip + k] < n[jp + k]) {
+			jp += k;
+			k = 1;
+			p = jp - ip;
+		} else {
+			ip = jp++;
+			k = p = 1;
+		}
+	}
+
+	if (ip + 1 > ms + 1) {
+		ms = ip;
+	} else {
+		p = p0;
+	}
+
+	// Periodic needle ?
+	if (memcmp (n, n + p, ms + 1) != 0) {
+		memory0 = 0;
+		p = ((ms > l - ms - 1) ? ms : l - ms - 1) + 1;
+	} else {
+		memory0 = l - p;
+	}
+
+	critical = ms;
+	period = p;
+}
+
+ssize_t String::Searcher::findLong (const uint8_t* hay, size_t hlen) const
+{
+	const uint8_t* n = needle.bytes();
+	const size_t l = needle.length();
+	size_t pos = 0;
+	size_t work = 0;
+
+	while (pos + l <= hlen) {
+		const uint8_t* c = memfind_candidate (hay + pos, hlen - pos, l, n[off1], off1, n[off2], off2);
+		if (!c) {
+			break;
+		}
+
+		pos = c - hay;
+		if (memcmp (c, n, l) == 0) {
+			return pos;
+		}
+
+		// Too many false candidates: a linear-time algorithm takes over.
+		work += l;
+		if (work > 2 * pos + 8 * l) {
+			const ssize_t res = findTwoWay (c, hlen - pos);
+			return (res >= 0) ? res + pos : -1;
+		}
+		++pos;
+	}
+
+	return -1;
+}
+
+ssize_t String::Searcher::findTwoWay (const uint8_t* hay, size_t hlen) const
+{
+	const uint8_t* n = needle.bytes();
+	const size_t l = needle.length();
+	const uint8_t* h = hay;
+	const uint8_t* z = hay + hlen;
+	size_t mem = 0;
+	size_t k;
+
+	while (static_cast<size_t>(z - h) >= l) {
+
+		// Check the last byte of the window first.
+		k = l - shift[h[l - 1]];
+		if (k) {
+			h += k;
+			mem = 0;
+			continue;
+		}
+
+		// Compare the right half...
+		for (k = (critical + 1 > mem) ? critical + 1 : mem; k < l && n[k] == h[k]; ++k)
+			;
+		if (k < l) {
+			h += k - critical;
+			mem = 0;
+			continue;
+		}
+
+		// ... then the left half.
+		for (k = critical + 1; k > mem && n[k - 1] == h[k - 1]; --k)
+			;
+		if (k <= mem) {
+			return (h - hay);
+		}
+
+		h += period;
+		mem = memory0;
+	}
+
+	return -1;
+}
+
+ssize_t String::Searcher::findLastHorspool (const uint8_t* hay, size_t hlen) const
+{
+	const uint8_t* n = needle.bytes();
+	const size_t l = needle.length();
+
+	if (hlen < l) {
+		return -1;
+	}
+
+	const uint8_t* p = hay + hlen - l;
+
+	for (;;) {
+		if (*p == *n && memcmp (p, n, l) == 0) {
+			return (p - hay);
+		}
+		const size_t s = rshift[*p];
+		if (static_cast<size_t>(p - hay) < s) {
+			break;
+		}
+		p -= s;
+	}
+
+	return -1;
+}
+
+ssize_t String::Searcher::find (const StringView& hay, size_t from) const
+{
+	if (from >= hay.length()) {
+		return -1;
+	}
+
+	const uint8_t* h = hay.bytes() + from;
+	const size_t hlen = hay.length() - from;
+	const uint8_t* res;
+	ssize_t pos;
+
+	switch (strategy) {
+		case SINGLE_BYTE:
+			res = static_cast<const uint8_t*>(memchr (h, *needle.bytes(), hlen));
+			return res ? (res - hay.bytes()) : -1;
+
+		case SHORT_NEEDLE:
+			if (needle.length() > hlen) {
+				return -1;
+			}
+			res = memfind_pair (h, hlen, needle.bytes(), needle.length(), off1, off2);
+			return res ? (res - hay.bytes()) : -1;
+
+		case LONG_NEEDLE_HYBRID:
+			pos = findLong (h, hlen);
+			return (pos >= 0) ? pos + from : -1;
+
+		default:
+			break;
+	}
+
+	return -1;
+}
+
+ssize_t String::Searcher::findLast (const StringView& hay) const
+{
+	const uint8_t* res;
+
+	switch (strategy) {
+		case SINGLE_BYTE:
+			return hay.lastIndexOfChar (static_cast<char>(*needle.bytes()));
+
+		case SHORT_NEEDLE:
+			if (needle.length() > hay.length()) {
+				return -1;
+			}
+			res = memrfind_pair (hay.bytes(), hay.length(), needle.bytes(), needle.length(), off1, off2);
+			return res ? (res - hay.bytes()) : -1;
+
+		case LONG_NEEDLE_HYBRID:
+			return findLastHorspool (hay.bytes(), hay.length());
+
+		default:
+			break;
+	}
+
+	return -1;
+}
+
+size_t String::Searcher::count (const StringView& hay) const
+{
+	size_t nb = 0;
+	ssize_t pos = find (hay);
+
+	while (pos >= 0) {
+		++nb;
+		pos = find (hay, pos + needle.length());
+	}
+
+	return nb;
+}
+
+} // namespace Fianet
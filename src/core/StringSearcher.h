@@ -0,0 +1,147 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_STRINGSEARCHER_H
+#define FIANET_STRINGSEARCHER_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * @class String::Searcher
+ * A substring searcher, compiled once from a needle and reused against any
+ * number of haystacks.
+ *
+ * String::indexOf() has to analyse its needle on every call. When the same
+ * needles are looked up in every record, a Searcher moves that work out of
+ * the hot path. The search strategy is chosen from the needle length:
+ * - 1 byte: memchr().
+ * - up to LONG_NEEDLE bytes: the vectorized memfind() kernel, with its filter
+ *   bytes selected once.
+ * - longer needles: the same vectorized candidate filter, as long as false
+ *   candidates stay cheap to reject. When verifying them costs more than a
+ *   linear scan would (highly repetitive data), the search switches to the
+ *   Two-Way algorithm (Crochemore-Perrin) combined with a bad character
+ *   shift table, so the search always runs in linear time.
+ *
+ * findLast() uses the reverse memrfind() kernel for short needles, and a
+ * reverse Horspool search for longer ones.
+ *
+ * The needle is copied in the Searcher, which can outlive the String it was
+ * built from.
+ *
+ * An empty needle is never found, like with String::indexOf().
+ */
+class String::Searcher {
+public:
+	/// Needles longer than this may fall back to the Two-Way algorithm.
+	static const size_t LONG_NEEDLE = 32;
+
+private:
+	enum Strategy {
+		EMPTY,
+		SINGLE_BYTE,
+		SHORT_NEEDLE,
+		LONG_NEEDLE_HYBRID
+	};
+
+	XString needle;
+	Strategy strategy;
+
+	/// memfind() filter bytes.
+	size_t off1;
+	size_t off2;
+
+	/// Two-Way critical factorization position (long needles).
+	size_t critical;
+	/// Two-Way period, or the shift to use for non-periodic needles.
+	size_t period;
+	/// Length of the prefix known to match after a shift, for periodic needles.
+	size_t memory0;
+	/// Bad character shifts of long needles, for forward and backward search.
+	size_t shift[256];
+	size_t rshift[256];
+
+	void compile();
+	ssize_t findLong (const uint8_t* hay, size_t hlen) const;
+	ssize_t findTwoWay (const uint8_t* hay, size_t hlen) const;
+	ssize_t findLastHorspool (const uint8_t* hay, size_t hlen) const;
+
+public:
+	/**
+	 * Builds a searcher for a needle.
+	 * @param needle the String to look for. Its content is copied.
+	 */
+	explicit Searcher (const StringView& needle);
+
+	Searcher (const Searcher& s);
+	Searcher& operator = (const Searcher& s);
+
+	~Searcher()
+	{ }
+
+	/// @return the needle the searcher looks for.
+	const String& str() const {
+		return needle;
+	}
+
+	/**
+	 * Gets the position of the first occurrence of the needle in a String.
+	 *
+	 * @param hay the String to search.
+	 * @param from the position the search starts from.
+	 * @return the position of the first occurrence at or after from,
+	 * -1 if not found.
+	 */
+	ssize_t find (const StringView& hay, size_t from = 0) const;
+
+	/**
+	 * Gets the position of the last occurrence of the needle in a String.
+	 *
+	 * @param hay the String to search.
+	 * @return the position of the last occurrence, -1 if not found.
+	 */
+	ssize_t findLast (const StringView& hay) const;
+
+	/**
+	 * Counts the non-overlapping occurrences of the needle in a String,
+	 * from left to right. For example, "aa" occurs twice in "aaaaa".
+	 *
+	 * @param hay the String to search.
+	 * @return the number of occurrences.
+	 */
+	size_t count (const StringView& hay) const;
+
+	/**
+	 * Same as String::contains(), with a compiled needle.
+	 * @return true if hay contains the needle.
+	 */
+	bool contains (const StringView& hay) const;
+};
+
+inline bool String::Searcher::contains (const StringView& hay) const
+{
+	return (find (hay) >= 0);
+}
+
+} // namespace Fianet
+
+#endif // FIANET_STRINGSEARCHER_H
@@ -0,0 +1,383 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "fianet-core.h"
+#include "StringSort.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctype.h>
+#include <pthread.h>
+
+namespace Fianet {
+
+namespace {
+
+/// A String and its cached bytes, from the current depth.
+struct Item {
+	uint64_t key;
+	const uint8_t* ptr;
+	size_t len;
+};
+
+/// Below this size, partitions are sorted by insertion.
+const size_t INSERTION_THRESHOLD = 16;
+
+/// Partitions of this size or more are queued for other threads.
+const size_t PARALLEL_THRESHOLD = 32 * 1024;
+
+/// Shared state of a sort.
+struct Context {
+	/// Folding of each byte: identity, or upper case.
+	uint8_t fold[256];
+	bool folding;
+
+	bool parallel;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+
+	struct Job {
+		Item* items;
+		size_t count;
+		size_t depth;
+	};
+	/// Queued partitions. Partitions are disjoint and large: the queue never overflows.
+	Job* jobs;
+	size_t queued;
+	/// Queued partitions, and partitions being sorted.
+	size_t pending;
+};
+
+/// @return the big-endian value of the folded bytes of an item at a depth, 0-padded.
+inline uint64_t loadKey (const Context& ctx, const Item& it, size_t depth)
+{
+	const uint8_t* p = it.ptr + depth;
+	const size_t left = it.len - depth;
+
+	if (!ctx.folding && left >= 8) {
+		uint64_t v;
+		std::memcpy (&v, p, sizeof(v));
+#ifdef CPU_IS_LITTLE_ENDIAN
+		v = __builtin_bswap64 (v);
+#endif
+		return v;
+	}
+
+	uint64_t v = 0;
+	const size_t n = (left < 8) ? left : 8;
+	for (size_t i = 0; i < n; ++i) {
+		v |= static_cast<uint64_t>(ctx.fold[p[i]]) << (56 - 8 * i);
+	}
+	return v;
+}
+
+/// Compares two items sharing their first 'depth' bytes, from that depth on.
+inline int compareFrom (const Context& ctx, const Item& a, const Item& b, size_t depth)
+{
+	if (a.key != b.key) {
+		return (a.key < b.key) ? -1 : 1;
+	}
+	// The cached bytes are equal: compare what follows them.
+	depth += 8;
+	const size_t la = (a.len > depth) ? a.len - depth : 0;
+	const size_t lb = (b.len > depth) ? b.len - depth : 0;
+	const size_t n = (la < lb) ? la : lb;
+
+	if (n) {
+		if (!ctx.folding) {
+			const int res = std::memcmp (a.ptr + depth, b.ptr + depth, n);
+			if (res) {
+				return res;
+			}
+		} else {
+			for (size_t i = 0; i < n; ++i) {
+				const int res = ctx.fold[a.ptr[depth + i]] - ctx.fold[b.ptr[depth + i]];
+				if (res) {
+					return res;
+				}
+			}
+		}
+	}
+	return (a.len < b.len) ? -1 : (a.len > b.len) ? 1 : 0;
+}
+
+void insertionSort (const Context& ctx, Item* a, size_t n, size_t depth)
+{
+	for (size_t i = 1; i < n; ++i) {
+		const Item it = a[i];
+		size_t j = i;
+		while (j > 0 && compareFrom (ctx, it, a[j - 1], depth) < 0) {
+			a[j] = a[j - 1];
+			--j;
+		}
+		a[j] = it;
+	}
+}
+
+inline void swap (Item& a, Item& b)
+{
+	const Item t = a;
+	a = b;
+	b = t;
+}
+
+inline uint64_t median (uint64_t a, uint64_t b, uint64_t c)
+{
+	if (a < b) {
+		return (b < c) ? b : (a < c) ? c : a;
+	}
+	return (a < c) ? a : (b < c) ? c : b;
+}
+
+uint64_t pivot (const Item* a, size_t n)
+{
+	if (n < 1024) {
+		return median (a[0].key, a[n / 2].key, a[n - 1].key);
+	}
+	const size_t s = n / 8;
+	return median (median (a[0].key, a[s].key, a[2 * s].key),
+		median (a[3 * s].key, a[4 * s].key, a[5 * s].key),
+		median (a[6 * s].key, a[7 * s].key, a[n - 1].key));
+}
+
+void sortFrom (Context& ctx, Item* a, size_t n, size_t depth);
+
+/// Sorts a partition, or queues it if it is large enough for another thread.
+void dispatch (Context& ctx, Item* a, size_t n, size_t depth)
+{
+	if (n < 2) {
+		return;
+	}
+	if (ctx.parallel && n >= PARALLEL_THRESHOLD) {
+		pthread_mutex_lock (&ctx.mutex);
+		Context::Job& job = ctx.jobs[ctx.queued++];
+		job.items = a;
+		job.count = n;
+		job.depth = depth;
+		++ctx.pending;
+		pthread_cond_signal (&ctx.cond);
+		pthread_mutex_unlock (&ctx.mutex);
+		return;
+	}
+	sortFrom (ctx, a, n, depth);
+}
+
+/// Sorts items sharing their first 'depth' bytes, whose keys are loaded at that depth.
+void sortFrom (Context& ctx, Item* a, size_t n, size_t depth)
+{
+	while (n > 1) {
+		if (n < INSERTION_THRESHOLD) {
+			insertionSort (ctx, a, n, depth);
+			return;
+		}
+
+		// Three-way partition on the cached bytes.
+		const uint64_t p = pivot (a, n);
+		size_t lt = 0, i = 0, gt = n;
+		while (i < gt) {
+			if (a[i].key < p) {
+				swap (a[lt++], a[i++]);
+			} else if (a[i].key > p) {
+				swap (a[i], a[--gt]);
+			} else {
+				++i;
+			}
+		}
+		dispatch (ctx, a, lt, depth);
+		dispatch (ctx, a + gt, n - gt, depth);
+
+		// Equal bytes: the Strings ending within them come first, ordered by
+		// length, as each is a prefix of the following ones.
+		a += lt;
+		n = gt - lt;
+		size_t counts[9] = { 0 };
+		size_t ended = 0;
+		for (i = 0; i < n; ++i) {
+			if (a[i].len <= depth + 8) {
+				++counts[a[i].len - depth];
+				swap (a[ended++], a[i]);
+			}
+		}
+		if (ended > 1) {
+			// Same bytes and at most 9 lengths: put each item in the slot of
+			// its length, as the American flag sort does.
+			size_t next[9], stop[9];
+			size_t pos = 0;
+			for (size_t l = 0; l <= 8; ++l) {
+				next[l] = pos;
+				pos += counts[l];
+				stop[l] = pos;
+			}
+			for (size_t l = 0; l <= 8; ++l) {
+				while (next[l] < stop[l]) {
+					const size_t target = a[next[l]].len - depth;
+					if (target == l) {
+						++next[l];
+					} else {
+						swap (a[next[l]], a[next[target]++]);
+					}
+				}
+			}
+		}
+
+		a += ended;
+		n -= ended;
+		depth += 8;
+		for (i = 0; i < n; ++i) {
+			a[i].key = loadKey (ctx, a[i], depth);
+		}
+	}
+}
+
+/// Sorts queued partitions until none is left nor being sorted.
+void drain (Context& ctx)
+{
+	pthread_mutex_lock (&ctx.mutex);
+	for (;;) {
+		while (ctx.queued == 0 && ctx.pending > 0) {
+			pthread_cond_wait (&ctx.cond, &ctx.mutex);
+		}
+		if (ctx.queued == 0) {
+			break;
+		}
+		const Context::Job job = ctx.jobs[--ctx.queued];
+		pthread_mutex_unlock (&ctx.mutex);
+
+		sortFrom (ctx, job.items, job.count, job.depth);
+
+		pthread_mutex_lock (&ctx.mutex);
+		if (--ctx.pending == 0) {
+			pthread_cond_broadcast (&ctx.cond);
+		}
+	}
+	pthread_mutex_unlock (&ctx.mutex);
+}
+
+void* worker (void* arg)
+{
+	drain (*static_cast<Context*>(arg));
+	return 0;
+}
+
+void sortParallel (Context& ctx, Item* items, size_t n, unsigned threads)
+{
+	ctx.jobs = static_cast<Context::Job*>(std::malloc ((n / PARALLEL_THRESHOLD + 1) * sizeof(Context::Job)));
+	pthread_t* ids = static_cast<pthread_t*>(std::malloc (threads * sizeof(pthread_t)));
+	if (!ctx.jobs || !ids) {
+		std::free (ctx.jobs);
+		std::free (ids);
+		THROW ("sortStrings: malloc() returned NULL");
+	}
+
+	ctx.parallel = true;
+	pthread_mutex_init (&ctx.mutex, 0);
+	pthread_cond_init (&ctx.cond, 0);
+	ctx.jobs[0].items = items;
+	ctx.jobs[0].count = n;
+	ctx.jobs[0].depth = 0;
+	ctx.queued = 1;
+	ctx.pending = 1;
+
+	// If a thread cannot be started, the others sort its share.
+	unsigned started = 0;
+	while (started + 1 < threads && pthread_create (&ids[started], 0, worker, &ctx) == 0) {
+		++started;
+	}
+	drain (ctx);
+	for (unsigned i = 0; i < started; ++i) {
+		pthread_join (ids[i], 0);
+	}
+
+	pthread_cond_destroy (&ctx.cond);
+	pthread_mutex_destroy (&ctx.mutex);
+	std::free (ids);
+	std::free (ctx.jobs);
+}
+
+void sortArray (String* begin, String* end, unsigned threads, bool ignoreCase)
+{
+	if (end - begin < 2) {
+		return;
+	}
+	const size_t n = end - begin;
+
+	Context ctx;
+	ctx.folding = ignoreCase;
+	ctx.parallel = false;
+	ctx.jobs = 0;
+	ctx.queued = ctx.pending = 0;
+	for (int c = 0; c < 256; ++c) {
+		if (!ignoreCase) {
+			ctx.fold[c] = static_cast<uint8_t>(c);
+		} else if (getCaseFolding() == LOCALE_CASE_FOLDING) {
+			ctx.fold[c] = static_cast<uint8_t>(toupper (c));
+		} else {
+			ctx.fold[c] = static_cast<uint8_t>((c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c);
+		}
+	}
+
+	Item* items = static_cast<Item*>(std::malloc (n * sizeof(Item)));
+	if (!items) {
+		THROW ("sortStrings: malloc() returned NULL");
+	}
+	for (size_t i = 0; i < n; ++i) {
+		items[i].ptr = reinterpret_cast<const uint8_t*>(begin[i].cstr());
+		items[i].len = begin[i].length();
+		items[i].key = loadKey (ctx, items[i], 0);
+	}
+
+	if (threads == 0) {
+		const long cpus = sysconf (_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? static_cast<unsigned>(cpus) : 1;
+	}
+	if (threads > n / PARALLEL_THRESHOLD) {
+		threads = static_cast<unsigned>(n / PARALLEL_THRESHOLD);
+	}
+
+	try {
+		if (threads > 1) {
+			sortParallel (ctx, items, n, threads);
+		} else {
+			sortFrom (ctx, items, n, 0);
+		}
+	} catch (...) {
+		std::free (items);
+		throw;
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		begin[i] = String (reinterpret_cast<const char*>(items[i].ptr), items[i].len);
+	}
+	std::free (items);
+}
+
+} // namespace
+
+void sortStrings (String* begin, String* end, unsigned threads)
+{
+	sortArray (begin, end, threads, false);
+}
+
+void isortStrings (String* begin, String* end, unsigned threads)
+{
+	sortArray (begin, end, threads, true);
+}
+
+} // namespace Fianet
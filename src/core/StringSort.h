@@ -0,0 +1,64 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_STRINGSORT_H
+#define FIANET_STRINGSORT_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+/**
+ * Sorts an array of Strings in the order of String::Comparator: by bytes,
+ * then by length.
+ *
+ * This is a multikey quicksort working on 8 bytes at a time: each String
+ * gets a cached big-endian copy of its next 8 bytes, arrays are partitioned
+ * on these integers, and only the Strings sharing the same 8 bytes move on
+ * to the next ones. Common prefixes are thus read once, instead of once per
+ * comparison as with std::sort() and String::Comparator. The cache takes
+ * 24 bytes per String, allocated for the duration of the call.
+ *
+ * Large partitions are sorted in parallel when threads is greater than 1:
+ * the threads are started for the call, and take partitions from a shared
+ * queue until the array is sorted. Arrays too small to be worth it are
+ * sorted by the calling thread only.
+ *
+ * The sort is not stable: the order of equal Strings (views on different
+ * copies of the same bytes) is unspecified.
+ *
+ * @param begin the first String.
+ * @param end the String following the last one.
+ * @param threads the number of threads to use, the calling thread
+ * included. 0 uses one thread per online CPU.
+ * @throw Exception if memory is exhausted.
+ */
+void sortStrings (String* begin, String* end, unsigned threads = 1);
+
+/**
+ * sortStrings() variant, in the order of String::IComparator: bytes are
+ * compared as memicompare() does, following the rules selected by
+ * setCaseFolding().
+ */
+void isortStrings (String* begin, String* end, unsigned threads = 1);
+
+} // namespace Fianet
+
+#endif // FIANET_STRINGSORT_H
@@ -22,14 +22,14 @@
 
 namespace Fianet {
 
-StringTokenizer::StringTokenizer (const String& str)
+StringTokenizer::StringTokenizer (const StringView& str)
 : myString(str)
 {
 
 }
 
 
-StringTokenizer::Iterator StringTokenizer::begin (const String& delimiter)
+StringTokenizer::Iterator StringTokenizer::begin (const StringView& delimiter)
 {
 	return Iterator (this, delimiter);
 }
@@ -48,13 +48,13 @@ StringTokenizer::Iterator& StringTokenizer::end()
 }
 
 
-StringTokenizer::Iterator::Iterator(StringTokenizer* owner_, const String& delim)
+StringTokenizer::Iterator::Iterator(StringTokenizer* owner_, const StringView& delim)
  : owner(owner_), delimiter(delim), delimpos(0), rank(0), token()
 {
 	delimpos = owner->str().indexOf(delimiter);
 
 	if (delimpos == -1) {
-		token.adopt (owner->str());
+		token.adopt (owner->str().cstr(), owner->str().length());
 		if (token.length() == 0) {
 			*this = owner->end();
 		}
@@ -70,11 +70,11 @@ StringTokenizer::Iterator& StringTokenizer::Iterator::operator ++ ()
 		*this = StringTokenizer::end();
 
 	} else {
-		String sub (owner->str().substr (delimpos+delimiter.length()));
+		StringView sub (owner->str().substr (delimpos+delimiter.length()));
 
 		int nextdp = sub.indexOf(delimiter);
 		if (nextdp == -1) {
-			token.adopt (sub);
+			token.adopt (sub.cstr(), sub.length());
 			delimpos = -1;
 
 		} else {
@@ -108,18 +108,18 @@ StringTokenizer::ReverseIterator StringTokenizer::rbegin(char delimiter)
 	return ReverseIterator (this, delim);
 }
 
-StringTokenizer::ReverseIterator StringTokenizer::rbegin (const String& delimiter)
+StringTokenizer::ReverseIterator StringTokenizer::rbegin (const StringView& delimiter)
 {
 	return ReverseIterator (this, delimiter);
 }
 
-StringTokenizer::ReverseIterator::ReverseIterator(StringTokenizer* owner_, const String& delim)
+StringTokenizer::ReverseIterator::ReverseIterator(StringTokenizer* owner_, const StringView& delim)
  : owner(owner_), delimiter(delim), delimpos(0), rank(0), token()
 {
 	delimpos = owner->str().lastIndexOf(delimiter);
 
 	if (delimpos == -1) {
-		token.adopt (owner->str());
+		token.adopt (owner->str().cstr(), owner->str().length());
 		if (token.length() == 0) {
 			*this = owner->rend();
 		}
@@ -135,15 +135,17 @@ StringTokenizer::ReverseIterator& StringTokenizer::ReverseIterator::operator ++
 		*this = StringTokenizer::rend();
 
 	} else {
-		String sub (owner->str().substr (0, delimpos));
+		// The next delimiter is searched for before the current one.
+		const StringView& str = owner->str();
+		const uint8_t* p = memrfind (str.bytes(), delimpos, delimiter.bytes(), delimiter.length());
 
-		int nextdp = sub.lastIndexOf(delimiter);
-		if (nextdp == -1) {
-			token.adopt (sub);
+		if (!p) {
+			token.adopt (str.cstr(), delimpos);
 			delimpos = -1;
 
 		} else {
-			token.adopt (sub.cstr()+nextdp+delimiter.length(), delimpos-nextdp-delimiter.length());
+			int nextdp = p - str.bytes();
+			token.adopt (str.cstr()+nextdp+delimiter.length(), delimpos-nextdp-delimiter.length());
 			delimpos = nextdp;
 		}
 		++rank;
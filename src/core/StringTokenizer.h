@@ -41,7 +41,8 @@ public:
 	class ReverseIterator;
 
 protected:
-	const String& myString;
+	/// The tokenized view, copied: it may be built from a temporary String.
+	const StringView myString;
 
 private:
 	StringTokenizer();
@@ -54,14 +55,14 @@ public:
 
 	/**
 	 * Creates a tokenizer instance on a target string.
-	 * The string *must* exist until the destruction of
+	 * The string data *must* exist until the destruction of
 	 * the iterator.
      * @param str
      */
-	StringTokenizer (const String& str);
+	StringTokenizer (const StringView& str);
 
 	/// @return the string targeted by the tokenizer.
-	const String& str() const {
+	const StringView& str() const {
 		return myString;
 	}
 
@@ -81,7 +82,7 @@ public:
 	 * found in the string, StringTokenizer::end()
 	 * if no token is found in the string.
 	 */
-	Iterator begin (const String& delimiter);
+	Iterator begin (const StringView& delimiter);
 
 	/**
 	 * 'No more token' mark.
@@ -105,7 +106,7 @@ public:
 	 * found in the end of the string, StringTokenizer::rend()
 	 * if no token is found in the string.
 	 */
-	ReverseIterator rbegin (const String& delimiter);
+	ReverseIterator rbegin (const StringView& delimiter);
 
 	/**
 	 * 'No more token' mark for reverse iterator.
@@ -125,7 +126,7 @@ public:
  */
 class StringTokenizer::Iterator {
 	friend Iterator StringTokenizer::begin(char delimiter);
-	friend Iterator StringTokenizer::begin(const String& delimiter);
+	friend Iterator StringTokenizer::begin(const StringView& delimiter);
 
 	StringTokenizer* owner;
 
@@ -135,7 +136,7 @@ class StringTokenizer::Iterator {
 	uint32_t rank;
 	String token;
 
-	Iterator (StringTokenizer* owner, const String& delimiter);
+	Iterator (StringTokenizer* owner, const StringView& delimiter);
 
 public:
 	Iterator()
@@ -209,7 +210,7 @@ public:
  */
 class StringTokenizer::ReverseIterator {
 	friend ReverseIterator StringTokenizer::rbegin(char delimiter);
-	friend ReverseIterator StringTokenizer::rbegin(const String& delimiter);
+	friend ReverseIterator StringTokenizer::rbegin(const StringView& delimiter);
 
 	StringTokenizer* owner;
 
@@ -219,7 +220,7 @@ class StringTokenizer::ReverseIterator {
 	uint32_t rank;
 	String token;
 
-	ReverseIterator (StringTokenizer* owner, const String& delimiter);
+	ReverseIterator (StringTokenizer* owner, const StringView& delimiter);
 
 public:
 	ReverseIterator()
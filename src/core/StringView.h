@@ -0,0 +1,931 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_STRINGVIEW_H
+#define FIANET_STRINGVIEW_H
+
+#include "fianet-core.h"
+
+namespace Fianet {
+
+class CharSet;
+
+/**
+ * Looks for the 1st occurrence of needle in haystack.
+ *
+ * Uses SSE2 or AVX2 when the library is built for a CPU that supports them.
+ *
+ * @return the address of the 1st haystack byte sequence that matches needle.
+ * @return haystack if needle_len is 0.
+ * @return NULL if needle is not found in haystack.
+ */
+uint8_t* memfind (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len);
+
+/**
+ * Looks for the last occurrence of needle in haystack. Uses the same
+ * vectorized kernels as memfind(), scanning the haystack from its end.
+ *
+ * @return the address of the last haystack byte sequence that matches needle.
+ * @return haystack + haystack_len if needle_len is 0.
+ * @return NULL if needle is not found in haystack.
+ */
+uint8_t* memrfind (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len);
+
+/**
+ * Case folding rules of the case-insensitive functions.
+ * @see setCaseFolding()
+ */
+enum CaseFolding {
+	/// Only ASCII letters are folded, whatever the locale (default).
+	ASCII_CASE_FOLDING,
+	/// Bytes are folded with toupper(), following the current locale.
+	LOCALE_CASE_FOLDING
+};
+
+/**
+ * Selects the case folding rules of memifind(), memicompare(), and of
+ * every case-insensitive String method (iequals(), icontains(),
+ * String::IComparator, ...).
+ *
+ * ASCII folding is the default: it processes a full SIMD register at a time
+ * and gives the same results as toupper() in the "C" locale. Programs that
+ * rely on a locale to fold other bytes (e.g. ISO-8859-1 accented letters)
+ * have to opt in to LOCALE_CASE_FOLDING, once at startup.
+ *
+ * The same rules apply to XString::toUppercase() and XString::toLowercase().
+ * The trim() methods do not depend on them: they always remove the
+ * isspace() bytes of the current locale.
+ *
+ * @param folding the case folding rules.
+ */
+void setCaseFolding (CaseFolding folding);
+
+/// @return the current case folding rules.
+CaseFolding getCaseFolding();
+
+/**
+ * Looks for the 1st occurrence of needle in haystack. case-insensitive variant.
+ * @see setCaseFolding()
+ * @return the address of the 1st haystack byte sequence that matches needle.
+ * @return NULL if needle is not found in haystack.
+ */
+uint8_t* memifind (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len);
+
+
+/**
+ * Compares two byte buffers in a "case-insensitive" way.
+ * @see setCaseFolding()
+ * @see memcmp()
+ */
+int memicompare (const void* s1, const void* s2, size_t sz);
+
+/**
+ * memifind() folding ASCII letters only. An empty needle matches at the
+ * beginning of haystack.
+ */
+uint8_t* memifind_ascii (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len);
+
+/// memicompare() folding ASCII letters only.
+int memicompare_ascii (const void* s1, const void* s2, size_t sz);
+
+/// memifind() folding bytes with toupper().
+uint8_t* memifind_locale (const void* haystack, size_t haystack_len, const void* needle, size_t needle_len);
+
+/// memicompare() folding bytes with toupper().
+int memicompare_locale (const void* s1, const void* s2, size_t sz);
+
+/**
+ * Hashes a byte buffer with a fast 64-bit non-cryptographic hash (wyhash).
+ * Not suitable where an attacker chooses the keys and can observe the
+ * collisions, unless the seed is kept secret.
+ *
+ * @param s the buffer.
+ * @param len the buffer length, in bytes.
+ * @param seed the seed, giving independent hash functions.
+ * @return the hash value.
+ */
+uint64_t memhash (const void* s, size_t len, uint64_t seed = 0);
+
+/**
+ * memhash() variant, case-insensitive: buffers that memicompare() finds
+ * equal have the same hash. The bytes are folded while they are read.
+ * @see setCaseFolding()
+ */
+uint64_t memihash (const void* s, size_t len, uint64_t seed = 0);
+
+/**
+ * Result of the StringView::tryTo*() conversions.
+ */
+enum ParseStatus {
+	/// The conversion succeeded.
+	PARSE_OK,
+	/// The String is empty.
+	PARSE_EMPTY,
+	/// The String is not a number of the expected form.
+	PARSE_FORMAT_ERROR,
+	/// The number does not fit in the range of the type.
+	PARSE_RANGE_ERROR
+};
+
+
+/**
+ * @class StringView
+ * The read-only core of String: a data pointer and a length, 16 bytes, with
+ * no virtual method.
+ *
+ * A StringView is trivially copyable: it is copied with two register moves,
+ * passed by value in registers, and can be stored in arrays handled with
+ * memcpy(). Every read-only String algorithm (comparisons, searches,
+ * hashing, number conversions) is a StringView method, so the compiler sees
+ * through the calls made in hot loops.
+ *
+ * String derives from StringView, and adds the (virtual) methods that move
+ * the view, like trim(). A String is passed where a StringView is expected
+ * without any conversion, and a StringView converts to a String when needed.
+ *
+ * @code
+ * StringView merchant = record.substr (0, 8);
+ * if (merchant.startsWith ("FR")) ...
+ * @endcode
+ *
+ * Like a String, a StringView references data it does not own, which must
+ * outlive it, and is not guaranteed to be NUL-terminated.
+ */
+class StringView {
+protected:
+	/// Address of our data.
+	uint8_t* ptr;
+	/// Number of bytes used by our data.
+	size_t len;
+
+public:
+	/**
+	 * Empty view.
+	 */
+	StringView()
+		: ptr((uint8_t*)""), len(0)
+	{ }
+
+	/**
+	 * Constructs a view on a null-terminated C string.
+	 * @param c_str address of the C string to get a view on.
+	 */
+	StringView (const char* c_str)
+		: ptr((uint8_t*)c_str), len(::strlen (c_str))
+	{ }
+
+	/**
+	 * Constructs a view on a byte buffer, which does not necessarily end
+	 * with a null byte.
+	 *
+	 * @param addr the data pointer.
+	 * @param ln the data length in bytes.
+	 */
+	StringView (const char* addr, size_t ln)
+		: ptr((uint8_t*)addr), len(ln)
+	{ }
+
+	/**
+	 * Convenient read-only pointer access.
+	 * @note Unlike std::string::c_str(), there is no guarantee to have a
+	 * NUL-terminated string! Use with caution!
+	 * @return the data pointer casted to a char*.
+	 */
+	const char* cstr() const {
+		return (const char*) ptr;
+	}
+
+	/**
+	 * Convenient read-only pointer access.
+	 * @return the data pointer casted to a uint8_t.
+	 */
+	const uint8_t* bytes() const {
+		return ptr;
+	}
+
+	/**
+	 * @return the buffer length in bytes.
+	 */
+	size_t length() const {
+		return len;
+	}
+
+	/**
+	 * Access a character at a given position with bounds checking.
+	 * @param pos the position to get the character from. Must be included in
+	 * the range [ 0 ... length() - 1]
+	 * @return the character.
+	 * @throw Exception when the position is out of bounds.
+	 */
+	char charAt (size_t pos) const {
+		if (UNLIKELY(pos >= len)) {
+			THROWF ("String::charAt(): index '%lu' out of bounds.", (unsigned long) pos);
+		}
+		return (char) ptr[pos];
+	}
+
+	/// @see charAt()
+	char operator[] (size_t pos) const {
+		return charAt (pos);
+	}
+
+	/**
+	 * @return true if the data pointed by both strings is the same, using
+	 * byte comparison if necessary.
+	 */
+	bool equals (const StringView& s) const {
+		return (s.len == len && (s.ptr == ptr || len == 0 || std::memcmp (ptr, s.ptr, len) == 0));
+	}
+
+	/**
+	 * See if a char is present in the String data.
+	 * @return true if c is found, false if not.
+	 */
+	bool containsChar (char c) const {
+		return (indexOfChar (c) >= 0);
+	}
+
+	/**
+	 * See if current String data contains the data of an other String, using
+	 * byte comparison if necessary.
+	 * @param s the String that may be contained by *this instance.
+	 * @return true if *this contains s, false if not.
+	 */
+	bool contains (const StringView& s) const {
+		return (s.len == 0 || (s.len <= len && (s.ptr == ptr || memfind (ptr, len, s.ptr, s.len) != 0)));
+	}
+
+	/**
+	 * See if current String data starts with the same bytes than an
+	 * other String, using byte comparison if necessary.
+	 *
+	 * @param s the String to look for in *this instance.
+	 * @return true if *this starts with s, false if not.
+	 */
+	bool startsWith (const StringView& s) const {
+		return (s.len <= len && (s.ptr == ptr || s.len == 0 || std::memcmp (ptr, s.ptr, s.len) == 0));
+	}
+
+	/**
+	 * See if current String data ends with the same bytes than an
+	 * other String, using byte comparison if necessary.
+	 *
+	 * @param s the String to look for in *this instance.
+	 * @return true if *this starts with s, false if not.
+	 */
+	bool endsWith (const StringView& s) const {
+		return (s.len <= len && (s.len == 0 || std::memcmp (ptr + len - s.len, s.ptr, s.len) == 0));
+	}
+
+	/**
+	 * Compares two Strings.
+	 *
+	 * This function performs a binary comparison of the byte data contained
+	 * in the current instance buffer and in the given argument.
+	 *
+	 * @param s the String instance to compare to.
+	 *
+	 * @return 0 when the contents of both String objects are equal.
+	 * @return a number > 0 when the first character that does not match
+	 * has a greater value in the current instance than in s.
+	 * @return a number &lt; 0 when the first character that does not match
+	 * has a greater value in the current instance than in s.
+	 *
+	 * @see memcmp
+	 */
+	int compareTo (const StringView& s) const {
+		const size_t common = (len < s.len) ? len : s.len;
+		const int res = (s.ptr == ptr || common == 0) ? 0 : std::memcmp (ptr, s.ptr, common);
+		if (res == 0 && len != s.len) {
+			return (len < s.len) ? -1 : 1;
+		}
+		return res;
+	}
+
+	/**
+	 * Compares two Strings up to a given number of characters.
+	 *
+	 * This function performs a binary comparison of the byte data contained
+	 * in the current instance buffer and in the given argument.
+	 *
+	 * @param s the String instance to compare to.
+	 * @param nb the maximum number of bytes to compare.
+	 *
+	 * @return 0 when the contents of both String objects are equal.
+	 * @return a number > 0 when the first character that does not match
+	 * has a greater value in the current instance than in s.
+	 * @return a number &lt; 0 when the first character that does not match
+	 * has a greater value in the current instance than in s.
+	 *
+	 * @see memcmp
+	 */
+	int compareTo (const StringView& s, uint32_t nb) const {
+		const size_t common = (len < s.len) ? len : s.len;
+		return (s.ptr == ptr || nb == 0) ? 0 : std::memcmp (ptr, s.ptr, (nb < common) ? nb : common);
+	}
+
+	/**
+	 * @return true if the data pointed by both strings is the same, using
+	 * case-insensitive comparison if necessary.
+	 */
+	bool iequals (const StringView& s) const {
+		return (s.len == len && (s.ptr == ptr || len == 0 || memicompare (ptr, s.ptr, len) == 0));
+	}
+
+	/**
+	 * @return a 64-bit hash of the String data, see memhash(). Strings that
+	 * are equal() have the same hash.
+	 */
+	uint64_t hash() const;
+
+	/**
+	 * @return a case-insensitive hash of the String data, see memihash().
+	 * Strings that are iequals() have the same hash.
+	 * @note results depend on the case folding rules, see setCaseFolding().
+	 */
+	uint64_t ihash() const {
+		return memihash (ptr, len);
+	}
+
+	/**
+	 * See if current String data contains the data of an other String, using
+	 * case-insensitive comparison.
+	 *
+	 * @param s the String that may be contained by *this instance.
+	 * @return true if *this contains s, false if not.
+	 * @note results depend on the case folding rules, see setCaseFolding().
+	 */
+	bool icontains (const StringView& s) const {
+		return (s.len == 0 || (s.len <= len && (s.ptr == ptr || memifind (ptr, len, s.ptr, s.len) != 0)));
+	}
+
+	/**
+	 * See if current String data starts with the same bytes than an
+	 * other String, using case-insensitive comparison.
+	 *
+	 * @param s the String to look for in *this instance.
+	 * @return true if *this starts with s, false if not.
+	 * @note results depend on the case folding rules, see setCaseFolding().
+	 */
+	bool istartsWith (const StringView& s) const {
+		return (s.len <= len && (s.ptr == ptr || s.len == 0 || memicompare (ptr, s.ptr, s.len) == 0));
+	}
+
+	/**
+	 * See if current String data ends with the same bytes than an
+	 * other String, using case-insensitive comparison.
+	 *
+	 * @param s the String to look for in *this instance.
+	 * @return true if *this starts with s, false if not.
+	 * @note results depend on the case folding rules, see setCaseFolding().
+	 */
+	bool iendsWith (const StringView& s) const {
+		return (s.len <= len && (s.len == 0 || memicompare (ptr + len - s.len, s.ptr, s.len) == 0));
+	}
+
+	/**
+	 * Compares two Strings up to a given number of characters, using
+	 * case-insensitive comparison.
+	 * @see compareTo()
+	 */
+	int icompareTo (const StringView& s, uint32_t nbChars) const {
+		const size_t common = (len < s.len) ? len : s.len;
+		return (s.ptr == ptr || nbChars == 0) ? 0 : memicompare (ptr, s.ptr, (nbChars < common) ? nbChars : common);
+	}
+
+	/**
+	 * Compares two Strings, using case-insensitive comparison.
+	 * @see compareTo()
+	 */
+	int icompareTo (const StringView& s) const {
+		const size_t common = (len < s.len) ? len : s.len;
+		const int res = (s.ptr == ptr || common == 0) ? 0 : memicompare (ptr, s.ptr, common);
+		if (res == 0 && len != s.len) {
+			return (len < s.len) ? -1 : 1;
+		}
+		return res;
+	}
+
+	/**
+	 * Get a substring with zero-copy.
+	 *
+	 * @param offset is the beginning offset of the substring. The substring will
+	 *   - if offset is non negative, the extracted string begins at the [0+offset] position.
+	 *   - if offset is negative, the substring begins at the [length()+offset] position (e.g. counting is made from the end of the String buffer).
+	 *   - if offset is out of bounds (e.g. offset > length() or offset &lt; -length()), the returned String is empty (e.g. String::blank()).
+	 *
+	 * @param nb is the number of bytes of the desired substring, given that:
+	 *   - If nb is zero, the returned substring is String::blank().
+	 *   - If nb is non negative, the substring will contain at most nb bytes from the starting position.
+	 *   - If nb is negative, the substring will contain at most (length() - nb) bytes.
+	 *   - The calculated length cannot be larger than the String instance length, and cannot be negative.
+	 *     It is adjusted as necessary.
+	 *
+	 * @return a view on the extracted substring, or an empty view.
+	 */
+	StringView substr (int offset, int nb) const;
+
+	/**
+	 * Get a substring with zero-copy. The substring begins at a given position and
+	 * includes all the bytes up to the end of the pointed data.
+	 *
+	 * @param offset is the beginning offset of the substring. The substring will
+	 *   - If offset is non negative, the extracted string begins at the [0 + offset] position.
+	 *   - If offset is negative, the substring begins at the [length() + offset] position (e.g. counting is made from the end of the String buffer).
+	 *   - If offset is out of bounds (e.g. offset > length() or offset &lt; -length()), the returned String is empty (e.g. String::blank()).
+	 * @return a view on the extracted substring, or an empty view.
+	 */
+	StringView substr (int offset) const;
+
+	/**
+	 * Substring search.
+	 *
+	 * Gets the position of the first occurrence of a String within
+	 * the current instance.
+	 *
+	 * @param s the String to look for in the current instance.
+	 * @return the position of the matching byte sequence that is looked for,
+	 * -1 if not found.
+	 */
+	ssize_t indexOf (const StringView& s) const {
+		const uint8_t* p = (s.len > 0) ? memfind (ptr, len, s.ptr, s.len) : 0;
+		return p ? (p - ptr) : -1;
+	}
+
+	/**
+	 * Character search.
+	 *
+	 * @param c the character to look for.
+	 * @return the position of the first occurrence of c in the String
+	 * data, -1 if not found.
+	 */
+	ssize_t indexOfChar (char c) const {
+		const uint8_t* p = static_cast<const uint8_t*>(memchr (ptr, (uint8_t)c, len));
+		return p ? (p - ptr) : -1;
+	}
+
+	/**
+	 * Substring search from the end.
+	 *
+	 * Gets the position of the last occurrence of a String within
+	 * the current instance.
+	 *
+	 * @param s the String to look for in the current instance.
+	 * @return the last position of the 1st byte of s within the current instance
+	 * data, -1 if not found.
+	 */
+	ssize_t lastIndexOf (const StringView& s) const {
+		const uint8_t* p = (s.len > 0 && s.len <= len) ? memrfind (ptr, len, s.ptr, s.len) : 0;
+		return p ? (p - ptr) : -1;
+	}
+
+	/**
+	 * Character search.
+	 *
+	 * @param c the character to look for.
+	 * @return the position of the last occurrence of c in the String
+	 * data, -1 if not found.
+	 */
+	ssize_t lastIndexOfChar (char c) const {
+		const uint8_t* p = static_cast<const uint8_t*>(memrchr (ptr, (uint8_t)c, len));
+		return p ? (p - ptr) : -1;
+	}
+
+	/**
+	 * Character set search: gets the position of the first byte that
+	 * belongs to a set, in a single pass whatever the size of the set.
+	 *
+	 * @param set the bytes to look for.
+	 * @param from the position the search starts from.
+	 * @return the position of the first byte at or after from that belongs
+	 * to set, -1 if not found.
+	 */
+	ssize_t findFirstOf (const CharSet& set, size_t from = 0) const;
+
+	/**
+	 * Character set search.
+	 *
+	 * @param set the bytes to skip.
+	 * @param from the position the search starts from.
+	 * @return the position of the first byte at or after from that does not
+	 * belong to set, -1 if not found.
+	 */
+	ssize_t findFirstNotOf (const CharSet& set, size_t from = 0) const;
+
+	/**
+	 * Character set search from the end.
+	 *
+	 * @param set the bytes to look for.
+	 * @return the position of the last byte that belongs to set, -1 if not
+	 * found.
+	 */
+	ssize_t findLastOf (const CharSet& set) const;
+
+	/**
+	 * Character set search from the end.
+	 *
+	 * @param set the bytes to skip.
+	 * @return the position of the last byte that does not belong to set, -1
+	 * if not found.
+	 */
+	ssize_t findLastNotOf (const CharSet& set) const;
+
+	/**
+	 * Occurrences counted by countOf(), findAll() and MatchIterator.
+	 */
+	enum Overlap {
+		/// An occurrence starts after the end of the previous one: "aa" occurs twice in "aaaaa".
+		NON_OVERLAPPING,
+		/// An occurrence starts after the start of the previous one: "aa" occurs 4 times in "aaaaa".
+		OVERLAPPING
+	};
+
+	class MatchIterator;
+
+	/**
+	 * Counts the occurrences of a String within the current instance.
+	 *
+	 * @param needle the String to look for. An empty needle is never found.
+	 * @param mode NON_OVERLAPPING or OVERLAPPING occurrences.
+	 * @return the number of occurrences.
+	 */
+	size_t countOf (const StringView& needle, Overlap mode = NON_OVERLAPPING) const;
+
+	/**
+	 * Collects the positions of the occurrences of a String within the
+	 * current instance.
+	 *
+	 * @param needle the String to look for. An empty needle is never found.
+	 * @param out receives the positions, in increasing order, through
+	 * out.push_back() (e.g. a std::vector<size_t>).
+	 * @param mode NON_OVERLAPPING or OVERLAPPING occurrences.
+	 * @return the number of occurrences.
+	 */
+	template <class Container>
+	size_t findAll (const StringView& needle, Container& out, Overlap mode = NON_OVERLAPPING) const;
+
+	/**
+	 * Creates an iterator on the occurrences of a String within the current
+	 * instance.
+	 *
+	 * @code
+	 * for (String::MatchIterator it = field.matches ("@"); it.valid(); ++it) {
+	 *     ... it.position() ...
+	 * }
+	 * @endcode
+	 *
+	 * @param needle the String to look for. An empty needle is never found.
+	 * @param mode NON_OVERLAPPING or OVERLAPPING occurrences.
+	 * @return an iterator on the first occurrence.
+	 * @note *this and needle must exist while the iterator is in use.
+	 */
+	MatchIterator matches (const StringView& needle, Overlap mode = NON_OVERLAPPING) const;
+
+	/**
+	 * Converts the String data to an int value.
+	 *
+	 * The String content is interpreted as an integral number and returns the
+	 * corresponding value. The base in which the number is written
+	 * is determined automatically.
+	 *
+	 * @see strtol() and similar C functions.
+	 *
+	 * @return the integral value read from the String data.
+	 * @throw NumberRangeError when the value cannot fit in the range of the
+	 * desired type.
+	 * @throw NumberFormatError if an invalid character was encountered during
+	 * the conversion process.
+	 */
+	int toInt() const;
+
+	/**
+	 * Converts the String data to an int32_t value.
+	 *
+	 * The String content is interpreted as an integral number and returns the
+	 * corresponding value. The base in which the number is written
+	 * is determined automatically.
+	 * 
+	 * @see strtol() and similar C functions.
+	 *
+	 * @return the integral value read from the String data.
+	 * @throw NumberRangeError when the value cannot fit in the range of the
+	 * desired type.
+	 * @throw NumberFormatError if an invalid character was encountered during
+	 * the conversion process.
+	 */
+	int32_t toInt32() const;
+
+	/**
+	 * Converts the String data to an uint32_t value.
+	 *
+	 * The String content is interpreted as an integral number and returns the
+	 * corresponding value. The base in which the number is written
+	 * is determined automatically.
+	 *
+	 * @see strtol() and similar C functions.
+	 *
+	 * @return the integral value read from the String data.
+	 * @throw NumberRangeError when the value cannot fit in the range of the
+	 * desired type.
+	 * @throw NumberFormatError if an invalid character was encountered during
+	 * the conversion process.
+	 */
+	uint32_t toUint32() const;
+
+	/**
+	 * Converts the String data to an int64_t value.
+	 *
+	 * The String content is interpreted as an integral number and returns the
+	 * corresponding value. The base in which the number is written
+	 * is determined automatically.
+	 *
+	 * @see strtol() and similar C functions.
+	 *
+	 * @return the integral value read from the String data.
+	 * @throw NumberRangeError when the value cannot fit in the range of the
+	 * desired type.
+	 * @throw NumberFormatError if an invalid character was encountered during
+	 * the conversion process.
+	 */
+	int64_t toInt64() const;
+
+	/**
+	 * Converts the String data to an uint64_t value.
+	 *
+	 * The String content is interpreted as an integral number and returns the
+	 * corresponding value. The base in which the number is written
+	 * is determined automatically.
+	 *
+	 * @see strtol() and similar C functions.
+	 *
+	 * @return the integral value read from the String data.
+	 * @throw NumberRangeError when the value cannot fit in the range of the
+	 * desired type.
+	 * @throw NumberFormatError if an invalid character was encountered during
+	 * the conversion process.
+	 */
+	uint64_t toUint64() const;
+
+	/**
+	 * Converts the String data to a double value.
+	 *
+	 * The String content is interpreted as a floating point number and returns
+	 * the corresponding value.
+	 *
+	 * @see strtod() and similar C functions.
+	 *
+	 * @return the floating point value read from the String data.
+	 * @throw NumberRangeError when the value cannot fit in the range of the
+	 * desired type.
+	 * @throw NumberFormatError if an invalid character was encountered during
+	 * the conversion process.
+	 */
+	double toFloat() const;
+
+	/**
+	 * Converts the String data to an int value, without throwing.
+	 *
+	 * The tryTo*() conversions accept the same numbers as the to*() ones,
+	 * which are implemented on top of them. They report errors with a
+	 * status instead of an exception, for the fields where malformed
+	 * numbers are expected:
+	 *
+	 * @code
+	 * int32_t amount;
+	 * if (field.tryToInt32 (amount) != PARSE_OK) {
+	 *     ++rejected;
+	 * }
+	 * @endcode
+	 *
+	 * @param value receives the converted value. It is left unchanged when
+	 * the conversion fails.
+	 * @return PARSE_OK, or PARSE_EMPTY, PARSE_FORMAT_ERROR or
+	 * PARSE_RANGE_ERROR.
+	 */
+	ParseStatus tryToInt (int& value) const;
+
+	/// @see tryToInt(), toInt32()
+	ParseStatus tryToInt32 (int32_t& value) const;
+
+	/// @see tryToInt(), toUint32()
+	ParseStatus tryToUint32 (uint32_t& value) const;
+
+	/// @see tryToInt(), toInt64()
+	ParseStatus tryToInt64 (int64_t& value) const;
+
+	/// @see tryToInt(), toUint64()
+	ParseStatus tryToUint64 (uint64_t& value) const;
+
+	/// @see tryToInt(), toFloat()
+	ParseStatus tryToFloat (double& value) const;
+
+	/**
+	 * Converts the String data to a fixed-point Decimal, without going
+	 * through a double: "1234.56" with a scale of 2 gives 123456 * 10^-2,
+	 * exactly.
+	 *
+	 * The String may start with white spaces and a sign, and holds digits
+	 * with at most one decimal separator ("12", "12.5", ".5" and "12."
+	 * are valid). When groupSeparator is not 0, it may split the integer
+	 * part in groups of 3 digits: "1 234 567,89" with ' ' and ','.
+	 * Exponents, hexadecimal numbers, infinities and NaNs are not valid.
+	 *
+	 * Numbers with fewer decimals than the scale are padded with zeros.
+	 * Numbers with more are only valid when the extra decimals are zeros,
+	 * so that no amount is silently rounded.
+	 *
+	 * @param scale the number of decimals of the result, at most
+	 * Decimal::MAX_SCALE.
+	 * @param value receives the converted value. It is left unchanged when
+	 * the conversion fails.
+	 * @param decimalSeparator the byte that separates the decimals.
+	 * @param groupSeparator the byte that separates the groups of digits,
+	 * 0 for none.
+	 * @return PARSE_OK, or PARSE_EMPTY, PARSE_FORMAT_ERROR, or
+	 * PARSE_RANGE_ERROR when the number does not fit an int64_t mantissa
+	 * or has non-zero digits beyond the scale.
+	 */
+	ParseStatus tryToDecimal (unsigned scale, Decimal& value, char decimalSeparator = '.', char groupSeparator = 0) const;
+
+	/**
+	 * tryToDecimal() variant that throws.
+	 *
+	 * @throw NumberRangeError when the number does not fit, or has non-zero
+	 * digits beyond the scale.
+	 * @throw NumberFormatError if the String is not a decimal number.
+	 */
+	Decimal toDecimal (unsigned scale, char decimalSeparator = '.', char groupSeparator = 0) const;
+
+	/**
+	 * Allows Strings to be used in STL containers, used for value comparison.
+	 */
+	struct Comparator {
+		bool operator() (const StringView& p1, const StringView& p2) const {
+			return (p1.compareTo(p2) < 0);
+		}
+		bool starts (const StringView& p1, const StringView& s2) const {
+			return p1.startsWith(s2);
+		}
+	};
+
+	/**
+	 * Allows Strings to be used in STL containers, used for case-insensitive
+	 * value comparison.
+	 */
+	struct IComparator {
+		bool operator() (const StringView& p1, const StringView& p2) const {
+			return (p1.icompareTo(p2) < 0);
+		}
+		bool starts (const StringView& p1, const StringView& s2) const {
+			return p1.istartsWith(s2);
+		}
+	};
+
+	/**
+	 * Allows Strings to be used as keys of hashed containers, with Equal.
+	 * @code
+	 * std::unordered_map<XString, Merchant, String::Hasher, String::Equal> merchants;
+	 * @endcode
+	 */
+	struct Hasher {
+		size_t operator() (const StringView& s) const {
+			return static_cast<size_t>(s.hash());
+		}
+	};
+
+	/// Hashed containers, used for value comparison.
+	struct Equal {
+		bool operator() (const StringView& s1, const StringView& s2) const {
+			return s1.equals(s2);
+		}
+	};
+
+	/// Allows Strings to be used as case-insensitive keys of hashed containers, with IEqual.
+	struct IHasher {
+		size_t operator() (const StringView& s) const {
+			return static_cast<size_t>(s.ihash());
+		}
+	};
+
+	/// Hashed containers, used for case-insensitive value comparison.
+	struct IEqual {
+		bool operator() (const StringView& s1, const StringView& s2) const {
+			return s1.iequals(s2);
+		}
+	};
+};
+
+/**
+ * @class StringView::MatchIterator
+ * Walks through the occurrences of a needle in a String, from left to right.
+ *
+ * The needle is analysed once, and each increment resumes the vectorized
+ * search right after the previous occurrence (or right after its first byte
+ * with OVERLAPPING).
+ *
+ * @note The haystack and needle Strings must exist while the iterator is in
+ * use.
+ */
+class StringView::MatchIterator {
+	const uint8_t* hay;
+	size_t hayLength;
+	const uint8_t* needle;
+	size_t needleLength;
+	Overlap mode;
+	size_t off1;
+	size_t off2;
+	/// Position of the current occurrence, -1 when there is no more.
+	ssize_t pos;
+
+	void next (size_t from);
+
+public:
+	/**
+	 * Creates an iterator on the first occurrence of needle in hay.
+	 * @see StringView::matches()
+	 */
+	MatchIterator (const StringView& hay, const StringView& needle, Overlap mode = NON_OVERLAPPING);
+
+	/// @return true if the iterator is on an occurrence.
+	bool valid() const {
+		return (pos >= 0);
+	}
+
+	/// @return the position of the current occurrence, -1 if there is no more.
+	ssize_t position() const {
+		return pos;
+	}
+
+	/// @return the current occurrence, as a substring of the haystack.
+	StringView value() const {
+		return valid() ? StringView ((const char*) hay + pos, needleLength) : StringView();
+	}
+
+	/// Moves to the next occurrence.
+	MatchIterator& operator ++() {
+		if (valid()) {
+			next (pos + ((mode == OVERLAPPING) ? 1 : needleLength));
+		}
+		return *this;
+	}
+};
+
+inline StringView::MatchIterator StringView::matches (const StringView& needle, Overlap mode) const
+{
+	return MatchIterator (*this, needle, mode);
+}
+
+template <class Container>
+size_t StringView::findAll (const StringView& needle, Container& out, Overlap mode) const
+{
+	size_t nb = 0;
+	for (MatchIterator it (*this, needle, mode); it.valid(); ++it, ++nb) {
+		out.push_back (static_cast<size_t>(it.position()));
+	}
+	return nb;
+}
+
+inline bool operator == (const StringView& s1, const StringView& s2) {
+	return (s1.equals(s2));
+}
+
+inline bool operator != (const StringView& s1, const StringView& s2) {
+	return (!s1.equals(s2));
+}
+
+inline bool operator > (const StringView& s1, const StringView& s2) {
+	return (s1.compareTo(s2) > 0);
+}
+
+inline bool operator >= (const StringView& s1, const StringView& s2) {
+	return (s1.compareTo(s2) >= 0);
+}
+
+inline bool operator < (const StringView& s1, const StringView& s2) {
+	return (s1.compareTo(s2) < 0);
+}
+
+inline bool operator <= (const StringView& s1, const StringView& s2) {
+	return (s1.compareTo(s2) <= 0);
+}
+
+} // namespace Fianet
+
+#endif // FIANET_STRINGVIEW_H
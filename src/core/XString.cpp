@@ -19,6 +19,8 @@
  *
  */
 #include "XString.h"
+#include "ByteSearch.h"
+#include "NumberFormatting.h"
 #include <stdarg.h>
 
 namespace Fianet {
@@ -229,63 +231,251 @@ XString& XString::appendChar (char c)
 	return *this;
 }
 
-XString& XString::appendInt (int v)
+/*
+ * Integer formatting: the digits are written from the last one, two at a
+ * time from a table of the 100 digit pairs, straight into the buffer.
+ */
+
+namespace {
+
+const char DIGIT_PAIRS[201] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+const uint64_t POWERS_OF_TEN[20] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+	100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+	10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+	100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/// @return the number of decimal digits of v, 1 for 0.
+inline unsigned decimalDigits (uint64_t v)
 {
-	char buf[128];
-	size_t size = snprintf (buf, sizeof(buf), "%i", v);
+	// 1233 / 4096 is a bit more than log10(2). Setting the lowest bit
+	// changes no digit count, and gives 0 a digit.
+	v |= 1;
+	const unsigned t = ((64 - __builtin_clzll (v)) * 1233) >> 12;
+	return t + (v >= POWERS_OF_TEN[t]);
+}
 
-	return append (buf, size);
+/// Writes the digits of v before end.
+template <class T>
+inline void writeDigits (uint8_t* end, T v)
+{
+	while (v >= 100) {
+		const unsigned r = static_cast<unsigned>(v % 100);
+		v /= 100;
+		end -= 2;
+		memcpy (end, DIGIT_PAIRS + 2 * r, 2);
+	}
+	if (v >= 10) {
+		memcpy (end - 2, DIGIT_PAIRS + 2 * v, 2);
+	} else {
+		end[-1] = static_cast<uint8_t>('0' + v);
+	}
 }
 
-XString& XString::appendInt32 (int32_t v)
+inline uint64_t absolute (int64_t v)
 {
-	char buf[128];
-	size_t size = snprintf (buf, sizeof(buf), "%ld", (long) v);
+	return (v < 0) ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+}
 
-	return append (buf, size);
+} // namespace
+
+uint8_t* XString::appendSpace (size_t sz)
+{
+	if (available() < sz+1) {
+		expand (sz+1);
+	}
+
+	uint8_t* p = ptr+len;
+	len += sz;
+	*(ptr+len) = '\0';
+
+	return p;
 }
 
-XString& XString::appendUint32 (uint32_t v)
+uint8_t* XString::appendSpace (size_t sz, String& s)
+{
+	const size_t offset = reinterpret_cast<uintptr_t>(s.bytes()) - reinterpret_cast<uintptr_t>(ptr);
+	const bool inside = (offset < len);
+	uint8_t* p = appendSpace (sz);
+
+	if (inside) {
+		s.adopt (cstr() + offset, s.length());
+	}
+	return p;
+}
+
+XString& XString::appendInteger (uint64_t v, bool negative, unsigned width)
+{
+	const size_t digits = decimalDigits (v);
+	const size_t size = (width > digits + negative) ? width : digits + negative;
+	uint8_t* p = appendSpace (size);
+
+	if (negative) {
+		*p = '-';
+	}
+	memset (p + negative, '0', size - digits - negative);
+	if (v <= UINT32_MAX) {
+		writeDigits (p + size, static_cast<uint32_t>(v));
+	} else {
+		writeDigits (p + size, v);
+	}
+	return *this;
+}
+
+XString& XString::appendInt (int v)
 {
-	char buf[128];
-	size_t size = snprintf (buf, sizeof(buf), "%lu", (unsigned long) v);
+	return appendInteger (absolute (v), v < 0, 0);
+}
 
-	return append (buf, size);
+XString& XString::appendInt32 (int32_t v)
+{
+	return appendInteger (absolute (v), v < 0, 0);
+}
+
+XString& XString::appendUint32 (uint32_t v)
+{
+	return appendInteger (v, false, 0);
 }
 
 XString& XString::appendInt64 (int64_t v)
 {
-	char buf[128];
-#if (defined(BITS) && BITS == 64)
-	size_t size = snprintf (buf, sizeof(buf), "%ld", v);
-#else
-	size_t size = snprintf (buf, sizeof(buf), "%lld", v);
-#endif
-	return append (buf, size);
+	return appendInteger (absolute (v), v < 0, 0);
 }
 
 XString& XString::appendUint64 (uint64_t v)
 {
-	char buf[128];
-#if (defined(BITS) && BITS == 64)
-	size_t size = snprintf (buf, sizeof(buf), "%lu", v);
-#else
-	size_t size = snprintf (buf, sizeof(buf), "%llu", v);
-#endif
-	return append (buf, size);
+	return appendInteger (v, false, 0);
 }
 
+XString& XString::appendInt64 (int64_t v, unsigned width)
+{
+	return appendInteger (absolute (v), v < 0, width);
+}
 
-XString& XString::ltrim()
+XString& XString::appendUint64 (uint64_t v, unsigned width)
+{
+	return appendInteger (v, false, width);
+}
+
+XString& XString::appendDecimal (const Decimal& d, char decimalSeparator, char groupSeparator)
 {
-	uint8_t* lptr = ptr;
-	uint8_t* endptr = ptr+len-1;
-	size_t newlen = len;
+	const unsigned scale = d.scale();
+	const uint64_t m = absolute (d.mantissa());
+	uint64_t integer = m / POWERS_OF_TEN[scale];
+	const uint64_t fraction = m % POWERS_OF_TEN[scale];
+	const size_t digits = decimalDigits (integer);
+	const size_t groups = groupSeparator ? (digits - 1) / 3 : 0;
+	const bool negative = (d.mantissa() < 0);
+	uint8_t* p = appendSpace (negative + digits + groups + (scale ? scale + 1 : 0));
 
-	while (lptr <= endptr && isspace (static_cast<int>(*lptr))) {
-		++lptr;
-		--newlen;
+	if (negative) {
+		*p++ = '-';
 	}
+	uint8_t* end = p + digits + groups;
+	if (scale) {
+		*end = static_cast<uint8_t>(decimalSeparator);
+		memset (end + 1, '0', scale);
+		if (fraction) {
+			writeDigits (end + 1 + scale, fraction);
+		}
+	}
+	for (size_t g = 0; g < groups; ++g) {
+		const unsigned r = static_cast<unsigned>(integer % 1000);
+		integer /= 1000;
+		end -= 3;
+		end[0] = static_cast<uint8_t>('0' + r / 100);
+		memcpy (end + 1, DIGIT_PAIRS + 2 * (r % 100), 2);
+		*--end = static_cast<uint8_t>(groupSeparator);
+	}
+	writeDigits (end, integer);
+	return *this;
+}
+
+XString& XString::appendHexUint64 (uint64_t v, unsigned width, bool upperCase)
+{
+	const char* hex = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+	const size_t digits = (64 - __builtin_clzll (v | 1) + 3) / 4;
+	const size_t size = (width > digits) ? width : digits;
+	uint8_t* p = appendSpace (size);
+
+	memset (p, '0', size - digits);
+	uint8_t* end = p + size;
+	do {
+		*--end = hex[v & 0xF];
+		v >>= 4;
+	} while (v);
+	return *this;
+}
+
+
+XString& XString::appendPrinted (const char* format, unsigned precision, double v)
+{
+	size_t size = printDouble (reinterpret_cast<char*>(ptr+len), available()+1, format, precision, v);
+
+	if (size > available()) {
+		expand (size+1);
+		size = printDouble (reinterpret_cast<char*>(ptr+len), available()+1, format, precision, v);
+	}
+	len += size;
+
+	return *this;
+}
+
+XString& XString::appendDouble (double v)
+{
+	if (available() < MAX_DOUBLE_LENGTH + 1) {
+		expand (MAX_DOUBLE_LENGTH + 1);
+	}
+
+	len += formatShortest (v, ptr+len);
+	*(ptr+len) = '\0';
+
+	return *this;
+}
+
+XString& XString::appendDouble (double v, unsigned precision)
+{
+	if (available() < MAX_DOUBLE_LENGTH + 1) {
+		expand (MAX_DOUBLE_LENGTH + 1);
+	}
+
+	const size_t size = formatGeneral (v, precision, ptr+len);
+	if (UNLIKELY(size == 0)) {
+		return appendPrinted ("%.*g", precision, v);
+	}
+	len += size;
+	*(ptr+len) = '\0';
+
+	return *this;
+}
+
+XString& XString::appendFixed (double v, unsigned decimals)
+{
+	if (available() < MAX_DOUBLE_LENGTH + 1) {
+		expand (MAX_DOUBLE_LENGTH + 1);
+	}
+
+	const size_t size = formatFixed (v, decimals, ptr+len);
+	if (UNLIKELY(size == 0)) {
+		return appendPrinted ("%.*f", decimals, v);
+	}
+	len += size;
+	*(ptr+len) = '\0';
+
+	return *this;
+}
+
+
+XString& XString::ltrim()
+{
+	const size_t nb = memltrim (ptr, len);
+	const uint8_t* lptr = ptr + nb;
+	size_t newlen = len - nb;
 
 	if (newlen == 0) {
 		*buf = '\0';
@@ -304,16 +494,8 @@ XString& XString::ltrim()
 
 XString& XString::rtrim()
 {
-	uint8_t* rptr = ptr+len-1;
-	size_t newlen = len;
-
-	while (rptr >= ptr && isspace (static_cast<int>(*rptr))) {
-		--rptr;
-		--newlen;
-	}
-
-	*(rptr+1) = '\0';
-	len = newlen;
+	len -= memrtrim (ptr, len);
+	ptr[len] = '\0';
 
 	return *this;
 }
@@ -366,6 +548,11 @@ XString& XString::resize (size_t nbchars)
 
 XString& XString::toUppercase()
 {
+	if (getCaseFolding() == ASCII_CASE_FOLDING) {
+		memupper_ascii (ptr, len);
+		return *this;
+	}
+
 	uint8_t* myptr = ptr;
 	uint8_t* end = ptr+len;
 
@@ -378,6 +565,11 @@ XString& XString::toUppercase()
 
 XString& XString::toLowercase()
 {
+	if (getCaseFolding() == ASCII_CASE_FOLDING) {
+		memlower_ascii (ptr, len);
+		return *this;
+	}
+
 	uint8_t* myptr = ptr;
 	uint8_t* end = ptr+len;
 
@@ -424,49 +616,43 @@ XString& XString::sprintf (const char* fmt, ...)
 
 XString& XString::parseInt (int v)
 {
-	return this->sprintf("%d", v);
+	len = 0;
+	return appendInt (v);
 }
 
 XString& XString::parseInt32 (int32_t v)
 {
-	return this->sprintf("%d", v);
+	len = 0;
+	return appendInt32 (v);
 }
 
 XString& XString::parseUint32 (uint32_t v)
 {
-	return this->sprintf("%u", v);
+	len = 0;
+	return appendUint32 (v);
 }
 
 XString& XString::parseInt64 (int64_t v)
 {
-#if (defined(BITS) && BITS == 64)
-	return this->sprintf("%ld", v);
-#else
-	return this->sprintf("%lld", v);
-#endif
+	len = 0;
+	return appendInt64 (v);
 }
 
 XString& XString::parseUint64 (uint64_t v)
 {
-#if (defined(BITS) && BITS == 64)
-	return this->sprintf("%lu", v);
-#else
-	return this->sprintf("%llu", v);
-#endif
+	len = 0;
+	return appendUint64 (v);
 }
 
 XString& XString::parseFloat (double v)
 {
-	return this->sprintf("%g", v);
+	len = 0;
+	return appendDouble (v);
 }
 
 XString& XString::operator << (double val)
 {
-	char buf[256];
-	size_t sz = snprintf (buf, sizeof(buf),"%g", val);
-
-	append (buf, sz);
-	return *this;
+	return appendDouble (val);
 }
 
 } //namespace Fianet
@@ -90,6 +90,30 @@ private:
      */
 	size_t available() const;
 
+	/**
+	 * Extends the string by sz bytes, to be written by the caller. The
+	 * buffer is expanded as needed, and the terminal '\0' is written.
+	 *
+	 * @param sz the number of bytes to add.
+	 * @return the address of the first added byte.
+	 */
+	uint8_t* appendSpace (size_t sz);
+
+	/// Appends the decimal digits of v, with zeros before them up to width bytes.
+	XString& appendInteger (uint64_t v, bool negative, unsigned width);
+
+	/// Appends v with snprintf() in the "C" locale, for a format with a precision.
+	XString& appendPrinted (const char* format, unsigned precision, double v);
+
+	/**
+	 * appendSpace() for data computed from s, which may be a view on this
+	 * XString: s is then moved along with the buffer if it is reallocated.
+	 */
+	uint8_t* appendSpace (size_t sz, String& s);
+
+	// The decode*Into() methods write into appendSpace().
+	friend class String;
+
 public:
 	~XString();
 
@@ -211,11 +235,26 @@ public:
 	 */
 	XString& copyFromChar (char c);
 
+	/**
+	 * Replaces the contents with a decimal representation of an integral
+	 * value, as appendInt() and friends write it.
+	 *
+	 * @param v the integral value to convert.
+	 * @return *this.
+	 */
 	XString& parseInt (int v);
 	XString& parseInt32 (int32_t v);
 	XString& parseUint32 (uint32_t v);
 	XString& parseInt64 (int64_t v);
 	XString& parseUint64 (uint64_t v);
+
+	/**
+	 * Replaces the contents with the shortest representation of a value
+	 * that reads back as it, as appendDouble() writes it.
+	 *
+	 * @param v the value to convert.
+	 * @return *this.
+	 */
 	XString& parseFloat (double v);
 
 	/**
@@ -315,6 +354,125 @@ public:
 	 */
 	XString& appendUint64 (uint64_t v);
 
+	/**
+	 * Appends a decimal representation of an integral value, padded with
+	 * zeros to width bytes, as the "%0*lld" format does: a negative value
+	 * starts with a '-' counted in the width.
+	 *
+	 * @param v the integral value to convert and append.
+	 * @param width the minimum number of bytes to append.
+	 */
+	XString& appendInt64 (int64_t v, unsigned width);
+
+	/**
+	 * Appends a decimal representation of an integral value, padded with
+	 * zeros to width bytes, as the "%0*llu" format does.
+	 *
+	 * @param v the integral value to convert and append.
+	 * @param width the minimum number of bytes to append.
+	 */
+	XString& appendUint64 (uint64_t v, unsigned width);
+
+	/**
+	 * Appends a hexadecimal representation of an integral value, padded
+	 * with zeros to width bytes, as the "%0*llx" format does.
+	 *
+	 * @param v the integral value to convert and append.
+	 * @param width the minimum number of bytes to append.
+	 * @param upperCase true for the "%0*llX" format (upper case letters).
+	 */
+	XString& appendHexUint64 (uint64_t v, unsigned width = 0, bool upperCase = false);
+
+	/**
+	 * Appends the shortest decimal representation that reads back as v,
+	 * laid out as the "%.17g" format does: "0.1" for 0.1, "1e+20" for
+	 * 1e20, and "0.30000000000000004" for 0.1 + 0.2.
+	 *
+	 * The digits are computed with the Ryu algorithm, and written straight
+	 * into the buffer. The decimal separator is always '.', whatever the
+	 * locale.
+	 *
+	 * @param v the value to convert and append.
+	 */
+	XString& appendDouble (double v);
+
+	/**
+	 * Appends a representation of v with the "%.*g" format in the "C"
+	 * locale: precision significant digits, without trailing zeros.
+	 * appendDouble (v, 6) writes what the "%g" format does.
+	 *
+	 * @param v the value to convert and append.
+	 * @param precision the maximum number of significant digits.
+	 */
+	XString& appendDouble (double v, unsigned precision);
+
+	/**
+	 * Appends a representation of v with the "%.*f" format in the "C"
+	 * locale: decimals digits after the '.', none and no '.' for 0.
+	 *
+	 * @param v the value to convert and append.
+	 * @param decimals the number of digits after the '.'.
+	 */
+	XString& appendFixed (double v, unsigned decimals);
+
+	/**
+	 * Appends a fixed-point Decimal with all its decimals: Decimal (123450, 2)
+	 * gives "1234.50", Decimal (-5, 3) gives "-0.005". The digits are
+	 * computed exactly from the mantissa, and written straight into the
+	 * buffer.
+	 *
+	 * @param d the number to append.
+	 * @param decimalSeparator the byte written before the decimals, if any.
+	 * @param groupSeparator when not 0, the byte written between the groups
+	 * of 3 digits of the integer part: "1 234,50" with ' ' and ','.
+	 * @see StringView::tryToDecimal()
+	 */
+	XString& appendDecimal (const Decimal& d, char decimalSeparator = '.', char groupSeparator = 0);
+
+	/**
+	 * Appends the bytes of data as hexadecimal digits, two per byte.
+	 *
+	 * @param data the bytes to encode.
+	 * @param upperCase true for 'A' to 'F', false for 'a' to 'f'.
+	 * @see String::decodeHexInto()
+	 * @see appendHexUint64() for integral values.
+	 */
+	XString& appendHex (const String& data, bool upperCase = false);
+
+	/**
+	 * Appends the bytes of data encoded in base64 (RFC 4648, section 4),
+	 * padded with '=' to a multiple of 4 characters.
+	 *
+	 * @param data the bytes to encode.
+	 * @see String::decodeBase64Into()
+	 */
+	XString& appendBase64 (const String& data);
+
+	/**
+	 * Same as appendBase64(), with the base64url alphabet (RFC 4648,
+	 * section 5) and without padding, as in JWT and URL tokens.
+	 */
+	XString& appendBase64Url (const String& data);
+
+	/**
+	 * Appends the bytes of data encoded in base32 (RFC 4648, section 6),
+	 * padded with '=' to a multiple of 8 characters.
+	 *
+	 * @param data the bytes to encode.
+	 * @see String::decodeBase32Into()
+	 */
+	XString& appendBase32 (const String& data);
+
+	/**
+	 * Appends a UUID in its canonical form, such as
+	 * "123e4567-e89b-12d3-a456-426614174000".
+	 *
+	 * @param uuid the 16 bytes of the UUID.
+	 * @param upperCase true for 'A' to 'F', false for 'a' to 'f'.
+	 * @see String::decodeUuid()
+	 */
+	XString& appendUuid (const uint8_t uuid[16], bool upperCase = false);
+
 	/**
 	 * Removes whitespaces at the beginning of the string.
 	 *
@@ -369,14 +527,14 @@ public:
 
 	/**
 	 * Replaces all the characters in the buffer by their upper-case
-	 * counterparts.
+	 * counterparts, following the rules of setCaseFolding().
 	 * @return *this
 	 */
 	XString& toUppercase();
 
 	/**
 	 * Replaces all the characters in the buffer by their lower-case
-	 * counterparts.
+	 * counterparts, following the rules of setCaseFolding().
 	 * @return *this
 	 */
 	XString& toLowercase();
@@ -427,7 +585,7 @@ public:
      */
 	XString& operator << (uint32_t val);
 	/**
-	 * @see appendFloat()
+	 * @see appendDouble()
      * @param val
      * @return *this
      */
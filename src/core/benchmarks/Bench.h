@@ -0,0 +1,123 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef FIANET_BENCH_H
+#define FIANET_BENCH_H
+
+#include "fianet-core.h"
+#include <time.h>
+
+/*
+ * Minimal benchmark harness.
+ *
+ * A benchmark is a function declared with the BENCHMARK() macro. It builds its
+ * input data, then calls Bench::measure() once per variant to compare. Each
+ * measure() call runs a functor repeatedly for a fixed amount of time and
+ * prints the average time per call (and the throughput when a byte count is
+ * given).
+ */
+
+namespace Bench {
+
+typedef void (*Function)();
+
+/**
+ * Registers a benchmark function at static initialization time.
+ */
+struct Registrar {
+	Registrar (const char* name, Function f);
+};
+
+/**
+ * Runs every registered benchmark whose name contains filter (all of them
+ * if filter is NULL).
+ * @return the number of benchmarks run.
+ */
+int runAll (const char* filter);
+
+/// @return a monotonic timestamp, in seconds.
+inline double now()
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/// Results are accumulated here so that the compiler cannot drop them.
+extern volatile uintptr_t sink;
+
+template <class T>
+inline void keep (T v)
+{
+	sink += (uintptr_t) v;
+}
+
+/// Minimum duration of a measure, in seconds.
+const double MIN_DURATION = 0.25;
+
+/**
+ * Runs f() until MIN_DURATION has elapsed, then prints the average duration
+ * of a call.
+ *
+ * @param label the name of the measured variant.
+ * @param bytes the number of bytes processed by a call, to compute a
+ * throughput. 0 to omit it.
+ * @param f the functor to run.
+ * @return the average duration of a call, in nanoseconds.
+ */
+template <class F>
+double measure (const char* label, size_t bytes, F& f)
+{
+	size_t iterations = 0;
+	size_t batch = 1;
+	double start = now();
+	double elapsed = 0;
+
+	do {
+		for (size_t i = 0; i < batch; ++i) {
+			f();
+		}
+		iterations += batch;
+		if (batch < (1U << 20)) {
+			batch *= 2;
+		}
+		elapsed = now() - start;
+	} while (elapsed < MIN_DURATION);
+
+	double ns = elapsed * 1e9 / iterations;
+
+	if (bytes) {
+		printf ("  %-40s %12.1f ns/call %10.1f MB/s\n", label, ns, (bytes / (1024.0 * 1024.0)) / (ns * 1e-9));
+	} else {
+		printf ("  %-40s %12.1f ns/call\n", label, ns);
+	}
+	fflush (stdout);
+
+	return ns;
+}
+
+} // namespace Bench
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static Bench::Registrar name##_registrar (#name, name); \
+	static void name()
+
+#endif // FIANET_BENCH_H
@@ -0,0 +1,482 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "StringSearcher.h"
+
+using namespace Fianet;
+
+namespace {
+
+// memfind() as it was before the vectorized kernels: memchr() on the first
+// needle byte, then memcmp() on every candidate.
+uint8_t* legacy_memfind (const void* s1, size_t len_s1, const void* s2, size_t len_s2)
+{
+	const uint8_t* ptr1 = static_cast<const uint8_t*>(s1);
+	const uint8_t* ptr2 = static_cast<const uint8_t*>(s2);
+	const uint8_t* end = ptr1 + len_s1;
+	ssize_t ln = len_s1;
+
+	while (ln > 0) {
+		ptr1 = (uint8_t*) memchr(ptr1, (int)*ptr2, ln);
+		if (!ptr1 || (end - ptr1) < static_cast<ssize_t>(len_s2))
+			break;
+
+		if (memcmp(ptr1, ptr2, len_s2) == 0)
+			return const_cast<uint8_t*>(ptr1);
+
+		++ptr1;
+		ln = end - ptr1;
+	}
+
+	return 0;
+}
+
+/**
+ * Builds an XML scoring payload of about 'size' bytes, made of many
+ * fields sharing the same markup.
+ */
+void buildXmlPayload (XString& out, size_t size)
+{
+	static const char* names[] = { "amount", "currency", "merchant", "country", "ip", "phone", "zip", "city" };
+	int i = 0;
+
+	out.clear();
+	out.append ("<?xml version=\"1.0\" encoding=\"UTF-8\"?><Transaction id=\"T0001\">");
+	while (out.length() < size) {
+		out.append ("<field name=\"");
+		out.append (names[i % 8]);
+		out.append ("\" type=\"string\">value ");
+		out.appendInt (i * 7919);
+		out.append ("</field>\n");
+		++i;
+	}
+	out.append ("<email type=\"string\">john.doe@example.com</email></Transaction>");
+}
+
+typedef uint8_t* (*FindFunction) (const void*, size_t, const void*, size_t);
+
+uint8_t* glibc_memmem (const void* h, size_t hl, const void* n, size_t nl)
+{
+	return (uint8_t*) memmem (h, hl, n, nl);
+}
+
+struct Find {
+	FindFunction func;
+	const String& hay;
+	const String& needle;
+
+	Find (FindFunction f, const String& h, const String& n)
+		: func(f), hay(h), needle(n)
+	{ }
+
+	void operator()() {
+		Bench::keep (func (hay.bytes(), hay.length(), needle.bytes(), needle.length()));
+	}
+};
+
+void compare (const char* title, const String& hay, const String& needle)
+{
+	printf (" %s\n", title);
+
+	Find legacy (legacy_memfind, hay, needle);
+	Find current (memfind, hay, needle);
+	Find libc (glibc_memmem, hay, needle);
+
+	Bench::measure ("legacy memchr+memcmp", hay.length(), legacy);
+	Bench::measure ("memfind", hay.length(), current);
+	Bench::measure ("glibc memmem", hay.length(), libc);
+}
+
+} // namespace
+
+BENCHMARK (memfind_xml_payload)
+{
+	XString xml;
+	buildXmlPayload (xml, 4096);
+
+	compare ("4 KB, needle at the end", xml, "<email type=\"string\">");
+	compare ("4 KB, not found", xml, "<field name=\"device\"");
+	compare ("4 KB, short needle at the end", xml, "</Transaction>");
+	compare ("4 KB, 2 bytes needle not found", xml, "<x");
+
+	buildXmlPayload (xml, 64 * 1024);
+	compare ("64 KB, needle at the end", xml, "<email type=\"string\">");
+}
+
+BENCHMARK (memfind_short_fields)
+{
+	// Short free text fields, as seen in addresses and names.
+	String field ("12 rue de la Republique, 69002 Lyon, France");
+
+	compare ("43 bytes, found", field, "Lyon");
+	compare ("43 bytes, not found", field, "Paris");
+}
+
+namespace {
+
+struct IndexOf {
+	const String& hay;
+	const String& needle;
+
+	IndexOf (const String& h, const String& n)
+		: hay(h), needle(n)
+	{ }
+
+	void operator()() {
+		Bench::keep (hay.indexOf (needle));
+	}
+};
+
+struct SearcherFind {
+	const String& hay;
+	const String::Searcher& searcher;
+
+	SearcherFind (const String& h, const String::Searcher& s)
+		: hay(h), searcher(s)
+	{ }
+
+	void operator()() {
+		Bench::keep (searcher.find (hay));
+	}
+};
+
+void compareSearcher (const char* title, const String& hay, const String& needle)
+{
+	printf (" %s\n", title);
+
+	String::Searcher searcher (needle);
+	IndexOf indexOf (hay, needle);
+	SearcherFind find (hay, searcher);
+
+	Bench::measure ("String::indexOf", hay.length(), indexOf);
+	Bench::measure ("String::Searcher::find", hay.length(), find);
+}
+
+} // namespace
+
+BENCHMARK (searcher_vs_indexOf)
+{
+	XString xml;
+	buildXmlPayload (xml, 4096);
+
+	compareSearcher ("4 KB, short needle", xml, "<email type=\"string\">");
+	compareSearcher ("4 KB, long needle", xml, "<email type=\"string\">john.doe@example.com</email>");
+
+	// Worst case for the memchr + memcmp approach: quadratic.
+	XString zeros, needle;
+	for (int i = 0; i < 64 * 1024; ++i) {
+		zeros.appendChar ('0');
+	}
+	for (int i = 0; i < 1024; ++i) {
+		needle.appendChar ('0');
+	}
+	needle.appendChar ('1');
+	compareSearcher ("64 KB of '0', 1 KB needle '000...01'", zeros, needle);
+
+	// Worst case for the candidate filter: both filter bytes match at every
+	// other position, and verification fails in the middle of the needle.
+	XString periodic;
+	for (int i = 0; i < 32 * 1024; ++i) {
+		periodic.append ("ab");
+	}
+	needle.clear();
+	for (int i = 0; i < 300; ++i) {
+		needle.append ("ab");
+	}
+	needle.append ("aa");
+	for (int i = 0; i < 300; ++i) {
+		needle.append ("ab");
+	}
+	needle.appendChar ('a');
+	compareSearcher ("64 KB of 'ab', 1.2 KB needle '(ab)*aa(ab)*a'", periodic, needle);
+}
+
+namespace {
+
+typedef int (*CompareFunction) (const void*, const void*, size_t);
+
+struct ICompare {
+	CompareFunction func;
+	const String& s1;
+	const String& s2;
+
+	ICompare (CompareFunction f, const String& a, const String& b)
+		: func(f), s1(a), s2(b)
+	{ }
+
+	void operator()() {
+		Bench::keep (func (s1.bytes(), s2.bytes(), s1.length()));
+	}
+};
+
+void compareICompare (const char* title, const String& s1, const String& s2)
+{
+	printf (" %s\n", title);
+
+	ICompare locale (memicompare_locale, s1, s2);
+	ICompare ascii (memicompare_ascii, s1, s2);
+
+	Bench::measure ("memicompare, toupper()", s1.length(), locale);
+	Bench::measure ("memicompare, ASCII folding", s1.length(), ascii);
+}
+
+void compareIFind (const char* title, const String& hay, const String& needle)
+{
+	printf (" %s\n", title);
+
+	Find locale (memifind_locale, hay, needle);
+	Find ascii (memifind_ascii, hay, needle);
+
+	Bench::measure ("memifind, toupper()", hay.length(), locale);
+	Bench::measure ("memifind, ASCII folding", hay.length(), ascii);
+}
+
+} // namespace
+
+BENCHMARK (case_insensitive)
+{
+	compareICompare ("16 bytes keys", "Content-Encoding", "content-encoding");
+	compareICompare ("64 bytes keys", "Jean-Christophe de la Fontaine, 12 avenue des Champs-Elysees Paris",
+			"JEAN-CHRISTOPHE DE LA FONTAINE, 12 AVENUE DES CHAMPS-ELYSEES PARIS");
+
+	XString xml;
+	buildXmlPayload (xml, 4096);
+	compareIFind ("4 KB, needle at the end", xml, "<EMAIL TYPE=\"STRING\">");
+	compareIFind ("4 KB, not found", xml, "<FIELD NAME=\"DEVICE\"");
+}
+
+namespace {
+
+// Occurrence counting as our feature extractors did it: substr() + indexOf().
+struct SubstrCount {
+	const String& hay;
+	const String& needle;
+
+	SubstrCount (const String& h, const String& n)
+		: hay(h), needle(n)
+	{ }
+
+	void operator()() {
+		size_t nb = 0;
+		String rest (hay);
+		ssize_t pos;
+
+		while ((pos = rest.indexOf (needle)) >= 0) {
+			++nb;
+			rest = rest.substr (pos + needle.length());
+		}
+		Bench::keep (nb);
+	}
+};
+
+struct CountOf {
+	const String& hay;
+	const String& needle;
+
+	CountOf (const String& h, const String& n)
+		: hay(h), needle(n)
+	{ }
+
+	void operator()() {
+		Bench::keep (hay.countOf (needle));
+	}
+};
+
+void compareCount (const char* title, const String& hay, const String& needle)
+{
+	printf (" %s\n", title);
+
+	SubstrCount loop (hay, needle);
+	CountOf count (hay, needle);
+
+	Bench::measure ("substr() + indexOf() loop", hay.length(), loop);
+	Bench::measure ("String::countOf", hay.length(), count);
+}
+
+} // namespace
+
+BENCHMARK (countOf)
+{
+	XString xml;
+	buildXmlPayload (xml, 4096);
+
+	compareCount ("4 KB, one occurrence per field", xml, "<field name=");
+	compareCount ("4 KB, one occurrence every 8 fields", xml, "\"currency\"");
+	compareCount ("4 KB, 1 byte needle", xml, "\"");
+}
+
+namespace {
+
+// First of several delimiters, as done before CharSet: one indexOfChar()
+// per delimiter, then the minimum.
+ssize_t minIndexOfChar (const String& s, const char* delimiters)
+{
+	ssize_t best = -1;
+	for (const char* d = delimiters; *d; ++d) {
+		const ssize_t pos = s.indexOfChar (*d);
+		if (pos >= 0 && (best < 0 || pos < best)) {
+			best = pos;
+		}
+	}
+	return best;
+}
+
+struct SplitIndexOfChar {
+	const String& s;
+	const char* delimiters;
+
+	SplitIndexOfChar (const String& str, const char* d)
+		: s(str), delimiters(d)
+	{ }
+
+	void operator()() {
+		size_t nb = 0;
+		String rest (s);
+		ssize_t pos;
+
+		while ((pos = minIndexOfChar (rest, delimiters)) >= 0) {
+			++nb;
+			rest = rest.substr (pos + 1);
+		}
+		Bench::keep (nb);
+	}
+};
+
+struct SplitFindFirstOf {
+	const String& s;
+	const CharSet set;
+
+	SplitFindFirstOf (const String& str, const char* d)
+		: s(str), set(d)
+	{ }
+
+	void operator()() {
+		size_t nb = 0;
+		ssize_t pos = -1;
+
+		while ((pos = s.findFirstOf (set, pos + 1)) >= 0) {
+			++nb;
+		}
+		Bench::keep (nb);
+	}
+};
+
+void compareFirstOf (const char* title, const String& s, const char* delimiters)
+{
+	printf (" %s\n", title);
+
+	SplitIndexOfChar loop (s, delimiters);
+	SplitFindFirstOf set (s, delimiters);
+
+	Bench::measure ("indexOfChar() per delimiter", s.length(), loop);
+	Bench::measure ("String::findFirstOf", s.length(), set);
+}
+
+} // namespace
+
+BENCHMARK (findFirstOf)
+{
+	XString text, record;
+
+	while (text.length() < 4096) {
+		text.append ("Livraison en point relais si possible, merci de sonner deux fois. ");
+	}
+	text.append (";");
+
+	for (int i = 0; record.length() < 10 * 1024; ++i) {
+		record.append ("value ");
+		record.appendInt (i * 7919);
+		record.appendChar (";,|\t"[i % 4]);
+	}
+
+	compareFirstOf ("4 KB free text, delimiter at the end", text, ";|\t");
+	compareFirstOf ("10 KB record, 4 delimiters", record, ";,|\t");
+}
+
+namespace {
+
+struct IFind {
+	const String& hay;
+	const String& needle;
+
+	IFind (const String& h, const String& n)
+		: hay(h), needle(n)
+	{ }
+
+	void operator()() {
+		Bench::keep (memifind (hay.bytes(), hay.length(), needle.bytes(), needle.length()));
+	}
+};
+
+struct FirstOf {
+	const String& s;
+	const CharSet set;
+
+	FirstOf (const String& str, const char* chars)
+		: s(str), set(chars)
+	{ }
+
+	void operator()() {
+		Bench::keep (s.findFirstOf (set));
+	}
+};
+
+struct Uppercase {
+	XString& s;
+
+	explicit Uppercase (XString& str)
+		: s(str)
+	{ }
+
+	void operator()() {
+		Bench::keep (s.toUppercase().length());
+	}
+};
+
+} // namespace
+
+BENCHMARK (simd_levels)
+{
+	const SimdLevel initial = getSimdLevel();
+	XString xml, copy;
+	buildXmlPayload (xml, 4096);
+	copy.copyFrom (xml);
+
+	const String needle ("<email type=\"string\">");
+	const String ineedle ("<EMAIL TYPE=\"STRING\">");
+	Find find (memfind, xml, needle);
+	IFind ifind (xml, ineedle);
+	FirstOf firstOf (xml, "@;|");
+	Uppercase upper (copy);
+
+	for (int l = SIMD_SCALAR; l <= supportedSimdLevel(); ++l) {
+		setSimdLevel (static_cast<SimdLevel>(l));
+		printf (" 4 KB, %s\n", simdLevelName (getSimdLevel()));
+
+		Bench::measure ("memfind", xml.length(), find);
+		Bench::measure ("memifind", xml.length(), ifind);
+		Bench::measure ("String::findFirstOf", xml.length(), firstOf);
+		Bench::measure ("XString::toUppercase", copy.length(), upper);
+	}
+
+	setSimdLevel (initial);
+}
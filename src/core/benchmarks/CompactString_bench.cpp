@@ -0,0 +1,114 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include <algorithm>
+
+using namespace Fianet;
+
+namespace {
+
+const size_t ROWS = 100000;
+
+template <class S>
+struct Scan {
+	const S* column;
+	S key;
+
+	Scan (const S* c, const S& k)
+		: column(c), key(k)
+	{ }
+
+	void operator()() {
+		size_t found = 0;
+		for (size_t i = 0; i < ROWS; ++i) {
+			found += column[i].equals (key);
+		}
+		Bench::keep (found);
+	}
+
+private:
+	Scan (const Scan&);
+	Scan& operator = (const Scan&);
+};
+
+template <class S, class Comparator>
+struct Sort {
+	const S* column;
+	S* work;
+
+	Sort (const S* c, S* w)
+		: column(c), work(w)
+	{ }
+
+	void operator()() {
+		std::copy (column, column + ROWS, work);
+		std::sort (work, work + ROWS, Comparator());
+		Bench::keep (work[0].length());
+	}
+};
+
+void compare (const char* label, size_t length)
+{
+	char* data = new char[ROWS * length];
+	String* strings = new String[ROWS];
+	String* stringWork = new String[ROWS];
+	CompactString* compacts = new CompactString[ROWS];
+	CompactString* compactWork = new CompactString[ROWS];
+
+	// Country + merchant codes: most rows differ within the first 4 bytes.
+	for (size_t i = 0; i < ROWS; ++i) {
+		char* row = data + i * length;
+		memset (row, '0', length);
+		memcpy (row, (i % 3) ? "FR" : "BE", 2);
+		size_t v = (i * 2654435761u) % 1000000;
+		for (size_t d = 2; d < 8 && d < length; ++d) {
+			row[d] = 'A' + v % 26;
+			v /= 26;
+		}
+		strings[i] = String (row, length);
+		compacts[i] = CompactString (strings[i]);
+	}
+
+	printf (" %s, %u bytes, %u rows\n", label, (unsigned) length, (unsigned) ROWS);
+	Scan<String> stringScan (strings, strings[ROWS / 2]);
+	Scan<CompactString> compactScan (compacts, compacts[ROWS / 2]);
+	Sort<String, String::Comparator> stringSort (strings, stringWork);
+	Sort<CompactString, CompactString::Comparator> compactSort (compacts, compactWork);
+	Bench::measure ("String::equals() scan", 0, stringScan);
+	Bench::measure ("CompactString::equals() scan", 0, compactScan);
+	Bench::measure ("std::sort(), String::Comparator", 0, stringSort);
+	Bench::measure ("std::sort(), CompactString::Comparator", 0, compactSort);
+
+	delete [] compactWork;
+	delete [] compacts;
+	delete [] stringWork;
+	delete [] strings;
+	delete [] data;
+}
+
+} // namespace
+
+BENCHMARK (compact_string)
+{
+	compare ("inline", 10);
+	compare ("pointer", 24);
+}
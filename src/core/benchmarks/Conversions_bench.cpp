@@ -0,0 +1,646 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "ColumnParsing.h"
+#include <cerrno>
+
+using namespace Fianet;
+
+namespace {
+
+const size_t FIELDS = 10000;
+
+const int64_t POWERS_OF_TEN[19] = {
+	1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+	1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+	100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+	1000000000000000000LL
+};
+
+/// The previous String::toInt64(): a NUL-terminated copy, then strtoll().
+int64_t strtollInt64 (const String& s)
+{
+	char tmp[256];
+	char* end;
+	const size_t len = (s.length() < sizeof(tmp) - 1) ? s.length() : sizeof(tmp) - 1;
+
+	if (len == 0) {
+		throw NumberFormatError();
+	}
+	memcpy (tmp, s.cstr(), len);
+	tmp[len] = 0;
+	errno = 0;
+	const long long v = strtoll (tmp, &end, 0);
+	if (errno == ERANGE) {
+		throw NumberRangeError();
+	} else if (end != tmp + s.length()) {
+		throw NumberFormatError();
+	}
+	return v;
+}
+
+/// The previous String::toFloat(): a NUL-terminated copy, then strtod().
+double strtodFloat (const String& s)
+{
+	char tmp[256];
+	char* end;
+	const size_t len = (s.length() < sizeof(tmp) - 1) ? s.length() : sizeof(tmp) - 1;
+
+	if (len == 0) {
+		throw NumberFormatError();
+	}
+	memcpy (tmp, s.cstr(), len);
+	tmp[len] = 0;
+	errno = 0;
+	const double v = strtod (tmp, &end);
+	if (end != tmp + s.length()) {
+		throw NumberFormatError();
+	} else if (errno == ERANGE) {
+		throw NumberRangeError();
+	}
+	return v;
+}
+
+struct Strtoll {
+	const String* fields;
+
+	explicit Strtoll (const String* f)
+		: fields(f)
+	{ }
+
+	void operator()() {
+		int64_t sum = 0;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			sum += strtollInt64 (fields[i]);
+		}
+		Bench::keep (sum);
+	}
+};
+
+struct ToInt64 {
+	const String* fields;
+
+	explicit ToInt64 (const String* f)
+		: fields(f)
+	{ }
+
+	void operator()() {
+		int64_t sum = 0;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			sum += fields[i].toInt64();
+		}
+		Bench::keep (sum);
+	}
+};
+
+struct ToInt32 {
+	const String* fields;
+
+	explicit ToInt32 (const String* f)
+		: fields(f)
+	{ }
+
+	void operator()() {
+		int64_t sum = 0;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			sum += fields[i].toInt32();
+		}
+		Bench::keep (sum);
+	}
+};
+
+struct Strtod {
+	const String* fields;
+
+	explicit Strtod (const String* f)
+		: fields(f)
+	{ }
+
+	void operator()() {
+		double sum = 0;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			sum += strtodFloat (fields[i]);
+		}
+		Bench::keep (sum);
+	}
+};
+
+struct ToFloat {
+	const String* fields;
+
+	explicit ToFloat (const String* f)
+		: fields(f)
+	{ }
+
+	void operator()() {
+		double sum = 0;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			sum += fields[i].toFloat();
+		}
+		Bench::keep (sum);
+	}
+};
+
+struct Int64Column {
+	const String* fields;
+	int64_t* values;
+	uint8_t* status;
+
+	Int64Column (const String* f, int64_t* v, uint8_t* st)
+		: fields(f), values(v), status(st)
+	{ }
+
+	void operator()() {
+		Bench::keep (parseInt64Column (fields, FIELDS, values, status));
+	}
+};
+
+struct DoubleColumn {
+	const String* fields;
+	double* values;
+	uint8_t* status;
+
+	DoubleColumn (const String* f, double* v, uint8_t* st)
+		: fields(f), values(v), status(st)
+	{ }
+
+	void operator()() {
+		Bench::keep (parseDoubleColumn (fields, FIELDS, values, status));
+	}
+};
+
+/// Counts the valid fields with toInt64(), catching the exceptions.
+struct CatchToInt64 {
+	const String* fields;
+
+	explicit CatchToInt64 (const String* f)
+		: fields(f)
+	{ }
+
+	void operator()() {
+		int64_t sum = 0;
+		size_t rejected = 0;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			try {
+				sum += fields[i].toInt64();
+			} catch (const NumberError&) {
+				++rejected;
+			}
+		}
+		Bench::keep (sum + rejected);
+	}
+};
+
+/// Counts the valid fields with tryToInt64().
+struct TryToInt64 {
+	const String* fields;
+
+	explicit TryToInt64 (const String* f)
+		: fields(f)
+	{ }
+
+	void operator()() {
+		int64_t sum = 0;
+		size_t rejected = 0;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			int64_t v;
+			if (fields[i].tryToInt64 (v) == PARSE_OK) {
+				sum += v;
+			} else {
+				++rejected;
+			}
+		}
+		Bench::keep (sum + rejected);
+	}
+};
+
+/// The previous XString::appendInt64(): snprintf(), then append().
+struct SnprintfAppend {
+	const int64_t* values;
+	XString& out;
+
+	SnprintfAppend (const int64_t* v, XString& o)
+		: values(v), out(o)
+	{ }
+
+	void operator()() {
+		char buf[128];
+		out.clear();
+		for (size_t i = 0; i < FIELDS; ++i) {
+			out.append (buf, snprintf (buf, sizeof(buf), "%lld", (long long) values[i])).appendChar (';');
+		}
+		Bench::keep (out.length());
+	}
+};
+
+struct AppendInt64 {
+	const int64_t* values;
+	XString& out;
+
+	AppendInt64 (const int64_t* v, XString& o)
+		: values(v), out(o)
+	{ }
+
+	void operator()() {
+		out.clear();
+		for (size_t i = 0; i < FIELDS; ++i) {
+			out.appendInt64 (values[i]).appendChar (';');
+		}
+		Bench::keep (out.length());
+	}
+};
+
+/// XString::parseInt64() over the same XString, as done for each field of a record.
+struct ParseInt64 {
+	const int64_t* values;
+
+	explicit ParseInt64 (const int64_t* v)
+		: values(v)
+	{ }
+
+	void operator()() {
+		XString tmp;
+		size_t total = 0;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			total += tmp.parseInt64 (values[i]).length();
+		}
+		Bench::keep (total);
+	}
+};
+
+struct AppendHexUint64 {
+	const int64_t* values;
+	XString& out;
+
+	AppendHexUint64 (const int64_t* v, XString& o)
+		: values(v), out(o)
+	{ }
+
+	void operator()() {
+		out.clear();
+		for (size_t i = 0; i < FIELDS; ++i) {
+			out.appendHexUint64 (static_cast<uint64_t>(values[i]), 16).appendChar (';');
+		}
+		Bench::keep (out.length());
+	}
+};
+
+/// The previous XString::operator << (double): snprintf() with a format, then append().
+struct SnprintfDouble {
+	const double* values;
+	XString& out;
+	const char* format;
+
+	SnprintfDouble (const double* v, XString& o, const char* f)
+		: values(v), out(o), format(f)
+	{ }
+
+	void operator()() {
+		char buf[256];
+		out.clear();
+		for (size_t i = 0; i < FIELDS; ++i) {
+			out.append (buf, snprintf (buf, sizeof(buf), format, values[i])).appendChar (';');
+		}
+		Bench::keep (out.length());
+	}
+};
+
+/// XString::appendDouble(), appendDouble (v, 6) or appendFixed (v, 2).
+struct AppendDouble {
+	enum Mode { SHORTEST, GENERAL, FIXED };
+
+	const double* values;
+	XString& out;
+	Mode mode;
+
+	AppendDouble (const double* v, XString& o, Mode m)
+		: values(v), out(o), mode(m)
+	{ }
+
+	void operator()() {
+		out.clear();
+		for (size_t i = 0; i < FIELDS; ++i) {
+			if (mode == SHORTEST) {
+				out.appendDouble (values[i]);
+			} else if (mode == GENERAL) {
+				out.appendDouble (values[i], 6);
+			} else {
+				out.appendFixed (values[i], 2);
+			}
+			out.appendChar (';');
+		}
+		Bench::keep (out.length());
+	}
+};
+
+/// Amounts in cents the way they used to be read: toFloat(), then rounded.
+struct ToFloatCents {
+	const String* fields;
+	int64_t* cents;
+
+	ToFloatCents (const String* f, int64_t* c)
+		: fields(f), cents(c)
+	{ }
+
+	void operator()() {
+		for (size_t i = 0; i < FIELDS; ++i) {
+			const double v = fields[i].toFloat() * 100.0;
+			cents[i] = static_cast<int64_t>(v < 0 ? v - 0.5 : v + 0.5);
+		}
+		Bench::keep (cents[FIELDS - 1]);
+	}
+};
+
+/// String::tryToDecimal (2, ...).
+struct TryToDecimal {
+	const String* fields;
+	int64_t* cents;
+
+	TryToDecimal (const String* f, int64_t* c)
+		: fields(f), cents(c)
+	{ }
+
+	void operator()() {
+		Decimal d;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			fields[i].tryToDecimal (2, d);
+			cents[i] = d.mantissa();
+		}
+		Bench::keep (cents[FIELDS - 1]);
+	}
+};
+
+/// Amounts in cents written with appendFixed (cents / 100.0, 2) or appendDecimal().
+struct AppendCents {
+	const int64_t* cents;
+	XString& out;
+	bool decimal;
+
+	AppendCents (const int64_t* c, XString& o, bool d)
+		: cents(c), out(o), decimal(d)
+	{ }
+
+	void operator()() {
+		out.clear();
+		for (size_t i = 0; i < FIELDS; ++i) {
+			if (decimal) {
+				out.appendDecimal (Decimal (cents[i], 2));
+			} else {
+				out.appendFixed (static_cast<double>(cents[i]) / 100.0, 2);
+			}
+			out.appendChar (';');
+		}
+		Bench::keep (out.length());
+	}
+};
+
+/// Splits a buffer of NUL-separated fields.
+void splitFields (const XString& data, String* fields)
+{
+	const char* p = data.cstr();
+	for (size_t i = 0; i < FIELDS; ++i) {
+		const size_t len = strlen (p);
+		fields[i] = String (p, len);
+		p += len + 1;
+	}
+}
+
+/**
+ * Formats FIELDS random numbers with a printf() format: "%.2f" for
+ * amounts, "%.17g" for doubles printed with all their digits.
+ */
+void compareFloats (const char* label, const char* format, double scale)
+{
+	XString data;
+	String* fields = new String[FIELDS];
+	uint64_t seed = 42;
+	char buffer[64];
+
+	for (size_t i = 0; i < FIELDS; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		const double v = static_cast<double>(seed >> 11) / 9007199254740992.0 * scale;
+		data.append (buffer, snprintf (buffer, sizeof(buffer), format, v)).appendChar ('\0');
+	}
+	splitFields (data, fields);
+
+	printf (" %s, %u fields, %u bytes\n", label, (unsigned) FIELDS, (unsigned) data.length());
+	Strtod strtodParse (fields);
+	ToFloat toFloat (fields);
+	Bench::measure ("copy + strtod()", data.length(), strtodParse);
+	Bench::measure ("String::toFloat()", data.length(), toFloat);
+	double* values = new double[FIELDS];
+	uint8_t* status = new uint8_t[FIELDS];
+	DoubleColumn column (fields, values, status);
+	Bench::measure ("parseDoubleColumn()", data.length(), column);
+
+	delete [] status;
+	delete [] values;
+	delete [] fields;
+}
+
+/// Integers of 1 to maxDigits digits, one in 4 negative.
+void compareInts (const char* label, unsigned maxDigits)
+{
+	XString data;
+	String* fields = new String[FIELDS];
+	size_t* offsets = new size_t[FIELDS + 1];
+	uint64_t seed = 42;
+
+	for (size_t i = 0; i < FIELDS; ++i) {
+		offsets[i] = data.length();
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		const unsigned digits = 1 + (seed >> 33) % maxDigits;
+		if ((seed >> 20) % 4 == 0) {
+			data.appendChar ('-');
+		}
+		data.appendChar ('1' + (seed >> 40) % 9);
+		for (unsigned d = 1; d < digits; ++d) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			data.appendChar ('0' + (seed >> 33) % 10);
+		}
+	}
+	offsets[FIELDS] = data.length();
+	for (size_t i = 0; i < FIELDS; ++i) {
+		fields[i] = String (data.cstr() + offsets[i], offsets[i + 1] - offsets[i]);
+	}
+
+	printf (" %s, %u fields, %u bytes\n", label, (unsigned) FIELDS, (unsigned) data.length());
+	Strtoll strtollParse (fields);
+	ToInt64 toInt64 (fields);
+	Bench::measure ("copy + strtoll()", data.length(), strtollParse);
+	Bench::measure ("String::toInt64()", data.length(), toInt64);
+	if (maxDigits <= 9) {
+		ToInt32 toInt32 (fields);
+		Bench::measure ("String::toInt32()", data.length(), toInt32);
+	}
+	int64_t* values = new int64_t[FIELDS];
+	uint8_t* status = new uint8_t[FIELDS];
+	Int64Column column (fields, values, status);
+	Bench::measure ("parseInt64Column()", data.length(), column);
+
+	delete [] status;
+	delete [] values;
+
+	delete [] offsets;
+	delete [] fields;
+}
+
+} // namespace
+
+BENCHMARK (to_int)
+{
+	compareInts ("short (1-4 digits)", 4);
+	compareInts ("int32 (1-9 digits)", 9);
+	compareInts ("long (1-18 digits)", 18);
+}
+
+BENCHMARK (from_int)
+{
+	const unsigned maxDigits[] = { 4, 9, 18 };
+	int64_t* values = new int64_t[FIELDS];
+	XString out;
+
+	for (size_t m = 0; m < sizeof(maxDigits) / sizeof(maxDigits[0]); ++m) {
+		uint64_t seed = 42;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			const unsigned digits = 1 + (seed >> 33) % maxDigits[m];
+			values[i] = static_cast<int64_t>((seed >> 1) % POWERS_OF_TEN[digits]);
+			if ((seed >> 20) % 4 == 0) {
+				values[i] = -values[i];
+			}
+		}
+
+		AppendInt64 appendInt (values, out);
+		appendInt();
+		printf (" 1-%u digits, %u values, %u bytes\n", maxDigits[m], (unsigned) FIELDS, (unsigned) out.length());
+		SnprintfAppend snprintfAppend (values, out);
+		ParseInt64 parseInt (values);
+		AppendHexUint64 appendHex (values, out);
+		Bench::measure ("snprintf() + append()", out.length(), snprintfAppend);
+		Bench::measure ("XString::appendInt64()", out.length(), appendInt);
+		Bench::measure ("XString::parseInt64()", out.length(), parseInt);
+		Bench::measure ("XString::appendHexUint64 (v, 16)", 0, appendHex);
+	}
+
+	delete [] values;
+}
+
+BENCHMARK (from_float)
+{
+	const char* labels[] = { "amounts (2 decimals)", "scores (random doubles in [0, 1))", "large (up to 1e20)" };
+	double* values = new double[FIELDS];
+	XString out;
+
+	for (int kind = 0; kind < 3; ++kind) {
+		uint64_t seed = 42;
+		for (size_t i = 0; i < FIELDS; ++i) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			const double r = static_cast<double>(seed >> 11) / 9007199254740992.0;
+			values[i] = (kind == 0) ? static_cast<double>(seed % 1000000) / 100.0 : (kind == 1) ? r : r * 1e20;
+		}
+
+		printf (" %s, %u values\n", labels[kind], (unsigned) FIELDS);
+		SnprintfDouble g (values, out, "%g");
+		SnprintfDouble g17 (values, out, "%.17g");
+		SnprintfDouble f2 (values, out, "%.2f");
+		AppendDouble shortest (values, out, AppendDouble::SHORTEST);
+		AppendDouble general (values, out, AppendDouble::GENERAL);
+		AppendDouble fixed (values, out, AppendDouble::FIXED);
+		Bench::measure ("snprintf (\"%g\") + append()", 0, g);
+		Bench::measure ("XString::appendDouble (v, 6)", 0, general);
+		Bench::measure ("snprintf (\"%.17g\") + append()", 0, g17);
+		Bench::measure ("XString::appendDouble (v)", 0, shortest);
+		Bench::measure ("snprintf (\"%.2f\") + append()", 0, f2);
+		Bench::measure ("XString::appendFixed (v, 2)", 0, fixed);
+	}
+
+	delete [] values;
+}
+
+BENCHMARK (to_float)
+{
+	compareFloats ("amounts (%.2f)", "%.2f", 10000.0);
+	compareFloats ("scores (%.6f)", "%.6f", 1.0);
+	compareFloats ("doubles (%.17g)", "%.17g", 1e6);
+	compareFloats ("scientific (%.10e)", "%.10e", 1e-20);
+}
+
+BENCHMARK (decimals)
+{
+	XString data, out;
+	String* fields = new String[FIELDS];
+	int64_t* cents = new int64_t[FIELDS];
+	uint64_t seed = 42;
+
+	for (size_t i = 0; i < FIELDS; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		cents[i] = static_cast<int64_t>(seed % 10000000) - 1000000;
+		data.appendDecimal (Decimal (cents[i], 2)).appendChar ('\0');
+	}
+	splitFields (data, fields);
+
+	printf (" amounts (2 decimals), %u fields, %u bytes\n", (unsigned) FIELDS, (unsigned) data.length());
+	ToFloatCents toFloat (fields, cents);
+	TryToDecimal toDecimal (fields, cents);
+	Bench::measure ("toFloat() * 100, rounded", data.length(), toFloat);
+	Bench::measure ("String::tryToDecimal (2)", data.length(), toDecimal);
+	AppendCents fixed (cents, out, false);
+	AppendCents decimal (cents, out, true);
+	Bench::measure ("XString::appendFixed (v / 100.0, 2)", 0, fixed);
+	Bench::measure ("XString::appendDecimal()", 0, decimal);
+
+	delete [] cents;
+	delete [] fields;
+}
+
+BENCHMARK (malformed_fields)
+{
+	const char* malformed[] = { "", "N/A", "12a4", "1 000", "99999999999999999999" };
+	const unsigned ratios[] = { 0, 1, 5, 10, 50 };
+	XString data;
+	String* fields = new String[FIELDS];
+	char buffer[32];
+
+	for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); ++r) {
+		uint64_t seed = 42;
+		data.clear();
+		for (size_t i = 0; i < FIELDS; ++i) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			if ((seed >> 33) % 100 < ratios[r]) {
+				data.append (malformed[(seed >> 20) % 5]);
+			} else {
+				data.append (buffer, snprintf (buffer, sizeof(buffer), "%u", (unsigned) (seed >> 44)));
+			}
+			data.appendChar ('\0');
+		}
+		splitFields (data, fields);
+
+		printf (" %u%% malformed, %u fields\n", ratios[r], (unsigned) FIELDS);
+		CatchToInt64 catchParse (fields);
+		TryToInt64 tryParse (fields);
+		Bench::measure ("toInt64() + catch", 0, catchParse);
+		Bench::measure ("tryToInt64()", 0, tryParse);
+	}
+
+	delete [] fields;
+}
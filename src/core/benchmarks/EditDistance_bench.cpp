@@ -0,0 +1,175 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "EditDistance.h"
+
+using namespace Fianet;
+
+namespace {
+
+// Edit distance as our matching code did it: the full matrix, String::charAt().
+size_t naiveDistance (const String& a, const String& b)
+{
+	const size_t m = a.length(), n = b.length();
+	size_t* d = static_cast<size_t*>(malloc ((m + 1) * (n + 1) * sizeof(size_t)));
+
+	for (size_t i = 0; i <= m; ++i) {
+		d[i * (n + 1)] = i;
+	}
+	for (size_t j = 0; j <= n; ++j) {
+		d[j] = j;
+	}
+	for (size_t i = 1; i <= m; ++i) {
+		for (size_t j = 1; j <= n; ++j) {
+			size_t v = d[(i - 1) * (n + 1) + j - 1] + ((a.charAt (i - 1) == b.charAt (j - 1)) ? 0 : 1);
+			if (d[(i - 1) * (n + 1) + j] + 1 < v) {
+				v = d[(i - 1) * (n + 1) + j] + 1;
+			}
+			if (d[i * (n + 1) + j - 1] + 1 < v) {
+				v = d[i * (n + 1) + j - 1] + 1;
+			}
+			d[i * (n + 1) + j] = v;
+		}
+	}
+
+	const size_t res = d[m * (n + 1) + n];
+	free (d);
+	return res;
+}
+
+struct Naive {
+	const String& a;
+	const String& b;
+
+	Naive (const String& x, const String& y)
+		: a(x), b(y)
+	{ }
+
+	void operator()() {
+		Bench::keep (naiveDistance (a, b));
+	}
+};
+
+struct Myers {
+	const String& a;
+	const String& b;
+
+	Myers (const String& x, const String& y)
+		: a(x), b(y)
+	{ }
+
+	void operator()() {
+		Bench::keep (editDistance (a, b));
+	}
+};
+
+struct Bounded {
+	const String& a;
+	const String& b;
+	size_t k;
+
+	Bounded (const String& x, const String& y, size_t bound)
+		: a(x), b(y), k(bound)
+	{ }
+
+	void operator()() {
+		Bench::keep (withinDistance (a, b, k));
+	}
+};
+
+void compare (const char* title, const String& a, const String& b)
+{
+	printf (" %s\n", title);
+
+	Naive naive (a, b);
+	Myers myers (a, b);
+	Bounded bounded (a, b, 2);
+
+	Bench::measure ("naive matrix, charAt()", 0, naive);
+	Bench::measure ("editDistance", 0, myers);
+	Bench::measure ("withinDistance, k = 2", 0, bounded);
+}
+
+// One input against a list of reference records.
+struct NaiveBatch {
+	const String& input;
+	const String* records;
+	size_t count;
+
+	NaiveBatch (const String& in, const String* r, size_t nb)
+		: input(in), records(r), count(nb)
+	{ }
+
+	void operator()() {
+		size_t best = 0;
+		for (size_t i = 0; i < count; ++i) {
+			if (naiveDistance (input, records[i]) <= 2) {
+				++best;
+			}
+		}
+		Bench::keep (best);
+	}
+};
+
+struct Closest {
+	const EditDistance& input;
+	const String* records;
+	size_t count;
+
+	Closest (const EditDistance& in, const String* r, size_t nb)
+		: input(in), records(r), count(nb)
+	{ }
+
+	void operator()() {
+		Bench::keep (input.closest (records, count, 2));
+	}
+};
+
+} // namespace
+
+BENCHMARK (editDistance)
+{
+	compare ("names, 6 / 7 bytes", "Dupont", "Dupond.");
+	compare ("addresses, 42 / 40 bytes", "12 rue de la Republique, 69002 Lyon France",
+			"12, rue de la Republique 69002 LYON");
+	compare ("free text, 150 / 150 bytes",
+			"Livraison en point relais si possible, merci de sonner deux fois. Le colis peut etre laisse chez le gardien de l'immeuble en cas d'absence, merci !!",
+			"Livraison en point relais si possible : merci de sonner 2 fois. Le colis peut etre laisse chez la gardienne de l'immeuble en cas d'absence, merci.");
+
+	static const char* names[] = { "Martin", "Bernard", "Thomas", "Petit", "Robert", "Richard", "Durand", "Dubois" };
+	XString storage[1000];
+	String records[1000];
+	for (size_t i = 0; i < 1000; ++i) {
+		storage[i].append (names[i % 8]);
+		storage[i].appendInt (i);
+		records[i] = storage[i];
+	}
+
+	const String input ("Dupont-Moretti");
+	EditDistance compiled (input);
+	NaiveBatch naive (input, records, 1000);
+	Closest closest (compiled, records, 1000);
+
+	printf (" one name against 1000 records, k = 2\n");
+	Bench::measure ("naive matrix per record", 0, naive);
+	Bench::measure ("EditDistance::closest", 0, closest);
+}
@@ -0,0 +1,162 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+
+using namespace Fianet;
+
+namespace {
+
+/// The byte at a time hexadecimal encoding the new methods replace.
+struct SnprintfHex {
+	const String& data;
+	XString& out;
+
+	SnprintfHex (const String& d, XString& o)
+		: data(d), out(o)
+	{ }
+
+	void operator()() {
+		char buf[3];
+		out.clear();
+		for (size_t i = 0; i < data.length(); ++i) {
+			snprintf (buf, sizeof(buf), "%02x", data.bytes()[i]);
+			out.append (buf, 2);
+		}
+		Bench::keep (out.length());
+	}
+};
+
+struct Encode {
+	enum Format { HEX, BASE64, BASE32 };
+
+	const String& data;
+	XString& out;
+	Format format;
+
+	Encode (const String& d, XString& o, Format f)
+		: data(d), out(o), format(f)
+	{ }
+
+	void operator()() {
+		out.clear();
+		if (format == HEX) {
+			out.appendHex (data);
+		} else if (format == BASE64) {
+			out.appendBase64 (data);
+		} else {
+			out.appendBase32 (data);
+		}
+		Bench::keep (out.length());
+	}
+};
+
+struct Decode {
+	const String& text;
+	XString& out;
+	Encode::Format format;
+
+	Decode (const String& t, XString& o, Encode::Format f)
+		: text(t), out(o), format(f)
+	{ }
+
+	void operator()() {
+		out.clear();
+		if (format == Encode::HEX) {
+			Bench::keep (text.decodeHexInto (out));
+		} else if (format == Encode::BASE64) {
+			Bench::keep (text.decodeBase64Into (out));
+		} else {
+			Bench::keep (text.decodeBase32Into (out));
+		}
+	}
+};
+
+struct ParseUuid {
+	const String& text;
+
+	explicit ParseUuid (const String& t)
+		: text(t)
+	{ }
+
+	void operator()() {
+		uint8_t uuid[16];
+		Bench::keep (text.decodeUuid (uuid));
+	}
+};
+
+/// Runs a benchmark with the scalar kernels, then with the best ones.
+template <class F>
+void measureLevels (const char* label, size_t bytes, F& f)
+{
+	char name[64];
+	const SimdLevel best = getSimdLevel();
+
+	snprintf (name, sizeof(name), "%s, scalar", label);
+	setSimdLevel (SIMD_SCALAR);
+	Bench::measure (name, bytes, f);
+	snprintf (name, sizeof(name), "%s, %s", label, simdLevelName (best));
+	setSimdLevel (best);
+	Bench::measure (name, bytes, f);
+}
+
+} // namespace
+
+BENCHMARK (encoding)
+{
+	const size_t sizes[] = { 16, 32, 256, 4096 };
+	XString storage, out;
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+		uint64_t seed = 42;
+		storage.clear();
+		for (size_t j = 0; j < sizes[i]; ++j) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			storage.appendChar (static_cast<char>(seed >> 56));
+		}
+		String data (storage);
+		XString hex, base64, base32;
+		hex.appendHex (data);
+		base64.appendBase64 (data);
+		base32.appendBase32 (data);
+
+		printf (" %u bytes\n", (unsigned) data.length());
+		SnprintfHex snprintfHex (data, out);
+		Encode encodeHex (data, out, Encode::HEX);
+		Encode encodeBase64 (data, out, Encode::BASE64);
+		Encode encodeBase32 (data, out, Encode::BASE32);
+		Decode decodeHex (hex, out, Encode::HEX);
+		Decode decodeBase64 (base64, out, Encode::BASE64);
+		Decode decodeBase32 (base32, out, Encode::BASE32);
+		Bench::measure ("snprintf (\"%02x\") per byte", data.length(), snprintfHex);
+		measureLevels ("appendHex()", data.length(), encodeHex);
+		measureLevels ("decodeHexInto()", data.length(), decodeHex);
+		measureLevels ("appendBase64()", data.length(), encodeBase64);
+		measureLevels ("decodeBase64Into()", data.length(), decodeBase64);
+		Bench::measure ("appendBase32()", data.length(), encodeBase32);
+		Bench::measure ("decodeBase32Into()", data.length(), decodeBase32);
+	}
+
+	String uuid ("123e4567-e89b-12d3-a456-426614174000");
+	ParseUuid parseUuid (uuid);
+	printf (" UUID\n");
+	measureLevels ("decodeUuid()", 0, parseUuid);
+}
@@ -0,0 +1,161 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include <map>
+
+#if __cplusplus >= 201103L
+#include <unordered_map>
+#endif
+
+using namespace Fianet;
+
+namespace {
+
+const size_t KEYS = 10000;
+
+struct Hash {
+	const String& key;
+
+	explicit Hash (const String& k)
+		: key(k)
+	{ }
+
+	void operator()() {
+		Bench::keep (key.hash());
+	}
+};
+
+struct IHash {
+	const String& key;
+
+	explicit IHash (const String& k)
+		: key(k)
+	{ }
+
+	void operator()() {
+		Bench::keep (key.ihash());
+	}
+};
+
+struct TreeLookup {
+	const std::map<String, int, String::Comparator>& map;
+	const String* keys;
+	size_t i;
+
+	TreeLookup (const std::map<String, int, String::Comparator>& m, const String* k)
+		: map(m), keys(k), i(0)
+	{ }
+
+	void operator()() {
+		Bench::keep (map.find (keys[i])->second);
+		i = (i + 1) % KEYS;
+	}
+};
+
+#if __cplusplus >= 201103L
+struct HashLookup {
+	const std::unordered_map<String, int, String::Hasher, String::Equal>& map;
+	const String* keys;
+	size_t i;
+
+	HashLookup (const std::unordered_map<String, int, String::Hasher, String::Equal>& m, const String* k)
+		: map(m), keys(k), i(0)
+	{ }
+
+	void operator()() {
+		Bench::keep (map.find (keys[i])->second);
+		i = (i + 1) % KEYS;
+	}
+};
+
+struct HashedLookup {
+	const std::unordered_map<HashedString, int, HashedString::Hasher>& map;
+	const HashedString* keys;
+	size_t i;
+
+	HashedLookup (const std::unordered_map<HashedString, int, HashedString::Hasher>& m, const HashedString* k)
+		: map(m), keys(k), i(0)
+	{ }
+
+	void operator()() {
+		Bench::keep (map.find (keys[i])->second);
+		i = (i + 1) % KEYS;
+	}
+};
+#endif
+
+} // namespace
+
+BENCHMARK (string_hash)
+{
+	const char* texts[] = {
+		"FR",
+		"M00012345",
+		"jean.dupont@exemple.fr",
+		"12 rue de la Republique, 69002 Lyon, France",
+		"Livraison en point relais si possible, merci de sonner deux fois avant de partir."
+	};
+	for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); ++i) {
+		String text (texts[i]);
+		Hash hash (text);
+		IHash ihash (text);
+
+		printf (" %u bytes\n", (unsigned) text.length());
+		Bench::measure ("String::hash()", text.length(), hash);
+		Bench::measure ("String::ihash()", text.length(), ihash);
+	}
+}
+
+BENCHMARK (string_lookup)
+{
+	XString* storage = new XString[KEYS];
+	String* keys = new String[KEYS];
+	std::map<String, int, String::Comparator> tree;
+
+	for (size_t i = 0; i < KEYS; ++i) {
+		storage[i].append ("customer-");
+		storage[i].appendInt (static_cast<int>(i * 7919));
+		keys[i] = storage[i];
+		tree[keys[i]] = static_cast<int>(i);
+	}
+
+	printf (" %u keys\n", (unsigned) KEYS);
+	TreeLookup treeLookup (tree, keys);
+	Bench::measure ("std::map, Comparator", 0, treeLookup);
+#if __cplusplus >= 201103L
+	std::unordered_map<String, int, String::Hasher, String::Equal> hashed;
+	std::unordered_map<HashedString, int, HashedString::Hasher> prehashed;
+	HashedString* hashedKeys = new HashedString[KEYS];
+	for (size_t i = 0; i < KEYS; ++i) {
+		hashed[keys[i]] = static_cast<int>(i);
+		hashedKeys[i] = HashedString (keys[i]);
+		prehashed[hashedKeys[i]] = static_cast<int>(i);
+	}
+	HashLookup hashLookup (hashed, keys);
+	HashedLookup hashedLookup (prehashed, hashedKeys);
+	Bench::measure ("std::unordered_map, Hasher", 0, hashLookup);
+	Bench::measure ("std::unordered_map, HashedString", 0, hashedLookup);
+	delete [] hashedKeys;
+#endif
+	delete [] keys;
+	delete [] storage;
+}
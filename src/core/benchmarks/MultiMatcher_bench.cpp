@@ -0,0 +1,119 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "MultiMatcher.h"
+
+using namespace Fianet;
+
+namespace {
+
+/**
+ * Builds nb blacklisted tokens, lowercase words of 5 to 12 letters.
+ */
+XString* buildBlacklist (size_t nb)
+{
+	XString* tokens = new XString[nb];
+
+	srand (1234);
+	for (size_t i = 0; i < nb; ++i) {
+		size_t len = 5 + rand() % 8;
+		for (size_t j = 0; j < len; ++j) {
+			tokens[i].appendChar ('a' + rand() % 26);
+		}
+	}
+	return tokens;
+}
+
+struct IcontainsLoop {
+	const String& text;
+	const XString* tokens;
+	size_t nb;
+
+	IcontainsLoop (const String& t, const XString* tk, size_t n)
+		: text(t), tokens(tk), nb(n)
+	{ }
+
+	void operator()() {
+		bool found = false;
+		for (size_t i = 0; i < nb && !found; ++i) {
+			found = text.icontains (tokens[i]);
+		}
+		Bench::keep (found);
+	}
+};
+
+struct MatcherContains {
+	const String& text;
+	const MultiMatcher& matcher;
+
+	MatcherContains (const String& t, const MultiMatcher& m)
+		: text(t), matcher(m)
+	{ }
+
+	void operator()() {
+		Bench::keep (matcher.contains (text));
+	}
+};
+
+void compareBlacklist (const String& text, size_t nb)
+{
+	XString* tokens = buildBlacklist (nb);
+	MultiMatcher teddy (MultiMatcher::IGNORE_CASE);
+	MultiMatcher ac (MultiMatcher::IGNORE_CASE);
+
+	for (size_t i = 0; i < nb; ++i) {
+		teddy.add (tokens[i]);
+		ac.add (tokens[i]);
+	}
+	teddy.compile();
+	ac.compile (MultiMatcher::AHO_CORASICK);
+
+	printf (" %u tokens, %u bytes of text\n", (unsigned) nb, (unsigned) text.length());
+
+	IcontainsLoop loop (text, tokens, nb);
+	MatcherContains m1 (text, teddy);
+	MatcherContains m2 (text, ac);
+
+	Bench::measure ("icontains() loop", text.length(), loop);
+	if (teddy.usedEngine() == MultiMatcher::TEDDY) {
+		Bench::measure ("MultiMatcher, Teddy", text.length(), m1);
+	}
+	Bench::measure ("MultiMatcher, Aho-Corasick", text.length(), m2);
+
+	delete[] tokens;
+}
+
+} // namespace
+
+BENCHMARK (multimatcher_blacklist)
+{
+	String address ("12 rue de la Republique, Batiment C, 69002 Lyon, France");
+	XString comment;
+	while (comment.length() < 1024) {
+		comment.append ("Livraison en point relais si possible, merci de sonner deux fois. ");
+	}
+
+	compareBlacklist (address, 16);
+	compareBlacklist (comment, 16);
+	compareBlacklist (address, 2000);
+	compareBlacklist (comment, 2000);
+}
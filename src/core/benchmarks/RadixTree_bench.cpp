@@ -0,0 +1,159 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "RadixTree.h"
+#include <map>
+
+using namespace Fianet;
+
+namespace {
+
+struct Range {
+	XString prefix;
+	int value;
+
+	Range()
+		: prefix(), value(0)
+	{ }
+};
+
+// What callers do today: the longest of the prefixes a text starts with.
+struct LinearScan {
+	const Range* ranges;
+	size_t count;
+	const XString* texts;
+	size_t i;
+
+	LinearScan (const Range* r, size_t n, const XString* t)
+		: ranges(r), count(n), texts(t), i(0)
+	{ }
+
+	void operator()() {
+		const Range* best = 0;
+		for (size_t k = 0; k < count; ++k) {
+			if (texts[i].startsWith (ranges[k].prefix) && (!best || ranges[k].prefix.length() > best->prefix.length())) {
+				best = &ranges[k];
+			}
+		}
+		Bench::keep (best ? best->value : 0);
+		i = (i + 1) & 1023;
+	}
+};
+
+struct TreePrefix {
+	const RadixTree<int>& tree;
+	const XString* texts;
+	size_t i;
+
+	TreePrefix (const RadixTree<int>& t, const XString* x)
+		: tree(t), texts(x), i(0)
+	{ }
+
+	void operator()() {
+		const int* v = tree.longestPrefix (texts[i]);
+		Bench::keep (v ? *v : 0);
+		i = (i + 1) & 1023;
+	}
+};
+
+typedef std::map<String, int, String::Comparator> TreeMap;
+
+struct MapFind {
+	const TreeMap& map;
+	const Range* ranges;
+	size_t count;
+	size_t i;
+
+	MapFind (const TreeMap& m, const Range* r, size_t n)
+		: map(m), ranges(r), count(n), i(0)
+	{ }
+
+	void operator()() {
+		Bench::keep (map.find (ranges[i].prefix)->second);
+		i = (i + 1 == count) ? 0 : i + 1;
+	}
+};
+
+struct TreeFind {
+	const RadixTree<int>& tree;
+	const Range* ranges;
+	size_t count;
+	size_t i;
+
+	TreeFind (const RadixTree<int>& t, const Range* r, size_t n)
+		: tree(t), ranges(r), count(n), i(0)
+	{ }
+
+	void operator()() {
+		Bench::keep (*tree.find (ranges[i].prefix));
+		i = (i + 1 == count) ? 0 : i + 1;
+	}
+};
+
+void compare (size_t count)
+{
+	Range* ranges = new Range[count];
+	XString* cards = new XString[1024];
+	RadixTree<int> tree;
+	TreeMap map;
+	unsigned seed = 1;
+
+	// BINs of 6 digits, and a few shorter ranges.
+	for (size_t i = 0; i < count; ++i) {
+		seed = seed * 1103515245 + 12345;
+		ranges[i].prefix.appendInt (static_cast<int>(400000 + (seed >> 8) % 200000));
+		if (i % 10 == 0) {
+			ranges[i].prefix.resize (4);
+		}
+		ranges[i].value = static_cast<int>(i);
+		tree.insert (ranges[i].prefix, ranges[i].value);
+		map.insert (TreeMap::value_type (ranges[i].prefix, ranges[i].value));
+	}
+	for (size_t i = 0; i < 1024; ++i) {
+		const String& bin = ranges[(i * 7) % count].prefix;
+		cards[i].append (bin).append (String ("1234567890123456").substr (0, 16 - bin.length()));
+	}
+
+	printf (" %u prefixes, %.1f bytes per key in the tree\n", (unsigned) tree.size(), (double) tree.memoryUsage() / tree.size());
+	TreeFind treeFind (tree, ranges, count);
+	MapFind mapFind (map, ranges, count);
+	Bench::measure ("std::map, Comparator, find()", 0, mapFind);
+	Bench::measure ("RadixTree::find()", 0, treeFind);
+	TreePrefix treePrefix (tree, cards);
+	if (count <= 10000) {
+		LinearScan scan (ranges, count, cards);
+		Bench::measure ("startsWith() scan, longest prefix", 0, scan);
+	}
+	Bench::measure ("RadixTree::longestPrefix()", 0, treePrefix);
+
+	delete [] cards;
+	delete [] ranges;
+}
+
+} // namespace
+
+BENCHMARK (radix_tree)
+{
+	compare (100);
+	compare (10000);
+	compare (100000);
+}
@@ -0,0 +1,158 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "Regex.h"
+
+#if __cplusplus >= 201103L
+#include <regex>
+#include <string>
+#endif
+
+using namespace Fianet;
+
+namespace {
+
+struct RegexMatches {
+	const String& text;
+	Regex& re;
+
+	RegexMatches (const String& t, Regex& r)
+		: text(t), re(r)
+	{ }
+
+	void operator()() {
+		Bench::keep (re.matches (text));
+	}
+};
+
+struct RegexContains {
+	const String& text;
+	Regex& re;
+
+	RegexContains (const String& t, Regex& r)
+		: text(t), re(r)
+	{ }
+
+	void operator()() {
+		Bench::keep (re.contains (text));
+	}
+};
+
+struct RegexFind {
+	const String& text;
+	Regex& re;
+	Regex::Match m;
+
+	RegexFind (const String& t, Regex& r)
+		: text(t), re(r), m()
+	{ }
+
+	void operator()() {
+		Bench::keep (re.find (text, m) ? m.end (1) : 0);
+	}
+};
+
+#if __cplusplus >= 201103L
+// std::regex, on a std::string copy as the callers of String::cstr() do.
+struct StdMatches {
+	const String& text;
+	const std::regex& re;
+
+	StdMatches (const String& t, const std::regex& r)
+		: text(t), re(r)
+	{ }
+
+	void operator()() {
+		Bench::keep (std::regex_match (std::string (text.cstr(), text.length()), re));
+	}
+};
+
+struct StdSearch {
+	const String& text;
+	const std::regex& re;
+
+	StdSearch (const String& t, const std::regex& r)
+		: text(t), re(r)
+	{ }
+
+	void operator()() {
+		std::smatch m;
+		std::string s (text.cstr(), text.length());
+		Bench::keep (std::regex_search (s, m, re) ? m.position (1) : 0);
+	}
+};
+#endif
+
+void compareMatches (const char* pattern, const String& text)
+{
+	Regex re (pattern);
+	RegexMatches fast (text, re);
+
+	printf (" matches \"%s\", %u bytes\n", pattern, (unsigned) text.length());
+	Bench::measure ("Regex::matches()", text.length(), fast);
+#if __cplusplus >= 201103L
+	std::regex stdRe (pattern);
+	StdMatches slow (text, stdRe);
+	Bench::measure ("std::regex_match()", text.length(), slow);
+#endif
+}
+
+void compareSearch (const char* pattern, const String& text)
+{
+	Regex re (pattern);
+	RegexContains contains (text, re);
+	RegexFind find (text, re);
+
+	printf (" search \"%s\", %u bytes, literal \"%s\"\n", pattern, (unsigned) text.length(), re.requiredLiteral().cstr());
+	Bench::measure ("Regex::contains()", text.length(), contains);
+	Bench::measure ("Regex::find(), captures", text.length(), find);
+#if __cplusplus >= 201103L
+	std::regex stdRe (pattern);
+	StdSearch slow (text, stdRe);
+	Bench::measure ("std::regex_search(), captures", text.length(), slow);
+#endif
+}
+
+} // namespace
+
+BENCHMARK (regex_validation)
+{
+	compareMatches ("\\d{5}", "69002");
+	compareMatches ("0[1-9]( ?[0-9]{2}){4}", "04 78 12 34 56");
+	compareMatches ("[\\w.+-]+@[\\w-]+\\.[\\w.]+", "jean.dupont+commandes@exemple-boutique.fr");
+}
+
+BENCHMARK (regex_search)
+{
+	XString comment;
+	while (comment.length() < 1024) {
+		comment.append ("Livraison en point relais si possible, merci de sonner deux fois. ");
+	}
+
+	// Rejected by the literal prefilter.
+	compareSearch ("([\\w.+-]+)@[\\w-]+\\.[\\w.]+", comment);
+	// No literal: the DFA rejects it.
+	compareSearch ("(\\d{2}) ?\\d{3}", comment);
+
+	comment.append (" Contact: jean.dupont@exemple.fr");
+	compareSearch ("([\\w.+-]+)@[\\w-]+\\.[\\w.]+", comment);
+}
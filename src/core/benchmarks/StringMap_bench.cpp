@@ -0,0 +1,101 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "StringMap.h"
+#include <map>
+
+using namespace Fianet;
+
+namespace {
+
+typedef std::map<String, int, String::Comparator> TreeMap;
+
+struct TreeFind {
+	const TreeMap& map;
+	const XString* keys;
+	size_t count;
+	size_t i;
+
+	TreeFind (const TreeMap& m, const XString* k, size_t n)
+		: map(m), keys(k), count(n), i(0)
+	{ }
+
+	void operator()() {
+		TreeMap::const_iterator it = map.find (keys[i]);
+		Bench::keep (it != map.end() ? it->second : 0);
+		i = (i + 1 == count) ? 0 : i + 1;
+	}
+};
+
+struct FlatFind {
+	const StringMap<int>& map;
+	const XString* keys;
+	size_t count;
+	size_t i;
+
+	FlatFind (const StringMap<int>& m, const XString* k, size_t n)
+		: map(m), keys(k), count(n), i(0)
+	{ }
+
+	void operator()() {
+		const int* v = map.find (keys[i]);
+		Bench::keep (v ? *v : 0);
+		i = (i + 1 == count) ? 0 : i + 1;
+	}
+};
+
+void compare (size_t size)
+{
+	XString* keys = new XString[2 * size];
+	TreeMap tree;
+	StringMap<int> flat;
+
+	// BIN-like keys: 6 digits. The second half of the keys is missing.
+	for (size_t i = 0; i < 2 * size; ++i) {
+		keys[i].appendInt (static_cast<int>(400000 + (i * 7919) % 600000));
+		if (i < size) {
+			tree[keys[i]] = static_cast<int>(i);
+			flat[keys[i]] = static_cast<int>(i);
+		}
+	}
+
+	printf (" %u keys\n", (unsigned) size);
+	TreeFind treeHit (tree, keys, size);
+	FlatFind flatHit (flat, keys, size);
+	TreeFind treeMiss (tree, keys + size, size);
+	FlatFind flatMiss (flat, keys + size, size);
+	Bench::measure ("std::map, Comparator, hit", 0, treeHit);
+	Bench::measure ("StringMap, hit", 0, flatHit);
+	Bench::measure ("std::map, Comparator, miss", 0, treeMiss);
+	Bench::measure ("StringMap, miss", 0, flatMiss);
+
+	delete [] keys;
+}
+
+} // namespace
+
+BENCHMARK (string_map)
+{
+	compare (100);
+	compare (10000);
+	compare (500000);
+}
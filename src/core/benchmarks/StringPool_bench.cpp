@@ -0,0 +1,122 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "StringPool.h"
+
+using namespace Fianet;
+
+namespace {
+
+const size_t KEYS = 10000;
+
+struct Copy {
+	const XString* keys;
+	XString copy;
+	size_t i;
+
+	explicit Copy (const XString* k)
+		: keys(k), copy(), i(0)
+	{ }
+
+	void operator()() {
+		copy.clear();
+		copy.append (keys[i]);
+		Bench::keep (copy.length());
+		i = (i + 1) % KEYS;
+	}
+
+private:
+	Copy (const Copy&);
+	Copy& operator = (const Copy&);
+};
+
+struct Intern {
+	StringPool& pool;
+	const XString* keys;
+	size_t i;
+
+	Intern (StringPool& p, const XString* k)
+		: pool(p), keys(k), i(0)
+	{ }
+
+	void operator()() {
+		Bench::keep (pool.intern (keys[i]).id());
+		i = (i + 1) % KEYS;
+	}
+};
+
+struct CompareStrings {
+	const XString* keys;
+	size_t i;
+
+	explicit CompareStrings (const XString* k)
+		: keys(k), i(0)
+	{ }
+
+	void operator()() {
+		Bench::keep (keys[i].equals (keys[(i * 7) % KEYS]));
+		i = (i + 1) % KEYS;
+	}
+};
+
+struct CompareSymbols {
+	const Symbol* symbols;
+	size_t i;
+
+	explicit CompareSymbols (const Symbol* s)
+		: symbols(s), i(0)
+	{ }
+
+	void operator()() {
+		Bench::keep (symbols[i] == symbols[(i * 7) % KEYS]);
+		i = (i + 1) % KEYS;
+	}
+};
+
+} // namespace
+
+BENCHMARK (string_pool)
+{
+	XString* keys = new XString[KEYS];
+	Symbol* symbols = new Symbol[KEYS];
+	StringPool pool;
+
+	// Keys sharing a long prefix, as merchant references do.
+	for (size_t i = 0; i < KEYS; ++i) {
+		keys[i].append ("FR-MERCHANT-2016-");
+		keys[i].appendInt (static_cast<int>(i % 100));
+		symbols[i] = pool.intern (keys[i]);
+	}
+
+	printf (" %u keys, %u distinct\n", (unsigned) KEYS, (unsigned) pool.size());
+	Copy copy (keys);
+	Intern intern (pool, keys);
+	CompareStrings compareStrings (keys);
+	CompareSymbols compareSymbols (symbols);
+	Bench::measure ("XString copy", 0, copy);
+	Bench::measure ("StringPool::intern(), pooled", 0, intern);
+	Bench::measure ("String::equals()", 0, compareStrings);
+	Bench::measure ("Symbol ==", 0, compareSymbols);
+
+	delete [] symbols;
+	delete [] keys;
+}
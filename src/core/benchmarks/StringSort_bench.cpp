@@ -0,0 +1,132 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "StringSort.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace Fianet;
+
+namespace {
+
+const size_t KEY_LENGTH = 20;
+
+/// Shuffles the keys with a fixed seed, so that every sort gets the same input.
+void shuffle (String* keys, size_t n)
+{
+	uint64_t seed = 42;
+	for (size_t i = n - 1; i > 0; --i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		std::swap (keys[i], keys[(seed >> 33) % (i + 1)]);
+	}
+}
+
+struct ShuffleOnly {
+	String* keys;
+	size_t n;
+
+	ShuffleOnly (String* k, size_t c)
+		: keys(k), n(c)
+	{ }
+
+	void operator()() {
+		shuffle (keys, n);
+		Bench::keep (keys[0].length());
+	}
+};
+
+struct StdSort {
+	String* keys;
+	size_t n;
+
+	StdSort (String* k, size_t c)
+		: keys(k), n(c)
+	{ }
+
+	void operator()() {
+		shuffle (keys, n);
+		std::sort (keys, keys + n, String::Comparator());
+		Bench::keep (keys[0].length());
+	}
+};
+
+struct SortStrings {
+	String* keys;
+	size_t n;
+	unsigned threads;
+
+	SortStrings (String* k, size_t c, unsigned t)
+		: keys(k), n(c), threads(t)
+	{ }
+
+	void operator()() {
+		shuffle (keys, n);
+		sortStrings (keys, keys + n, threads);
+		Bench::keep (keys[0].length());
+	}
+};
+
+void compare (size_t n)
+{
+	// Merchant references: a 12 byte common prefix, then 8 digits.
+	char* data = static_cast<char*>(malloc (n * KEY_LENGTH));
+	String* keys = new String[n];
+	uint64_t seed = 7;
+	for (size_t i = 0; i < n; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		char* key = data + i * KEY_LENGTH;
+		memcpy (key, "FR-MERCHANT-", 12);
+		unsigned v = static_cast<unsigned>((seed >> 33) % 100000000);
+		for (int d = 19; d >= 12; --d) {
+			key[d] = '0' + v % 10;
+			v /= 10;
+		}
+		keys[i] = String (key, KEY_LENGTH);
+	}
+
+	printf (" %u keys (shuffling included)\n", (unsigned) n);
+	ShuffleOnly shuffleOnly (keys, n);
+	StdSort stdSort (keys, n);
+	SortStrings sort1 (keys, n, 1);
+	SortStrings sortAll (keys, n, 0);
+	Bench::measure ("shuffle only", 0, shuffleOnly);
+	Bench::measure ("std::sort(), String::Comparator", 0, stdSort);
+	Bench::measure ("sortStrings()", 0, sort1);
+	Bench::measure ("sortStrings(), one thread per CPU", 0, sortAll);
+
+	delete [] keys;
+	free (data);
+}
+
+} // namespace
+
+BENCHMARK (string_sort)
+{
+	compare (1000000);
+	compare (10000000);
+}
+
+// About 3.5 GB of memory: only run when asked for.
+BENCHMARK (sort_strings_50m)
+{
+	compare (50000000);
+}
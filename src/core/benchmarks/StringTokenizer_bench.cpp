@@ -0,0 +1,190 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include "StringTokenizer.h"
+
+using namespace Fianet;
+
+namespace {
+
+// String::lastIndexOf() as it was before memrfind(): a backward byte loop
+// on the first needle byte, then memcmp().
+ssize_t legacy_lastIndexOf (const String& str, const String& s)
+{
+	if (s.length() > 0 && str.length() >= s.length()) {
+		const uint8_t first = s.bytes()[0];
+		const uint8_t* p = str.bytes() + str.length() - s.length();
+
+		while (p >= str.bytes()) {
+			if (*p == first && !memcmp (p, s.bytes(), s.length())) {
+				return (p - str.bytes());
+			}
+			--p;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Builds a CSV record of about 'size' bytes, with fields of 5 to 40 bytes.
+ */
+void buildRecord (XString& out, size_t size, const char* delimiter)
+{
+	int i = 0;
+
+	out.clear();
+	while (out.length() < size) {
+		if (i) {
+			out.append (delimiter);
+		}
+		out.append ("field");
+		for (int j = 0; j < (i * 7) % 35; ++j) {
+			out.appendChar ('a' + j % 26);
+		}
+		++i;
+	}
+}
+
+// Reverse split, as the ReverseIterator did it before memrfind().
+struct LegacyReverseSplit {
+	const String& record;
+	const String& delimiter;
+
+	LegacyReverseSplit (const String& r, const String& d)
+		: record(r), delimiter(d)
+	{ }
+
+	void operator()() {
+		size_t total = 0;
+		ssize_t delimpos = legacy_lastIndexOf (record, delimiter);
+
+		while (delimpos >= 0) {
+			String sub (record.substr (0, delimpos));
+			ssize_t next = legacy_lastIndexOf (sub, delimiter);
+			total += delimpos - next;
+			delimpos = next;
+		}
+		Bench::keep (total);
+	}
+};
+
+struct ReverseSplit {
+	const String& record;
+	const String& delimiter;
+
+	ReverseSplit (const String& r, const String& d)
+		: record(r), delimiter(d)
+	{ }
+
+	void operator()() {
+		size_t total = 0;
+		StringTokenizer tk (record);
+
+		for (StringTokenizer::ReverseIterator it = tk.rbegin (delimiter); it != tk.rend(); ++it) {
+			total += (*it).length();
+		}
+		Bench::keep (total);
+	}
+};
+
+struct ForwardSplit {
+	const String& record;
+	const String& delimiter;
+
+	ForwardSplit (const String& r, const String& d)
+		: record(r), delimiter(d)
+	{ }
+
+	void operator()() {
+		size_t total = 0;
+		StringTokenizer tk (record);
+
+		for (StringTokenizer::Iterator it = tk.begin (delimiter); it != tk.end(); ++it) {
+			total += (*it).length();
+		}
+		Bench::keep (total);
+	}
+};
+
+ssize_t current_lastIndexOf (const String& str, const String& s)
+{
+	return str.lastIndexOf (s);
+}
+
+struct LastIndexOf {
+	ssize_t (*func) (const String&, const String&);
+	const String& str;
+	const String& needle;
+
+	LastIndexOf (ssize_t (*f) (const String&, const String&), const String& h, const String& n)
+		: func(f), str(h), needle(n)
+	{ }
+
+	void operator()() {
+		Bench::keep (func (str, needle));
+	}
+};
+
+void compareSplit (size_t size, const char* delimiter)
+{
+	XString record;
+	String delim (delimiter);
+
+	buildRecord (record, size, delimiter);
+	printf (" %u bytes record, delimiter '%s'\n", (unsigned) record.length(), delimiter);
+
+	LegacyReverseSplit legacy (record, delim);
+	ReverseSplit reverse (record, delim);
+	ForwardSplit forward (record, delim);
+
+	Bench::measure ("legacy reverse split", record.length(), legacy);
+	Bench::measure ("ReverseIterator", record.length(), reverse);
+	Bench::measure ("Iterator", record.length(), forward);
+}
+
+} // namespace
+
+BENCHMARK (tokenizer_reverse_split)
+{
+	compareSplit (10 * 1024, ";");
+	compareSplit (10 * 1024, "||");
+	compareSplit (100 * 1024, ";");
+}
+
+BENCHMARK (lastIndexOf_long_record)
+{
+	XString fields, record;
+	buildRecord (fields, 16 * 1024, ";");
+
+	// The needle is only at the beginning of the record.
+	String needle ("id=20161231;");
+	record.append (needle);
+	record.append (fields);
+
+	printf (" %u bytes record, needle at the beginning\n", (unsigned) record.length());
+
+	LastIndexOf legacy (legacy_lastIndexOf, record, needle);
+	LastIndexOf current (current_lastIndexOf, record, needle);
+
+	Bench::measure ("legacy lastIndexOf", record.length(), legacy);
+	Bench::measure ("String::lastIndexOf", record.length(), current);
+}
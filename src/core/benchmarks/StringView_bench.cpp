@@ -0,0 +1,131 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+#include "fianet-core.h"
+#include <algorithm>
+
+using namespace Fianet;
+
+namespace {
+
+const size_t ROWS = 200000;
+
+template <class S>
+struct Copy {
+	const S* column;
+	S* work;
+
+	Copy (const S* c, S* w)
+		: column(c), work(w)
+	{ }
+
+	void operator()() {
+		std::copy (column, column + ROWS, work);
+		Bench::keep (work[ROWS - 1].length());
+	}
+};
+
+template <class S>
+struct Sort {
+	const S* column;
+	S* work;
+
+	Sort (const S* c, S* w)
+		: column(c), work(w)
+	{ }
+
+	void operator()() {
+		std::copy (column, column + ROWS, work);
+		std::sort (work, work + ROWS, StringView::Comparator());
+		Bench::keep (work[0].length());
+	}
+};
+
+template <class S>
+struct Filter {
+	const S* column;
+	S* work;
+
+	Filter (const S* c, S* w)
+		: column(c), work(w)
+	{ }
+
+	void operator()() {
+		size_t nb = 0;
+		for (size_t i = 0; i < ROWS; ++i) {
+			if (column[i].startsWith ("FR") && column[i].indexOfChar ('Z') < 0) {
+				work[nb++] = column[i];
+			}
+		}
+		Bench::keep (nb);
+	}
+};
+
+template <class S>
+void run (const char* label, const S* column, S* work)
+{
+	XString name;
+	Copy<S> copy (column, work);
+	Sort<S> sort (column, work);
+	Filter<S> filter (column, work);
+
+	name.copyFrom (label).append (" std::copy()");
+	Bench::measure (name.cstr(), 0, copy);
+	name.copyFrom (label).append (" std::sort()");
+	Bench::measure (name.cstr(), 0, sort);
+	name.copyFrom (label).append (" filter");
+	Bench::measure (name.cstr(), 0, filter);
+}
+
+} // namespace
+
+BENCHMARK (string_view)
+{
+	const size_t length = 16;
+	char* data = new char[ROWS * length];
+	String* strings = new String[ROWS];
+	String* stringWork = new String[ROWS];
+	StringView* views = new StringView[ROWS];
+	StringView* viewWork = new StringView[ROWS];
+
+	for (size_t i = 0; i < ROWS; ++i) {
+		char* row = data + i * length;
+		memset (row, '0', length);
+		memcpy (row, (i % 3) ? "FR" : "BE", 2);
+		size_t v = (i * 2654435761u) % 10000000;
+		for (size_t d = 2; d < 10; ++d) {
+			row[d] = 'A' + v % 26;
+			v /= 26;
+		}
+		strings[i] = String (row, length);
+		views[i] = StringView (row, length);
+	}
+
+	printf (" %u rows of %u bytes\n", (unsigned) ROWS, (unsigned) length);
+	run ("String", strings, stringWork);
+	run ("StringView", views, viewWork);
+
+	delete [] viewWork;
+	delete [] views;
+	delete [] stringWork;
+	delete [] strings;
+	delete [] data;
+}
@@ -0,0 +1,88 @@
+/*
+ * FIA-NET C++ COMMONS
+ *
+ * A library of core components developped for Fia-Net products.
+ * Copyright 2008 - 2016 FIA-NET S.A.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "Bench.h"
+
+namespace Bench {
+
+volatile uintptr_t sink = 0;
+
+namespace {
+
+struct Entry {
+	const char* name;
+	Function func;
+};
+
+const size_t MAX_BENCHMARKS = 256;
+
+// Plain arrays: registration happens during static initialization.
+Entry* registry()
+{
+	static Entry entries[MAX_BENCHMARKS];
+	return entries;
+}
+
+size_t& registrySize()
+{
+	static size_t size = 0;
+	return size;
+}
+
+} // namespace
+
+Registrar::Registrar (const char* name, Function f)
+{
+	if (registrySize() < MAX_BENCHMARKS) {
+		Entry& e = registry()[registrySize()++];
+		e.name = name;
+		e.func = f;
+	}
+}
+
+int runAll (const char* filter)
+{
+	int count = 0;
+
+	for (size_t i = 0; i < registrySize(); ++i) {
+		const Entry& e = registry()[i];
+		if (filter && !strstr (e.name, filter)) {
+			continue;
+		}
+		printf ("%s\n", e.name);
+		e.func();
+		++count;
+	}
+
+	return count;
+}
+
+} // namespace Bench
+
+int main (int argc, char** argv)
+{
+	const char* filter = (argc > 1) ? argv[1] : 0;
+
+	if (Bench::runAll (filter) == 0) {
+		fprintf (stderr, "No benchmark matches '%s'.\n", filter ? filter : "");
+		return 1;
+	}
+	return 0;
+}
@@ -86,7 +86,13 @@
 #include <unistd.h>
 
 #include "Exception.h"
+#include "Decimal.h"
+#include "StringView.h"
 #include "String.h"
 #include "XString.h"
+#include "CharSet.h"
+#include "CpuFeatures.h"
+#include "HashedString.h"
+#include "CompactString.h"
 
 #endif // FIANET_CORE_H
@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+
+using namespace Fianet;
+
+namespace {
+
+ssize_t naive_first (const uint8_t* p, size_t len, const bool* set, bool in, size_t from)
+{
+	for (size_t i = from; i < len; ++i) {
+		if (set[p[i]] == in) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+ssize_t naive_last (const uint8_t* p, size_t len, const bool* set, bool in)
+{
+	for (size_t i = len; i-- > 0; ) {
+		if (set[p[i]] == in) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+TEST (CharSetTest, set_operations_work)
+{
+	CharSet s (";,|\t");
+
+	EXPECT_EQ ((size_t)4, s.size());
+	EXPECT_TRUE (s.contains (';'));
+	EXPECT_TRUE (s.contains ('\t'));
+	EXPECT_FALSE (s.contains ('a'));
+	EXPECT_FALSE (s.contains ('\0'));
+
+	s.remove (';').add ('\xE9').addRange ('0', '9');
+	EXPECT_EQ ((size_t)14, s.size());
+	EXPECT_FALSE (s.contains (';'));
+	EXPECT_TRUE (s.contains ('\xE9'));
+	EXPECT_TRUE (s.contains ('5'));
+
+	CharSet c = s.complement();
+	EXPECT_EQ ((size_t)242, c.size());
+	EXPECT_FALSE (c.contains ('5'));
+	EXPECT_TRUE (c.contains (';'));
+
+	EXPECT_TRUE (CharSet().empty());
+	EXPECT_EQ ((size_t)256, CharSet().addRange ('\0', '\xFF').size());
+}
+
+TEST (CharSetTest, findFirstOf_works)
+{
+	String s ("name;city,zip|phone");
+	CharSet delims (";,|");
+
+	EXPECT_EQ (4, s.findFirstOf (delims));
+	EXPECT_EQ (9, s.findFirstOf (delims, 5));
+	EXPECT_EQ (-1, s.findFirstOf (delims, 14));
+	EXPECT_EQ (-1, s.findFirstOf (delims, 100));
+	EXPECT_EQ (13, s.findLastOf (delims));
+	EXPECT_EQ (-1, s.findFirstOf (CharSet()));
+
+	CharSet spaces (" \t\r\n");
+	String t ("  \t value \r\n");
+	EXPECT_EQ (4, t.findFirstNotOf (spaces));
+	EXPECT_EQ (8, t.findLastNotOf (spaces));
+	EXPECT_EQ (-1, CSTR(" \t ").findFirstNotOf (spaces));
+	EXPECT_EQ (-1, CSTR(" \t ").findLastNotOf (spaces));
+	EXPECT_EQ (-1, String::blank().findLastOf (spaces));
+}
+
+TEST (CharSetTest, matches_naive_search)
+{
+	uint8_t buf[200];
+	bool members[256];
+
+	srand (42);
+	for (int iter = 0; iter < 2000; ++iter) {
+		CharSet set;
+		memset (members, 0, sizeof(members));
+
+		// From empty sets to sets of every byte value.
+		const int nb = (iter % 10 == 0) ? 256 : rand() % 12;
+		for (int i = 0; i < nb; ++i) {
+			const uint8_t b = (nb == 256) ? i : rand() % 256;
+			set.add (static_cast<char>(b));
+			members[b] = true;
+		}
+		if (iter % 7 == 0) {
+			set = set.complement();
+			for (int b = 0; b < 256; ++b) {
+				members[b] = !members[b];
+			}
+		}
+
+		const size_t len = rand() % sizeof(buf);
+		for (size_t i = 0; i < len; ++i) {
+			// Mostly bytes outside of the set, so that matches are far.
+			buf[i] = (rand() % 40) ? 'a' + rand() % 3 : rand() % 256;
+		}
+		const size_t from = rand() % 40;
+		String s ((const char*) buf, len);
+
+		EXPECT_EQ (naive_first (buf, len, members, true, from), s.findFirstOf (set, from));
+		EXPECT_EQ (naive_first (buf, len, members, false, from), s.findFirstNotOf (set, from));
+		EXPECT_EQ (naive_last (buf, len, members, true), s.findLastOf (set));
+		EXPECT_EQ (naive_last (buf, len, members, false), s.findLastNotOf (set));
+	}
+}
+
+}
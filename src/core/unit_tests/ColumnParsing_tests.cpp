@@ -0,0 +1,228 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "ColumnParsing.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+
+using namespace Fianet;
+
+namespace {
+
+const char* INT_FIELDS[] = {
+	"0", "7", "-7", "-0", "42", "1234567890123456", "-9999999999999999", "12345678901234567",
+	"9223372036854775807", "-9223372036854775808", "9223372036854775808", "0123", "010", "0x1F",
+	"+5", " 12", "12 ", "", "-", "--1", "1-", "12a4", "N/A", "1.5", "1e3", "00", "-00"
+};
+
+const char* DOUBLE_FIELDS[] = {
+	"0", "-0", "0.0", "-0.0", "1.5", "-1.5", "1234.56", "0.1", ".5", "5.", "-.5", ".", "-.",
+	"123456789012345", "1234567890123456", "9007199254740993", "0.000000000000001", "1.23456789012345",
+	"12345678.12345678", "999999999999999.9", "1e5", "1.5e-3", "inf", "nan", "0x1p3", "1..2", "1.2.3",
+	"", "-", "+1.5", " 1.5", "1.5 ", "N/A", "00012.50", "3.14159265358979",
+	"256172.375411342"
+};
+
+/// Checks the columns against tryToInt64() and tryToFloat(), field by field.
+template <class S>
+void checkColumns (const std::vector<S>& fields, unsigned threads)
+{
+	const size_t n = fields.size();
+	std::vector<int64_t> ints (n + 1, -1);
+	std::vector<double> doubles (n + 1, -1);
+	std::vector<uint8_t> status (n + 1, 0xFF);
+	size_t ok = parseInt64Column (&fields[0], n, &ints[0], &status[0], threads);
+	size_t expected = 0;
+	for (size_t i = 0; i < n; ++i) {
+		int64_t v = 0;
+		const ParseStatus st = fields[i].tryToInt64 (v);
+		EXPECT_EQ (st, status[i]) << std::string (fields[i].cstr(), fields[i].length());
+		EXPECT_EQ ((st == PARSE_OK) ? v : 0, ints[i]) << std::string (fields[i].cstr(), fields[i].length());
+		expected += (st == PARSE_OK);
+	}
+	EXPECT_EQ (expected, ok);
+	EXPECT_EQ (0xFF, status[n]);
+	EXPECT_EQ (-1, ints[n]);
+
+	ok = parseDoubleColumn (&fields[0], n, &doubles[0], &status[0], threads);
+	expected = 0;
+	for (size_t i = 0; i < n; ++i) {
+		double v = 0;
+		const ParseStatus st = fields[i].tryToFloat (v);
+		EXPECT_EQ (st, status[i]) << std::string (fields[i].cstr(), fields[i].length());
+		if (st == PARSE_OK) {
+			if (v != v) {
+				EXPECT_NE (doubles[i], doubles[i]) << std::string (fields[i].cstr(), fields[i].length());
+			} else {
+				EXPECT_EQ (v, doubles[i]) << std::string (fields[i].cstr(), fields[i].length());
+				EXPECT_EQ (std::signbit (v), std::signbit (doubles[i])) << std::string (fields[i].cstr(), fields[i].length());
+			}
+			++expected;
+		} else {
+			EXPECT_EQ (0.0, doubles[i]) << std::string (fields[i].cstr(), fields[i].length());
+		}
+	}
+	EXPECT_EQ (expected, ok);
+	EXPECT_EQ (0xFF, status[n]);
+}
+
+/// Runs f with every SIMD level the CPU supports.
+template <class F>
+void forEachLevel (F f)
+{
+	const SimdLevel saved = getSimdLevel();
+	for (int level = SIMD_SCALAR; level <= supportedSimdLevel(); ++level) {
+		setSimdLevel (static_cast<SimdLevel>(level));
+		f();
+	}
+	setSimdLevel (saved);
+}
+
+struct CheckSamples {
+	void operator()() const {
+		std::vector<String> strings;
+		std::vector<StringView> views;
+		std::vector<XString> copies;
+		for (size_t i = 0; i < sizeof(INT_FIELDS) / sizeof(INT_FIELDS[0]); ++i) {
+			strings.push_back (String (INT_FIELDS[i]));
+		}
+		for (size_t i = 0; i < sizeof(DOUBLE_FIELDS) / sizeof(DOUBLE_FIELDS[0]); ++i) {
+			strings.push_back (String (DOUBLE_FIELDS[i]));
+		}
+		for (size_t i = 0; i < strings.size(); ++i) {
+			views.push_back (strings[i]);
+			copies.push_back (XString (strings[i]));
+		}
+		checkColumns (strings, 1);
+		checkColumns (views, 1);
+		checkColumns (copies, 1);
+	}
+};
+
+TEST (ColumnParsingTest, matches_the_field_conversions)
+{
+	forEachLevel (CheckSamples());
+}
+
+/// Random numbers of every length, with and without a sign and a '.'.
+struct CheckRandomFields {
+	std::vector<std::string>& storage;
+	unsigned threads;
+
+	void operator()() const {
+		std::vector<String> fields;
+		for (size_t i = 0; i < storage.size(); ++i) {
+			fields.push_back (String (storage[i].data(), storage[i].length()));
+		}
+		checkColumns (fields, threads);
+	}
+};
+
+void makeFields (std::vector<std::string>& storage, size_t count)
+{
+	uint64_t seed = 42;
+	for (size_t i = 0; i < count; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		const unsigned digits = 1 + (seed >> 33) % 20;
+		const unsigned dot = (seed >> 40) % 24;
+		std::string s ((seed >> 20) % 3 == 0 ? "-" : "");
+		for (unsigned d = 0; d < digits; ++d) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			if (d == dot) {
+				s += '.';
+			}
+			s += static_cast<char>('0' + (seed >> 33) % 10);
+		}
+		storage.push_back (s);
+	}
+}
+
+TEST (ColumnParsingTest, converts_random_fields)
+{
+	std::vector<std::string> storage;
+	makeFields (storage, 20000);
+	CheckRandomFields check = { storage, 1 };
+	forEachLevel (check);
+}
+
+/// Numbers of 15 significant digits, the longest the SIMD path converts.
+void makeLongFields (std::vector<std::string>& storage, size_t count)
+{
+	uint64_t seed = 7;
+	for (size_t i = 0; i < count; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		const unsigned dot = (seed >> 40) % 16;
+		std::string s ((seed >> 20) % 3 == 0 ? "-" : "");
+		for (unsigned d = 0; d < 15; ++d) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			if (d == dot && d != 0) {
+				s += '.';
+			}
+			s += static_cast<char>('0' + (d == 0 ? 1 + (seed >> 33) % 9 : (seed >> 33) % 10));
+		}
+		storage.push_back (s);
+	}
+}
+
+TEST (ColumnParsingTest, converts_fields_of_15_significant_digits)
+{
+	std::vector<std::string> storage;
+	makeLongFields (storage, 200000);
+	CheckRandomFields check = { storage, 1 };
+	forEachLevel (check);
+}
+
+TEST (ColumnParsingTest, splits_large_columns_between_threads)
+{
+	std::vector<std::string> storage;
+	makeFields (storage, 100003);
+	CheckRandomFields check = { storage, 4 };
+	forEachLevel (check);
+	check.threads = 0;
+	forEachLevel (check);
+}
+
+TEST (ColumnParsingTest, status_is_optional)
+{
+	String fields[] = { String ("12"), String ("x"), String ("-3.5") };
+	int64_t ints[3];
+	double doubles[3];
+
+	EXPECT_EQ (1u, parseInt64Column (fields, 3, ints));
+	EXPECT_EQ (12, ints[0]);
+	EXPECT_EQ (0, ints[1]);
+	EXPECT_EQ (0, ints[2]);
+	EXPECT_EQ (2u, parseDoubleColumn (fields, 3, doubles));
+	EXPECT_EQ (12.0, doubles[0]);
+	EXPECT_EQ (0.0, doubles[1]);
+	EXPECT_EQ (-3.5, doubles[2]);
+	EXPECT_EQ (0u, parseInt64Column (fields, 0, ints));
+}
+
+struct CheckPageEnd {
+	void operator()() const {
+		const long page = sysconf (_SC_PAGESIZE);
+		char* mem = static_cast<char*>(mmap (0, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+		ASSERT_NE (MAP_FAILED, mem);
+		ASSERT_EQ (0, mprotect (mem + page, page, PROT_NONE));
+
+		// Fields ending on the last byte before the protected page.
+		const char* numbers[] = { "5", "-12", "1234.5", "1234567890123456", "-123456789.012345" };
+		for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+			const size_t len = strlen (numbers[i]);
+			memcpy (mem + page - len, numbers[i], len);
+			std::vector<StringView> fields (1, String (mem + page - len, len));
+			checkColumns (fields, 1);
+		}
+		munmap (mem, 2 * page);
+	}
+};
+
+TEST (ColumnParsingTest, reads_fields_at_the_end_of_a_page)
+{
+	forEachLevel (CheckPageEnd());
+}
+
+} // namespace
@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace Fianet;
+
+namespace {
+
+TEST (CompactStringTest, layout_works)
+{
+	EXPECT_EQ ((size_t)16, sizeof(CompactString));
+
+	const char* longText = "FR-MERCHANT-2016-000042";
+	CompactString empty, shortOne ("FR-2016"), longOne (longText);
+	EXPECT_EQ ((size_t)0, empty.length());
+	EXPECT_TRUE (empty.str().equals (""));
+	EXPECT_TRUE (shortOne.isInline());
+	EXPECT_FALSE (longOne.isInline());
+	EXPECT_TRUE (shortOne.str().equals ("FR-2016"));
+	EXPECT_EQ (longText, longOne.data());
+	EXPECT_TRUE (longOne.str().equals (longText));
+	EXPECT_EQ (String (longText).hash(), longOne.hash());
+	EXPECT_EQ (String ("FR-2016").hash(), shortOne.hash());
+
+	// Short strings are copied.
+	char buffer[] = "123456789012";
+	CompactString copied (String (buffer, 12));
+	buffer[0] = 'X';
+	EXPECT_TRUE (copied.isInline());
+	EXPECT_TRUE (copied.str().equals ("123456789012"));
+
+	// Trivially copyable.
+	CompactString raw;
+	memcpy (&raw, &longOne, sizeof(raw));
+	EXPECT_TRUE (raw == longOne);
+}
+
+TEST (CompactStringTest, comparisons_work)
+{
+	EXPECT_TRUE (CompactString ("abc") == CompactString (String ("xabcx").substr (1, 3)));
+	EXPECT_TRUE (CompactString ("abc") != CompactString ("abd"));
+	EXPECT_TRUE (CompactString ("abc") != CompactString ("ab"));
+	EXPECT_TRUE (CompactString ("FR-MERCHANT-2016-000042") == CompactString (XString ("FR-MERCHANT-2016-000042")));
+	EXPECT_TRUE (CompactString ("FR-MERCHANT-2016-000042") != CompactString ("FR-MERCHANT-2016-000043"));
+
+	EXPECT_TRUE (CompactString ("FR-MERCHANT-2016").startsWith ("FR"));
+	EXPECT_TRUE (CompactString ("FR-MERCHANT-2016").startsWith ("FR-MERCHANT"));
+	EXPECT_TRUE (CompactString ("FR-MERCHANT-2016").startsWith (""));
+	EXPECT_FALSE (CompactString ("FR-MERCHANT-2016").startsWith ("FR-MERCHANT-2017"));
+	EXPECT_FALSE (CompactString ("FR").startsWith ("FR-"));
+	EXPECT_FALSE (CompactString ("FR-M").startsWith ("FX"));
+
+	// Same order as String::compareTo(), including 0 and high bytes.
+	const char alphabet[] = { 0, 1, 'a', 'b', '\x7F', '\x80', '\xFF' };
+	std::vector<std::string> storage;
+	unsigned seed = 99;
+	for (int i = 0; i < 3000; ++i) {
+		seed = seed * 1103515245 + 12345;
+		std::string s ((i % 3) ? "" : "FR-MERCHANT-");
+		const unsigned n = (seed >> 16) % 16;
+		for (unsigned k = 0; k < n; ++k) {
+			seed = seed * 1103515245 + 12345;
+			s += alphabet[(seed >> 16) % 7];
+		}
+		storage.push_back (s);
+	}
+	for (size_t i = 0; i < storage.size(); ++i) {
+		const String a (storage[i].data(), storage[i].length());
+		const CompactString ca (a);
+		for (size_t j = i; j < storage.size(); j += 7) {
+			const String b (storage[j].data(), storage[j].length());
+			const CompactString cb (b);
+			const int expected = a.compareTo (b);
+			const int res = ca.compareTo (cb);
+			ASSERT_EQ (expected < 0, res < 0) << i << " " << j;
+			ASSERT_EQ (expected > 0, res > 0) << i << " " << j;
+			ASSERT_EQ (a.equals (b), ca.equals (cb));
+			ASSERT_EQ (a.startsWith (b), ca.startsWith (cb)) << i << " " << j;
+		}
+	}
+
+	std::vector<CompactString> sorted;
+	for (size_t i = 0; i < storage.size(); ++i) {
+		sorted.push_back (CompactString (storage[i].data(), storage[i].length()));
+	}
+	std::sort (sorted.begin(), sorted.end(), CompactString::Comparator());
+	std::vector<std::string> expected (storage);
+	std::sort (expected.begin(), expected.end());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		ASSERT_EQ (expected[i], std::string (sorted[i].data(), sorted[i].length()));
+	}
+}
+
+} // namespace
@@ -0,0 +1,174 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "ByteSearch.h"
+
+using namespace Fianet;
+
+namespace {
+
+TEST (CpuFeaturesTest, level_selection_works)
+{
+	const SimdLevel initial = getSimdLevel();
+	const SimdLevel supported = supportedSimdLevel();
+
+	EXPECT_LE (initial, supported);
+	EXPECT_EQ (SIMD_SCALAR, setSimdLevel (SIMD_SCALAR));
+	EXPECT_EQ (SIMD_SCALAR, getSimdLevel());
+	EXPECT_EQ (supported, setSimdLevel (SIMD_AVX2));
+	EXPECT_EQ (supported, getSimdLevel());
+
+	// The results do not depend on the level.
+	String hay ("<field name=\"amount\">12.50</field><field name=\"currency\">EUR</field>");
+	for (int l = SIMD_SCALAR; l <= supported; ++l) {
+		setSimdLevel (static_cast<SimdLevel>(l));
+		EXPECT_EQ (34, hay.indexOf ("<field name=\"currency\""));
+		EXPECT_EQ (34, hay.lastIndexOf ("<field"));
+		EXPECT_TRUE (hay.icontains ("CURRENCY"));
+	}
+
+	setSimdLevel (initial);
+}
+
+TEST (CpuFeaturesTest, level_names_work)
+{
+	SimdLevel level = SIMD_SCALAR;
+
+	for (int l = SIMD_SCALAR; l <= SIMD_AVX2; ++l) {
+		EXPECT_TRUE (simdLevelFromName (simdLevelName (static_cast<SimdLevel>(l)), level));
+		EXPECT_EQ (l, level);
+	}
+	EXPECT_TRUE (simdLevelFromName ("SSE2", level));
+	EXPECT_EQ (SIMD_SSE2, level);
+	EXPECT_FALSE (simdLevelFromName ("neon", level));
+	EXPECT_EQ (SIMD_SSE2, level);
+}
+
+// Bytes of the random buffers: few distinct values, so that needles match
+// often, with both cases and bytes from 0x80.
+const char alphabet[] = "aAbBzZ<>\" \t\xE9\xC9\x80\xFF@";
+
+void randomBytes (uint8_t* p, size_t len)
+{
+	for (size_t i = 0; i < len; ++i) {
+		p[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+	}
+}
+
+ssize_t offset (const uint8_t* res, const uint8_t* base)
+{
+	return res ? (res - base) : -1;
+}
+
+// Checks every level the CPU supports against the scalar kernels.
+TEST (CpuFeaturesTest, kernels_match_scalar)
+{
+	const ByteKernels* ref = byteKernels (SIMD_SCALAR);
+	ASSERT_TRUE (ref != 0);
+
+	uint8_t buffer[200], needle[48], copy1[200], copy2[200];
+	srand (42);
+
+	for (int l = SIMD_SSE2; l <= supportedSimdLevel(); ++l) {
+		const ByteKernels* k = byteKernels (static_cast<SimdLevel>(l));
+		ASSERT_TRUE (k != 0);
+		SCOPED_TRACE (simdLevelName (k->level));
+
+		for (int iter = 0; iter < 4000; ++iter) {
+			const size_t start = rand() % 8;
+			const size_t len = rand() % (sizeof(buffer) - start);
+			uint8_t* hay = buffer + start;
+			randomBytes (buffer, sizeof(buffer));
+
+			// Needles: copies of the haystack, or random bytes.
+			size_t nlen = 1 + rand() % (sizeof(needle) - 1);
+			if (len > 0 && rand() % 2) {
+				nlen = 1 + rand() % ((len < sizeof(needle)) ? len : sizeof(needle));
+				memcpy (needle, hay + rand() % (len - nlen + 1), nlen);
+			} else {
+				randomBytes (needle, nlen);
+				nlen = 1 + rand() % 3;
+			}
+			size_t off1, off2;
+			memfindSelectBytes (needle, nlen, off1, off2);
+
+			EXPECT_EQ (offset (ref->find (hay, len, needle, nlen, off1, off2), hay),
+			           offset (k->find (hay, len, needle, nlen, off1, off2), hay));
+			EXPECT_EQ (offset (ref->rfind (hay, len, needle, nlen, off1, off2), hay),
+			           offset (k->rfind (hay, len, needle, nlen, off1, off2), hay));
+			EXPECT_EQ (offset (ref->candidate (hay, len, nlen, needle[off1], off1, needle[off2], off2), hay),
+			           offset (k->candidate (hay, len, nlen, needle[off1], off1, needle[off2], off2), hay));
+
+			// Case-insensitive kernels, on a needle with flipped cases.
+			for (size_t i = 0; i < nlen; ++i) {
+				if (rand() % 2) {
+					needle[i] ^= 0x20;
+				}
+			}
+			EXPECT_EQ (offset (ref->ifind (hay, len, needle, nlen, off1, off2), hay),
+			           offset (k->ifind (hay, len, needle, nlen, off1, off2), hay));
+
+			memcpy (copy1, hay, len);
+			for (size_t i = 0; i < len; ++i) {
+				if (rand() % 2) {
+					copy1[i] ^= 0x20;
+				}
+			}
+			EXPECT_EQ (ref->icompare (hay, copy1, len), k->icompare (hay, copy1, len));
+
+			memcpy (copy1, hay, len);
+			memcpy (copy2, hay, len);
+			const uint8_t first = (rand() % 2) ? 'a' : 'A';
+			ref->flipcase (copy1, len, first);
+			k->flipcase (copy2, len, first);
+			EXPECT_EQ (0, memcmp (copy1, copy2, len));
+
+			// Character sets, with and without bytes from 0x80.
+			CharSet set;
+			const size_t nb = rand() % 4;
+			for (size_t i = 0; i < nb; ++i) {
+				set.add (alphabet[rand() % (sizeof(alphabet) - 1)]);
+			}
+			if (rand() % 2) {
+				set = set.complement();
+			}
+			const bool in = (rand() % 2);
+
+			EXPECT_EQ (offset (ref->charset (hay, len, set, in), hay), offset (k->charset (hay, len, set, in), hay));
+			EXPECT_EQ (offset (ref->rcharset (hay, len, set, in), hay), offset (k->rcharset (hay, len, set, in), hay));
+		}
+	}
+}
+
+TEST (CpuFeaturesTest, trim_and_case_conversion_work_at_every_level)
+{
+	const SimdLevel initial = getSimdLevel();
+
+	for (int l = SIMD_SCALAR; l <= supportedSimdLevel(); ++l) {
+		setSimdLevel (static_cast<SimdLevel>(l));
+		SCOPED_TRACE (simdLevelName (getSimdLevel()));
+
+		XString s;
+		s.append (" \t\r\n                                   ");
+		s.append ("Livraison en point relais, merci de sonner deux fois. \xC9t\xE9");
+		s.append ("\v\f                                                  \n");
+
+		String view (s);
+		view.trim();
+		EXPECT_TRUE (view.equals ("Livraison en point relais, merci de sonner deux fois. \xC9t\xE9"));
+
+		s.trim();
+		EXPECT_TRUE (s.equals ("Livraison en point relais, merci de sonner deux fois. \xC9t\xE9"));
+		s.toUppercase();
+		EXPECT_TRUE (s.equals ("LIVRAISON EN POINT RELAIS, MERCI DE SONNER DEUX FOIS. \xC9T\xE9"));
+		s.toLowercase();
+		EXPECT_TRUE (s.equals ("livraison en point relais, merci de sonner deux fois. \xC9t\xE9"));
+
+		XString blank ("   \t\t   \n                                         ");
+		blank.trim();
+		EXPECT_EQ ((size_t)0, blank.length());
+	}
+
+	setSimdLevel (initial);
+}
+
+} // namespace
@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include <string>
+
+using namespace Fianet;
+
+namespace {
+
+Decimal parse (const char* s, unsigned scale, char decimalSeparator = '.', char groupSeparator = 0)
+{
+	Decimal d (-1, 99);
+	EXPECT_EQ (PARSE_OK, String (s).tryToDecimal (scale, d, decimalSeparator, groupSeparator)) << s;
+	return d;
+}
+
+ParseStatus status (const char* s, unsigned scale, char decimalSeparator = '.', char groupSeparator = 0)
+{
+	Decimal d (-1, 99);
+	const ParseStatus st = String (s).tryToDecimal (scale, d, decimalSeparator, groupSeparator);
+	if (st != PARSE_OK) {
+		EXPECT_EQ (Decimal (-1, 99), d) << s;
+	}
+	return st;
+}
+
+std::string format (const Decimal& d, char decimalSeparator = '.', char groupSeparator = 0)
+{
+	XString s ("|");
+	s.appendDecimal (d, decimalSeparator, groupSeparator);
+	return std::string (s.cstr() + 1, s.length() - 1);
+}
+
+TEST (DecimalTest, parses_amounts)
+{
+	EXPECT_EQ (Decimal (123456, 2), parse ("1234.56", 2));
+	EXPECT_EQ (Decimal (123450, 2), parse ("1234.5", 2));
+	EXPECT_EQ (Decimal (123400, 2), parse ("1234", 2));
+	EXPECT_EQ (Decimal (123400, 2), parse ("1234.", 2));
+	EXPECT_EQ (Decimal (50, 2), parse (".5", 2));
+	EXPECT_EQ (Decimal (-123456, 2), parse ("-1234.56", 2));
+	EXPECT_EQ (Decimal (123456, 2), parse ("  +1234.56", 2));
+	EXPECT_EQ (Decimal (0, 2), parse ("-0.00", 2));
+	EXPECT_EQ (Decimal (1234, 0), parse ("1234", 0));
+	EXPECT_EQ (Decimal (1234, 0), parse ("1234.000", 0));
+	EXPECT_EQ (Decimal (123456, 2), parse ("1234.56000", 2));
+	EXPECT_EQ (Decimal (1, 18), parse ("0.000000000000000001", 18));
+	EXPECT_EQ (Decimal (1234567890123456789LL, 0), parse ("1234567890123456789", 0));
+	EXPECT_EQ (Decimal (1234567890123456789LL, 4), parse ("123456789012345.6789", 4));
+	EXPECT_EQ (Decimal (INT64_MAX, 2), parse ("92233720368547758.07", 2));
+	EXPECT_EQ (Decimal (INT64_MIN, 2), parse ("-92233720368547758.08", 2));
+	EXPECT_EQ (Decimal (12, 0), parse ("00000000000000000000000000012", 0));
+
+	// Separators.
+	EXPECT_EQ (Decimal (123456, 2), parse ("1234,56", 2, ','));
+	EXPECT_EQ (Decimal (123456, 2), parse ("1 234,56", 2, ',', ' '));
+	EXPECT_EQ (Decimal (123456789, 2), parse ("1,234,567.89", 2, '.', ','));
+	EXPECT_EQ (Decimal (12345678900LL, 2), parse ("123.456.789", 2, ',', '.'));
+	EXPECT_EQ (Decimal (123, 0), parse ("123", 0, '.', ','));
+	EXPECT_EQ (Decimal (1234, 0), parse ("1234", 0, '.', ','));
+
+	// The throwing variant.
+	EXPECT_EQ (Decimal (-7, 1), String ("-0.7").toDecimal (1));
+	EXPECT_THROW (String ("0.75").toDecimal (1), NumberRangeError);
+	EXPECT_THROW (String ("abc").toDecimal (1), NumberFormatError);
+}
+
+TEST (DecimalTest, rejects_malformed_numbers)
+{
+	EXPECT_EQ (PARSE_EMPTY, status ("", 2));
+	const char* malformed[] = {
+		" ", "-", "+", ".", "-.", "1.2.3", "1,5", "12a", "1e5", "0x10", "inf", "nan", "1 ", "- 1", "--1", "1-"
+	};
+	for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); ++i) {
+		EXPECT_EQ (PARSE_FORMAT_ERROR, status (malformed[i], 2)) << malformed[i];
+	}
+
+	const char* badGroups[] = {
+		",123", "1,23", "1234,567", "1,2345", "1,234,56", "1,,234", "1,234,", "1,234.", "12345678,123"
+	};
+	for (size_t i = 0; i < sizeof(badGroups) / sizeof(badGroups[0]); ++i) {
+		if (std::string (badGroups[i]) == "1,234.") {
+			EXPECT_EQ (PARSE_OK, status (badGroups[i], 2, '.', ','));
+		} else {
+			EXPECT_EQ (PARSE_FORMAT_ERROR, status (badGroups[i], 2, '.', ',')) << badGroups[i];
+		}
+	}
+}
+
+TEST (DecimalTest, reports_what_does_not_fit)
+{
+	// Digits beyond the scale.
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("1234.567", 2));
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("0.0000001", 2));
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("1.5", 0));
+
+	// The mantissa.
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("92233720368547758.08", 2));
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("-92233720368547758.09", 2));
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("10000000000000000000", 0));
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("99999999999999999999999999", 0));
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("10", 18));
+	EXPECT_EQ (PARSE_RANGE_ERROR, status ("1", 19));
+}
+
+TEST (DecimalTest, formats_amounts)
+{
+	EXPECT_EQ ("1234.56", format (Decimal (123456, 2)));
+	EXPECT_EQ ("1234.50", format (Decimal (123450, 2)));
+	EXPECT_EQ ("-0.05", format (Decimal (-5, 2)));
+	EXPECT_EQ ("0.00", format (Decimal (0, 2)));
+	EXPECT_EQ ("0", format (Decimal()));
+	EXPECT_EQ ("-42", format (Decimal (-42, 0)));
+	EXPECT_EQ ("0.000000000000000001", format (Decimal (1, 18)));
+	EXPECT_EQ ("9.223372036854775807", format (Decimal (INT64_MAX, 18)));
+	EXPECT_EQ ("-92233720368547758.08", format (Decimal (INT64_MIN, 2)));
+
+	EXPECT_EQ ("1234,56", format (Decimal (123456, 2), ','));
+	EXPECT_EQ ("1 234,56", format (Decimal (123456, 2), ',', ' '));
+	EXPECT_EQ ("-123 456 789", format (Decimal (-123456789, 0), ',', ' '));
+	EXPECT_EQ ("12 345 678,9", format (Decimal (123456789, 1), ',', ' '));
+	EXPECT_EQ ("100", format (Decimal (100, 0), '.', ','));
+	EXPECT_EQ ("1,000.00", format (Decimal (100000, 2), '.', ','));
+	EXPECT_EQ ("9,223,372,036,854,775,807", format (Decimal (INT64_MAX, 0), '.', ','));
+}
+
+TEST (DecimalTest, round_trips)
+{
+	uint64_t seed = 42;
+	for (int i = 0; i < 100000; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		const Decimal d (static_cast<int64_t>(seed) >> (seed % 64), static_cast<unsigned>((seed >> 8) % 19));
+		const char separators[][2] = { { '.', 0 }, { ',', ' ' }, { '.', ',' }, { ',', '.' } };
+		const char* sep = separators[(seed >> 16) % 4];
+
+		XString s;
+		s.appendDecimal (d, sep[0], sep[1]);
+		Decimal back;
+		ASSERT_EQ (PARSE_OK, s.tryToDecimal (d.scale(), back, sep[0], sep[1])) << s.cstr();
+		EXPECT_EQ (d, back) << s.cstr();
+	}
+}
+
+} // namespace
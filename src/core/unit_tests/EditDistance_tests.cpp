@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "EditDistance.h"
+
+using namespace Fianet;
+
+namespace {
+
+// Reference: the full dynamic programming matrix.
+size_t naiveDistance (const String& a, const String& b, bool ignoreCase)
+{
+	const size_t m = a.length(), n = b.length();
+	size_t* prev = new size_t[n + 1];
+	size_t* cur = new size_t[n + 1];
+
+	for (size_t j = 0; j <= n; ++j) {
+		prev[j] = j;
+	}
+	for (size_t i = 1; i <= m; ++i) {
+		cur[0] = i;
+		for (size_t j = 1; j <= n; ++j) {
+			char x = a.charAt (i - 1), y = b.charAt (j - 1);
+			if (ignoreCase) {
+				x = toupper (x);
+				y = toupper (y);
+			}
+			size_t d = prev[j - 1] + ((x == y) ? 0 : 1);
+			if (prev[j] + 1 < d) {
+				d = prev[j] + 1;
+			}
+			if (cur[j - 1] + 1 < d) {
+				d = cur[j - 1] + 1;
+			}
+			cur[j] = d;
+		}
+		size_t* tmp = prev;
+		prev = cur;
+		cur = tmp;
+	}
+
+	const size_t res = prev[n];
+	delete[] prev;
+	delete[] cur;
+	return res;
+}
+
+void randomString (XString& s, size_t len, const char* alphabet)
+{
+	const size_t nb = strlen (alphabet);
+	s.clear();
+	for (size_t i = 0; i < len; ++i) {
+		s.appendChar (alphabet[rand() % nb]);
+	}
+}
+
+TEST (EditDistanceTest, known_distances_work)
+{
+	EXPECT_EQ ((size_t)3, editDistance ("kitten", "sitting"));
+	EXPECT_EQ ((size_t)3, editDistance ("sitting", "kitten"));
+	EXPECT_EQ ((size_t)0, editDistance ("Dupont", "Dupont"));
+	EXPECT_EQ ((size_t)1, editDistance ("Dupont", "Dupond"));
+	EXPECT_EQ ((size_t)6, editDistance ("", "Dupont"));
+	EXPECT_EQ ((size_t)6, editDistance ("Dupont", ""));
+	EXPECT_EQ ((size_t)0, editDistance ("", ""));
+	EXPECT_EQ ((size_t)2, editDistance ("12 rue de la Paix", "12 rue de la paix."));
+	EXPECT_EQ ((size_t)1, editDistance ("12 rue de la Paix", "12 rue de la paix.", EditDistance::IGNORE_CASE));
+}
+
+TEST (EditDistanceTest, matches_naive_distance)
+{
+	XString a, b;
+	srand (7);
+
+	// Lengths around the block boundaries.
+	for (int iter = 0; iter < 3000; ++iter) {
+		randomString (a, rand() % 200, "abcAB ");
+		if (rand() % 2) {
+			randomString (b, rand() % 200, "abcAB ");
+		} else {
+			// Close strings: a few edits of a.
+			b.copyFrom (a);
+			for (int e = rand() % 5; e > 0 && b.length() > 0; --e) {
+				XString tmp;
+				const size_t pos = rand() % b.length();
+				tmp.append (b.substr (0, pos));
+				tmp.appendChar ("xyz"[rand() % 3]);
+				tmp.append (b.substr (pos + (rand() % 2)));
+				b.copyFrom (tmp);
+			}
+		}
+
+		const bool ignoreCase = (iter % 3 == 0);
+		const EditDistance::Mode mode = ignoreCase ? EditDistance::IGNORE_CASE : EditDistance::CASE_SENSITIVE;
+		const size_t expected = naiveDistance (a, b, ignoreCase);
+
+		EditDistance ed (a, mode);
+		EXPECT_EQ (expected, ed.distance (b)) << a.cstr() << " / " << b.cstr();
+		EXPECT_EQ (expected, editDistance (b, a, mode));
+
+		const size_t k = rand() % 10;
+		EXPECT_EQ (expected <= k, ed.within (b, k));
+		EXPECT_EQ (expected <= k, withinDistance (a, b, k, mode));
+		if (expected <= k) {
+			EXPECT_EQ (expected, ed.distance (b, k));
+		} else {
+			EXPECT_LT (k, ed.distance (b, k));
+		}
+	}
+}
+
+TEST (EditDistanceTest, batch_works)
+{
+	EditDistance input ("DUPONT", EditDistance::IGNORE_CASE);
+	const String candidates[] = { "Martin", "Dupond", "Durand", "dupont", "Dupont" };
+	size_t results[5];
+	size_t dist = 99;
+
+	input.distances (candidates, 5, results);
+	EXPECT_EQ ((size_t)6, results[0]);
+	EXPECT_EQ ((size_t)1, results[1]);
+	EXPECT_EQ ((size_t)3, results[2]);
+	EXPECT_EQ ((size_t)0, results[3]);
+	EXPECT_EQ ((size_t)0, results[4]);
+
+	EXPECT_EQ (3, input.closest (candidates, 5, 2, &dist));
+	EXPECT_EQ ((size_t)0, dist);
+	EXPECT_EQ (1, input.closest (candidates, 3, 2, &dist));
+	EXPECT_EQ ((size_t)1, dist);
+	EXPECT_EQ (-1, input.closest (candidates, 1, 2));
+}
+
+} // namespace
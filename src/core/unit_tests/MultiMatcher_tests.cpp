@@ -0,0 +1,181 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+
+#include "MultiMatcher.h"
+
+#include <set>
+#include <utility>
+
+using namespace Fianet;
+
+namespace {
+
+typedef std::set< std::pair<size_t, uint32_t> > MatchSet;
+
+struct Collector : public MultiMatcher::Handler {
+	MatchSet matches;
+
+	bool onMatch (uint32_t pattern, size_t offset) {
+		matches.insert (std::make_pair (offset, pattern));
+		return true;
+	}
+};
+
+void naive_matches (const String& text, const XString* patterns, size_t nb, bool icase, MatchSet& out)
+{
+	out.clear();
+	for (size_t id = 0; id < nb; ++id) {
+		const String& p = patterns[id];
+		for (size_t i = 0; i + p.length() <= text.length(); ++i) {
+			const String sub (text.cstr() + i, p.length());
+			if (icase ? sub.iequals (p) : sub.equals (p)) {
+				out.insert (std::make_pair (i, (uint32_t) id));
+			}
+		}
+	}
+}
+
+void random_string (XString& s, size_t len, const char* alphabet)
+{
+	size_t nb = strlen (alphabet);
+	s.clear();
+	for (size_t i = 0; i < len; ++i) {
+		s.appendChar (alphabet[rand() % nb]);
+	}
+}
+
+TEST (MultiMatcherTest, finds_all_patterns)
+{
+	static const MultiMatcher::Engine engines[] = { MultiMatcher::AUTO, MultiMatcher::AHO_CORASICK };
+
+	for (size_t e = 0; e < 2; ++e) {
+		MultiMatcher m;
+		EXPECT_EQ ((uint32_t)0, m.add ("he"));
+		EXPECT_EQ ((uint32_t)1, m.add ("she"));
+		EXPECT_EQ ((uint32_t)2, m.add ("his"));
+		EXPECT_EQ ((uint32_t)3, m.add ("hers"));
+		m.compile (engines[e]);
+		const bool teddy = (e == 0 && getSimdLevel() >= SIMD_SSSE3);
+		EXPECT_EQ (teddy ? MultiMatcher::TEDDY : MultiMatcher::AHO_CORASICK, m.usedEngine());
+
+		Collector c;
+		EXPECT_EQ ((size_t)4, m.findAll (CSTR("ushers his"), c));
+
+		MatchSet expected;
+		expected.insert (std::make_pair ((size_t)1, (uint32_t)1));
+		expected.insert (std::make_pair ((size_t)2, (uint32_t)0));
+		expected.insert (std::make_pair ((size_t)2, (uint32_t)3));
+		expected.insert (std::make_pair ((size_t)7, (uint32_t)2));
+		EXPECT_TRUE (expected == c.matches);
+
+		MultiMatcher::Match first;
+		EXPECT_TRUE (m.findFirst (CSTR("ushers his"), first));
+		EXPECT_EQ ((uint32_t)1, first.pattern);
+		EXPECT_EQ ((size_t)1, first.offset);
+
+		EXPECT_TRUE (m.contains (CSTR("this")));
+		EXPECT_FALSE (m.contains (CSTR("HERS")));
+		EXPECT_FALSE (m.contains (String::blank()));
+		EXPECT_FALSE (m.findFirst (CSTR("nothing"), first));
+	}
+}
+
+TEST (MultiMatcherTest, ignore_case_works)
+{
+	static const MultiMatcher::Engine engines[] = { MultiMatcher::AUTO, MultiMatcher::AHO_CORASICK };
+
+	for (size_t e = 0; e < 2; ++e) {
+		MultiMatcher m (MultiMatcher::IGNORE_CASE);
+		m.add ("Mickey Mouse");
+		m.add ("TEST@test.com");
+		m.compile (engines[e]);
+
+		EXPECT_TRUE (m.contains (CSTR("Name: MICKEY MOUSE")));
+		EXPECT_TRUE (m.contains (CSTR("test@TEST.COM")));
+		EXPECT_FALSE (m.contains (CSTR("Mickey Mous")));
+		EXPECT_EQ (CSTR("mickey mouse"), m.pattern (0));
+		EXPECT_EQ (String::blank(), m.pattern (2));
+	}
+}
+
+TEST (MultiMatcherTest, leftmost_match_is_first)
+{
+	MultiMatcher m;
+	m.add ("bcdef");
+	m.add ("abcdefgh");
+	m.add ("cd");
+	m.add ("abc");
+	m.compile (MultiMatcher::AHO_CORASICK);
+
+	// "cd" ends first, but "abcdefgh" and "abc" start before.
+	MultiMatcher::Match first;
+	EXPECT_TRUE (m.findFirst (CSTR("xxabcdefghxx"), first));
+	EXPECT_EQ ((uint32_t)1, first.pattern);
+	EXPECT_EQ ((size_t)2, first.offset);
+}
+
+TEST (MultiMatcherTest, misuse_throws)
+{
+	MultiMatcher m;
+	EXPECT_THROW (m.add (String::blank()), Fianet::Exception);
+	EXPECT_THROW (m.contains (CSTR("abc")), Fianet::Exception);
+
+	m.compile();
+	EXPECT_TRUE (m.isCompiled());
+	EXPECT_FALSE (m.contains (CSTR("abc")));
+	EXPECT_THROW (m.add ("abc"), Fianet::Exception);
+	EXPECT_THROW (m.compile(), Fianet::Exception);
+}
+
+TEST (MultiMatcherTest, matches_naive_search)
+{
+	static const char* alphabets[] = { "ab", "aAbB", "abcdefghijklmnopqrstuvwxyzABCXYZ0123@." };
+	static const size_t counts[] = { 1, 3, 8, 20, 32, 33, 200 };
+	static const MultiMatcher::Engine engines[] = { MultiMatcher::AUTO, MultiMatcher::AHO_CORASICK };
+	XString patterns[200];
+	XString text;
+	MatchSet expected;
+
+	srand (42);
+	for (size_t a = 0; a < sizeof(alphabets)/sizeof(alphabets[0]); ++a) {
+		for (size_t n = 0; n < sizeof(counts)/sizeof(counts[0]); ++n) {
+			for (int iter = 0; iter < 6; ++iter) {
+				random_string (text, rand() % 300, alphabets[a]);
+				for (size_t i = 0; i < counts[n]; ++i) {
+					size_t len = 1 + rand() % ((iter % 2) ? 4 : 12);
+					if (rand() % 2 && text.length() > len) {
+						patterns[i].copyFrom (text.substr (rand() % (text.length() - len), len));
+					} else {
+						random_string (patterns[i], len, alphabets[a]);
+					}
+				}
+
+				for (int icase = 0; icase < 2; ++icase) {
+					naive_matches (text, patterns, counts[n], icase, expected);
+
+					for (size_t e = 0; e < 2; ++e) {
+						MultiMatcher m (icase ? MultiMatcher::IGNORE_CASE : MultiMatcher::CASE_SENSITIVE);
+						for (size_t i = 0; i < counts[n]; ++i) {
+							m.add (patterns[i]);
+						}
+						m.compile (engines[e]);
+
+						Collector c;
+						EXPECT_EQ (expected.size(), m.findAll (text, c));
+						EXPECT_TRUE (expected == c.matches) << text.cstr();
+						EXPECT_EQ (!expected.empty(), m.contains (text));
+
+						MultiMatcher::Match first;
+						EXPECT_EQ (!expected.empty(), m.findFirst (text, first));
+						if (!expected.empty()) {
+							EXPECT_EQ (expected.begin()->first, first.offset);
+							EXPECT_EQ (expected.begin()->second, first.pattern);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+}
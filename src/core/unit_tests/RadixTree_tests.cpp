@@ -0,0 +1,181 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "RadixTree.h"
+
+#include <map>
+#include <string>
+
+using namespace Fianet;
+
+namespace {
+
+TEST (RadixTreeTest, find_works)
+{
+	RadixTree<int> tree;
+	EXPECT_TRUE (tree.empty());
+	EXPECT_TRUE (tree.find ("4970") == 0);
+
+	EXPECT_TRUE (tree.insert ("4970", 1));
+	EXPECT_TRUE (tree.insert ("497010", 2));
+	EXPECT_TRUE (tree.insert ("49", 3));
+	EXPECT_TRUE (tree.insert ("5132", 4));
+	EXPECT_TRUE (tree.insert ("", 5));
+	EXPECT_FALSE (tree.insert ("4970", 6));
+	tree["497011"] = 7;
+	EXPECT_EQ ((size_t)6, tree.size());
+
+	EXPECT_EQ (1, *tree.find ("4970"));
+	EXPECT_EQ (2, *tree.find (XString ("497010")));
+	EXPECT_EQ (3, *tree.find (String ("x49x").substr (1, 2)));
+	EXPECT_EQ (5, *tree.find (""));
+	EXPECT_EQ (7, tree["497011"]);
+	EXPECT_TRUE (tree.find ("4") == 0);
+	EXPECT_TRUE (tree.find ("497") == 0);
+	EXPECT_TRUE (tree.find ("4970101") == 0);
+	EXPECT_TRUE (tree.find ("513") == 0);
+	EXPECT_FALSE (tree.contains ("5133"));
+	EXPECT_GT (tree.memoryUsage(), (size_t)0);
+
+	tree.clear();
+	EXPECT_TRUE (tree.empty());
+	EXPECT_EQ ((size_t)0, tree.memoryUsage());
+	EXPECT_FALSE (tree.contains ("4970"));
+}
+
+TEST (RadixTreeTest, longest_prefix_works)
+{
+	RadixTree<int> bins;
+	bins.insert ("4", 1);
+	bins.insert ("4970", 2);
+	bins.insert ("497010", 3);
+	bins.insert ("5", 4);
+
+	size_t length = 0;
+	ASSERT_TRUE (bins.longestPrefix ("4970101234567890", length) != 0);
+	EXPECT_EQ (3, *bins.longestPrefix ("4970101234567890", length));
+	EXPECT_EQ ((size_t)6, length);
+	EXPECT_EQ (2, *bins.longestPrefix ("4970111234567890", length));
+	EXPECT_EQ ((size_t)4, length);
+	EXPECT_EQ (2, *bins.longestPrefix ("4970"));
+	EXPECT_EQ (1, *bins.longestPrefix ("497"));
+	EXPECT_EQ (4, *bins.longestPrefix ("5132"));
+	EXPECT_TRUE (bins.longestPrefix ("6011") == 0);
+	EXPECT_TRUE (bins.longestPrefix ("") == 0);
+
+	bins.insert ("", 0);
+	EXPECT_EQ (0, *bins.longestPrefix ("6011", length));
+	EXPECT_EQ ((size_t)0, length);
+}
+
+TEST (RadixTreeTest, iterators_work)
+{
+	RadixTree<int> tree;
+	const char* keys[] = { "33", "3312", "33123", "3313", "34", "4", "", "3" };
+	for (int i = 0; i < 8; ++i) {
+		tree.insert (keys[i], i);
+	}
+
+	XString all;
+	for (RadixTree<int>::Iterator it = tree.all(); it.valid(); ++it) {
+		all.append (it.key()).appendChar (',');
+		it.value() *= 10;
+	}
+	EXPECT_TRUE (all.equals (",3,33,3312,33123,3313,34,4,"));
+	EXPECT_EQ (10, *tree.find ("3312"));
+
+	XString prefixed;
+	for (RadixTree<int>::Iterator it = tree.withPrefix ("331"); it.valid(); ++it) {
+		prefixed.append (it.key()).appendChar (',');
+	}
+	EXPECT_TRUE (prefixed.equals ("3312,33123,3313,"));
+	EXPECT_FALSE (tree.withPrefix ("335").valid());
+	EXPECT_FALSE (tree.withPrefix ("5").valid());
+
+	XString range;
+	const RadixTree<int>& constTree = tree;
+	for (RadixTree<int>::ConstIterator it = constTree.range ("331", "34"); it.valid(); ++it) {
+		range.append (it.key()).appendChar (',');
+	}
+	EXPECT_TRUE (range.equals ("3312,33123,3313,"));
+
+	RadixTree<int>::ConstIterator it = constTree.range ("3312", "3313");
+	RadixTree<int>::ConstIterator copy = it;
+	++it;
+	EXPECT_TRUE (copy.key().equals ("3312"));
+	EXPECT_TRUE (it.key().equals ("33123"));
+	++copy;
+	++copy;
+	EXPECT_FALSE (copy.valid());
+	copy = it;
+	EXPECT_TRUE (copy.key().equals ("33123"));
+}
+
+TEST (RadixTreeTest, matches_std_map)
+{
+	RadixTree<int> tree;
+	std::map<std::string, int> ref;
+	unsigned seed = 4242;
+	XString key;
+
+	// Random keys over a small alphabet, to get shared prefixes, keys that
+	// are prefixes of others, and nodes of every size.
+	for (int n = 0; n < 20000; ++n) {
+		seed = seed * 1103515245 + 12345;
+		const unsigned len = (seed >> 16) % 9;
+		key.clear();
+		for (unsigned i = 0; i < len; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const unsigned r = (seed >> 16) % 1000;
+			key.appendChar (static_cast<char>((r < 800) ? '0' + r % 4 : r - 700));
+		}
+		const std::string s (key.cstr(), key.length());
+		EXPECT_EQ (ref.insert (std::make_pair (s, n)).second, tree.insert (key, n));
+	}
+	EXPECT_EQ (ref.size(), tree.size());
+
+	std::map<std::string, int>::const_iterator r = ref.begin();
+	for (RadixTree<int>::Iterator it = tree.all(); it.valid(); ++it, ++r) {
+		ASSERT_TRUE (r != ref.end());
+		ASSERT_EQ (r->first, std::string (it.key().cstr(), it.key().length()));
+		EXPECT_EQ (r->second, it.value());
+	}
+	EXPECT_TRUE (r == ref.end());
+
+	// Bounds that are keys or not.
+	const char* bounds[] = { "", "0", "01", "0123", "1", "13", "2\xFF", "3", "\xC8", "\xFF" };
+	for (int i = 0; i < 10; ++i) {
+		const std::string lo (bounds[i]);
+		for (int j = i; j < 10; ++j) {
+			const std::string hi (bounds[j]);
+			std::map<std::string, int>::const_iterator e = ref.lower_bound (lo);
+			for (RadixTree<int>::Iterator it = tree.range (bounds[i], bounds[j]); it.valid(); ++it, ++e) {
+				ASSERT_TRUE (e != ref.end() && e->first < hi);
+				ASSERT_EQ (e->first, std::string (it.key().cstr(), it.key().length()));
+			}
+			EXPECT_TRUE (e == ref.end() || e->first >= hi) << lo << " " << hi;
+		}
+
+		std::map<std::string, int>::const_iterator e = ref.lower_bound (lo);
+		for (RadixTree<int>::Iterator it = tree.withPrefix (bounds[i]); it.valid(); ++it, ++e) {
+			ASSERT_TRUE (e != ref.end());
+			ASSERT_EQ (e->first, std::string (it.key().cstr(), it.key().length()));
+		}
+		EXPECT_TRUE (e == ref.end() || e->first.compare (0, lo.length(), lo) != 0);
+
+		// Longest prefix of each key, extended.
+		for (std::map<std::string, int>::const_iterator k = ref.begin(); k != ref.end(); ++k) {
+			const std::string text = k->first + bounds[i];
+			size_t length = 0;
+			const int* v = tree.longestPrefix (String (text.c_str(), text.length()), length);
+			ASSERT_TRUE (v != 0);
+			size_t expected = text.length();
+			while (ref.find (text.substr (0, expected)) == ref.end()) {
+				--expected;
+			}
+			EXPECT_EQ (expected, length);
+			EXPECT_EQ (ref[text.substr (0, expected)], *v);
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,315 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "Regex.h"
+
+using namespace Fianet;
+
+namespace {
+
+TEST (RegexTest, matches_work)
+{
+	Regex postcode ("^\\d{5}$");
+	EXPECT_TRUE (postcode.matches ("69002"));
+	EXPECT_FALSE (postcode.matches ("6900"));
+	EXPECT_FALSE (postcode.matches ("690021"));
+	EXPECT_FALSE (postcode.matches ("6900A"));
+	EXPECT_FALSE (postcode.matches (""));
+
+	// matches() is anchored at both ends without '^' and '$' too.
+	Regex phone ("0[1-9]( ?[0-9]{2}){4}");
+	EXPECT_TRUE (phone.matches ("0478123456"));
+	EXPECT_TRUE (phone.matches ("04 78 12 34 56"));
+	EXPECT_FALSE (phone.matches ("04 78 12 34 5"));
+	EXPECT_FALSE (phone.matches ("Tel: 0478123456"));
+	EXPECT_TRUE (phone.contains ("Tel: 0478123456"));
+
+	Regex alt ("cat|dog|bird");
+	EXPECT_TRUE (alt.matches ("dog"));
+	EXPECT_FALSE (alt.matches ("dogs"));
+	EXPECT_FALSE (alt.matches ("do"));
+
+	Regex empty ("");
+	EXPECT_TRUE (empty.matches (""));
+	EXPECT_FALSE (empty.matches ("a"));
+	EXPECT_TRUE (empty.contains ("a"));
+
+	Regex star ("a*b*");
+	EXPECT_TRUE (star.matches (""));
+	EXPECT_TRUE (star.matches ("aaabb"));
+	EXPECT_FALSE (star.matches ("aba"));
+
+	Regex dot ("a.c");
+	EXPECT_TRUE (dot.matches ("abc"));
+	EXPECT_TRUE (dot.matches ("a\xE9" "c"));
+	EXPECT_FALSE (dot.matches ("a\nc"));
+}
+
+TEST (RegexTest, classes_and_escapes_work)
+{
+	Regex cls ("[a-c_\\d-]+");
+	EXPECT_TRUE (cls.matches ("ab_9-c"));
+	EXPECT_FALSE (cls.matches ("abd"));
+
+	Regex neg ("[^0-9 ]+");
+	EXPECT_TRUE (neg.matches ("abc"));
+	EXPECT_FALSE (neg.matches ("ab c"));
+	EXPECT_FALSE (neg.matches ("a1"));
+
+	Regex bracket ("[]a]+");
+	EXPECT_TRUE (bracket.matches ("]a]"));
+
+	Regex words ("\\w+\\s+\\W\\S\\D");
+	EXPECT_TRUE (words.matches ("ab_1 \t.xy"));
+	EXPECT_FALSE (words.matches ("ab_1 \t.x1"));
+
+	Regex escaped ("\\.\\*\\(\\)\\[\\\\\\x41\\t");
+	EXPECT_TRUE (escaped.matches (".*()[\\A\t"));
+
+	Regex email ("[\\w.+-]+@[\\w-]+\\.[\\w.]+");
+	EXPECT_TRUE (email.matches ("jean.dupont+test@fia-net.com"));
+	EXPECT_FALSE (email.matches ("jean.dupont@localhost"));
+}
+
+TEST (RegexTest, repetitions_work)
+{
+	Regex exact ("a{3}");
+	EXPECT_FALSE (exact.matches ("aa"));
+	EXPECT_TRUE (exact.matches ("aaa"));
+	EXPECT_FALSE (exact.matches ("aaaa"));
+
+	Regex bounded ("a{2,4}");
+	EXPECT_FALSE (bounded.matches ("a"));
+	EXPECT_TRUE (bounded.matches ("aa"));
+	EXPECT_TRUE (bounded.matches ("aaaa"));
+	EXPECT_FALSE (bounded.matches ("aaaaa"));
+
+	Regex unbounded ("(ab){2,}");
+	EXPECT_FALSE (unbounded.matches ("ab"));
+	EXPECT_TRUE (unbounded.matches ("abab"));
+	EXPECT_TRUE (unbounded.matches ("ababababab"));
+
+	Regex optional ("colou?r");
+	EXPECT_TRUE (optional.matches ("color"));
+	EXPECT_TRUE (optional.matches ("colour"));
+
+	// Exponential for backtracking engines.
+	Regex nested ("(a*)*b");
+	XString text;
+	for (int i = 0; i < 5000; ++i) {
+		text.appendChar ('a');
+	}
+	EXPECT_FALSE (nested.matches (text));
+	EXPECT_FALSE (nested.contains (text));
+	text.appendChar ('b');
+	EXPECT_TRUE (nested.matches (text));
+}
+
+TEST (RegexTest, captures_work)
+{
+	Regex::Match m;
+
+	Regex date ("(\\d{4})-(\\d{2})-(\\d{2})");
+	ASSERT_TRUE (date.match ("2016-03-31", m));
+	EXPECT_EQ ((size_t)4, m.groups());
+	EXPECT_TRUE (m.group (0).equals ("2016-03-31"));
+	EXPECT_TRUE (m.group (1).equals ("2016"));
+	EXPECT_TRUE (m.group (2).equals ("03"));
+	EXPECT_TRUE (m.group (3).equals ("31"));
+	EXPECT_EQ (5, m.start (2));
+	EXPECT_EQ (7, m.end (2));
+	EXPECT_FALSE (date.match ("2016-03-3", m));
+	EXPECT_FALSE (m.matched());
+
+	ASSERT_TRUE (date.find ("Order of 2016-03-31, shipped 2016-04-02", m));
+	EXPECT_EQ (9, m.start());
+	EXPECT_TRUE (m.group (3).equals ("31"));
+	ASSERT_TRUE (date.find ("Order of 2016-03-31, shipped 2016-04-02", m, m.end()));
+	EXPECT_EQ (29, m.start());
+	EXPECT_TRUE (m.group (2).equals ("04"));
+	EXPECT_FALSE (date.find ("Order of 2016-03-31, shipped 2016-04-02", m, m.end()));
+
+	// Groups that do not take part in the match.
+	Regex opt ("(a)|(b)");
+	ASSERT_TRUE (opt.match ("b", m));
+	EXPECT_FALSE (m.matched (1));
+	EXPECT_TRUE (m.matched (2));
+	EXPECT_EQ (-1, m.start (1));
+	EXPECT_EQ ((size_t)0, m.group (1).length());
+	EXPECT_FALSE (m.matched (3));
+
+	// A repeated group captures its last iteration.
+	Regex rep ("(\\w)+");
+	ASSERT_TRUE (rep.match ("abc", m));
+	EXPECT_TRUE (m.group (1).equals ("c"));
+
+	// Non-capturing groups.
+	Regex nc ("(?:ab)+(c)");
+	EXPECT_EQ ((size_t)2, nc.groups());
+	ASSERT_TRUE (nc.match ("ababc", m));
+	EXPECT_TRUE (m.group (1).equals ("c"));
+}
+
+TEST (RegexTest, leftmost_first_semantics_work)
+{
+	Regex::Match m;
+
+	// The leftmost match, then the first alternative.
+	Regex alt ("b|abc|ab");
+	ASSERT_TRUE (alt.find ("xabcd", m));
+	EXPECT_TRUE (m.group().equals ("abc"));
+
+	Regex alt2 ("ab|abc");
+	ASSERT_TRUE (alt2.find ("xabcd", m));
+	EXPECT_TRUE (m.group().equals ("ab"));
+	// Unless the whole text must match.
+	ASSERT_TRUE (alt2.match ("abc", m));
+	EXPECT_TRUE (m.group().equals ("abc"));
+
+	// Greedy and lazy repetitions.
+	Regex greedy ("<(.+)>");
+	Regex lazy ("<(.+?)>");
+	ASSERT_TRUE (greedy.find ("<a><b>", m));
+	EXPECT_TRUE (m.group (1).equals ("a><b"));
+	ASSERT_TRUE (lazy.find ("<a><b>", m));
+	EXPECT_TRUE (m.group (1).equals ("a"));
+
+	Regex lazyBounded ("a{2,4}?");
+	ASSERT_TRUE (lazyBounded.find ("aaaa", m));
+	EXPECT_EQ (2, m.end());
+
+	// Empty matches.
+	Regex star ("x*");
+	ASSERT_TRUE (star.find ("abc", m));
+	EXPECT_EQ (0, m.start());
+	EXPECT_EQ (0, m.end());
+	ASSERT_TRUE (star.find ("abc", m, 3));
+	EXPECT_EQ (3, m.start());
+	EXPECT_FALSE (star.find ("abc", m, 4));
+
+	// A repetition stops at an iteration matching the empty text.
+	Regex emptyBody ("(?:(c*|\\d*)+)?");
+	ASSERT_TRUE (emptyBody.find ("11", m));
+	EXPECT_EQ (0, m.start());
+	EXPECT_EQ (0, m.end());
+	Regex lazyBody ("(?:[a-c]?\?)*");
+	ASSERT_TRUE (lazyBody.find ("ab", m));
+	EXPECT_EQ (0, m.start());
+	EXPECT_EQ (0, m.end());
+	Regex plusBody ("(?:c*|\\d*){2,}");
+	ASSERT_TRUE (plusBody.find ("11", m));
+	EXPECT_EQ (0, m.end());
+	Regex loop ("(a|b*)*c");
+	ASSERT_TRUE (loop.find ("xabbc", m));
+	EXPECT_EQ (1, m.start());
+	EXPECT_EQ (5, m.end());
+}
+
+TEST (RegexTest, anchors_work)
+{
+	Regex::Match m;
+
+	Regex start ("^ab");
+	EXPECT_TRUE (start.contains ("abc"));
+	EXPECT_FALSE (start.contains ("cab"));
+	EXPECT_FALSE (start.find ("abab", m, 1));
+
+	Regex end ("ab$");
+	EXPECT_TRUE (end.contains ("cab"));
+	EXPECT_FALSE (end.contains ("abc"));
+	ASSERT_TRUE (end.find ("abab", m));
+	EXPECT_EQ (2, m.start());
+
+	Regex both ("^$");
+	EXPECT_TRUE (both.contains (""));
+	EXPECT_FALSE (both.contains ("a"));
+
+	Regex inner ("a(^b|c$)");
+	EXPECT_FALSE (inner.contains ("ab"));
+	EXPECT_TRUE (inner.contains ("xac"));
+	EXPECT_FALSE (inner.contains ("xacx"));
+}
+
+TEST (RegexTest, ignore_case_works)
+{
+	Regex::Match m;
+
+	Regex re ("rue (de la )?r[eé]publique", Regex::IGNORE_CASE);
+	EXPECT_TRUE (re.contains ("12 RUE DE LA REPUBLIQUE"));
+	EXPECT_TRUE (re.contains ("12 Rue Republique"));
+	EXPECT_FALSE (re.contains ("12 avenue de la Republique"));
+
+	Regex neg ("[^a-z]+", Regex::IGNORE_CASE);
+	EXPECT_TRUE (neg.matches ("12-34"));
+	EXPECT_FALSE (neg.matches ("12A34"));
+
+	ASSERT_TRUE (re.find ("Au 12 Rue De La Republique.", m));
+	EXPECT_EQ (6, m.start());
+	EXPECT_TRUE (m.group (1).equals ("De La "));
+}
+
+TEST (RegexTest, required_literals_work)
+{
+	EXPECT_TRUE (Regex ("ab+c").requiredLiteral().equals ("a"));
+	EXPECT_TRUE (Regex ("\\d+@fia-net\\.com").requiredLiteral().equals ("@fia-net.com"));
+	EXPECT_TRUE (Regex ("(\\d{4})-(\\d{2})").requiredLiteral().equals ("-"));
+	EXPECT_TRUE (Regex ("x(abc)y\\d").requiredLiteral().equals ("xabcy"));
+	EXPECT_TRUE (Regex ("a?bcd").requiredLiteral().equals ("bcd"));
+	EXPECT_TRUE (Regex ("[0-9]+(EUR|USD)").requiredLiteral().equals (""));
+	EXPECT_TRUE (Regex ("(?:total: )+\\d+").requiredLiteral().equals ("total: "));
+	EXPECT_TRUE (Regex ("paris", Regex::IGNORE_CASE).requiredLiteral().iequals ("PARIS"));
+
+	// The prefilter does not change the results.
+	Regex re ("\\d+@fia-net\\.com");
+	EXPECT_TRUE (re.contains ("contact: 123@fia-net.com"));
+	EXPECT_FALSE (re.contains ("contact: abc@fia-net.com"));
+	EXPECT_FALSE (re.contains ("contact: 123@fia-net.fr"));
+}
+
+TEST (RegexTest, invalid_patterns_throw)
+{
+	const char* invalid[] = {
+		"(ab", "ab)", "[ab", "*a", "a**", "a{2,1}", "a{", "a{1001}", "\\",
+		"\\q", "(?=a)", "[z-a]", "\\x4", "(((((((((((((((((a)))))))))))))))))"
+	};
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+		EXPECT_THROW (Regex re (invalid[i]), Exception) << invalid[i];
+	}
+}
+
+// The DFA, with its cache flushed many times, agrees with the Pike VM.
+TEST (RegexTest, engines_agree)
+{
+	const char* patterns[] = {
+		"a(b|c)*d", "(a|ab)(c|bcd)(d*)", "[ab]{3,5}c?", "(a+|b+)*c", "^(ab|a)*$", "a.{8}b",
+		"x*y*z*$", "(?:a|b)*?c", "(a|b|c|d)*dcba"
+	};
+	XString text;
+	Regex::Match m;
+	srand (11);
+
+	for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); ++p) {
+		Regex re (patterns[p]);
+		for (int iter = 0; iter < 500; ++iter) {
+			text.clear();
+			for (int i = rand() % 30; i > 0; --i) {
+				text.appendChar ("abcdxyz"[rand() % 7]);
+			}
+
+			const bool whole = re.matches (text);
+			EXPECT_EQ (whole, re.match (text, m)) << patterns[p] << " / " << text.cstr();
+			if (whole) {
+				EXPECT_EQ (0, m.start());
+				EXPECT_EQ ((ssize_t)text.length(), m.end());
+			}
+
+			const bool found = re.contains (text);
+			EXPECT_EQ (found, re.find (text, m)) << patterns[p] << " / " << text.cstr();
+			if (found) {
+				// The match found matches on its own.
+				EXPECT_TRUE (Regex (patterns[p]).matches (m.group())) << patterns[p] << " / " << text.cstr();
+			}
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "StringMap.h"
+
+#include <map>
+#include <string>
+
+using namespace Fianet;
+
+namespace {
+
+TEST (StringMapTest, find_works)
+{
+	StringMap<int> map;
+	EXPECT_TRUE (map.empty());
+	EXPECT_TRUE (map.find ("4970") == 0);
+
+	EXPECT_TRUE (map.insert ("4970", 1));
+	EXPECT_FALSE (map.insert ("4970", 2));
+	map["5132"] = 3;
+	map[""] = 4;
+	EXPECT_EQ ((size_t)3, map.size());
+
+	// const char*, String, XString and HashedString lookups.
+	ASSERT_TRUE (map.find ("4970") != 0);
+	EXPECT_EQ (1, *map.find ("4970"));
+	EXPECT_EQ (3, *map.find (String ("x5132x").substr (1, 4)));
+	EXPECT_EQ (3, *map.find (XString ("5132")));
+	EXPECT_EQ (3, *map.find (HashedString (String ("5132"))));
+	EXPECT_EQ (4, *map.find (String()));
+	EXPECT_TRUE (map.find ("497") == 0);
+	EXPECT_TRUE (map.find ("49700") == 0);
+	EXPECT_TRUE (map.contains ("5132"));
+
+	const StringMap<int>& constMap = map;
+	EXPECT_EQ (1, *constMap.find ("4970"));
+
+	EXPECT_TRUE (map.erase ("4970"));
+	EXPECT_FALSE (map.erase ("4970"));
+	EXPECT_FALSE (map.contains ("4970"));
+	EXPECT_EQ ((size_t)2, map.size());
+
+	map.clear();
+	EXPECT_TRUE (map.empty());
+	EXPECT_FALSE (map.contains ("5132"));
+	map["5132"] = 5;
+	EXPECT_EQ (5, *map.find ("5132"));
+}
+
+TEST (StringMapTest, keys_are_owned)
+{
+	StringMap<int> owned;
+	StringMap<int> borrowed (StringMap<int>::CASE_SENSITIVE, StringMap<int>::BORROWED_KEYS);
+	XString key ("FR");
+	const char* country = "FR";
+
+	owned[key] = 250;
+	borrowed[String (country)] = 250;
+	key.clear();
+	key.append ("BE");
+	EXPECT_TRUE (owned.contains ("FR"));
+	EXPECT_FALSE (owned.contains ("BE"));
+	EXPECT_EQ (country, StringMap<int>::Iterator (borrowed).key().cstr());
+	EXPECT_NE (key.cstr(), StringMap<int>::Iterator (owned).key().cstr());
+}
+
+TEST (StringMapTest, ignore_case_works)
+{
+	StringMap<int> map (StringMap<int>::IGNORE_CASE);
+	map["contact@Exemple.FR"] = 1;
+	EXPECT_FALSE (map.insert ("CONTACT@exemple.fr", 2));
+	EXPECT_EQ ((size_t)1, map.size());
+	EXPECT_EQ (1, *map.find ("Contact@Exemple.fr"));
+	EXPECT_EQ (1, *map.find (HashedString (String ("contact@exemple.fr"))));
+	EXPECT_TRUE (map.find ("contact@exemple.fr ") == 0);
+}
+
+struct Counted {
+	static int live;
+	int value;
+
+	Counted() : value(0) { ++live; }
+	Counted (const Counted& c) : value(c.value) { ++live; }
+	~Counted() { --live; }
+	Counted& operator = (const Counted& c) { value = c.value; return *this; }
+};
+
+int Counted::live = 0;
+
+TEST (StringMapTest, matches_std_map)
+{
+	StringMap<Counted>* map = new StringMap<Counted>();
+	std::map<std::string, int> ref;
+	XString key;
+	unsigned seed = 12345;
+
+	// Random inserts and erases on a small key space, to leave deleted
+	// slots around and rehash in place as well as grow.
+	for (int n = 0; n < 200000; ++n) {
+		seed = seed * 1103515245 + 12345;
+		const unsigned k = (seed >> 8) % ((n < 100000) ? 5000 : 50000);
+		key.clear();
+		key.append ("card-");
+		key.appendInt (static_cast<int>(k));
+		const std::string s (key.cstr(), key.length());
+
+		if ((seed >> 28) < 5) {
+			EXPECT_EQ (ref.erase (s) == 1, map->erase (key));
+		} else {
+			(*map)[key].value = n;
+			ref[s] = n;
+		}
+	}
+
+	EXPECT_EQ (ref.size(), map->size());
+	EXPECT_EQ ((int)ref.size(), Counted::live);
+	for (std::map<std::string, int>::const_iterator it = ref.begin(); it != ref.end(); ++it) {
+		const Counted* c = map->find (String (it->first.c_str(), it->first.length()));
+		ASSERT_TRUE (c != 0) << it->first;
+		EXPECT_EQ (it->second, c->value);
+	}
+
+	size_t visited = 0;
+	for (StringMap<Counted>::ConstIterator it (*map); it.valid(); ++it) {
+		std::map<std::string, int>::const_iterator r = ref.find (std::string (it.key().cstr(), it.key().length()));
+		ASSERT_TRUE (r != ref.end());
+		EXPECT_EQ (r->second, it.value().value);
+		++visited;
+	}
+	EXPECT_EQ (ref.size(), visited);
+
+	map->reserve (100000);
+	EXPECT_EQ (ref.size(), map->size());
+	delete map;
+	EXPECT_EQ (0, Counted::live);
+}
+
+} // namespace
@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "StringPool.h"
+
+#include <pthread.h>
+#include <vector>
+
+using namespace Fianet;
+
+namespace {
+
+TEST (StringPoolTest, intern_works)
+{
+	StringPool pool;
+	EXPECT_EQ ((size_t)0, pool.size());
+
+	XString merchant ("M0001");
+	Symbol a = pool.intern (merchant);
+	Symbol b = pool.intern (String ("xM0001y").substr (1, 5));
+	Symbol c = pool.intern ("M0002");
+	Symbol empty = pool.intern ("");
+
+	EXPECT_FALSE (a.isNull());
+	EXPECT_TRUE (Symbol().isNull());
+	EXPECT_TRUE (a == b);
+	EXPECT_TRUE (a != c);
+	EXPECT_TRUE (empty != a);
+	EXPECT_EQ ((size_t)3, pool.size());
+
+	// The view points to the pooled copy, shared by all equal symbols.
+	EXPECT_TRUE (a.str().equals ("M0001"));
+	EXPECT_NE (merchant.cstr(), a.str().cstr());
+	EXPECT_EQ (a.str().cstr(), b.str().cstr());
+	EXPECT_EQ ('\0', a.str().cstr()[5]);
+	merchant.clear();
+	merchant.append ("XXXXX");
+	EXPECT_TRUE (a.str().equals ("M0001"));
+	EXPECT_EQ ((size_t)0, empty.str().length());
+
+	Symbol found;
+	EXPECT_TRUE (pool.find ("M0002", found));
+	EXPECT_TRUE (found == c);
+	EXPECT_FALSE (pool.find ("M0003", found));
+	EXPECT_TRUE (pool.find ("", found));
+	EXPECT_TRUE (found == empty);
+	EXPECT_EQ ((size_t)3, pool.size());
+
+	EXPECT_TRUE (pool.symbol (c.id()) == c);
+	EXPECT_TRUE (pool.symbol (c.id()).str().equals ("M0002"));
+	EXPECT_THROW (pool.symbol (0), Exception);
+	EXPECT_THROW (pool.symbol (0xFFFFFFF0u), Exception);
+
+	// Pools are independent.
+	StringPool other;
+	EXPECT_FALSE (other.find ("M0001", found));
+}
+
+TEST (StringPoolTest, many_strings_work)
+{
+	StringPool pool;
+	std::vector<uint32_t> ids;
+	XString key;
+
+	// Enough strings to grow the tables, and long ones for their own slabs.
+	for (int i = 0; i < 50000; ++i) {
+		key.clear();
+		key.append ("customer-");
+		key.appendInt (i);
+		if (i % 1000 == 0) {
+			for (int k = 0; k < 2000; ++k) {
+				key.appendChar ('a' + k % 26);
+			}
+		}
+		ids.push_back (pool.intern (key).id());
+	}
+	EXPECT_EQ ((size_t)50000, pool.size());
+	EXPECT_GT (pool.memoryUsage(), (size_t)50000 * 16);
+
+	for (int i = 0; i < 50000; ++i) {
+		key.clear();
+		key.append ("customer-");
+		key.appendInt (i);
+		if (i % 1000 == 0) {
+			for (int k = 0; k < 2000; ++k) {
+				key.appendChar ('a' + k % 26);
+			}
+		}
+		Symbol s = pool.symbol (ids[i]);
+		ASSERT_TRUE (s.str().equals (key)) << i;
+		ASSERT_EQ (ids[i], pool.intern (key).id());
+	}
+	EXPECT_EQ ((size_t)50000, pool.size());
+}
+
+struct Worker {
+	StringPool* pool;
+	int first;
+	int count;
+	std::vector<uint32_t> ids;
+	bool ok;
+};
+
+void* internKeys (void* arg)
+{
+	Worker* w = static_cast<Worker*>(arg);
+	XString key;
+
+	for (int i = 0; i < w->count; ++i) {
+		key.clear();
+		key.append ("FR");
+		key.appendInt (w->first + i);
+		Symbol s = w->pool->intern (key);
+		w->ids.push_back (s.id());
+
+		// Readers see every entry inserted so far, wherever it is.
+		Symbol found;
+		if (!s.str().equals (key) || !w->pool->find (key, found) || found != s
+				|| w->pool->symbol (s.id()) != s) {
+			w->ok = false;
+		}
+	}
+	return 0;
+}
+
+TEST (StringPoolTest, concurrent_intern_works)
+{
+	const int THREADS = 8, KEYS = 20000;
+	StringPool pool;
+	Worker workers[THREADS];
+	pthread_t threads[THREADS];
+
+	// Each thread overlaps half of its keys with the next one.
+	for (int t = 0; t < THREADS; ++t) {
+		workers[t].pool = &pool;
+		workers[t].first = t * KEYS / 2;
+		workers[t].count = KEYS;
+		workers[t].ok = true;
+		ASSERT_EQ (0, pthread_create (&threads[t], 0, internKeys, &workers[t]));
+	}
+	for (int t = 0; t < THREADS; ++t) {
+		pthread_join (threads[t], 0);
+		EXPECT_TRUE (workers[t].ok);
+	}
+
+	EXPECT_EQ ((size_t)(THREADS + 1) * KEYS / 2, pool.size());
+	for (int t = 0; t + 1 < THREADS; ++t) {
+		for (int i = 0; i < KEYS / 2; ++i) {
+			ASSERT_EQ (workers[t].ids[KEYS / 2 + i], workers[t + 1].ids[i]);
+		}
+	}
+}
+
+} // namespace
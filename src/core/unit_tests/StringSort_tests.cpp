@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "StringSort.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Fianet;
+
+namespace {
+
+/// Random keys with long common prefixes, duplicates, empty keys and high bytes.
+void makeKeys (std::vector<std::string>& storage, size_t count, unsigned seed)
+{
+	const char* prefixes[] = { "", "FR", "FR-MERCHANT-", "FR-MERCHANT-2016-", "fr-merchant-2016-0", "\xE9t\xE9" };
+	storage.clear();
+	for (size_t i = 0; i < count; ++i) {
+		seed = seed * 1103515245 + 12345;
+		std::string s (prefixes[(seed >> 16) % 6]);
+		const unsigned len = (seed >> 8) % 13;
+		for (unsigned k = 0; k < len; ++k) {
+			seed = seed * 1103515245 + 12345;
+			const unsigned r = (seed >> 16) % 40;
+			s += static_cast<char>((r < 30) ? "aAbB0\x01\xFF-"[r % 8] : r);
+		}
+		storage.push_back (s);
+	}
+}
+
+void checkSort (size_t count, unsigned threads, bool ignoreCase)
+{
+	std::vector<std::string> storage;
+	makeKeys (storage, count, static_cast<unsigned>(count + threads));
+
+	std::vector<String> keys;
+	for (size_t i = 0; i < storage.size(); ++i) {
+		keys.push_back (String (storage[i].data(), storage[i].length()));
+	}
+	std::vector<String> expected (keys);
+	if (ignoreCase) {
+		std::stable_sort (expected.begin(), expected.end(), String::IComparator());
+		isortStrings (&keys[0], &keys[0] + keys.size(), threads);
+	} else {
+		std::stable_sort (expected.begin(), expected.end(), String::Comparator());
+		sortStrings (&keys[0], &keys[0] + keys.size(), threads);
+	}
+
+	// Same order, and the same views.
+	std::multiset<const char*> before, after;
+	for (size_t i = 0; i < keys.size(); ++i) {
+		ASSERT_EQ (0, ignoreCase ? keys[i].icompareTo (expected[i]) : keys[i].compareTo (expected[i])) << i;
+		ASSERT_EQ (expected[i].length(), keys[i].length()) << i;
+		before.insert (expected[i].cstr());
+		after.insert (keys[i].cstr());
+	}
+	EXPECT_TRUE (before == after);
+}
+
+TEST (StringSortTest, sortStrings_works)
+{
+	String none;
+	sortStrings (&none, &none);
+
+	String three[] = { "b", "ab", "a" };
+	sortStrings (three, three + 3);
+	EXPECT_TRUE (three[0].equals ("a"));
+	EXPECT_TRUE (three[1].equals ("ab"));
+	EXPECT_TRUE (three[2].equals ("b"));
+
+	checkSort (10, 1, false);
+	checkSort (1000, 1, false);
+	checkSort (100000, 1, false);
+}
+
+TEST (StringSortTest, isortStrings_works)
+{
+	String words[] = { "abc", "ABD", "Ab", "a", "" };
+	isortStrings (words, words + 5);
+	EXPECT_TRUE (words[0].equals (""));
+	EXPECT_TRUE (words[1].equals ("a"));
+	EXPECT_TRUE (words[2].equals ("Ab"));
+	EXPECT_TRUE (words[3].equals ("abc"));
+	EXPECT_TRUE (words[4].equals ("ABD"));
+
+	checkSort (1000, 1, true);
+	checkSort (100000, 1, true);
+
+	setCaseFolding (LOCALE_CASE_FOLDING);
+	checkSort (10000, 1, true);
+	setCaseFolding (ASCII_CASE_FOLDING);
+}
+
+TEST (StringSortTest, parallel_sort_works)
+{
+	checkSort (300000, 4, false);
+	checkSort (300000, 3, true);
+	checkSort (300000, 0, false);
+}
+
+TEST (StringSortTest, equal_keys_work)
+{
+	// Many identical keys, longer than the cached bytes.
+	std::vector<String> keys (70000, String ("FR-MERCHANT-2016-000042"));
+	keys.push_back ("FR-MERCHANT-2016-00004");
+	keys.push_back ("FR-MERCHANT-2016-0000421");
+	sortStrings (&keys[0], &keys[0] + keys.size(), 2);
+	EXPECT_TRUE (keys.front().equals ("FR-MERCHANT-2016-00004"));
+	EXPECT_TRUE (keys[1].equals ("FR-MERCHANT-2016-000042"));
+	EXPECT_TRUE (keys.back().equals ("FR-MERCHANT-2016-0000421"));
+}
+
+} // namespace
@@ -258,4 +258,35 @@ TEST (StringTokenizerTest, StringTokenizer_successive_LongDelimiter)
 
 }
 
+TEST (StringTokenizerTest, StringTokenizer_long_record)
+{
+	// A record longer than the vectorized search blocks.
+	XString record;
+	for (int i = 0; i < 500; ++i) {
+		if (i) {
+			record.append (";;");
+		}
+		record.appendInt (i * 7919);
+	}
+	StringTokenizer tk(record);
+
+	int i = 499;
+	StringTokenizer::ReverseIterator rit = tk.rbegin(";;");
+	for (; rit != tk.rend(); ++rit, --i) {
+		XString expected;
+		expected.appendInt (i * 7919);
+		EXPECT_EQ (expected, *rit);
+		EXPECT_EQ (499 - i, rit.index());
+	}
+	EXPECT_EQ (-1, i);
+
+	i = 0;
+	for (StringTokenizer::Iterator it = tk.begin(";;"); it != tk.end(); ++it, ++i) {
+		XString expected;
+		expected.appendInt (i * 7919);
+		EXPECT_EQ (expected, *it);
+	}
+	EXPECT_EQ (500, i);
+}
+
 }
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include "StringTokenizer.h"
+#include "StringSearcher.h"
+#include <algorithm>
+#include <vector>
+
+using namespace Fianet;
+
+namespace {
+
+TEST (StringViewTest, is_a_plain_pointer_and_length)
+{
+	EXPECT_EQ (2 * sizeof(void*), sizeof(StringView));
+
+	const char* data = "merchant=M0001";
+	StringView views[2];
+	views[0] = StringView (data, 8);
+	memcpy (&views[1], &views[0], sizeof(StringView));
+	EXPECT_TRUE (views[1].equals ("merchant"));
+	EXPECT_EQ (data, views[1].cstr());
+
+	StringView empty;
+	EXPECT_EQ ((size_t)0, empty.length());
+	EXPECT_TRUE (empty.equals (String::blank()));
+}
+
+TEST (StringViewTest, read_only_algorithms_work)
+{
+	StringView v ("FR-M0001-2016");
+
+	EXPECT_TRUE (v.startsWith ("FR-"));
+	EXPECT_TRUE (v.iendsWith ("-2016"));
+	EXPECT_TRUE (v.icontains ("m0001"));
+	EXPECT_FALSE (v.contains ("M0002"));
+	EXPECT_EQ (3, v.indexOf ("M0"));
+	EXPECT_EQ (8, v.lastIndexOfChar ('-'));
+	EXPECT_EQ ('M', v[3]);
+	EXPECT_THROW (v.charAt (13), Exception);
+	EXPECT_EQ (2, v.findFirstOf (CharSet ("-")));
+	EXPECT_EQ ((size_t)2, v.countOf ("-"));
+	EXPECT_TRUE (v.substr (3, 5).equals ("M0001"));
+	EXPECT_EQ (2016, v.substr (-4).toInt());
+	EXPECT_LT (v.compareTo ("FR-M0002"), 0);
+	EXPECT_EQ (0, v.icompareTo ("fr-m0001-2016"));
+	EXPECT_EQ (String (v).hash(), v.hash());
+	EXPECT_TRUE (v.matches ("0").value().equals ("0"));
+}
+
+TEST (StringViewTest, views_on_the_same_data_are_compared_by_length)
+{
+	const char* data = "amounts";
+	StringView a (data, 6), b (data, 7);
+
+	EXPECT_GT (0, a.compareTo (b));
+	EXPECT_LT (0, b.compareTo (a));
+	EXPECT_GT (0, a.icompareTo (b));
+	EXPECT_TRUE (b.startsWith (a));
+	EXPECT_FALSE (a.startsWith (b));
+	EXPECT_FALSE (a.contains (b));
+	EXPECT_TRUE (a < b);
+	EXPECT_TRUE (a.contains (""));
+	EXPECT_TRUE (StringView().contains (""));
+}
+
+TEST (StringViewTest, strings_are_views)
+{
+	XString owned ("the quick brown fox");
+	String s (owned.substr (4, 5));
+	const StringView& v = s;
+
+	EXPECT_TRUE (v.equals ("quick"));
+	EXPECT_TRUE (s == StringView ("quick"));
+	EXPECT_TRUE (owned.contains (v));
+
+	// A view converts back to a String without copying the data.
+	String back (owned.StringView::substr (10));
+	EXPECT_EQ (owned.cstr() + 10, back.cstr());
+	back.trim();
+	EXPECT_TRUE (back.equals ("brown fox"));
+}
+
+TEST (StringViewTest, apis_take_views)
+{
+	StringView line ("FR;M0001;;250");
+	StringTokenizer tokenizer (line);
+	std::vector<String> fields;
+	for (StringTokenizer::Iterator it = tokenizer.begin (StringView (";")); it != tokenizer.end(); ++it) {
+		fields.push_back (*it);
+	}
+	ASSERT_EQ ((size_t)4, fields.size());
+	EXPECT_TRUE (fields[3].equals ("250"));
+
+	String::Searcher searcher (StringView ("M0"));
+	EXPECT_EQ (3, searcher.find (line));
+
+	std::vector<StringView> keys;
+	keys.push_back ("fr");
+	keys.push_back ("BE");
+	keys.push_back ("de");
+	std::sort (keys.begin(), keys.end(), StringView::IComparator());
+	EXPECT_TRUE (keys[0].equals ("BE"));
+	EXPECT_TRUE (keys[2].equals ("fr"));
+	EXPECT_EQ (CompactString ("BE"), CompactString (keys[0]));
+	EXPECT_EQ (HashedString (keys[0]), HashedString (String ("BE")));
+}
+
+} // namespace
@@ -0,0 +1,157 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+
+#include "StringSearcher.h"
+
+using namespace Fianet;
+
+namespace {
+
+ssize_t naive_find (const String& hay, const String& needle, size_t from)
+{
+	for (size_t i = from; i + needle.length() <= hay.length(); ++i) {
+		if (memcmp (hay.bytes() + i, needle.bytes(), needle.length()) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+ssize_t naive_find_last (const String& hay, const String& needle)
+{
+	for (ssize_t i = (ssize_t) hay.length() - (ssize_t) needle.length(); i >= 0; --i) {
+		if (memcmp (hay.bytes() + i, needle.bytes(), needle.length()) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+size_t naive_count (const String& hay, const String& needle)
+{
+	size_t nb = 0;
+	ssize_t pos = naive_find (hay, needle, 0);
+
+	while (pos >= 0) {
+		++nb;
+		pos = naive_find (hay, needle, pos + needle.length());
+	}
+	return nb;
+}
+
+void random_string (XString& s, size_t len, const char* alphabet)
+{
+	size_t nb = strlen (alphabet);
+	s.clear();
+	for (size_t i = 0; i < len; ++i) {
+		s.appendChar (alphabet[rand() % nb]);
+	}
+}
+
+TEST (SearcherTest, find_works)
+{
+	String::Searcher s ("abc");
+
+	EXPECT_EQ (0, s.find (CSTR("abcabc")));
+	EXPECT_EQ (3, s.find (CSTR("abcabc"), 1));
+	EXPECT_EQ (-1, s.find (CSTR("abcabc"), 4));
+	EXPECT_EQ (-1, s.find (CSTR("abcabc"), 100));
+	EXPECT_EQ (2, s.find (CSTR("ababcab")));
+	EXPECT_EQ (-1, s.find (CSTR("ab")));
+	EXPECT_EQ (-1, s.find (String::blank()));
+
+	String::Searcher c ("b");
+	EXPECT_EQ (1, c.find (CSTR("abcabc")));
+	EXPECT_EQ (4, c.find (CSTR("abcabc"), 2));
+	EXPECT_EQ (4, c.findLast (CSTR("abcabc")));
+
+	String::Searcher e ("");
+	EXPECT_EQ (-1, e.find (CSTR("abc")));
+	EXPECT_EQ (-1, e.findLast (CSTR("abc")));
+	EXPECT_EQ ((size_t)0, e.count (CSTR("abc")));
+	EXPECT_FALSE (e.contains (CSTR("abc")));
+}
+
+TEST (SearcherTest, findLast_count_contains_work)
+{
+	String::Searcher s ("aa");
+
+	EXPECT_EQ (2, s.findLast (CSTR("aaaa")));
+	EXPECT_EQ ((size_t)2, s.count (CSTR("aaaaa")));
+	EXPECT_TRUE (s.contains (CSTR("baab")));
+	EXPECT_FALSE (s.contains (CSTR("abab")));
+
+	String::Searcher x ("</field>");
+	EXPECT_EQ ((size_t)3, x.count (CSTR("<field>1</field><field>2</field><field>3</field>")));
+	EXPECT_EQ (40, x.findLast (CSTR("<field>1</field><field>2</field><field>3</field>")));
+}
+
+TEST (SearcherTest, searcher_outlives_needle)
+{
+	XString* needle = new XString ("needle");
+	String::Searcher s (*needle);
+	delete needle;
+
+	EXPECT_EQ (4, s.find (CSTR("hay needle hay")));
+	EXPECT_EQ (CSTR("needle"), s.str());
+
+	String::Searcher copy (s);
+	EXPECT_EQ (4, copy.find (CSTR("hay needle hay")));
+
+	copy = String::Searcher ("hay");
+	EXPECT_EQ (11, copy.findLast (CSTR("hay needle hay")));
+}
+
+TEST (SearcherTest, long_needles_work)
+{
+	// Two-Way on periodic and non periodic needles.
+	XString hay;
+	for (int i = 0; i < 20; ++i) {
+		hay.append ("abababababababababababababababababababac");
+	}
+	hay.append ("abababababababababababababababababababababababab");
+
+	String::Searcher periodic (CSTR("abababababababababababababababababababab"));
+	EXPECT_EQ (naive_find (hay, periodic.str(), 0), periodic.find (hay));
+	EXPECT_EQ (naive_find_last (hay, periodic.str()), periodic.findLast (hay));
+	EXPECT_EQ (naive_count (hay, periodic.str()), periodic.count (hay));
+
+	String::Searcher other (CSTR("bababababababababababababababababababac"));
+	EXPECT_EQ (1, other.find (hay));
+	EXPECT_EQ (naive_find_last (hay, other.str()), other.findLast (hay));
+	EXPECT_EQ ((size_t)20, other.count (hay));
+}
+
+TEST (SearcherTest, matches_naive_search)
+{
+	static const char* alphabets[] = { "ab", "abc", "abcdefghijklmnopqrstuvwxyz<>\"=" };
+	static const size_t needle_lens[] = { 1, 2, 3, 5, 8, 16, 31, 32, 33, 40, 64, 100 };
+	XString hay, needle;
+
+	srand (42);
+	for (size_t a = 0; a < sizeof(alphabets)/sizeof(alphabets[0]); ++a) {
+		for (size_t n = 0; n < sizeof(needle_lens)/sizeof(needle_lens[0]); ++n) {
+			for (int iter = 0; iter < 30; ++iter) {
+				random_string (hay, 50 + rand() % 500, alphabets[a]);
+				if (iter % 2 && hay.length() > needle_lens[n]) {
+					// Make sure the needle is there.
+					size_t pos = rand() % (hay.length() - needle_lens[n]);
+					needle.copyFrom (hay.substr (pos, needle_lens[n]));
+				} else {
+					random_string (needle, needle_lens[n], alphabets[a]);
+				}
+
+				String::Searcher s (needle);
+				size_t from = rand() % 20;
+
+				EXPECT_EQ (naive_find (hay, needle, 0), s.find (hay)) << needle.cstr();
+				EXPECT_EQ (naive_find (hay, needle, from), s.find (hay, from)) << needle.cstr();
+				EXPECT_EQ (naive_find_last (hay, needle), s.findLast (hay)) << needle.cstr();
+				EXPECT_EQ (naive_count (hay, needle), s.count (hay)) << needle.cstr();
+				EXPECT_EQ (hay.contains (needle), s.contains (hay)) << needle.cstr();
+			}
+		}
+	}
+}
+
+}
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+
+#include <clocale>
+
+using namespace Fianet;
+
+namespace {
+
+void random_bytes (char* s, size_t len, const char* alphabet)
+{
+	for (size_t i = 0; i < len; ++i) {
+		s[i] = alphabet ? alphabet[rand() % strlen (alphabet)] : static_cast<char>(rand() % 256);
+	}
+}
+
+TEST (CaseFoldingTest, ascii_folding_is_the_default)
+{
+	EXPECT_EQ (ASCII_CASE_FOLDING, getCaseFolding());
+
+	setCaseFolding (LOCALE_CASE_FOLDING);
+	EXPECT_EQ (LOCALE_CASE_FOLDING, getCaseFolding());
+	EXPECT_TRUE (CSTR("Hello World").iequals ("HELLO world"));
+	EXPECT_TRUE (CSTR("Hello World").icontains ("O W"));
+
+	setCaseFolding (ASCII_CASE_FOLDING);
+	EXPECT_TRUE (CSTR("Hello World").iequals ("HELLO world"));
+	EXPECT_TRUE (CSTR("Hello World").icontains ("O W"));
+}
+
+TEST (CaseFoldingTest, ascii_folding_only_changes_letters)
+{
+	// Bytes around the letter ranges, and non ASCII bytes.
+	EXPECT_EQ (0, memicompare_ascii ("azAZ", "AZaz", 4));
+	EXPECT_GT (0, memicompare_ascii ("@", "a", 1));
+	EXPECT_LT (0, memicompare_ascii ("[", "a", 1));
+	EXPECT_LT (0, memicompare_ascii ("_", "z", 1));
+	EXPECT_LT (0, memicompare_ascii ("{", "Z", 1));
+	EXPECT_NE (0, memicompare_ascii ("`", "@", 1));
+	EXPECT_NE (0, memicompare_ascii ("\xE9", "\xC9", 1));
+
+	EXPECT_TRUE (CSTR("ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`@{|}~0123456789").iequals ("abcdefghijklmnopqrstuvwxyz[\\]^_`@{|}~0123456789"));
+	EXPECT_FALSE (CSTR("R\xC9SUM\xC9 \xE0 LIRE, LONG ENOUGH FOR SIMD").iequals ("r\xE9sum\xE9 \xE0 lire, long enough for simd"));
+}
+
+TEST (CaseFoldingTest, matches_locale_folding_in_C_locale)
+{
+	char a[80], b[80];
+
+	ASSERT_TRUE (setlocale (LC_CTYPE, "C") != 0);
+
+	srand (42);
+	for (int iter = 0; iter < 2000; ++iter) {
+		const size_t len = rand() % sizeof(a);
+		const char* alphabet = (iter % 3 == 0) ? 0 : "aAbBzZ@[`{_09";
+
+		random_bytes (a, len, alphabet);
+		memcpy (b, a, len);
+
+		// Randomly change the case of some letters, and sometimes one byte.
+		for (size_t i = 0; i < len; ++i) {
+			if (rand() % 2 && isalpha (static_cast<unsigned char>(a[i]))) {
+				b[i] = a[i] ^ 0x20;
+			}
+		}
+		if (len && rand() % 2) {
+			random_bytes (b + rand() % len, 1, alphabet);
+		}
+
+		EXPECT_EQ (memicompare_locale (a, b, len), memicompare_ascii (a, b, len));
+
+		// Search a part of a, or random bytes.
+		if (len) {
+			const size_t off = rand() % len;
+			const size_t nlen = 1 + rand() % (len - off);
+			if (rand() % 2) {
+				random_bytes (b, nlen, alphabet);
+			} else {
+				memcpy (b, a + off, nlen);
+				b[0] ^= isalpha (static_cast<unsigned char>(b[0])) ? 0x20 : 0;
+			}
+			EXPECT_EQ (memifind_locale (a, len, b, nlen), memifind_ascii (a, len, b, nlen));
+		}
+	}
+}
+
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+
+#include <vector>
+
+using namespace Fianet;
+
+namespace {
+
+void naive_findAll (const String& hay, const String& needle, bool overlapping, std::vector<size_t>& out)
+{
+	out.clear();
+	if (needle.length() == 0) {
+		return;
+	}
+	for (size_t i = 0; i + needle.length() <= hay.length(); ) {
+		if (memcmp (hay.bytes() + i, needle.bytes(), needle.length()) == 0) {
+			out.push_back (i);
+			i += overlapping ? 1 : needle.length();
+		} else {
+			++i;
+		}
+	}
+}
+
+TEST (StringTest, countOf_works)
+{
+	EXPECT_EQ ((size_t)2, CSTR("aaaaa").countOf ("aa"));
+	EXPECT_EQ ((size_t)4, CSTR("aaaaa").countOf ("aa", String::OVERLAPPING));
+	EXPECT_EQ ((size_t)3, CSTR("a;b;;c").countOf (";"));
+	EXPECT_EQ ((size_t)0, CSTR("abc").countOf ("abcd"));
+	EXPECT_EQ ((size_t)0, CSTR("abc").countOf (""));
+	EXPECT_EQ ((size_t)0, String::blank().countOf ("a"));
+	EXPECT_EQ ((size_t)1, CSTR("abc").countOf ("abc"));
+}
+
+TEST (StringTest, findAll_works)
+{
+	std::vector<size_t> pos;
+
+	EXPECT_EQ ((size_t)3, CSTR("<a><b><c>").findAll ("<", pos));
+	ASSERT_EQ ((size_t)3, pos.size());
+	EXPECT_EQ ((size_t)0, pos[0]);
+	EXPECT_EQ ((size_t)3, pos[1]);
+	EXPECT_EQ ((size_t)6, pos[2]);
+
+	pos.clear();
+	EXPECT_EQ ((size_t)3, CSTR("abababa").findAll ("aba", pos, String::OVERLAPPING));
+	ASSERT_EQ ((size_t)3, pos.size());
+	EXPECT_EQ ((size_t)4, pos[2]);
+}
+
+TEST (StringTest, MatchIterator_works)
+{
+	String s ("id=1&id=22&name=x&id=333");
+	String::MatchIterator it = s.matches ("id=");
+
+	ASSERT_TRUE (it.valid());
+	EXPECT_EQ (0, it.position());
+	EXPECT_EQ (CSTR("id="), it.value());
+
+	++it;
+	ASSERT_TRUE (it.valid());
+	EXPECT_EQ (5, it.position());
+
+	++it;
+	ASSERT_TRUE (it.valid());
+	EXPECT_EQ (18, it.position());
+
+	++it;
+	EXPECT_FALSE (it.valid());
+	EXPECT_EQ (-1, it.position());
+	EXPECT_EQ (String::blank(), it.value());
+
+	// Incrementing past the end does nothing.
+	++it;
+	EXPECT_FALSE (it.valid());
+
+	EXPECT_FALSE (s.matches ("").valid());
+	EXPECT_FALSE (s.matches ("#").valid());
+}
+
+TEST (StringTest, findAll_matches_naive_search)
+{
+	static const char* alphabets[] = { "a", "ab", "abc<>", "abcdefghijklmnopqrstuvwxyz" };
+	std::vector<size_t> expected, found;
+	XString hay, needle;
+
+	srand (42);
+	for (size_t a = 0; a < sizeof(alphabets)/sizeof(alphabets[0]); ++a) {
+		const size_t nb = strlen (alphabets[a]);
+
+		for (int iter = 0; iter < 300; ++iter) {
+			hay.clear();
+			needle.clear();
+			for (size_t len = rand() % 200; len > 0; --len) {
+				hay.appendChar (alphabets[a][rand() % nb]);
+			}
+			for (size_t len = 1 + rand() % 5; len > 0; --len) {
+				needle.appendChar (alphabets[a][rand() % nb]);
+			}
+
+			for (int overlapping = 0; overlapping < 2; ++overlapping) {
+				const String::Overlap mode = overlapping ? String::OVERLAPPING : String::NON_OVERLAPPING;
+
+				naive_findAll (hay, needle, overlapping, expected);
+				found.clear();
+				EXPECT_EQ (expected.size(), hay.findAll (needle, found, mode));
+				EXPECT_TRUE (expected == found) << hay.cstr() << " / " << needle.cstr();
+				EXPECT_EQ (expected.size(), hay.countOf (needle, mode));
+			}
+		}
+	}
+}
+
+}
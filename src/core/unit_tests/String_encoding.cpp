@@ -0,0 +1,276 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include <string>
+
+using namespace Fianet;
+
+namespace {
+
+/// Runs f with every SIMD level the CPU supports.
+template <class F>
+void forEachLevel (F f)
+{
+	const SimdLevel saved = getSimdLevel();
+	for (int level = SIMD_SCALAR; level <= supportedSimdLevel(); ++level) {
+		setSimdLevel (static_cast<SimdLevel>(level));
+		f();
+	}
+	setSimdLevel (saved);
+}
+
+std::string str (const XString& s)
+{
+	return std::string (s.cstr(), s.length());
+}
+
+enum Encoding { HEX, BASE64, BASE64URL, BASE32 };
+
+std::string encode (Encoding e, const String& data)
+{
+	XString out;
+	switch (e) {
+	case HEX:		out.appendHex (data); break;
+	case BASE64:	out.appendBase64 (data); break;
+	case BASE64URL:	out.appendBase64Url (data); break;
+	case BASE32:	out.appendBase32 (data); break;
+	}
+	return str (out);
+}
+
+/// Decodes s after a prefix, which must be left alone on failure.
+bool decode (Encoding e, const String& s, std::string& result)
+{
+	XString out ("prefix");
+	bool ok = false;
+	switch (e) {
+	case HEX:		ok = s.decodeHexInto (out); break;
+	case BASE64:	ok = s.decodeBase64Into (out); break;
+	case BASE64URL:	ok = s.decodeBase64UrlInto (out); break;
+	case BASE32:	ok = s.decodeBase32Into (out); break;
+	}
+	const std::string decoded = str (out);
+	EXPECT_EQ ("prefix", decoded.substr (0, 6));
+	if (!ok) {
+		EXPECT_EQ ((size_t)6, decoded.length()) << s.cstr();
+	}
+	result = decoded.substr (6);
+	return ok;
+}
+
+bool valid (Encoding e, const char* s)
+{
+	std::string result;
+	return decode (e, String (s), result);
+}
+
+/// Test vectors of RFC 4648, section 10.
+struct CheckVectors {
+	void operator()() const {
+		const char* data[] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+		const char* base64[] = { "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy" };
+		const char* base64url[] = { "", "Zg", "Zm8", "Zm9v", "Zm9vYg", "Zm9vYmE", "Zm9vYmFy" };
+		const char* base32[] = { "", "MY======", "MZXQ====", "MZXW6===", "MZXW6YQ=", "MZXW6YTB", "MZXW6YTBOI======" };
+		const char* hex[] = { "", "66", "666f", "666f6f", "666f6f62", "666f6f6261", "666f6f626172" };
+		std::string result;
+
+		for (int i = 0; i < 7; ++i) {
+			EXPECT_EQ (base64[i], encode (BASE64, data[i]));
+			EXPECT_EQ (base64url[i], encode (BASE64URL, data[i]));
+			EXPECT_EQ (base32[i], encode (BASE32, data[i]));
+			EXPECT_EQ (hex[i], encode (HEX, data[i]));
+
+			EXPECT_TRUE (decode (BASE64, base64[i], result));
+			EXPECT_EQ (data[i], result);
+			EXPECT_TRUE (decode (BASE64URL, base64url[i], result));
+			EXPECT_EQ (data[i], result);
+			EXPECT_TRUE (decode (BASE64URL, base64[i], result));
+			EXPECT_EQ (data[i], result);
+			EXPECT_TRUE (decode (BASE32, base32[i], result));
+			EXPECT_EQ (data[i], result);
+			EXPECT_TRUE (decode (HEX, hex[i], result));
+			EXPECT_EQ (data[i], result);
+		}
+		XString upper;
+		EXPECT_EQ ("DEADBEEF00FF", str (upper.appendHex (String ("\xDE\xAD\xBE\xEF\x00\xFF", 6), true)));
+		EXPECT_TRUE (decode (HEX, "DeadBeef00fF", result));
+		EXPECT_EQ (std::string ("\xDE\xAD\xBE\xEF\x00\xFF", 6), result);
+		EXPECT_EQ ("-_-_", encode (BASE64URL, "\xFB\xFF\xBF"));
+		EXPECT_EQ ("+/+/", encode (BASE64, "\xFB\xFF\xBF"));
+	}
+};
+
+TEST (StringEncodingTest, encodes_rfc4648_vectors)
+{
+	forEachLevel (CheckVectors());
+}
+
+/// Every length and byte value, at every level, compared with the scalar code.
+struct CheckRoundTrips {
+	void operator()() const {
+		const Encoding encodings[] = { HEX, BASE64, BASE64URL, BASE32 };
+		std::string data;
+		uint64_t seed = 42;
+		for (size_t len = 0; len <= 300; ++len) {
+			for (int e = 0; e < 4; ++e) {
+				const std::string encoded = encode (encodings[e], String (data.c_str(), data.length()));
+				std::string decoded;
+				EXPECT_TRUE (decode (encodings[e], String (encoded.c_str(), encoded.length()), decoded)) << encoded;
+				EXPECT_EQ (data, decoded) << e << " " << len;
+
+				const SimdLevel level = getSimdLevel();
+				setSimdLevel (SIMD_SCALAR);
+				EXPECT_EQ (encode (encodings[e], String (data.c_str(), data.length())), encoded);
+				setSimdLevel (level);
+			}
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			data.push_back (static_cast<char>(seed >> 56));
+		}
+	}
+};
+
+TEST (StringEncodingTest, round_trips)
+{
+	forEachLevel (CheckRoundTrips());
+}
+
+/// Every byte value at every position of long inputs: only the alphabet is accepted.
+struct CheckAlphabets {
+	void operator()() const {
+		std::string hex (128, 'a');
+		std::string base64 (128, 'A');
+		std::string result;
+		for (size_t pos = 0; pos < 128; ++pos) {
+			for (int c = 0; c < 256; ++c) {
+				hex[pos] = static_cast<char>(c);
+				base64[pos] = static_cast<char>(c);
+				const bool isHex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+				const bool isAlnum = isHex || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')
+					|| (c == '=' && pos == 127);
+				ASSERT_EQ (isHex, decode (HEX, String (hex.data(), hex.length()), result)) << pos << " " << c;
+				ASSERT_EQ (isAlnum || c == '+' || c == '/', decode (BASE64, String (base64.data(), base64.length()), result))
+					<< pos << " " << c;
+				ASSERT_EQ (isAlnum || c == '-' || c == '_', decode (BASE64URL, String (base64.data(), base64.length()), result))
+					<< pos << " " << c;
+			}
+			hex[pos] = 'a';
+			base64[pos] = 'A';
+		}
+		std::string base32 (64, 'A');
+		for (int c = 0; c < 256; ++c) {
+			base32[21] = static_cast<char>(c);
+			EXPECT_EQ ((c >= 'A' && c <= 'Z') || (c >= '2' && c <= '7'), decode (BASE32, String (base32.data(), base32.length()), result)) << c;
+		}
+	}
+};
+
+TEST (StringEncodingTest, rejects_bytes_out_of_the_alphabet)
+{
+	forEachLevel (CheckAlphabets());
+}
+
+TEST (StringEncodingTest, decoding_is_strict)
+{
+	// Lengths and padding.
+	EXPECT_FALSE (valid (HEX, "abc"));
+	EXPECT_FALSE (valid (HEX, " ab"));
+	EXPECT_FALSE (valid (BASE64, "Zg"));
+	EXPECT_FALSE (valid (BASE64, "Zg="));
+	EXPECT_FALSE (valid (BASE64, "Zg==="));
+	EXPECT_FALSE (valid (BASE64, "Z==="));
+	EXPECT_FALSE (valid (BASE64, "===="));
+	EXPECT_FALSE (valid (BASE64, "=Zg="));
+	EXPECT_FALSE (valid (BASE64, "Zg==Zg=="));
+	EXPECT_FALSE (valid (BASE64, "Zm9v\n"));
+	EXPECT_FALSE (valid (BASE64URL, "Z"));
+	EXPECT_FALSE (valid (BASE64URL, "Zg="));
+	EXPECT_FALSE (valid (BASE64URL, "Zm9vY"));
+	EXPECT_FALSE (valid (BASE32, "MY"));
+	EXPECT_FALSE (valid (BASE32, "MY====="));
+	EXPECT_FALSE (valid (BASE32, "M======="));
+	EXPECT_FALSE (valid (BASE32, "MZX====="));
+	EXPECT_FALSE (valid (BASE32, "========"));
+	EXPECT_FALSE (valid (BASE32, "my======"));
+
+	// Unused bits.
+	EXPECT_TRUE (valid (BASE64, "Zg=="));
+	EXPECT_FALSE (valid (BASE64, "Zh=="));
+	EXPECT_TRUE (valid (BASE64, "Zm8="));
+	EXPECT_FALSE (valid (BASE64, "Zm9="));
+	EXPECT_FALSE (valid (BASE64URL, "Zh"));
+	EXPECT_TRUE (valid (BASE32, "MY======"));
+	EXPECT_FALSE (valid (BASE32, "MZ======"));
+	EXPECT_FALSE (valid (BASE32, "MZXR===="));
+	EXPECT_FALSE (valid (BASE32, "MZXW7==="));
+	EXPECT_FALSE (valid (BASE32, "MZXW6YR="));
+
+	// Errors beyond the SIMD blocks.
+	std::string base64 (100, 'A');
+	base64[98] = '=';
+	EXPECT_FALSE (valid (BASE64, base64.c_str()));
+	base64[99] = '=';
+	EXPECT_TRUE (valid (BASE64, base64.c_str()));
+	base64[97] = 'B';
+	EXPECT_FALSE (valid (BASE64, base64.c_str()));
+}
+
+TEST (StringEncodingTest, works_on_its_own_buffer)
+{
+	XString s ("foobar");
+	s.appendBase64 (s);
+	EXPECT_EQ ("foobarZm9vYmFy", str (s));
+
+	// Enough to reallocate the buffer.
+	XString big;
+	for (int i = 0; i < 300; ++i) {
+		big.appendChar ('a' + i % 26);
+	}
+	const std::string expected = str (big) + encode (HEX, big);
+	big.appendHex (big);
+	EXPECT_EQ (expected, str (big));
+
+	XString encoded ("Zm9vYmFy");
+	EXPECT_TRUE (encoded.decodeBase64Into (encoded));
+	EXPECT_EQ ("Zm9vYmFyfoobar", str (encoded));
+	XString hex (encode (HEX, big).c_str());
+	const size_t len = hex.length();
+	EXPECT_TRUE (hex.decodeHexInto (hex));
+	EXPECT_EQ (str (big), str (hex).substr (len));
+}
+
+struct CheckUuids {
+	void operator()() const {
+		const uint8_t bytes[16] = {
+			0x12, 0x3e, 0x45, 0x67, 0xe8, 0x9b, 0x12, 0xd3, 0xa4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x00
+		};
+		XString s;
+		EXPECT_EQ ("123e4567-e89b-12d3-a456-426614174000", str (s.appendUuid (bytes)));
+		s.clear();
+		EXPECT_EQ ("123E4567-E89B-12D3-A456-426614174000", str (s.appendUuid (bytes, true)));
+
+		uint8_t uuid[16];
+		EXPECT_TRUE (String ("123e4567-e89b-12d3-a456-426614174000").decodeUuid (uuid));
+		EXPECT_EQ (0, memcmp (bytes, uuid, 16));
+		memset (uuid, 0, 16);
+		EXPECT_TRUE (s.decodeUuid (uuid));
+		EXPECT_EQ (0, memcmp (bytes, uuid, 16));
+
+		const char* invalid[] = {
+			"", "123e4567e89b12d3a456426614174000", "{123e4567-e89b-12d3-a456-426614174000}",
+			"123e4567-e89b-12d3-a456-42661417400", "123e4567-e89b-12d3-a456-4266141740000",
+			"123e4567-e89b-12d3-a456_426614174000", "123e4567-e89b12-d3-a456-426614174000",
+			"123e4567-e89b-12d3-a456-42661417400g", " 23e4567-e89b-12d3-a456-426614174000"
+		};
+		for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+			memset (uuid, 0xAA, 16);
+			EXPECT_FALSE (String (invalid[i]).decodeUuid (uuid)) << invalid[i];
+			EXPECT_EQ (0xAA, uuid[0]);
+		}
+	}
+};
+
+TEST (StringEncodingTest, uuids)
+{
+	forEachLevel (CheckUuids());
+}
+
+} // namespace
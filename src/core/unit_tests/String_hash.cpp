@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include <set>
+#include <clocale>
+
+#if __cplusplus >= 201103L
+#include <unordered_map>
+#define HASH_MAP std::unordered_map
+#else
+#include <tr1/unordered_map>
+#define HASH_MAP std::tr1::unordered_map
+#endif
+
+using namespace Fianet;
+
+namespace {
+
+TEST (StringHashTest, equal_strings_have_equal_hashes)
+{
+	char buffer[300];
+	XString text;
+	for (int i = 0; i < 300; ++i) {
+		buffer[i] = 'A' + (i * 7) % 26;
+	}
+	text.append (buffer, sizeof(buffer));
+
+	// Every length, on copies at different alignments.
+	for (size_t len = 0; len <= 200; ++len) {
+		String view (buffer + 3, len);
+		XString copy (view);
+		EXPECT_EQ (view.hash(), copy.hash()) << len;
+		EXPECT_EQ (view.hash(), memhash (buffer + 3, len));
+		EXPECT_EQ (text.substr (3, len).hash(), view.hash());
+		EXPECT_NE (memhash (buffer + 3, len, 1), view.hash());
+	}
+
+	EXPECT_EQ (String().hash(), String ("").hash());
+	EXPECT_EQ (String().hash(), HashedString().hash());
+}
+
+TEST (StringHashTest, hashes_differ)
+{
+	std::set<uint64_t> hashes;
+	XString key;
+
+	// Short keys differing by one byte, and prefixes of each other.
+	for (int i = 0; i < 20000; ++i) {
+		key.clear();
+		key.append ("FR");
+		key.appendInt (i);
+		hashes.insert (key.hash());
+	}
+	for (int len = 0; len < 200; ++len) {
+		key.clear();
+		for (int i = 0; i < len; ++i) {
+			key.appendChar ('x');
+		}
+		hashes.insert (key.hash());
+	}
+	EXPECT_EQ ((size_t)20200, hashes.size());
+
+	// Single bit flips.
+	char buffer[64];
+	memset (buffer, 'a', sizeof(buffer));
+	for (size_t len = 1; len <= sizeof(buffer); ++len) {
+		const uint64_t ref = memhash (buffer, len);
+		for (size_t bit = 0; bit < 8 * len; ++bit) {
+			buffer[bit / 8] ^= (1 << (bit % 8));
+			EXPECT_NE (ref, memhash (buffer, len)) << len << " " << bit;
+			buffer[bit / 8] ^= (1 << (bit % 8));
+		}
+	}
+}
+
+TEST (StringHashTest, ihash_works)
+{
+	const char* upper = "RUE DE LA REPUBLIQUE, 69002 LYON - BATIMENT C [@`{~]";
+	const char* mixed = "rue de la Republique, 69002 lyon - batiment c [@`{~]";
+
+	for (size_t len = 0; len <= strlen (upper); ++len) {
+		EXPECT_EQ (String (upper, len).ihash(), String (mixed, len).ihash()) << len;
+		EXPECT_EQ (memihash (upper, len), String (upper, len).ihash());
+	}
+	// Only letters are folded.
+	EXPECT_NE (String ("a@").ihash(), String ("a`").ihash());
+	EXPECT_NE (String ("[z").ihash(), String ("{z").ihash());
+	EXPECT_NE (String ("\xE9t\xE9").ihash(), String ("\xC9T\xC9").ihash());
+
+	if (setlocale (LC_CTYPE, "fr_FR.ISO-8859-1") || setlocale (LC_CTYPE, "fr_FR.iso88591")) {
+		setCaseFolding (LOCALE_CASE_FOLDING);
+		EXPECT_EQ (String ("\xE9t\xE9 \xE0 Paris").ihash(), String ("\xC9T\xC9 \xC0 PARIS").ihash());
+		EXPECT_TRUE (String ("\xE9t\xE9 \xE0 Paris").iequals ("\xC9T\xC9 \xC0 PARIS"));
+		setCaseFolding (ASCII_CASE_FOLDING);
+		setlocale (LC_CTYPE, "C");
+	}
+	setCaseFolding (LOCALE_CASE_FOLDING);
+	EXPECT_EQ (String (upper).ihash(), String (mixed).ihash());
+	setCaseFolding (ASCII_CASE_FOLDING);
+}
+
+TEST (StringHashTest, hashed_containers_work)
+{
+	HASH_MAP<XString, int, String::Hasher, String::Equal> merchants;
+	merchants[XString ("M0001")] = 1;
+	merchants[XString ("M0002")] = 2;
+	merchants[XString ("m0002")] = 3;
+
+	EXPECT_EQ ((size_t)3, merchants.size());
+	EXPECT_EQ (2, merchants[XString (String ("xM0002y").substr (1, 5))]);
+	EXPECT_TRUE (merchants.find (XString ("M0003")) == merchants.end());
+
+	HASH_MAP<String, int, String::IHasher, String::IEqual> countries;
+	countries[String ("FR")] = 250;
+	countries[String ("fr")] = 251;
+	EXPECT_EQ ((size_t)1, countries.size());
+	EXPECT_EQ (251, countries[String ("Fr")]);
+
+	HASH_MAP<HashedString, int, HashedString::Hasher> fields;
+	const char* names[] = { "amount", "currency", "email", "amounts" };
+	for (int i = 0; i < 4; ++i) {
+		fields[HashedString (names[i])] = i;
+	}
+	XString name ("currency");
+	HashedString key (name);
+	EXPECT_EQ (name.hash(), key.hash());
+	EXPECT_TRUE (key.str().equals ("currency"));
+	ASSERT_TRUE (fields.find (key) != fields.end());
+	EXPECT_EQ (1, fields.find (key)->second);
+	EXPECT_TRUE (fields.find (HashedString (String ("amount"))) != fields.end());
+	EXPECT_TRUE (fields.find (HashedString (String ("amoun"))) == fields.end());
+}
+
+TEST (StringHashTest, views_on_the_same_data_are_compared_by_length)
+{
+	const char* data = "amounts";
+	String a (data, 6), b (data, 7);
+
+	EXPECT_FALSE (a.equals (b));
+	EXPECT_FALSE (b.equals (a));
+	EXPECT_FALSE (a.iequals (b));
+	EXPECT_TRUE (a.equals (String (data, 6)));
+	EXPECT_FALSE (HashedString (a) == HashedString (b));
+}
+
+} // namespace
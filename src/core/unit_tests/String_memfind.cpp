@@ -33,6 +33,137 @@ TEST (StringTest, memfind_works)
 	EXPECT_EQ(str_XYXYXZ + 2, ptr);
 }
 
+// Naive reference implementation.
+static const uint8_t* naive_memfind (const uint8_t* h, size_t hl, const uint8_t* n, size_t nl)
+{
+	for (size_t i = 0; i + nl <= hl; ++i) {
+		if (memcmp (h + i, n, nl) == 0) {
+			return h + i;
+		}
+	}
+	return 0;
+}
+
+TEST (StringTest, memfind_edge_cases)
+{
+	const char* hay = "abcdef";
+
+	EXPECT_EQ ((uint8_t*)hay, memfind(hay, 6, "xyz", 0));
+	EXPECT_EQ (0, memfind(hay, 2, "abc", 3));
+	EXPECT_EQ (0, memfind(hay, 0, "a", 1));
+	EXPECT_EQ ((uint8_t*)hay + 5, memfind(hay, 6, "f", 1));
+	EXPECT_EQ ((uint8_t*)hay, memfind(hay, 6, "abcdef", 6));
+	EXPECT_EQ (0, memfind(hay, 5, "abcdef", 6));
+}
+
+TEST (StringTest, memfind_long_haystacks)
+{
+	// Needles placed around the 16 and 32 bytes block boundaries.
+	char buf[300];
+	const char* needles[] = { "<a>", "\"id\"", "</Transaction>", "zz", "aaaaaaaaab", "q", "<x y=\"1\"/>" };
+
+	for (size_t n = 0; n < sizeof(needles)/sizeof(needles[0]); ++n) {
+		const uint8_t* needle = (const uint8_t*) needles[n];
+		size_t nl = strlen (needles[n]);
+
+		for (size_t pos = 0; pos + nl <= sizeof(buf); ++pos) {
+			memset (buf, 'a', sizeof(buf));
+			// Lots of false candidates on the first and last needle bytes.
+			for (size_t i = 0; i < sizeof(buf); i += 3) {
+				buf[i] = needle[0];
+			}
+			memcpy (buf + pos, needle, nl);
+
+			for (size_t hl = pos; hl <= sizeof(buf); hl += 37) {
+				const uint8_t* expected = naive_memfind ((const uint8_t*) buf, hl, needle, nl);
+				EXPECT_EQ (expected, memfind (buf, hl, needle, nl)) << needles[n] << " at " << pos << " in " << hl;
+			}
+			const uint8_t* expected = naive_memfind ((const uint8_t*) buf, sizeof(buf), needle, nl);
+			EXPECT_EQ (expected, memfind (buf, sizeof(buf), needle, nl)) << needles[n] << " at " << pos;
+		}
+	}
+}
+
+TEST (StringTest, indexOf_long_haystack)
+{
+	XString s;
+	for (int i = 0; i < 100; ++i) {
+		s.append ("<field name=\"amount\">12</field>");
+	}
+	s.append ("<field name=\"email\">x@y.fr</field>");
+
+	EXPECT_EQ (3100, s.indexOf ("<field name=\"email\">"));
+	EXPECT_EQ (13, s.indexOf ("amount"));
+	EXPECT_TRUE (s.contains ("x@y.fr"));
+	EXPECT_FALSE (s.contains ("<field name=\"phone\">"));
+}
+
+// Naive reference implementation.
+static const uint8_t* naive_memrfind (const uint8_t* h, size_t hl, const uint8_t* n, size_t nl)
+{
+	for (size_t i = hl - nl + 1; hl >= nl && i-- > 0; ) {
+		if (memcmp (h + i, n, nl) == 0) {
+			return h + i;
+		}
+	}
+	return 0;
+}
+
+TEST (StringTest, memrfind_edge_cases)
+{
+	const char* hay = "abcabc";
+
+	EXPECT_EQ ((uint8_t*)hay + 6, memrfind(hay, 6, "xyz", 0));
+	EXPECT_EQ (0, memrfind(hay, 2, "abc", 3));
+	EXPECT_EQ (0, memrfind(hay, 0, "a", 1));
+	EXPECT_EQ ((uint8_t*)hay + 3, memrfind(hay, 6, "a", 1));
+	EXPECT_EQ ((uint8_t*)hay + 3, memrfind(hay, 6, "abc", 3));
+	EXPECT_EQ ((uint8_t*)hay, memrfind(hay, 5, "abc", 3));
+	EXPECT_EQ ((uint8_t*)hay, memrfind(hay, 6, "abcabc", 6));
+	EXPECT_EQ ((uint8_t*)hay + 2, memrfind(hay, 6, "cab", 2));
+}
+
+TEST (StringTest, memrfind_long_haystacks)
+{
+	char buf[300];
+	const char* needles[] = { "<a>", "\"id\"", "</Transaction>", "zz", "baaaaaaaaa", "q", "<x y=\"1\"/>" };
+
+	for (size_t n = 0; n < sizeof(needles)/sizeof(needles[0]); ++n) {
+		const uint8_t* needle = (const uint8_t*) needles[n];
+		size_t nl = strlen (needles[n]);
+
+		for (size_t pos = 0; pos + nl <= sizeof(buf); ++pos) {
+			memset (buf, 'a', sizeof(buf));
+			for (size_t i = 0; i < sizeof(buf); i += 3) {
+				buf[i] = needle[nl - 1];
+			}
+			memcpy (buf + pos, needle, nl);
+
+			for (size_t hl = pos; hl <= sizeof(buf); hl += 37) {
+				const uint8_t* expected = naive_memrfind ((const uint8_t*) buf, hl, needle, nl);
+				EXPECT_EQ (expected, memrfind (buf, hl, needle, nl)) << needles[n] << " at " << pos << " in " << hl;
+			}
+			const uint8_t* expected = naive_memrfind ((const uint8_t*) buf, sizeof(buf), needle, nl);
+			EXPECT_EQ (expected, memrfind (buf, sizeof(buf), needle, nl)) << needles[n] << " at " << pos;
+		}
+	}
+}
+
+TEST (StringTest, lastIndexOf_long_haystack)
+{
+	XString s;
+	s.append ("<field name=\"email\">x@y.fr</field>");
+	for (int i = 0; i < 100; ++i) {
+		s.append ("<field name=\"amount\">12</field>");
+	}
+
+	EXPECT_EQ (0, s.lastIndexOf ("<field name=\"email\">"));
+	EXPECT_EQ (3116, s.lastIndexOf ("amount"));
+	EXPECT_EQ (3126, s.lastIndexOfChar ('<'));
+	EXPECT_EQ (-1, s.lastIndexOf ("<field name=\"phone\">"));
+	EXPECT_EQ (-1, s.lastIndexOfChar ('#'));
+}
+
 TEST (StringTest, memifind_works)
 {
 	uint8_t *ptr;
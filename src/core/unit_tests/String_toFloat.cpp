@@ -20,6 +20,9 @@
  */
 #include "gtest/gtest.h"
 #include <limits.h>
+#include <cerrno>
+#include <clocale>
+#include <cmath>
 #include "fianet-core.h"
 
 using namespace Fianet;
@@ -58,3 +61,68 @@ TEST (StringTest, toFloat_ConversionCorrectness)
 	EXPECT_EQ (11.5, String("1.15e01").toFloat());
 }
 
+
+TEST (StringTest, toFloat_MatchesStrtod)
+{
+	const char* values[] = {
+		"1", "-2.5", " 3.25", "+.5", "5.", "1e10", "1E-10", "2.2250738585072014e-308", "1.7976931348623157e308",
+		"9007199254740993", "9007199254740992.5", "4.35679716e+10", "0.1000000000000000055511151231257827021181583404541015625",
+		"123456789012345678901234567890", "0.000000000000000000000000000001234567890123456789",
+		"7.2057594037927933e16", "3.14159265358979323846264338327950288", "1.00000000000000011102230246251565404236316680908203125",
+		"2.4703282292062327e-324", "1e-400", "1e400", "-1e400", "4.9406564584124654e-324", "2.225073858507201e-308",
+		"inf", "-Infinity", "0x1p3", "0x1.8P1", "0e999999", "1e", "1e+", "1.5e+3x", ".", "-", "0x", "00x1", "1,5"
+	};
+
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+		char* end;
+		errno = 0;
+		const double expected = strtod (values[i], &end);
+		if (end == values[i] || *end) {
+			EXPECT_THROW (String (values[i]).toFloat(), NumberFormatError) << values[i];
+		} else if (errno == ERANGE) {
+			EXPECT_THROW (String (values[i]).toFloat(), NumberRangeError) << values[i];
+		} else {
+			const double value = String (values[i]).toFloat();
+			EXPECT_EQ (0, memcmp (&expected, &value, sizeof(double))) << values[i];
+		}
+	}
+
+	const double nan = String ("nan").toFloat();
+	EXPECT_NE (nan, nan);
+	EXPECT_TRUE (std::signbit (String ("-0.0").toFloat()));
+	EXPECT_FALSE (std::signbit (String ("0.0").toFloat()));
+}
+
+TEST (StringTest, toFloat_ReadsLongInputs)
+{
+	// More digits than the previous 255-byte buffer, and no terminator.
+	XString longNumber ("1.");
+	for (int i = 0; i < 600; ++i) {
+		longNumber.appendChar ('0');
+	}
+	longNumber.append ("1e2");
+	EXPECT_EQ (100.0, String (longNumber.cstr(), longNumber.length()).toFloat());
+	longNumber.appendChar ('x');
+	EXPECT_THROW (String (longNumber.cstr(), longNumber.length()).toFloat(), NumberFormatError);
+	EXPECT_EQ (0.25, String ("0.25e1", 4).toFloat());
+
+	// 2^53 + 1 is halfway between two doubles: a nonzero digit far beyond
+	// it rounds up, instead of to even.
+	XString halfway ("9007199254740993.");
+	for (int i = 0; i < 1000; ++i) {
+		halfway.appendChar ('0');
+	}
+	EXPECT_EQ (9007199254740992.0, String (halfway.cstr(), halfway.length()).toFloat());
+	halfway.append ("1");
+	EXPECT_EQ (9007199254740994.0, String (halfway.cstr(), halfway.length()).toFloat());
+}
+
+TEST (StringTest, toFloat_IgnoresTheLocale)
+{
+	if (setlocale (LC_NUMERIC, "fr_FR.UTF-8") || setlocale (LC_NUMERIC, "fr_FR.ISO-8859-1") || setlocale (LC_NUMERIC, "de_DE.UTF-8")) {
+		EXPECT_EQ (1.5, String ("1.5").toFloat());
+		EXPECT_EQ (12.0, String ("0x1.8p3").toFloat());
+		EXPECT_THROW (String ("1,5").toFloat(), NumberFormatError);
+		setlocale (LC_NUMERIC, "C");
+	}
+}
@@ -225,3 +225,63 @@ TEST (StringTest, toInt_ConversionCorrectnessWitCopy)
 	EXPECT_NO_THROW (uint64_max.toUint64());
 }
 
+
+TEST (StringTest, toInt_MatchesStrtoll)
+{
+	const char* values[] = {
+		"1", "-1", "+7", "  42", "\t-42", "007", "0777", "08", "0x", "0x1g", "0XfF", "-0x80000000",
+		"12345678", "123456789", "1234567890123456", "12345678901234567", "00000000000000000001",
+		"99999999", "100000000", "4294967296", "-4294967295", "9223372036854775807",
+		"9223372036854775808", "-9223372036854775809", "18446744073709551615", "18446744073709551616",
+		"99999999999999999999", "000000000000000000000000000000018446744073709551615",
+		"0x7FFFFFFFFFFFFFFF", "0xFFFFFFFFFFFFFFFF", "0x10000000000000000", "01777777777777777777777",
+		"02000000000000000000000", "1234 ", "12345678a", "1234567a", "-", "+", " ", "1-2", "--1"
+	};
+
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+		const String s (values[i]);
+		char* end;
+		errno = 0;
+		const long long expected = strtoll (values[i], &end, 0);
+		if (end == values[i] || *end) {
+			EXPECT_THROW (s.toInt64(), NumberFormatError) << values[i];
+		} else if (errno == ERANGE) {
+			EXPECT_THROW (s.toInt64(), NumberRangeError) << values[i];
+		} else {
+			EXPECT_EQ (expected, s.toInt64()) << values[i];
+			if (expected >= INT32_MIN && expected <= INT32_MAX) {
+				EXPECT_EQ (expected, s.toInt32()) << values[i];
+			} else {
+				EXPECT_THROW (s.toInt32(), NumberRangeError) << values[i];
+			}
+		}
+
+		errno = 0;
+		const unsigned long long uexpected = strtoull (values[i], &end, 0);
+		if (end == values[i] || *end) {
+			EXPECT_THROW (s.toUint64(), NumberFormatError) << values[i];
+		} else if (errno == ERANGE || (s.indexOfChar ('-') >= 0 && uexpected != 0)) {
+			EXPECT_THROW (s.toUint64(), NumberRangeError) << values[i];
+		} else {
+			EXPECT_EQ (uexpected, s.toUint64()) << values[i];
+		}
+	}
+}
+
+TEST (StringTest, toInt_ParsesEveryLength)
+{
+	// Every length and alignment of the 8-digit blocks, without NUL terminator.
+	char buffer[32];
+	uint64_t expected = 0;
+
+	for (int len = 1; len <= 19; ++len) {
+		buffer[len - 1] = '0' + (len * 7) % 10;
+		expected = expected * 10 + (len * 7) % 10;
+		buffer[len] = '5';
+		EXPECT_EQ (expected, String (buffer, len).toUint64()) << len;
+		EXPECT_EQ (-static_cast<int64_t>(expected), XString ("-").append (buffer, len).toInt64()) << len;
+	}
+	EXPECT_THROW (String ("12345678901234567890", 20).toInt64(), NumberRangeError);
+	EXPECT_THROW (String ("1234567890123456789\0", 20).toUint64(), NumberFormatError);
+	EXPECT_EQ ((uint64_t)0, String ("-0").toUint64());
+}
@@ -1,6 +1,7 @@
 
 #include "gtest/gtest.h"
 #include "fianet-core.h"
+#include <clocale>
 
 using namespace Fianet;
 
@@ -37,4 +38,29 @@ TEST (StringTest, String_trim_works)
 	EXPECT_EQ (CSTR("abc"), CSTR("    abc").trim());
 }
 
+TEST (StringTest, String_trim_removes_the_spaces_of_the_locale)
+{
+	// Whatever the case folding rules, trim() removes the isspace() bytes.
+	const bool latin1 = setlocale (LC_CTYPE, "fr_FR.ISO-8859-1") || setlocale (LC_CTYPE, "fr_FR.iso88591");
+	char buffer[64];
+	for (int c = 1; c < 256; ++c) {
+		for (size_t len = 1; len < 40; len += 19) {
+			memset (buffer, ' ', sizeof(buffer));
+			buffer[len / 2] = static_cast<char>(c);
+			buffer[len] = 'x';
+			const size_t expected = isspace (c) ? len : len / 2;
+			EXPECT_EQ (sizeof(buffer) - expected, String (buffer, sizeof(buffer)).ltrim().length()) << c;
+
+			memset (buffer, ' ', sizeof(buffer));
+			buffer[sizeof(buffer) - 1 - len / 2] = static_cast<char>(c);
+			buffer[sizeof(buffer) - 1 - len] = 'x';
+			EXPECT_EQ (sizeof(buffer) - expected, String (buffer, sizeof(buffer)).rtrim().length()) << c;
+		}
+	}
+	if (latin1) {
+		EXPECT_EQ (CSTR("abc"), CSTR("\xA0 abc \xA0").trim());
+		setlocale (LC_CTYPE, "C");
+	}
+}
+
 }
@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+
+using namespace Fianet;
+
+namespace {
+
+TEST (StringTest, tryTo_ReportsStatuses)
+{
+	int32_t i32 = 7;
+	EXPECT_EQ (PARSE_OK, String ("-2147483648").tryToInt32 (i32));
+	EXPECT_EQ (INT32_MIN, i32);
+	EXPECT_EQ (PARSE_EMPTY, String().tryToInt32 (i32));
+	EXPECT_EQ (PARSE_FORMAT_ERROR, String (" ").tryToInt32 (i32));
+	EXPECT_EQ (PARSE_FORMAT_ERROR, String ("12a").tryToInt32 (i32));
+	EXPECT_EQ (PARSE_RANGE_ERROR, String ("2147483648").tryToInt32 (i32));
+	// Failed conversions leave the value unchanged.
+	EXPECT_EQ (INT32_MIN, i32);
+
+	int i = 0;
+	EXPECT_EQ (PARSE_OK, String ("0x10").tryToInt (i));
+	EXPECT_EQ (16, i);
+
+	uint32_t u32 = 0;
+	EXPECT_EQ (PARSE_OK, String ("4294967295").tryToUint32 (u32));
+	EXPECT_EQ (UINT32_MAX, u32);
+	EXPECT_EQ (PARSE_RANGE_ERROR, String ("-1").tryToUint32 (u32));
+	EXPECT_EQ (PARSE_RANGE_ERROR, String ("4294967296").tryToUint32 (u32));
+
+	int64_t i64 = 0;
+	EXPECT_EQ (PARSE_OK, String ("-9223372036854775808").tryToInt64 (i64));
+	EXPECT_EQ (INT64_MIN, i64);
+	EXPECT_EQ (PARSE_RANGE_ERROR, String ("9223372036854775808").tryToInt64 (i64));
+
+	uint64_t u64 = 0;
+	EXPECT_EQ (PARSE_OK, String ("18446744073709551615").tryToUint64 (u64));
+	EXPECT_EQ (UINT64_MAX, u64);
+	EXPECT_EQ (PARSE_RANGE_ERROR, String ("18446744073709551616").tryToUint64 (u64));
+	EXPECT_EQ (PARSE_FORMAT_ERROR, String ("0x").tryToUint64 (u64));
+
+	double d = 0;
+	EXPECT_EQ (PARSE_OK, String ("1234.56").tryToFloat (d));
+	EXPECT_EQ (1234.56, d);
+	EXPECT_EQ (PARSE_EMPTY, String().tryToFloat (d));
+	EXPECT_EQ (PARSE_FORMAT_ERROR, String ("12,5").tryToFloat (d));
+	EXPECT_EQ (PARSE_RANGE_ERROR, String ("1e999").tryToFloat (d));
+	EXPECT_EQ (1234.56, d);
+}
+
+TEST (StringTest, tryTo_AgreesWithTheThrowingConversions)
+{
+	const char* values[] = { "", "0", "-0", "42", "-42", "0x7fffffff", "0777", "08", "1e3", "1.5", " 7", "7 ",
+		"4294967296", "-2147483649", "99999999999999999999", "abc", "-", "inf" };
+
+	for (size_t k = 0; k < sizeof(values) / sizeof(values[0]); ++k) {
+		const String s (values[k]);
+		int64_t i64;
+		const ParseStatus status = s.tryToInt64 (i64);
+		if (status == PARSE_OK) {
+			EXPECT_EQ (i64, s.toInt64()) << values[k];
+		} else if (status == PARSE_RANGE_ERROR) {
+			EXPECT_THROW (s.toInt64(), NumberRangeError) << values[k];
+		} else {
+			EXPECT_THROW (s.toInt64(), NumberFormatError) << values[k];
+		}
+
+		double d;
+		const ParseStatus floatStatus = s.tryToFloat (d);
+		if (floatStatus == PARSE_OK) {
+			EXPECT_EQ (d, s.toFloat()) << values[k];
+		} else if (floatStatus == PARSE_RANGE_ERROR) {
+			EXPECT_THROW (s.toFloat(), NumberRangeError) << values[k];
+		} else {
+			EXPECT_THROW (s.toFloat(), NumberFormatError) << values[k];
+		}
+	}
+}
+
+} // namespace
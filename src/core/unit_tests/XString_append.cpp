@@ -1,6 +1,7 @@
 
 #include "gtest/gtest.h"
 #include "fianet-core.h"
+#include <vector>
 
 using namespace Fianet;
 
@@ -41,4 +42,83 @@ TEST (XStringTest, appendInt_works)
 	EXPECT_EQ (UINT64_MAX, s.appendUint64(UINT64_MAX).toUint64());
 }
 
+/// Values around every power of ten and of two, and their negations.
+std::vector<uint64_t> formattingValues()
+{
+	std::vector<uint64_t> values;
+	uint64_t p = 1;
+	for (int i = 0; i < 20; ++i, p *= 10) {
+		values.push_back (p - 1);
+		values.push_back (p);
+		values.push_back (p + 1);
+	}
+	for (int i = 0; i < 64; ++i) {
+		values.push_back ((1ULL << i) - 1);
+		values.push_back (1ULL << i);
+	}
+	values.push_back (UINT64_MAX);
+	uint64_t seed = 42;
+	for (int i = 0; i < 2000; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		values.push_back (seed >> (seed % 64));
+	}
+	const size_t n = values.size();
+	for (size_t i = 0; i < n; ++i) {
+		values.push_back (0 - values[i]);
+	}
+	return values;
+}
+
+TEST (XStringTest, appendInt_matches_printf)
+{
+	const std::vector<uint64_t> values = formattingValues();
+	char expected[128];
+
+	for (size_t i = 0; i < values.size(); ++i) {
+		const uint64_t v = values[i];
+		XString s ("x");
+
+		snprintf (expected, sizeof(expected), "x%d%ld%lu%lld%llu", (int) v, (long) (int32_t) v,
+			(unsigned long) (uint32_t) v, (long long) v, (unsigned long long) v);
+		s.appendInt ((int) v).appendInt32 ((int32_t) v).appendUint32 ((uint32_t) v);
+		s.appendInt64 ((int64_t) v).appendUint64 (v);
+		EXPECT_STREQ (expected, s.cstr()) << v;
+		EXPECT_EQ (strlen (expected), s.length());
+
+		snprintf (expected, sizeof(expected), "%llu", (unsigned long long) v);
+		EXPECT_STREQ (expected, s.parseUint64 (v).cstr());
+		snprintf (expected, sizeof(expected), "%lld", (long long) v);
+		EXPECT_STREQ (expected, s.parseInt64 ((int64_t) v).cstr());
+		snprintf (expected, sizeof(expected), "%d", (int32_t) v);
+		EXPECT_STREQ (expected, s.parseInt32 ((int32_t) v).cstr());
+		EXPECT_STREQ (expected, s.parseInt ((int) v).cstr());
+		snprintf (expected, sizeof(expected), "%u", (uint32_t) v);
+		EXPECT_STREQ (expected, s.parseUint32 ((uint32_t) v).cstr());
+		EXPECT_EQ (strlen (expected), s.length());
+	}
+}
+
+TEST (XStringTest, appendHexUint64_and_padding_match_printf)
+{
+	const std::vector<uint64_t> values = formattingValues();
+	const unsigned widths[] = { 0, 1, 2, 5, 16, 20, 21, 40 };
+	char expected[256];
+
+	for (size_t i = 0; i < values.size(); ++i) {
+		const uint64_t v = values[i];
+		for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+			const int width = widths[w];
+			XString s;
+
+			snprintf (expected, sizeof(expected), "%0*llx|%0*llX|%0*llu|%0*lld", width, (unsigned long long) v,
+				width, (unsigned long long) v, width, (unsigned long long) v, width, (long long) v);
+			s.appendHexUint64 (v, width).appendChar ('|').appendHexUint64 (v, width, true).appendChar ('|');
+			s.appendUint64 (v, width).appendChar ('|').appendInt64 ((int64_t) v, width);
+			EXPECT_STREQ (expected, s.cstr()) << v << " " << width;
+		}
+	}
+	XString s;
+	EXPECT_STREQ ("0", s.appendHexUint64 (0).cstr());
+}
+
 } // namespace
@@ -0,0 +1,163 @@
+#include "gtest/gtest.h"
+#include "fianet-core.h"
+#include <cfloat>
+#include <clocale>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace Fianet;
+
+namespace {
+
+std::string shortest (double v)
+{
+	XString s;
+	s.appendDouble (v);
+	return std::string (s.cstr(), s.length());
+}
+
+/// 1e-20 to 1e19, without pow() and libm.
+double powerOfTen (int exponent)
+{
+	static const double POWERS[40] = {
+		1e-20, 1e-19, 1e-18, 1e-17, 1e-16, 1e-15, 1e-14, 1e-13, 1e-12, 1e-11,
+		1e-10, 1e-9, 1e-8, 1e-7, 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1,
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+		1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19
+	};
+	return POWERS[exponent + 20];
+}
+
+/// Random doubles: any bit pattern, amounts and scores with few digits.
+std::vector<double> randomDoubles (size_t count)
+{
+	std::vector<double> values;
+	uint64_t seed = 42;
+	for (size_t i = 0; i < count; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		double v;
+		switch (i % 3) {
+			case 0:
+				memcpy (&v, &seed, sizeof(v));
+				break;
+			case 1:
+				v = static_cast<double>(seed % 100000000) / 100.0;
+				break;
+			default:
+				v = static_cast<double>((seed >> 20) % 1000000) * powerOfTen (static_cast<int>(seed % 40) - 20);
+				break;
+		}
+		values.push_back ((seed >> 63) ? -v : v);
+	}
+	return values;
+}
+
+TEST (XStringTest, appendDouble_writes_the_shortest_digits)
+{
+	EXPECT_EQ ("0", shortest (0.0));
+	EXPECT_EQ ("-0", shortest (-0.0));
+	EXPECT_EQ ("1", shortest (1.0));
+	EXPECT_EQ ("-1.5", shortest (-1.5));
+	EXPECT_EQ ("0.1", shortest (0.1));
+	EXPECT_EQ ("0.30000000000000004", shortest (0.1 + 0.2));
+	EXPECT_EQ ("0.3333333333333333", shortest (1.0 / 3));
+	EXPECT_EQ ("1234.56", shortest (1234.56));
+	EXPECT_EQ ("0.0001", shortest (0.0001));
+	EXPECT_EQ ("1e-05", shortest (0.00001));
+	EXPECT_EQ ("1.5e-05", shortest (0.000015));
+	EXPECT_EQ ("10000000000000000", shortest (1e16));
+	EXPECT_EQ ("1e+17", shortest (1e17));
+	EXPECT_EQ ("1.2345e+20", shortest (1.2345e20));
+	EXPECT_EQ ("9007199254740994", shortest (9007199254740994.0));
+	EXPECT_EQ ("1.2345678901234568e+17", shortest (123456789012345678.0));
+	EXPECT_EQ ("1.7976931348623157e+308", shortest (DBL_MAX));
+	EXPECT_EQ ("2.2250738585072014e-308", shortest (DBL_MIN));
+	EXPECT_EQ ("5e-324", shortest (4.9406564584124654e-324));
+	EXPECT_EQ ("inf", shortest (HUGE_VAL));
+	EXPECT_EQ ("-inf", shortest (-HUGE_VAL));
+	EXPECT_EQ ("nan", shortest (std::fabs (NAN)));
+
+	XString s ("score=");
+	s << 0.25;
+	EXPECT_STREQ ("score=0.25", s.cstr());
+	EXPECT_STREQ ("123456789.123", s.parseFloat (123456789.123).cstr());
+}
+
+TEST (XStringTest, appendDouble_reads_back)
+{
+	const std::vector<double> values = randomDoubles (100000);
+
+	for (size_t i = 0; i < values.size(); ++i) {
+		if (!std::isfinite (values[i])) {
+			continue;
+		}
+		XString s;
+		s.appendDouble (values[i]);
+		const double back = strtod (s.cstr(), 0);
+		EXPECT_EQ (0, memcmp (&back, &values[i], sizeof(double))) << s.cstr();
+
+		// No shorter "%.*e" reads back.
+		std::string significand;
+		for (const char* p = s.cstr(); *p && *p != 'e'; ++p) {
+			if (*p >= '0' && *p <= '9' && (*p != '0' || !significand.empty())) {
+				significand += *p;
+			}
+		}
+		const size_t digits = significand.find_last_not_of ('0') + 1;
+		char shorter[64];
+		snprintf (shorter, sizeof(shorter), "%.*e", (int) digits - 2, values[i]);
+		if (digits > 1 && values[i] != 0) {
+			EXPECT_NE (values[i], strtod (shorter, 0)) << s.cstr();
+		}
+	}
+}
+
+TEST (XStringTest, appendDouble_with_a_precision_matches_printf)
+{
+	std::vector<double> values = randomDoubles (30000);
+	values.push_back (0.5);
+	values.push_back (2.5);
+	values.push_back (0.125);
+	values.push_back (-0.0);
+	values.push_back (HUGE_VAL);
+	values.push_back (NAN);
+	values.push_back (DBL_MAX);
+	values.push_back (DBL_MIN / 3);
+	char expected[512];
+
+	for (size_t i = 0; i < values.size(); ++i) {
+		for (unsigned precision = 0; precision <= 18; ++precision) {
+			XString s ("|");
+			snprintf (expected, sizeof(expected), "|%.*g", precision, values[i]);
+			EXPECT_STREQ (expected, s.appendDouble (values[i], precision).cstr()) << precision;
+		}
+		for (unsigned decimals = 0; decimals <= 22; ++decimals) {
+			XString s ("|");
+			snprintf (expected, sizeof(expected), "|%.*f", decimals, values[i]);
+			EXPECT_STREQ (expected, s.appendFixed (values[i], decimals).cstr()) << decimals;
+		}
+	}
+
+	XString s;
+	s.appendFixed (1e300, 2);
+	EXPECT_EQ ((size_t) 304, s.length());
+	EXPECT_TRUE (s.endsWith (".00"));
+}
+
+TEST (XStringTest, appendDouble_ignores_the_locale)
+{
+	const char* locales[] = { "fr_FR.UTF-8", "fr_FR.utf8", "de_DE.UTF-8", "fr_FR" };
+	bool set = false;
+	for (size_t i = 0; i < sizeof(locales) / sizeof(locales[0]) && !set; ++i) {
+		set = (setlocale (LC_NUMERIC, locales[i]) != 0);
+	}
+
+	XString s;
+	s.appendDouble (1.5).appendChar (' ').appendDouble (2.25, 6).appendChar (' ');
+	s.appendFixed (3.125, 2).appendChar (' ').appendDouble (0.1, 17);
+	setlocale (LC_NUMERIC, "C");
+	EXPECT_STREQ ("1.5 2.25 3.12 0.10000000000000001", s.cstr());
+}
+
+} // namespace